@@ -0,0 +1,266 @@
+#pragma once
+
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+// Compiles requested objects in background jobs and hands them out once they're ready.
+//
+// A request that isn't ready returns PENDING right away, so the caller can use a
+// fallback or skip the work instead of waiting. The most recently requested
+// objects are compiled first: what the current frame needs goes ahead of what
+// an earlier frame asked for. At most maxConcurrentCompiles jobs run at a time,
+// which leaves the other workers to the frame jobs.
+//
+// A compile function that throws marks the object FAILED, it isn't retried.
+//
+// Request is the data needed to compile, it's only made for keys seen for the
+// first time. Value must be copyable, e.g. a ComPtr. Every Find calls Hash, so
+// keys that are costly to hash should carry their hash, like PipelineKey.
+//
+// This class is thread-safe. It must be destroyed by a thread of the job system,
+// it waits for the running compiles
+template <typename Key, typename Request, typename Value, typename Hash = std::hash<Key>>
+class AsyncCompileQueue {
+public:
+	enum class Status {
+		READY,
+		PENDING,
+		FAILED
+	};
+
+	struct Statistics {
+		// Requested but not compiled yet at the end of the frame
+		std::uint32_t pendingCount = 0;
+		// Requests that found their object not ready
+		std::uint32_t notReadyCount = 0;
+		std::uint32_t compiledCount = 0;
+		std::uint32_t failedCount = 0;
+	};
+
+	using CompileFunction = std::function<Value(const Request&)>;
+
+public:
+	AsyncCompileQueue(JobSystem &jobSystem, CompileFunction compile, std::size_t maxConcurrentCompiles);
+	AsyncCompileQueue(const AsyncCompileQueue&) = delete;
+	~AsyncCompileQueue();
+
+	AsyncCompileQueue& operator = (const AsyncCompileQueue&) = delete;
+
+	// Sets the value if it's READY. Otherwise queues the request if the key is new
+	// and moves it ahead of the requests of earlier frames
+	template <typename MakeRequest>
+	Status Find(const Key &key, MakeRequest &&makeRequest, Value &value);
+
+	void EndFrame();
+
+	Statistics LastFrameStatistics();
+
+private:
+	struct Entry {
+		Status status = Status::PENDING;
+		bool isCompiling = false;
+		std::uint64_t lastRequestFrame = 0;
+		Request request;
+		Value value;
+	};
+
+	using EntryPointer = typename std::unordered_map<Key, Entry, Hash>::pointer;
+
+	struct QueuedRequest {
+		std::uint64_t frame;
+		std::uint64_t sequence;
+		EntryPointer entry;
+
+		// Later frames first, then the order of requests within a frame
+		bool operator < (const QueuedRequest &other) const {
+			return frame != other.frame ? frame < other.frame : sequence > other.sequence;
+		}
+	};
+
+private:
+	// Must be called under the lock
+	void Enqueue(EntryPointer entry);
+
+	void StartCompiles();
+	void RunCompiles();
+
+private:
+	JobSystem &mJobSystem;
+	const CompileFunction mCompile;
+	const std::size_t mMaxConcurrentCompiles;
+
+	std::mutex mMutex;
+	std::unordered_map<Key, Entry, Hash> mEntries;
+	// An entry can be queued more than once, only the item with its latest frame counts
+	std::priority_queue<QueuedRequest> mQueue;
+	std::size_t mPendingCount = 0;
+
+	std::uint64_t mFrame = 1;
+	std::uint64_t mNextSequence = 0;
+	std::size_t mRunningCompilesCount = 0;
+	bool mIsStopping = false;
+	JobCounter mCompiles;
+
+	Statistics mFrameStatistics;
+	Statistics mLastFrameStatistics;
+};
+
+
+template <typename Key, typename Request, typename Value, typename Hash>
+AsyncCompileQueue<Key, Request, Value, Hash>::AsyncCompileQueue(
+	JobSystem &jobSystem,
+	CompileFunction compile,
+	std::size_t maxConcurrentCompiles
+)
+: mJobSystem(jobSystem), mCompile(std::move(compile)), mMaxConcurrentCompiles(std::max<std::size_t>(maxConcurrentCompiles, 1)) {
+}
+
+
+template <typename Key, typename Request, typename Value, typename Hash>
+AsyncCompileQueue<Key, Request, Value, Hash>::~AsyncCompileQueue() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mIsStopping = true;
+	}
+
+	mJobSystem.Wait(mCompiles);
+}
+
+
+template <typename Key, typename Request, typename Value, typename Hash>
+template <typename MakeRequest>
+typename AsyncCompileQueue<Key, Request, Value, Hash>::Status AsyncCompileQueue<Key, Request, Value, Hash>::Find(
+	const Key &key,
+	MakeRequest &&makeRequest,
+	Value &value
+) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		auto it = mEntries.find(key);
+		if (it != mEntries.end() && it->second.status == Status::READY) {
+			value = it->second.value;
+			return Status::READY;
+		}
+
+		if (it != mEntries.end() && it->second.status == Status::FAILED) {
+			return Status::FAILED;
+		}
+
+		mFrameStatistics.notReadyCount++;
+
+		if (it == mEntries.end()) {
+			it = mEntries.emplace(key, Entry()).first;
+			it->second.request = makeRequest();
+			mPendingCount++;
+			Enqueue(&*it);
+		} else if (it->second.lastRequestFrame != mFrame && !it->second.isCompiling) {
+			// Requeued with the current frame, the old item becomes stale
+			Enqueue(&*it);
+		}
+	}
+
+	StartCompiles();
+	return Status::PENDING;
+}
+
+
+template <typename Key, typename Request, typename Value, typename Hash>
+void AsyncCompileQueue<Key, Request, Value, Hash>::EndFrame() {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mFrameStatistics.pendingCount = static_cast<std::uint32_t>(mPendingCount);
+	mLastFrameStatistics = mFrameStatistics;
+	mFrameStatistics = Statistics();
+
+	mFrame++;
+}
+
+
+template <typename Key, typename Request, typename Value, typename Hash>
+typename AsyncCompileQueue<Key, Request, Value, Hash>::Statistics AsyncCompileQueue<Key, Request, Value, Hash>::LastFrameStatistics() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mLastFrameStatistics;
+}
+
+
+template <typename Key, typename Request, typename Value, typename Hash>
+void AsyncCompileQueue<Key, Request, Value, Hash>::Enqueue(EntryPointer entry) {
+	entry->second.lastRequestFrame = mFrame;
+	mQueue.push(QueuedRequest{ mFrame, mNextSequence++, entry });
+}
+
+
+template <typename Key, typename Request, typename Value, typename Hash>
+void AsyncCompileQueue<Key, Request, Value, Hash>::StartCompiles() {
+	std::size_t startedCount = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		while (!mIsStopping && mRunningCompilesCount < mMaxConcurrentCompiles && mRunningCompilesCount < mPendingCount) {
+			mRunningCompilesCount++;
+			startedCount++;
+		}
+	}
+
+	for (std::size_t i = 0; i < startedCount; i++) {
+		mJobSystem.RunBackground([this] { RunCompiles(); }, mCompiles);
+	}
+}
+
+
+template <typename Key, typename Request, typename Value, typename Hash>
+void AsyncCompileQueue<Key, Request, Value, Hash>::RunCompiles() {
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	// Takes the most recent requests until none is left
+	while (!mIsStopping && !mQueue.empty()) {
+		const QueuedRequest queued = mQueue.top();
+		mQueue.pop();
+
+		Entry &entry = queued.entry->second;
+		if (entry.isCompiling || entry.status != Status::PENDING || entry.lastRequestFrame != queued.frame) {
+			continue;
+		}
+
+		entry.isCompiling = true;
+		lock.unlock();
+
+		// Entries are never erased and their nodes don't move, the reference stays valid
+		Value value = Value();
+		bool isCompiled = true;
+		try {
+			value = mCompile(entry.request);
+		} catch (...) {
+			isCompiled = false;
+		}
+
+		lock.lock();
+
+		entry.isCompiling = false;
+		entry.status = isCompiled ? Status::READY : Status::FAILED;
+		entry.value = std::move(value);
+		entry.request = Request();
+		mPendingCount--;
+
+		if (isCompiled) {
+			mFrameStatistics.compiledCount++;
+		} else {
+			mFrameStatistics.failedCount++;
+		}
+	}
+
+	mRunningCompilesCount--;
+}
@@ -0,0 +1,86 @@
+#include "AsyncPipelineStateCompiler.h"
+
+#include <cassert>
+#include <cstring>
+
+
+AsyncPipelineStateCompiler::AsyncPipelineStateCompiler(
+	PipelineStateCache &pipelineStates,
+	JobSystem &jobSystem,
+	std::size_t maxConcurrentCompiles
+)
+: mPipelineStates(pipelineStates),
+  mCompiles(
+	  jobSystem,
+	  [this](const Stream &stream) {
+		  const D3D12_PIPELINE_STATE_STREAM_DESC streamDesc = { stream.size() * sizeof(void*), const_cast<void**>(stream.data()) };
+		  return mPipelineStates.GetOrCreate(streamDesc);
+	  },
+	  maxConcurrentCompiles
+  ) {
+}
+
+
+ComPtr<ID3D12PipelineState> AsyncPipelineStateCompiler::Find(const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc) {
+	return Find(mPipelineStates.BuildKey(streamDesc), streamDesc);
+}
+
+
+ComPtr<ID3D12PipelineState> AsyncPipelineStateCompiler::Find(
+	const PipelineKey &key,
+	const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc
+) {
+	// The copy is kept in pointers, its size must not be rounded up
+	assert(streamDesc.SizeInBytes % sizeof(void*) == 0);
+
+	ComPtr<ID3D12PipelineState> pipelineState;
+
+	mCompiles.Find(
+		key,
+		[&streamDesc]() {
+			Stream stream(streamDesc.SizeInBytes / sizeof(void*));
+			std::memcpy(stream.data(), streamDesc.pPipelineStateSubobjectStream, streamDesc.SizeInBytes);
+			return stream;
+		},
+		pipelineState
+	);
+
+	return pipelineState;
+}
+
+
+ID3D12PipelineState* AsyncPipelineStateCompiler::FindOrFallback(
+	const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc,
+	ID3D12PipelineState *fallback
+) {
+	return FindOrFallback(mPipelineStates.BuildKey(streamDesc), streamDesc, fallback);
+}
+
+
+ID3D12PipelineState* AsyncPipelineStateCompiler::FindOrFallback(
+	const PipelineKey &key,
+	const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc,
+	ID3D12PipelineState *fallback
+) {
+	// The cache keeps the pipeline alive
+	ComPtr<ID3D12PipelineState> pipelineState = Find(key, streamDesc);
+	return pipelineState ? pipelineState.Get() : fallback;
+}
+
+
+void AsyncPipelineStateCompiler::EndFrame() {
+	mCompiles.EndFrame();
+}
+
+
+AsyncPipelineStateCompiler::Statistics AsyncPipelineStateCompiler::LastFrameStatistics() {
+	const CompileQueue::Statistics compileStatistics = mCompiles.LastFrameStatistics();
+
+	Statistics statistics;
+	statistics.pendingCompilesCount = compileStatistics.pendingCount;
+	statistics.fallbacksCount = compileStatistics.notReadyCount;
+	statistics.compiledCount = compileStatistics.compiledCount;
+	statistics.failedCount = compileStatistics.failedCount;
+
+	return statistics;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "JobSystem.h"
+#include "AsyncCompileQueue.h"
+#include "PipelineStateCache.h"
+
+#include <cstddef>
+#include <vector>
+
+
+// Creates pipeline states in background jobs, so the render thread never waits for compilation.
+//
+// Find returns nullptr until the pipeline is ready, the caller draws with a fallback
+// pipeline or skips the draw. The pipelines needed by the latest frame are created
+// first. Only the stream is copied, the shaders, input layouts and root signature it
+// points to must stay alive until the pipeline is ready.
+//
+// This class is thread-safe. It must be destroyed by a thread of the job system
+class AsyncPipelineStateCompiler {
+public:
+	struct Statistics {
+		// Requested but not created yet at the end of the frame
+		UINT pendingCompilesCount = 0;
+		// Requests that found their pipeline still compiling and used a fallback or skipped the draw
+		UINT fallbacksCount = 0;
+		UINT compiledCount = 0;
+		UINT failedCount = 0;
+	};
+
+public:
+	AsyncPipelineStateCompiler(PipelineStateCache &pipelineStates, JobSystem &jobSystem, std::size_t maxConcurrentCompiles);
+	AsyncPipelineStateCompiler(const AsyncPipelineStateCompiler&) = delete;
+
+	AsyncPipelineStateCompiler& operator = (const AsyncPipelineStateCompiler&) = delete;
+
+	// Returns nullptr if the pipeline isn't ready or failed to be created. Builds
+	// the key of the stream, which serializes and hashes all of it
+	ComPtr<ID3D12PipelineState> Find(const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc);
+
+	// Takes the key PipelineStateCache::BuildKey returned for the stream, so a
+	// pipeline used every frame has its key built and hashed only once
+	ComPtr<ID3D12PipelineState> Find(const PipelineKey &key, const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc);
+
+	// Also returns the fallback if the pipeline failed to be created
+	ID3D12PipelineState* FindOrFallback(const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc, ID3D12PipelineState *fallback);
+
+	ID3D12PipelineState* FindOrFallback(
+		const PipelineKey &key,
+		const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc,
+		ID3D12PipelineState *fallback
+	);
+
+	void EndFrame();
+
+	Statistics LastFrameStatistics();
+
+private:
+	// Subobjects are aligned to pointers
+	using Stream = std::vector<void*>;
+
+	using CompileQueue = AsyncCompileQueue<PipelineKey, Stream, ComPtr<ID3D12PipelineState>, PipelineKeyHash>;
+
+private:
+	PipelineStateCache &mPipelineStates;
+	CompileQueue mCompiles;
+};
@@ -0,0 +1,50 @@
+#include "BindlessHandleTable.h"
+
+
+BindlessHandleTable::BindlessHandleTable(std::uint32_t capacity)
+: mCapacity(capacity), mGenerations(new std::atomic<std::uint32_t>[capacity]), mFreeList(capacity) {
+	for (std::uint32_t i = 0; i < capacity; i++) {
+		mGenerations[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+
+BindlessHandle BindlessHandleTable::Allocate() {
+	BindlessHandle handle;
+
+	handle.index = mFreeList.Pop();
+	if (handle.index == INVALID_DESCRIPTOR_INDEX) {
+		// Slots that were never used aren't in the free list
+		std::uint32_t usedSlotsCount = mUsedSlotsCount.load(std::memory_order_relaxed);
+		do {
+			if (usedSlotsCount == mCapacity) {
+				return BindlessHandle();
+			}
+		} while (!mUsedSlotsCount.compare_exchange_weak(usedSlotsCount, usedSlotsCount + 1, std::memory_order_relaxed));
+
+		handle.index = usedSlotsCount;
+	}
+
+	// Only the owner of a dead slot touches its generation, so no CAS is needed
+	handle.generation = mGenerations[handle.index].load(std::memory_order_relaxed) + 1;
+	mGenerations[handle.index].store(handle.generation, std::memory_order_release);
+
+	return handle;
+}
+
+
+bool BindlessHandleTable::Invalidate(BindlessHandle handle) {
+	if (!IsValid(handle)) {
+		return false;
+	}
+
+	std::uint32_t expected = handle.generation;
+	return mGenerations[handle.index].compare_exchange_strong(
+		expected, handle.generation + 1, std::memory_order_acq_rel, std::memory_order_relaxed
+	);
+}
+
+
+void BindlessHandleTable::Recycle(std::uint32_t index) {
+	mFreeList.Push(index);
+}
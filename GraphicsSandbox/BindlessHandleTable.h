@@ -0,0 +1,72 @@
+#pragma once
+
+
+#include "DescriptorAllocator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+
+// Stable handle of a slot in a bindless table. The index is what shaders see,
+// the generation tells a live handle from a stale one after the slot is reused.
+struct BindlessHandle {
+	std::uint32_t index = INVALID_DESCRIPTOR_INDEX;
+	std::uint32_t generation = 0;
+
+	bool operator == (const BindlessHandle &other) const {
+		return index == other.index && generation == other.generation;
+	}
+
+	bool operator != (const BindlessHandle &other) const {
+		return !(*this == other);
+	}
+};
+
+
+// Lock-free table of generation-checked slots.
+//
+// Freeing is split in two steps: Invalidate makes the handle stale at once,
+// Recycle makes the slot available again, e.g. after the GPU is done with it.
+// Live slots have odd generations, dead ones even, so a handle can't become
+// valid again by accident.
+//
+// This class is thread-safe
+class BindlessHandleTable {
+public:
+	explicit BindlessHandleTable(std::uint32_t capacity);
+	BindlessHandleTable(const BindlessHandleTable&) = delete;
+
+	BindlessHandleTable& operator = (const BindlessHandleTable&) = delete;
+
+	// Returns a handle with INVALID_DESCRIPTOR_INDEX if the table is full
+	BindlessHandle Allocate();
+
+	// Returns false if the handle is already stale
+	bool Invalidate(BindlessHandle handle);
+
+	// The slot must have been invalidated
+	void Recycle(std::uint32_t index);
+
+	bool IsValid(BindlessHandle handle) const {
+		if (handle.index >= mCapacity) {
+			return false;
+		}
+
+		std::uint32_t generation = mGenerations[handle.index].load(std::memory_order_acquire);
+		return (generation & 1) != 0 && generation == handle.generation;
+	}
+
+	std::uint32_t Capacity() const {
+		return mCapacity;
+	}
+
+private:
+	const std::uint32_t mCapacity;
+
+	std::unique_ptr<std::atomic<std::uint32_t>[]> mGenerations;
+	DescriptorFreeList mFreeList;
+
+	// Slots below it have been handed out at least once
+	std::atomic<std::uint32_t> mUsedSlotsCount{0};
+};
@@ -0,0 +1,138 @@
+#include "BindlessResourceTable.h"
+#include "d3dx12.h"
+
+#include <stdexcept>
+
+
+BindlessResourceTable::BindlessResourceTable(GraphicsDevice &device, WaitableGpuFence &fence, ShaderVisibleDescriptorRing &heap)
+: mDevice(device), mHeap(heap), mHandles(heap.PersistentDescriptorsCount()), mRetiringFrees(fence) {
+}
+
+
+BindlessHandle BindlessResourceTable::CreateShaderResourceView(ID3D12Resource *resource, const D3D12_SHADER_RESOURCE_VIEW_DESC *desc) {
+	BindlessHandle handle = AllocateHandle();
+	mDevice.GetD3dDevice()->CreateShaderResourceView(resource, desc, mHeap.PersistentCpuHandle(handle.index));
+
+	return handle;
+}
+
+
+BindlessHandle BindlessResourceTable::CreateUnorderedAccessView(ID3D12Resource *resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC *desc) {
+	BindlessHandle handle = AllocateHandle();
+	mDevice.GetD3dDevice()->CreateUnorderedAccessView(resource, nullptr, desc, mHeap.PersistentCpuHandle(handle.index));
+
+	return handle;
+}
+
+
+BindlessHandle BindlessResourceTable::CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC *desc) {
+	BindlessHandle handle = AllocateHandle();
+	mDevice.GetD3dDevice()->CreateConstantBufferView(desc, mHeap.PersistentCpuHandle(handle.index));
+
+	return handle;
+}
+
+
+BindlessHandle BindlessResourceTable::CopyDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE source) {
+	BindlessHandle handle = AllocateHandle();
+	mDevice.GetD3dDevice()->CopyDescriptorsSimple(
+		1, mHeap.PersistentCpuHandle(handle.index), source, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
+	);
+
+	return handle;
+}
+
+
+void BindlessResourceTable::Free(BindlessHandle handle) {
+	if (!mHandles.Invalidate(handle)) {
+		throw std::logic_error("Bindless handle is freed twice or is stale");
+	}
+
+	std::lock_guard<std::mutex> lock(mFreedMutex);
+	mFreedThisFrame.push_back(handle.index);
+}
+
+
+void BindlessResourceTable::EndFrame(const WaitableGpuFence::Label &label) {
+	std::vector<std::uint32_t> freed;
+
+	std::lock_guard<std::mutex> lock(mFreedMutex);
+
+	// Frees are retired by frame, so one label covers the whole batch
+	while (mRetiringFrees.TryAcquire(freed)) {
+		for (std::uint32_t index : freed) {
+			mHandles.Recycle(index);
+		}
+	}
+
+	if (!mFreedThisFrame.empty()) {
+		mRetiringFrees.Release(std::move(mFreedThisFrame), label);
+		mFreedThisFrame.clear();
+	}
+}
+
+
+BindlessHandle BindlessResourceTable::AllocateHandle() {
+	BindlessHandle handle = mHandles.Allocate();
+	if (handle.index == INVALID_DESCRIPTOR_INDEX) {
+		throw std::runtime_error("Bindless resource table is full");
+	}
+
+	return handle;
+}
+
+
+BindlessRootParameters::BindlessRootParameters(D3D12_SHADER_VISIBILITY visibility) {
+	// UINT_MAX makes the ranges unbounded, descriptors may change while the
+	// root signature is bound as long as the GPU doesn't read them
+	const D3D12_DESCRIPTOR_RANGE_TYPE rangeTypes[PARAMETERS_COUNT] = {
+		D3D12_DESCRIPTOR_RANGE_TYPE_SRV,
+		D3D12_DESCRIPTOR_RANGE_TYPE_UAV,
+		D3D12_DESCRIPTOR_RANGE_TYPE_CBV
+	};
+	const UINT registerSpaces[PARAMETERS_COUNT] = {
+		SRV_REGISTER_SPACE,
+		UAV_REGISTER_SPACE,
+		CBV_REGISTER_SPACE
+	};
+
+	for (UINT i = 0; i < PARAMETERS_COUNT; i++) {
+		CD3DX12_DESCRIPTOR_RANGE1 range;
+		range.Init(rangeTypes[i], UINT_MAX, 0, registerSpaces[i], D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE, 0);
+		mRanges[i] = range;
+
+		CD3DX12_ROOT_PARAMETER1 parameter;
+		parameter.InitAsDescriptorTable(1, &mRanges[i], visibility);
+		mParameters[i] = parameter;
+	}
+}
+
+
+UINT BindlessRootParameters::AppendTo(std::vector<D3D12_ROOT_PARAMETER1> &parameters) const {
+	UINT firstParameterIndex = static_cast<UINT>(parameters.size());
+	parameters.insert(parameters.end(), mParameters, mParameters + PARAMETERS_COUNT);
+
+	return firstParameterIndex;
+}
+
+
+void BindlessRootParameters::SetGraphicsRootTables(
+	ID3D12GraphicsCommandList *commandList,
+	UINT firstParameterIndex,
+	D3D12_GPU_DESCRIPTOR_HANDLE tableStart
+) const {
+	for (UINT i = 0; i < PARAMETERS_COUNT; i++) {
+		commandList->SetGraphicsRootDescriptorTable(firstParameterIndex + i, tableStart);
+	}
+}
+
+
+void BindlessRootParameters::SetComputeRootTables(
+	ID3D12GraphicsCommandList *commandList,
+	UINT firstParameterIndex,
+	D3D12_GPU_DESCRIPTOR_HANDLE tableStart
+) const {
+	for (UINT i = 0; i < PARAMETERS_COUNT; i++) {
+		commandList->SetComputeRootDescriptorTable(firstParameterIndex + i, tableStart);
+	}
+}
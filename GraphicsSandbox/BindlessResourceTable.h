@@ -0,0 +1,110 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "BindlessHandleTable.h"
+#include "RetirementQueue.h"
+#include "ShaderVisibleDescriptorRing.h"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+// Persistent descriptors in the reserved part of a shader-visible heap that
+// shaders index directly with BindlessHandle::index.
+//
+// A freed handle becomes stale at once, but its slot is reused only after the
+// label of the frame that freed it completes.
+//
+// Creating views and freeing are thread-safe
+class BindlessResourceTable {
+public:
+	BindlessResourceTable(GraphicsDevice &device, WaitableGpuFence &fence, ShaderVisibleDescriptorRing &heap);
+	BindlessResourceTable(const BindlessResourceTable&) = delete;
+
+	BindlessResourceTable& operator = (const BindlessResourceTable&) = delete;
+
+	BindlessHandle CreateShaderResourceView(ID3D12Resource *resource, const D3D12_SHADER_RESOURCE_VIEW_DESC *desc);
+	BindlessHandle CreateUnorderedAccessView(ID3D12Resource *resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC *desc);
+	BindlessHandle CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC *desc);
+
+	// Copies a descriptor that was created elsewhere, e.g. in a CPU descriptor heap
+	BindlessHandle CopyDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE source);
+
+	// The descriptor may still be read by the frame that is being recorded
+	void Free(BindlessHandle handle);
+
+	bool IsValid(BindlessHandle handle) const {
+		return mHandles.IsValid(handle);
+	}
+
+	// Handles freed since the previous call are reused once the label completes
+	void EndFrame(const WaitableGpuFence::Label &label);
+
+	// Start of the table for the root parameters of BindlessRootParameters
+	D3D12_GPU_DESCRIPTOR_HANDLE TableStart() const {
+		return mHeap.PersistentGpuHandle(0);
+	}
+
+private:
+	BindlessHandle AllocateHandle();
+
+private:
+	GraphicsDevice &mDevice;
+	ShaderVisibleDescriptorRing &mHeap;
+
+	BindlessHandleTable mHandles;
+
+	std::mutex mFreedMutex;
+	std::vector<std::uint32_t> mFreedThisFrame;
+	RetirementQueue<WaitableGpuFence, std::vector<std::uint32_t>> mRetiringFrees;
+};
+
+
+// Root parameters that expose the bindless table as unbounded arrays of SRVs,
+// UAVs and CBVs in their own register spaces, e.g.
+// Texture2D gTextures[] : register(t0, space1);
+//
+// Every parameter is a separate table that starts at TableStart, so the three
+// ranges alias the same descriptors.
+//
+// Parameters reference the ranges of this object, it must outlive the root
+// signature desc
+class BindlessRootParameters {
+public:
+	static constexpr UINT SRV_REGISTER_SPACE = 1;
+	static constexpr UINT UAV_REGISTER_SPACE = 2;
+	static constexpr UINT CBV_REGISTER_SPACE = 3;
+	static constexpr UINT PARAMETERS_COUNT = 3;
+
+public:
+	explicit BindlessRootParameters(D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL);
+	BindlessRootParameters(const BindlessRootParameters&) = delete;
+
+	BindlessRootParameters& operator = (const BindlessRootParameters&) = delete;
+
+	const D3D12_ROOT_PARAMETER1* Parameters() const {
+		return mParameters;
+	}
+
+	// Appends the parameters to the ones of a root signature, returns the index of the first one
+	UINT AppendTo(std::vector<D3D12_ROOT_PARAMETER1> &parameters) const;
+
+	void SetGraphicsRootTables(
+		ID3D12GraphicsCommandList *commandList,
+		UINT firstParameterIndex,
+		D3D12_GPU_DESCRIPTOR_HANDLE tableStart
+	) const;
+
+	void SetComputeRootTables(
+		ID3D12GraphicsCommandList *commandList,
+		UINT firstParameterIndex,
+		D3D12_GPU_DESCRIPTOR_HANDLE tableStart
+	) const;
+
+private:
+	D3D12_DESCRIPTOR_RANGE1 mRanges[PARAMETERS_COUNT];
+	D3D12_ROOT_PARAMETER1 mParameters[PARAMETERS_COUNT];
+};
@@ -0,0 +1,194 @@
+#include "BlobCacheFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+	#include "WindowsCommon.h"
+#endif
+
+
+namespace {
+	constexpr std::size_t ENTRY_ALIGNMENT = 8;
+
+
+	struct FileHeader {
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint64_t entriesCount;
+	};
+
+
+	struct EntryHeader {
+		std::uint64_t keyHash;
+		std::uint32_t keySize;
+		std::uint32_t blobSize;
+	};
+
+
+	std::size_t AlignEntrySize(std::size_t size) {
+		return (size + ENTRY_ALIGNMENT - 1) & ~(ENTRY_ALIGNMENT - 1);
+	}
+
+
+	// Replaces the destination in one step, readers see either the old or the new file
+	bool RenameOver(const std::string &sourcePath, const std::string &destinationPath) {
+	#if defined(_WIN32)
+		return MoveFileExA(sourcePath.c_str(), destinationPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+	#else
+		return std::rename(sourcePath.c_str(), destinationPath.c_str()) == 0;
+	#endif
+	}
+}
+
+
+BlobCacheFile::BlobCacheFile(std::uint32_t magic)
+: mMagic(magic) {
+}
+
+
+bool BlobCacheFile::Load(const std::string &path) {
+	mIndex.clear();
+	mNewEntries.clear();
+
+	if (!mFile.Open(path)) {
+		return false;
+	}
+
+	const std::uint8_t *data = mFile.Data();
+	const std::size_t size = mFile.Size();
+
+	FileHeader header;
+	if (size < sizeof(header)) {
+		return false;
+	}
+
+	std::memcpy(&header, data, sizeof(header));
+	if (header.magic != mMagic || header.version != VERSION) {
+		return false;
+	}
+
+	std::size_t position = sizeof(header);
+	for (std::uint64_t i = 0; i < header.entriesCount; i++) {
+		EntryHeader entryHeader;
+		if (size - position < sizeof(entryHeader)) {
+			mIndex.clear();
+			return false;
+		}
+
+		std::memcpy(&entryHeader, data + position, sizeof(entryHeader));
+
+		const std::size_t entrySize = AlignEntrySize(sizeof(entryHeader) + entryHeader.keySize + entryHeader.blobSize);
+		if (size - position < entrySize) {
+			mIndex.clear();
+			return false;
+		}
+
+		Entry entry;
+		entry.key = data + position + sizeof(entryHeader);
+		entry.keySize = entryHeader.keySize;
+		entry.blob = entry.key + entry.keySize;
+		entry.blobSize = entryHeader.blobSize;
+
+		mIndex.emplace(entryHeader.keyHash, entry);
+		position += entrySize;
+	}
+
+	return true;
+}
+
+
+void BlobCacheFile::Save(const std::string &path) {
+	const std::string temporaryPath = path + ".tmp";
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("Can't open cache file " + temporaryPath);
+		}
+
+		const FileHeader header = { mMagic, VERSION, mIndex.size() };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		const char padding[ENTRY_ALIGNMENT] = {};
+
+		for (const auto &indexEntry : mIndex) {
+			const Entry &entry = indexEntry.second;
+			const EntryHeader entryHeader = {
+				indexEntry.first,
+				static_cast<std::uint32_t>(entry.keySize),
+				static_cast<std::uint32_t>(entry.blobSize)
+			};
+
+			const std::size_t size = sizeof(entryHeader) + entry.keySize + entry.blobSize;
+
+			file.write(reinterpret_cast<const char*>(&entryHeader), sizeof(entryHeader));
+			file.write(reinterpret_cast<const char*>(entry.key), entry.keySize);
+			file.write(reinterpret_cast<const char*>(entry.blob), entry.blobSize);
+			file.write(padding, AlignEntrySize(size) - size);
+		}
+
+		if (!file) {
+			throw std::runtime_error("Can't write cache file " + temporaryPath);
+		}
+	}
+
+	// A mapped file can't be replaced on Windows
+	mIndex.clear();
+	mFile.Close();
+
+	if (!RenameOver(temporaryPath, path)) {
+		// The entries are still in the temporary file
+		Load(temporaryPath);
+		throw std::runtime_error("Can't replace cache file " + path);
+	}
+
+	Load(path);
+}
+
+
+bool BlobCacheFile::Find(const void *key, std::size_t keySize, std::uint64_t keyHash, Blob &blob) const {
+	auto range = mIndex.equal_range(keyHash);
+	for (auto it = range.first; it != range.second; ++it) {
+		const Entry &entry = it->second;
+		if (entry.keySize == keySize && std::memcmp(entry.key, key, keySize) == 0) {
+			blob.data = entry.blob;
+			blob.size = entry.blobSize;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void BlobCacheFile::Insert(const void *key, std::size_t keySize, std::uint64_t keyHash, const void *blob, std::size_t blobSize) {
+	auto range = mIndex.equal_range(keyHash);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second.keySize == keySize && std::memcmp(it->second.key, key, keySize) == 0) {
+			mIndex.erase(it);
+			break;
+		}
+	}
+
+	const std::uint8_t *keyBytes = static_cast<const std::uint8_t*>(key);
+	const std::uint8_t *blobBytes = static_cast<const std::uint8_t*>(blob);
+
+	NewEntry newEntry;
+	newEntry.keyHash = keyHash;
+	newEntry.key.assign(keyBytes, keyBytes + keySize);
+	newEntry.blob.assign(blobBytes, blobBytes + blobSize);
+
+	// Moving the vectors keeps their buffers, so the index stays valid when the list grows
+	mNewEntries.push_back(std::move(newEntry));
+
+	Entry entry;
+	entry.key = mNewEntries.back().key.data();
+	entry.keySize = keySize;
+	entry.blob = mNewEntries.back().blob.data();
+	entry.blobSize = blobSize;
+
+	mIndex.emplace(keyHash, entry);
+}
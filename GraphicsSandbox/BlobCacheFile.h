@@ -0,0 +1,80 @@
+#pragma once
+
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// Blobs keyed by arbitrary bytes, read from a memory-mapped file.
+//
+// Loading only builds an index of the mapped entries, blobs are never copied.
+// New blobs are kept in memory until Save, which writes every entry into a new
+// file and maps it in place of the old one.
+//
+// The file is a header with a magic number, the format version and the number
+// of entries, followed by the entries: the key hash, the key and blob sizes, the
+// key and the blob, each entry padded to 8 bytes. A file that doesn't parse is
+// treated as empty.
+//
+// This class is not thread-safe
+class BlobCacheFile {
+public:
+	struct Blob {
+		const void *data;
+		std::size_t size;
+	};
+
+public:
+	explicit BlobCacheFile(std::uint32_t magic);
+	BlobCacheFile(const BlobCacheFile&) = delete;
+
+	BlobCacheFile& operator = (const BlobCacheFile&) = delete;
+
+	// Returns false if the file is missing or invalid, the cache is empty then
+	bool Load(const std::string &path);
+
+	// Writes a temporary file first, so a failed save doesn't corrupt the old one
+	void Save(const std::string &path);
+
+	// The blob stays valid until the next Load or Save
+	bool Find(const void *key, std::size_t keySize, std::uint64_t keyHash, Blob &blob) const;
+
+	void Insert(const void *key, std::size_t keySize, std::uint64_t keyHash, const void *blob, std::size_t blobSize);
+
+	std::size_t EntriesCount() const {
+		return mIndex.size();
+	}
+
+	bool HasNewEntries() const {
+		return !mNewEntries.empty();
+	}
+
+private:
+	static constexpr std::uint32_t VERSION = 1;
+
+	struct Entry {
+		const std::uint8_t *key;
+		std::size_t keySize;
+		const std::uint8_t *blob;
+		std::size_t blobSize;
+	};
+
+	struct NewEntry {
+		std::uint64_t keyHash;
+		std::vector<std::uint8_t> key;
+		std::vector<std::uint8_t> blob;
+	};
+
+private:
+	const std::uint32_t mMagic;
+
+	MappedFile mFile;
+	// Points into the mapped file or the new entries
+	std::unordered_multimap<std::uint64_t, Entry> mIndex;
+	std::vector<NewEntry> mNewEntries;
+};
@@ -0,0 +1,41 @@
+#include "CommandAllocatorPool.h"
+
+
+CommandAllocatorPool::CommandAllocatorPool(GraphicsDevice &device, WaitableGpuFence &fence)
+: mDevice(device) {
+	mQueues.reserve(COMMAND_LIST_TYPES_COUNT);
+	for (UINT i = 0; i < COMMAND_LIST_TYPES_COUNT; i++) {
+		mQueues.emplace_back(fence);
+	}
+}
+
+
+ComPtr<ID3D12CommandAllocator> CommandAllocatorPool::Acquire(D3D12_COMMAND_LIST_TYPE type) {
+	ComPtr<ID3D12CommandAllocator> allocator;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (!mQueues[type].TryAcquire(allocator)) {
+			++mCreatedCount;
+		}
+	}
+
+	if (allocator) {
+		// The GPU is done with it, so the memory can be reused
+		D3D_CHECK(allocator->Reset());
+	} else {
+		D3D_CHECK(mDevice.GetD3dDevice()->CreateCommandAllocator(type, IID_PPV_ARGS(&allocator)));
+	}
+
+	return allocator;
+}
+
+
+void CommandAllocatorPool::Release(
+	D3D12_COMMAND_LIST_TYPE type,
+	ComPtr<ID3D12CommandAllocator> allocator,
+	const WaitableGpuFence::Label &label
+) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mQueues[type].Release(std::move(allocator), label);
+}
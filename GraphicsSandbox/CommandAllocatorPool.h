@@ -0,0 +1,51 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "RetirementQueue.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+// Recycles command allocators once the GPU is done with the lists recorded into them.
+//
+// An allocator is handed out already reset and is given back together with the
+// label put after the submission of its command lists. Several lists can be
+// recorded per frame this way without flushing the queue and without creating
+// allocators every frame.
+//
+// This class is thread-safe
+class CommandAllocatorPool {
+public:
+	CommandAllocatorPool(GraphicsDevice &device, WaitableGpuFence &fence);
+	CommandAllocatorPool(const CommandAllocatorPool&) = delete;
+
+	CommandAllocatorPool& operator = (const CommandAllocatorPool&) = delete;
+
+	ComPtr<ID3D12CommandAllocator> Acquire(D3D12_COMMAND_LIST_TYPE type);
+
+	void Release(
+		D3D12_COMMAND_LIST_TYPE type,
+		ComPtr<ID3D12CommandAllocator> allocator,
+		const WaitableGpuFence::Label &label
+	);
+
+	// Allocators created since the pool construction
+	UINT CreatedCount() const {
+		return mCreatedCount;
+	}
+
+private:
+	static constexpr UINT COMMAND_LIST_TYPES_COUNT = D3D12_COMMAND_LIST_TYPE_COPY + 1;
+
+	using AllocatorQueue = RetirementQueue<WaitableGpuFence, ComPtr<ID3D12CommandAllocator>>;
+
+	GraphicsDevice &mDevice;
+
+	std::mutex mMutex;
+	std::vector<AllocatorQueue> mQueues;
+	std::atomic<UINT> mCreatedCount{0};
+};
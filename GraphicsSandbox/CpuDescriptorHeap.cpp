@@ -0,0 +1,90 @@
+#include "CpuDescriptorHeap.h"
+#include "d3dx12.h"
+
+
+namespace {
+	ComPtr<ID3D12DescriptorHeap> CreateCpuHeap(GraphicsDevice &device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT count) {
+		D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+		heapDesc.Type = type;
+		heapDesc.NumDescriptors = count;
+		heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+		heapDesc.NodeMask = 0;
+
+		ComPtr<ID3D12DescriptorHeap> heap;
+		D3D_CHECK(device.GetD3dDevice()->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&heap)));
+
+		return heap;
+	}
+}
+
+
+CpuDescriptorHeap::CpuDescriptorHeap(
+	GraphicsDevice &device,
+	D3D12_DESCRIPTOR_HEAP_TYPE type,
+	UINT descriptorsPerPage,
+	UINT transientDescriptorsCount
+)
+: mDevice(device),
+  mType(type),
+  mDescriptorSize(device.GetD3dDevice()->GetDescriptorHandleIncrementSize(type)),
+  mPersistentAllocator(descriptorsPerPage, MAX_PAGES_COUNT, [this](UINT pageIndex) { CreatePage(pageIndex); }),
+  mTransientHeap(CreateCpuHeap(device, type, transientDescriptorsCount)),
+  mTransientStart(mTransientHeap->GetCPUDescriptorHandleForHeapStart()),
+  mTransientAllocator(transientDescriptorsCount) {
+}
+
+
+CpuDescriptor CpuDescriptorHeap::AllocatePersistent() {
+	UINT index = mPersistentAllocator.Allocate();
+
+	UINT descriptorsPerPage = mPersistentAllocator.DescriptorsPerPage();
+	CD3DX12_CPU_DESCRIPTOR_HANDLE handle(
+		mPageStarts[index / descriptorsPerPage],
+		index % descriptorsPerPage,
+		mDescriptorSize
+	);
+
+	return CpuDescriptor{ handle, index };
+}
+
+
+void CpuDescriptorHeap::FreePersistent(const CpuDescriptor &descriptor) {
+	mPersistentAllocator.Free(descriptor.index);
+}
+
+
+D3D12_CPU_DESCRIPTOR_HANDLE CpuDescriptorHeap::AllocateTransient(UINT count) {
+	UINT index = mTransientAllocator.Allocate(count);
+	if (index == INVALID_DESCRIPTOR_INDEX) {
+		throw std::runtime_error("Out of transient descriptors");
+	}
+
+	return CD3DX12_CPU_DESCRIPTOR_HANDLE(mTransientStart, index, mDescriptorSize);
+}
+
+
+void CpuDescriptorHeap::ResetTransient() {
+	mTransientAllocator.Reset();
+}
+
+
+void CpuDescriptorHeap::CreatePage(UINT pageIndex) {
+	mPages[pageIndex] = CreateCpuHeap(mDevice, mType, mPersistentAllocator.DescriptorsPerPage());
+	mPageStarts[pageIndex] = mPages[pageIndex]->GetCPUDescriptorHandleForHeapStart();
+}
+
+
+CpuDescriptorAllocator::CpuDescriptorAllocator(GraphicsDevice &device)
+: mCbvSrvUavHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 1024, 4096),
+  mSamplerHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, 128, 512),
+  mRtvHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 64, 256),
+  mDsvHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 64, 256) {
+}
+
+
+void CpuDescriptorAllocator::ResetTransient() {
+	mCbvSrvUavHeap.ResetTransient();
+	mSamplerHeap.ResetTransient();
+	mRtvHeap.ResetTransient();
+	mDsvHeap.ResetTransient();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "DescriptorAllocator.h"
+
+#include <array>
+
+
+// Descriptor that stays valid until it's freed
+struct CpuDescriptor {
+	D3D12_CPU_DESCRIPTOR_HANDLE handle;
+	UINT index;
+};
+
+
+// Non-shader-visible descriptors of one heap type.
+//
+// Persistent descriptors come from pages of heaps that are created on demand,
+// transient ones from a separate heap that is freed all at once by ResetTransient.
+// CPU descriptors are read when commands are recorded, so transient descriptors
+// can be reset as soon as the lists that use them are recorded.
+//
+// Allocation and freeing are lock-free and thread-safe, ResetTransient must not
+// race with them
+class CpuDescriptorHeap {
+public:
+	CpuDescriptorHeap(
+		GraphicsDevice &device,
+		D3D12_DESCRIPTOR_HEAP_TYPE type,
+		UINT descriptorsPerPage,
+		UINT transientDescriptorsCount
+	);
+	CpuDescriptorHeap(const CpuDescriptorHeap&) = delete;
+
+	CpuDescriptorHeap& operator = (const CpuDescriptorHeap&) = delete;
+
+	CpuDescriptor AllocatePersistent();
+	void FreePersistent(const CpuDescriptor &descriptor);
+
+	// Returns the first handle of a contiguous range
+	D3D12_CPU_DESCRIPTOR_HANDLE AllocateTransient(UINT count = 1);
+	void ResetTransient();
+
+	UINT DescriptorSize() const {
+		return mDescriptorSize;
+	}
+
+private:
+	static constexpr UINT MAX_PAGES_COUNT = 64;
+
+	void CreatePage(UINT pageIndex);
+
+private:
+	GraphicsDevice &mDevice;
+	const D3D12_DESCRIPTOR_HEAP_TYPE mType;
+	const UINT mDescriptorSize;
+
+	// Written only before the indices of a page are published
+	std::array<ComPtr<ID3D12DescriptorHeap>, MAX_PAGES_COUNT> mPages;
+	std::array<D3D12_CPU_DESCRIPTOR_HANDLE, MAX_PAGES_COUNT> mPageStarts;
+	PagedDescriptorAllocator mPersistentAllocator;
+
+	ComPtr<ID3D12DescriptorHeap> mTransientHeap;
+	D3D12_CPU_DESCRIPTOR_HANDLE mTransientStart;
+	LinearDescriptorAllocator mTransientAllocator;
+};
+
+
+// CPU descriptor heaps of every type
+class CpuDescriptorAllocator {
+public:
+	explicit CpuDescriptorAllocator(GraphicsDevice &device);
+	CpuDescriptorAllocator(const CpuDescriptorAllocator&) = delete;
+
+	CpuDescriptorAllocator& operator = (const CpuDescriptorAllocator&) = delete;
+
+	CpuDescriptorHeap& Heap(D3D12_DESCRIPTOR_HEAP_TYPE type) {
+		switch (type) {
+		case D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV:
+			return mCbvSrvUavHeap;
+		case D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER:
+			return mSamplerHeap;
+		case D3D12_DESCRIPTOR_HEAP_TYPE_RTV:
+			return mRtvHeap;
+		default:
+			return mDsvHeap;
+		}
+	}
+
+	CpuDescriptorHeap& Rtv() {
+		return mRtvHeap;
+	}
+
+	CpuDescriptorHeap& Dsv() {
+		return mDsvHeap;
+	}
+
+	CpuDescriptorHeap& CbvSrvUav() {
+		return mCbvSrvUavHeap;
+	}
+
+	CpuDescriptorHeap& Sampler() {
+		return mSamplerHeap;
+	}
+
+	void ResetTransient();
+
+private:
+	CpuDescriptorHeap mCbvSrvUavHeap;
+	CpuDescriptorHeap mSamplerHeap;
+	CpuDescriptorHeap mRtvHeap;
+	CpuDescriptorHeap mDsvHeap;
+};
@@ -0,0 +1,53 @@
+#include "CpuTimelineFence.h"
+
+#include <algorithm>
+
+
+CpuTimelineFence::Label CpuTimelineFence::PutLabel() {
+	Label label;
+	label.mLabelValue = mNextValue.fetch_add(1, std::memory_order_relaxed);
+
+	return label;
+}
+
+
+void CpuTimelineFence::Signal(const Label &label) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mCompletedValue.load(std::memory_order_relaxed) >= label.mLabelValue) {
+			return;
+		}
+
+		mCompletedValue.store(label.mLabelValue, std::memory_order_release);
+	}
+
+	mCompleted.notify_all();
+}
+
+
+void CpuTimelineFence::WaitForLabel(const Label &label) {
+	WaitForValue(label.mLabelValue);
+}
+
+
+void CpuTimelineFence::WaitForLabels(const Label *labels, std::size_t labelsCount) {
+	// Values complete in order, so waiting for the latest one is enough
+	std::uint64_t maxValue = 0;
+	for (std::size_t i = 0; i < labelsCount; i++) {
+		maxValue = std::max(maxValue, labels[i].mLabelValue);
+	}
+
+	WaitForValue(maxValue);
+}
+
+
+void CpuTimelineFence::WaitForValue(std::uint64_t value) {
+	if (mCompletedValue.load(std::memory_order_acquire) >= value) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mCompleted.wait(lock, [this, value] {
+		return mCompletedValue.load(std::memory_order_acquire) >= value;
+	});
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+
+// CPU-side counterpart of WaitableGpuFence with the same label interface.
+//
+// Labels are put by the producer and completed by whoever plays the role of
+// the GPU through Signal. It lets the code that is templated on a fence run,
+// and be measured, without a D3D12 device.
+//
+// All methods are thread-safe
+class CpuTimelineFence {
+public:
+	class Label {
+		friend CpuTimelineFence;
+
+	public:
+		bool operator < (const Label &other) const {
+			return mLabelValue < other.mLabelValue;
+		}
+
+	private:
+		std::uint64_t mLabelValue = 0;
+	};
+
+public:
+	CpuTimelineFence() = default;
+	CpuTimelineFence(const CpuTimelineFence&) = delete;
+
+	CpuTimelineFence& operator = (const CpuTimelineFence&) = delete;
+
+	Label PutLabel();
+
+	// Completes the label and every label put before it
+	void Signal(const Label &label);
+
+	// Doesn't block
+	bool IsComplete(const Label &label) const {
+		return mCompletedValue.load(std::memory_order_acquire) >= label.mLabelValue;
+	}
+
+	void WaitForLabel(const Label &label);
+
+	// Returns when all of the labels are complete. Only the latest label is
+	// waited for, there is one timeline like the one of a single queue
+	void WaitForLabels(const Label *labels, std::size_t labelsCount);
+
+	std::uint64_t CompletedValue() const {
+		return mCompletedValue.load(std::memory_order_acquire);
+	}
+
+private:
+	void WaitForValue(std::uint64_t value);
+
+private:
+	std::atomic<std::uint64_t> mNextValue{1};
+	std::atomic<std::uint64_t> mCompletedValue{0};
+
+	std::mutex mMutex;
+	std::condition_variable mCompleted;
+};
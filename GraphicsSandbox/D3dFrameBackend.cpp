@@ -0,0 +1,377 @@
+#include "D3dFrameBackend.h"
+#include "d3dx12.h"
+
+
+D3dFrameBackend::D3dFrameBackend(HWND hWnd, UINT width, UINT height, JobSystem &jobSystem)
+: D3dFrameBackend(width, height, jobSystem) {
+	UINT dxgiFactoryFlags = 0;
+
+	#if	defined(_DEBUG)
+	{
+		// Enable additional debug layers.
+		dxgiFactoryFlags |= DXGI_CREATE_FACTORY_DEBUG;
+	}
+	#endif
+
+	ComPtr<IDXGIFactory7> factory;
+	D3D_CHECK(CreateDXGIFactory2(dxgiFactoryFlags, IID_PPV_ARGS(&factory)));
+
+	DXGI_SAMPLE_DESC sampleDesc;
+	sampleDesc.Count = 1;
+	sampleDesc.Quality = 0;
+
+	{
+		DXGI_SWAP_CHAIN_DESC1 swapChainDesc;
+		swapChainDesc.Width = width;
+		swapChainDesc.Height = height;
+		swapChainDesc.Format = BACK_BUFFER_FORMAT;
+		swapChainDesc.Stereo = false;
+		swapChainDesc.SampleDesc = sampleDesc;
+		swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+		swapChainDesc.BufferCount = SWAP_CHAIN_BUFFERS_COUNT;
+		swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
+		swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+		swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
+		// Frames wait on the swap chain before they start instead of in Present
+		swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
+		ComPtr<IDXGISwapChain1> swapChain;
+		D3D_CHECK(factory->CreateSwapChainForHwnd(
+			mCommandQueue.Get(), hWnd, &swapChainDesc, nullptr, nullptr, &swapChain
+		));
+
+		// This sample does not support fullscreen transitions.
+		D3D_CHECK(factory->MakeWindowAssociation(hWnd, DXGI_MWA_NO_ALT_ENTER));
+
+		D3D_CHECK(swapChain.As(&mSwapChain));
+
+		D3D_CHECK(mSwapChain->SetMaximumFrameLatency(MAX_FRAME_LATENCY));
+		mFrameLatencyWaitableObject = mSwapChain->GetFrameLatencyWaitableObject();
+		WINDOWS_CHECK(mFrameLatencyWaitableObject != nullptr);
+
+		mCurrentBackBufferIndex = mSwapChain->GetCurrentBackBufferIndex();
+	}
+
+	mBackBuffers.resize(SWAP_CHAIN_BUFFERS_COUNT);
+	mBackBufferRtvs.resize(SWAP_CHAIN_BUFFERS_COUNT);
+
+	for (UINT i = 0; i < SWAP_CHAIN_BUFFERS_COUNT; i++) {
+		D3D_CHECK(mSwapChain->GetBuffer(i, IID_PPV_ARGS(&mBackBuffers[i])));
+		mResourceStates.Register(mBackBuffers[i].Get(), 1, ResourceState::PRESENT);
+
+		mBackBufferRtvs[i] = mCpuDescriptors.Rtv().AllocatePersistent();
+		mDevice.GetD3dDevice()->CreateRenderTargetView(mBackBuffers[i].Get(), nullptr, mBackBufferRtvs[i].handle);
+	}
+}
+
+
+D3dFrameBackend::D3dFrameBackend(UINT width, UINT height, JobSystem &jobSystem, FrameDumpWriter &frameWriter)
+: D3dFrameBackend(width, height, jobSystem) {
+	const CD3DX12_RESOURCE_DESC backBufferDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+		BACK_BUFFER_FORMAT, width, height, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET
+	);
+
+	UINT64 readbackBufferSize;
+	mDevice.GetD3dDevice()->GetCopyableFootprints(
+		&backBufferDesc, 0, 1, 0, &mReadbackFootprint, nullptr, nullptr, &readbackBufferSize
+	);
+
+	mBackBuffers.resize(OFFSCREEN_BUFFERS_COUNT);
+	mBackBufferRtvs.resize(OFFSCREEN_BUFFERS_COUNT);
+
+	for (UINT i = 0; i < OFFSCREEN_BUFFERS_COUNT; i++) {
+		// In the state of the buffers of a swap chain, the frame graph doesn't tell them apart
+		D3D_CHECK(mDevice.GetD3dDevice()->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&backBufferDesc,
+			D3D12_RESOURCE_STATE_PRESENT,
+			nullptr,
+			IID_PPV_ARGS(&mBackBuffers[i])
+		));
+		mResourceStates.Register(mBackBuffers[i].Get(), 1, ResourceState::PRESENT);
+
+		mBackBufferRtvs[i] = mCpuDescriptors.Rtv().AllocatePersistent();
+		mDevice.GetD3dDevice()->CreateRenderTargetView(mBackBuffers[i].Get(), nullptr, mBackBufferRtvs[i].handle);
+
+		mReadbackBuffers.push_back(std::make_unique<ReadbackBuffer>(mDevice, readbackBufferSize));
+	}
+
+	mReadbacks = std::make_unique<ReadbackRing<WaitableGpuFence>>(mFence, frameWriter, OFFSCREEN_BUFFERS_COUNT);
+	mCurrentBackBufferIndex = static_cast<UINT>(mReadbacks->Acquire());
+}
+
+
+D3dFrameBackend::D3dFrameBackend(UINT width, UINT height, JobSystem &jobSystem)
+: mFence(mDevice),
+  mCpuDescriptors(mDevice),
+  mShaderVisibleDescriptors(
+	mDevice, mFence, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, SHADER_VISIBLE_DESCRIPTORS_COUNT, BINDLESS_DESCRIPTORS_COUNT
+  ),
+  mBindlessResources(mDevice, mFence, mShaderVisibleDescriptors),
+  mUploads(
+	mFence,
+	[this](std::uint64_t size) { return std::make_unique<UploadBuffer>(mDevice, size); },
+	UPLOAD_RING_SIZE,
+	UPLOAD_DEDICATED_SIZE_THRESHOLD
+  ),
+  mGpuMemory(mDevice),
+  mTransientResources(mDevice, mFence, mGpuMemory),
+  mPipelineStates(mDevice, PIPELINE_CACHE_FILE_PATH),
+  // Half of the workers at most, the others are left to the frame jobs
+  mPipelineCompiler(mPipelineStates, jobSystem, (jobSystem.ThreadsCount() - 1) / 2),
+  mRootSignatures(mDevice, mPipelineStates, ROOT_SIGNATURE_CACHE_FILE_PATH),
+  mCommandQueue(CreateDirectCommandQueue(mDevice)),
+  mGpuProfiler(mDevice, mCommandQueue.Get(), mFence),
+  mCommandAllocators(mDevice, mFence),
+  mRecordingBackend(mDevice, mCommandAllocators, mResourceStates, mCommandQueue.Get()),
+  mCurrentBackBufferIndex(0) {
+	DXGI_SAMPLE_DESC sampleDesc;
+	sampleDesc.Count = 1;
+	sampleDesc.Quality = 0;
+
+	{
+		mDepthStencilDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		mDepthStencilDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		mDepthStencilDesc.Width = width;
+		mDepthStencilDesc.Height = height;
+		mDepthStencilDesc.DepthOrArraySize = 1;
+		mDepthStencilDesc.MipLevels = 1;
+		mDepthStencilDesc.Format = DEPTH_STENCIL_FORMAT;
+		mDepthStencilDesc.SampleDesc = sampleDesc;
+		mDepthStencilDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+		mDepthStencilDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+
+		mDepthStencilClearValue = {};
+		mDepthStencilClearValue.Format = DEPTH_STENCIL_FORMAT;
+		mDepthStencilClearValue.DepthStencil.Depth = 1.0f;
+		mDepthStencilClearValue.DepthStencil.Stencil = 0;
+
+		// Placed once the frame graph is compiled
+		mDepthStencilBuffer = NO_TRANSIENT_RESOURCE;
+	}
+
+	// The view is created once the depth-stencil buffer is placed
+	mDepthStencilDsv = mCpuDescriptors.Dsv().AllocatePersistent();
+}
+
+
+D3dFrameBackend::~D3dFrameBackend() {
+	// Frames in flight still reference resources owned by this object. The
+	// flush fails only if the device is lost, and then the GPU doesn't use
+	// them anymore, so the error is only logged
+	try {
+		FlushCommandQueue();
+	} catch (const std::exception &exception) {
+		OutputDebugStringA("D3dFrameBackend: flushing the command queue failed: ");
+		OutputDebugStringA(exception.what());
+		OutputDebugStringA("\n");
+	}
+
+	// Pipelines compiled and signatures serialized in this run are created from their blobs in the next one
+	try {
+		mPipelineStates.Save();
+		mRootSignatures.Save();
+	} catch (...) {
+	}
+
+	if (mFrameLatencyWaitableObject != nullptr) {
+		CloseHandle(mFrameLatencyWaitableObject);
+	}
+}
+
+
+void D3dFrameBackend::PlaceTransientResources(const CompiledRenderGraph &graph, RenderGraph::ResourceId depthStencilId) {
+	const CompiledRenderGraph::Lifetime &depthStencilLifetime = graph.resourceLifetimes[depthStencilId];
+
+	ID3D12Resource *previousDepthStencilBuffer = mDepthStencilBuffer != NO_TRANSIENT_RESOURCE
+		? mTransientResources.Resource(mDepthStencilBuffer)
+		: nullptr;
+
+	mTransientResources.BeginDeclarations();
+	mDepthStencilBuffer = mTransientResources.Declare(
+		mDepthStencilDesc,
+		D3D12_RESOURCE_STATE_DEPTH_WRITE,
+		&mDepthStencilClearValue,
+		depthStencilLifetime.firstPass,
+		depthStencilLifetime.lastPass
+	);
+
+	if (mTransientResources.Compile()) {
+		ID3D12Resource *depthStencilBuffer = mTransientResources.Resource(mDepthStencilBuffer);
+
+		if (previousDepthStencilBuffer != nullptr) {
+			mResourceStates.Unregister(previousDepthStencilBuffer);
+		}
+		mResourceStates.Register(
+			depthStencilBuffer,
+			D3D12GetFormatPlaneCount(mDevice.GetD3dDevice().Get(), mDepthStencilDesc.Format),
+			ResourceState::DEPTH_WRITE
+		);
+
+		mDevice.GetD3dDevice()->CreateDepthStencilView(depthStencilBuffer, nullptr, mDepthStencilDsv.handle);
+	}
+}
+
+
+void D3dFrameBackend::BeginRecording(CommandList &commandList) {
+	ID3D12DescriptorHeap *descriptorHeaps[] = { mShaderVisibleDescriptors.Heap() };
+	commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+}
+
+
+void D3dFrameBackend::FlushPassBarriers(CommandList &commandList, std::uint32_t pass) {
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	mTransientResources.AppendAliasingBarriers(pass, barriers);
+	commandList.FlushBarriers(barriers);
+}
+
+
+void D3dFrameBackend::FlushBarriers(CommandList &commandList) {
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	commandList.FlushBarriers(barriers);
+}
+
+
+void D3dFrameBackend::WaitForFrameLatency() {
+	if (mFrameLatencyWaitableObject != nullptr) {
+		WINDOWS_CHECK(WaitForSingleObjectEx(mFrameLatencyWaitableObject, FRAME_LATENCY_TIMEOUT_MILLISECONDS, TRUE) != WAIT_FAILED);
+	}
+}
+
+
+D3dFrameBackend::Fence::Label D3dFrameBackend::Present() {
+	// Descriptors were copied into the recorded lists, the transient ones can be reused
+	mCpuDescriptors.ResetTransient();
+
+	if (mSwapChain) {
+		if (mGpuProfiler.IsResolveNeeded()) {
+			RecordGpuProfileResolve();
+		}
+
+		D3D_CHECK(mSwapChain->Present(mSyncInterval, 0));
+
+		return mFence.PutLabel(mCommandQueue.Get());
+	}
+
+	RecordReadback();
+	if (mGpuProfiler.IsResolveNeeded()) {
+		RecordGpuProfileResolve();
+	}
+
+	const Fence::Label label = mFence.PutLabel(mCommandQueue.Get());
+
+	const ImageView image = {
+		mReadbackBuffers[mCurrentBackBufferIndex]->CpuAddress() + mReadbackFootprint.Offset,
+		mReadbackFootprint.Footprint.Width,
+		mReadbackFootprint.Footprint.Height,
+		mReadbackFootprint.Footprint.RowPitch
+	};
+	mReadbacks->Submit(mCurrentBackBufferIndex, label, mPresentedFramesCount, image);
+	mPresentedFramesCount++;
+
+	return label;
+}
+
+
+void D3dFrameBackend::EndFrame(FrameContext &frame, const Fence::Label &label) {
+	mShaderVisibleDescriptors.EndFrame(label);
+	mBindlessResources.EndFrame(label);
+	mUploads.EndFrame(label);
+	mTransientResources.EndFrame(label);
+	mPipelineCompiler.EndFrame();
+	mGpuProfiler.EndFrame(label);
+
+	mRecordingBackend.TakeSubmittedAllocators(frame.directCommandAllocators);
+	for (auto &commandAllocator : frame.directCommandAllocators) {
+		mCommandAllocators.Release(D3D12_COMMAND_LIST_TYPE_DIRECT, std::move(commandAllocator), label);
+	}
+	frame.directCommandAllocators.clear();
+
+	mCurrentBackBufferIndex = mSwapChain
+		? mSwapChain->GetCurrentBackBufferIndex()
+		: static_cast<UINT>(mReadbacks->Acquire());
+}
+
+
+void D3dFrameBackend::WaitForReadbacks() {
+	mReadbacks->WaitForAll();
+}
+
+
+ReadbackRing<WaitableGpuFence>::Statistics D3dFrameBackend::ReadbackStatistics() {
+	return mReadbacks->GetStatistics();
+}
+
+
+D3dFrameBackend::FrameStatistics D3dFrameBackend::LastFrameStatistics() {
+	auto descriptorStatistics = mShaderVisibleDescriptors.LastFrameStatistics();
+
+	FrameStatistics statistics;
+	statistics.descriptorTablesStagedCount = descriptorStatistics.stagedTablesCount;
+	statistics.descriptorTablesDeduplicatedCount = descriptorStatistics.deduplicatedTablesCount;
+	statistics.descriptorStagingCopiesCount = descriptorStatistics.stagingCopiesCount;
+
+	auto pipelineStatistics = mPipelineCompiler.LastFrameStatistics();
+	statistics.pipelineCompilesPendingCount = pipelineStatistics.pendingCompilesCount;
+	statistics.pipelineFallbacksCount = pipelineStatistics.fallbacksCount;
+
+	return statistics;
+}
+
+
+ComPtr<ID3D12CommandQueue> D3dFrameBackend::CreateDirectCommandQueue(GraphicsDevice &device) {
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+
+	ComPtr<ID3D12CommandQueue> commandQueue;
+	D3D_CHECK(device.GetD3dDevice()->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&commandQueue)));
+
+	return commandQueue;
+}
+
+
+void D3dFrameBackend::RecordReadback() {
+	ID3D12Resource *backBuffer = mBackBuffers[mCurrentBackBufferIndex].Get();
+
+	CommandList commandList = mRecordingBackend.BeginCommandList();
+	const GpuScope gpuScope = mGpuProfiler.BeginScope(commandList.commandList.Get(), "Readback copy");
+
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	commandList.states.Transition(backBuffer, ALL_SUBRESOURCES, ResourceState::COPY_SOURCE);
+	commandList.FlushBarriers(barriers);
+
+	const CD3DX12_TEXTURE_COPY_LOCATION destination(
+		mReadbackBuffers[mCurrentBackBufferIndex]->Resource(), mReadbackFootprint
+	);
+	const CD3DX12_TEXTURE_COPY_LOCATION source(backBuffer, 0);
+	commandList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+
+	// Back to the state the frame graph imports it in
+	commandList.states.Transition(backBuffer, ALL_SUBRESOURCES, ResourceState::PRESENT);
+
+	mGpuProfiler.EndScope(commandList.commandList.Get(), gpuScope);
+	mRecordingBackend.EndCommandList(commandList);
+	mRecordingBackend.ExecuteCommandLists(&commandList, 1);
+}
+
+
+void D3dFrameBackend::RecordGpuProfileResolve() {
+	// After every scope of the frame, the lists are executed in order
+	CommandList commandList = mRecordingBackend.BeginCommandList();
+	mGpuProfiler.ResolveFrame(commandList.commandList.Get());
+	mRecordingBackend.EndCommandList(commandList);
+	mRecordingBackend.ExecuteCommandLists(&commandList, 1);
+}
+
+
+void D3dFrameBackend::FlushCommandQueue() {
+	auto label = mFence.PutLabel(mCommandQueue.Get());
+	mShaderVisibleDescriptors.EndFrame(label);
+	mBindlessResources.EndFrame(label);
+	mUploads.EndFrame(label);
+	mTransientResources.EndFrame(label);
+	mPipelineCompiler.EndFrame();
+	mFence.WaitForLabel(label);
+}
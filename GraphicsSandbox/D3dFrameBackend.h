@@ -0,0 +1,226 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "CommandAllocatorPool.h"
+#include "D3dRecordingBackend.h"
+#include "JobSystem.h"
+#include "CpuDescriptorHeap.h"
+#include "ShaderVisibleDescriptorRing.h"
+#include "BindlessResourceTable.h"
+#include "UploadBuffer.h"
+#include "UploadRing.h"
+#include "GpuMemoryAllocator.h"
+#include "TransientResourceAllocator.h"
+#include "RenderGraph.h"
+#include "PipelineStateCache.h"
+#include "AsyncPipelineStateCompiler.h"
+#include "RootSignatureCache.h"
+#include "ReadbackBuffer.h"
+#include "ReadbackRing.h"
+#include "FrameDumpWriter.h"
+#include "GpuProfiler.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+// Backend of FrameRenderer for a D3D12 device and a swap chain of a window, or
+// offscreen for batch jobs.
+//
+// Offscreen, frames are rendered into a ring of textures. Present copies the
+// frame into a readback buffer of its texture, and a ReadbackRing hands the
+// buffer over to a FrameDumpWriter once the copy completes, so neither the CPU
+// nor the GPU wait for the readback.
+//
+// GPU scopes are timed with a GpuProfiler while a FrameProfiler captures.
+//
+// BeginRecording and the barrier flushes are thread-safe, they're called by the
+// recording tasks. Other methods are called by one thread
+class D3dFrameBackend {
+public:
+	using Fence = WaitableGpuFence;
+	using RecordingBackend = D3dRecordingBackend;
+	using CommandList = D3dRecordingBackend::CommandList;
+	using RenderTargetView = D3D12_CPU_DESCRIPTOR_HANDLE;
+	using DepthStencilView = D3D12_CPU_DESCRIPTOR_HANDLE;
+	using GpuScope = GpuProfiler::Scope;
+
+	// Transient state owned by one frame in flight
+	struct FrameContext {
+		// Allocators recorded into during the frame, returned to the pool on submission
+		std::vector<ComPtr<ID3D12CommandAllocator>> directCommandAllocators;
+	};
+
+	// Counters of the last rendered frame
+	struct FrameStatistics {
+		UINT descriptorTablesStagedCount;
+		UINT descriptorTablesDeduplicatedCount;
+		UINT descriptorStagingCopiesCount;
+		UINT pipelineCompilesPendingCount;
+		// Draws that used a fallback pipeline while theirs was compiling
+		UINT pipelineFallbacksCount;
+	};
+
+public:
+	D3dFrameBackend(HWND hWnd, UINT width, UINT height, JobSystem &jobSystem);
+	// Offscreen, the writer must outlive the backend
+	D3dFrameBackend(UINT width, UINT height, JobSystem &jobSystem, FrameDumpWriter &frameWriter);
+	~D3dFrameBackend();
+	D3dFrameBackend(const D3dFrameBackend&) = delete;
+
+	D3dFrameBackend& operator = (const D3dFrameBackend&) = delete;
+
+	Fence& GetFence() {
+		return mFence;
+	}
+
+	RecordingBackend& Recording() {
+		return mRecordingBackend;
+	}
+
+	void* BackBuffer() {
+		return mBackBuffers[mCurrentBackBufferIndex].Get();
+	}
+
+	RenderTargetView BackBufferView() const {
+		return mBackBufferRtvs[mCurrentBackBufferIndex].handle;
+	}
+
+	// Places the transient resources by the pass lifetimes of a new frame graph
+	void PlaceTransientResources(const CompiledRenderGraph &graph, RenderGraph::ResourceId depthStencilId);
+
+	void* DepthStencilBuffer() {
+		return mTransientResources.Resource(mDepthStencilBuffer);
+	}
+
+	DepthStencilView DepthStencilBufferView() const {
+		return mDepthStencilDsv.handle;
+	}
+
+	void BeginRecording(CommandList &commandList);
+
+	// Aliasing barriers of the transient resources go in one batch with the transitions
+	void FlushPassBarriers(CommandList &commandList, std::uint32_t pass);
+
+	void FlushBarriers(CommandList &commandList);
+
+	GpuScope BeginGpuScope(CommandList &commandList, const char *name) {
+		return mGpuProfiler.BeginScope(commandList.commandList.Get(), name);
+	}
+
+	void EndGpuScope(CommandList &commandList, const GpuScope &scope) {
+		mGpuProfiler.EndScope(commandList.commandList.Get(), scope);
+	}
+
+	// Blocks until the swap chain is ready for a new frame, so the frame starts
+	// as late as possible and presents with the lowest latency. Offscreen it
+	// returns right away
+	void WaitForFrameLatency();
+
+	// 0 presents right away, 1 on the next vertical blank
+	void SetSyncInterval(UINT syncInterval) {
+		mSyncInterval = syncInterval;
+	}
+
+	// Offscreen, queues the readback of the frame
+	Fence::Label Present();
+
+	// Offscreen, waits if every texture is still being read back
+	void EndFrame(FrameContext &frame, const Fence::Label &label);
+
+	// Offscreen, waits until the files of the presented frames are written and
+	// rethrows the errors of the writer
+	void WaitForReadbacks();
+
+	// Offscreen
+	ReadbackRing<WaitableGpuFence>::Statistics ReadbackStatistics();
+
+	// Waits for the captured frames in flight and adds their GPU scopes to the
+	// capture, before it's exported
+	void CollectGpuProfile() {
+		mGpuProfiler.CollectAll();
+	}
+
+	FrameStatistics LastFrameStatistics();
+
+private:
+	// Everything but the back buffers
+	D3dFrameBackend(UINT width, UINT height, JobSystem &jobSystem);
+
+	static ComPtr<ID3D12CommandQueue> CreateDirectCommandQueue(GraphicsDevice &device);
+
+	void FlushCommandQueue();
+
+	void RecordReadback();
+
+	void RecordGpuProfileResolve();
+
+private:
+	static constexpr DXGI_FORMAT BACK_BUFFER_FORMAT = DXGI_FORMAT_R8G8B8A8_UNORM;
+	static constexpr DXGI_FORMAT DEPTH_STENCIL_FORMAT = DXGI_FORMAT_D32_FLOAT_S8X24_UINT;
+	static constexpr UINT SWAP_CHAIN_BUFFERS_COUNT = 2;
+	// Frames queued for presentation before the waitable object blocks
+	static constexpr UINT MAX_FRAME_LATENCY = 1;
+	// Long enough for a frame at any refresh rate, the wait never hangs if the window stops presenting
+	static constexpr DWORD FRAME_LATENCY_TIMEOUT_MILLISECONDS = 1000;
+	// Textures of the frames rendered offscreen, the ones being read back included
+	static constexpr UINT OFFSCREEN_BUFFERS_COUNT = 3;
+	static constexpr UINT SHADER_VISIBLE_DESCRIPTORS_COUNT = 65536;
+	// Reserved at the beginning of the shader-visible heap
+	static constexpr UINT BINDLESS_DESCRIPTORS_COUNT = 16384;
+	static constexpr UINT64 UPLOAD_RING_SIZE = 16 * 1024 * 1024;
+	// Larger uploads get a buffer of their own
+	static constexpr UINT64 UPLOAD_DEDICATED_SIZE_THRESHOLD = 4 * 1024 * 1024;
+	static constexpr UINT NO_TRANSIENT_RESOURCE = UINT_MAX;
+	// Relative to the working directory
+	static constexpr const char *PIPELINE_CACHE_FILE_PATH = "PipelineCache.bin";
+	static constexpr const char *ROOT_SIGNATURE_CACHE_FILE_PATH = "RootSignatureCache.bin";
+
+	GraphicsDevice mDevice;
+
+	WaitableGpuFence mFence;
+
+	CpuDescriptorAllocator mCpuDescriptors;
+	ShaderVisibleDescriptorRing mShaderVisibleDescriptors;
+	BindlessResourceTable mBindlessResources;
+
+	UploadRing<WaitableGpuFence, UploadBuffer> mUploads;
+	GpuMemoryAllocator mGpuMemory;
+	TransientResourceAllocator mTransientResources;
+
+	PipelineStateCache mPipelineStates;
+	AsyncPipelineStateCompiler mPipelineCompiler;
+	RootSignatureCache mRootSignatures;
+
+	ComPtr<ID3D12CommandQueue> mCommandQueue;
+	GpuProfiler mGpuProfiler;
+
+	CommandAllocatorPool mCommandAllocators;
+	ResourceStateRegistry mResourceStates;
+	D3dRecordingBackend mRecordingBackend;
+
+	// Null offscreen
+	ComPtr<IDXGISwapChain4> mSwapChain;
+	HANDLE mFrameLatencyWaitableObject = nullptr;
+	UINT mSyncInterval = 1;
+	UINT mCurrentBackBufferIndex;
+
+	std::vector<ComPtr<ID3D12Resource>> mBackBuffers;
+	D3D12_RESOURCE_DESC mDepthStencilDesc;
+	D3D12_CLEAR_VALUE mDepthStencilClearValue;
+	// Transient resource id
+	UINT mDepthStencilBuffer;
+
+	std::vector<CpuDescriptor> mBackBufferRtvs;
+	CpuDescriptor mDepthStencilDsv;
+
+	// Offscreen, one buffer per back buffer
+	std::vector<std::unique_ptr<ReadbackBuffer>> mReadbackBuffers;
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT mReadbackFootprint;
+	// Destroyed before the buffers, the writer reads them until then
+	std::unique_ptr<ReadbackRing<WaitableGpuFence>> mReadbacks;
+	std::uint64_t mPresentedFramesCount = 0;
+};
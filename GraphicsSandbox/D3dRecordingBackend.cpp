@@ -0,0 +1,138 @@
+#include "D3dRecordingBackend.h"
+#include "d3dx12.h"
+
+
+namespace {
+	void AppendD3dBarriers(const std::vector<TrackedBarrier> &trackedBarriers, std::vector<D3D12_RESOURCE_BARRIER> &barriers) {
+		for (const TrackedBarrier &trackedBarrier : trackedBarriers) {
+			ID3D12Resource *resource = static_cast<ID3D12Resource*>(trackedBarrier.resource);
+
+			if (trackedBarrier.type == TrackedBarrier::Type::UAV) {
+				barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+				continue;
+			}
+
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+				resource,
+				static_cast<D3D12_RESOURCE_STATES>(trackedBarrier.before),
+				static_cast<D3D12_RESOURCE_STATES>(trackedBarrier.after),
+				trackedBarrier.subresource,
+				static_cast<D3D12_RESOURCE_BARRIER_FLAGS>(trackedBarrier.split)
+			));
+		}
+	}
+}
+
+
+void D3dRecordingBackend::CommandList::FlushBarriers(std::vector<D3D12_RESOURCE_BARRIER> &barriers) {
+	trackedBarriers.clear();
+	states.Flush(trackedBarriers);
+	AppendD3dBarriers(trackedBarriers, barriers);
+
+	if (!barriers.empty()) {
+		commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+	}
+}
+
+
+D3dRecordingBackend::D3dRecordingBackend(
+	GraphicsDevice &device,
+	CommandAllocatorPool &allocatorPool,
+	ResourceStateRegistry &stateRegistry,
+	ID3D12CommandQueue *commandQueue
+)
+: mDevice(device), mAllocatorPool(allocatorPool), mStateRegistry(stateRegistry), mCommandQueue(commandQueue) {
+}
+
+
+D3dRecordingBackend::CommandList D3dRecordingBackend::BeginCommandList() {
+	CommandList result;
+	result.commandAllocator = mAllocatorPool.Acquire(COMMAND_LIST_TYPE);
+	result.states = ResourceStateTracker(&mStateRegistry);
+
+	{
+		std::lock_guard<std::mutex> lock(mFreeCommandListsMutex);
+		if (!mFreeCommandLists.empty()) {
+			result.commandList = std::move(mFreeCommandLists.back());
+			mFreeCommandLists.pop_back();
+		}
+	}
+
+	if (result.commandList) {
+		D3D_CHECK(result.commandList->Reset(result.commandAllocator.Get(), nullptr));
+	} else {
+		// Created lists are already in the recording state
+		D3D_CHECK(mDevice.GetD3dDevice()->CreateCommandList(
+			0, COMMAND_LIST_TYPE, result.commandAllocator.Get(), nullptr, IID_PPV_ARGS(&result.commandList)
+		));
+	}
+
+	return result;
+}
+
+
+void D3dRecordingBackend::EndCommandList(CommandList &commandList) {
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+
+	commandList.trackedBarriers.clear();
+	commandList.states.Finish(commandList.trackedBarriers);
+	AppendD3dBarriers(commandList.trackedBarriers, barriers);
+
+	if (!barriers.empty()) {
+		commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+	}
+
+	D3D_CHECK(commandList->Close());
+}
+
+
+void D3dRecordingBackend::ExecuteCommandLists(CommandList *commandLists, std::size_t count) {
+	mSubmission.clear();
+	mResolvingLists.clear();
+
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+
+	for (std::size_t i = 0; i < count; i++) {
+		// States are resolved in submission order, so each list sees the ones left by the previous
+		mResolvingBarriers.clear();
+		mStateRegistry.Resolve(commandLists[i].states, mResolvingBarriers);
+		commandLists[i].states.Reset();
+
+		if (!mResolvingBarriers.empty()) {
+			CommandList resolvingList = BeginCommandList();
+
+			barriers.clear();
+			AppendD3dBarriers(mResolvingBarriers, barriers);
+			resolvingList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+			D3D_CHECK(resolvingList->Close());
+
+			mSubmission.push_back(resolvingList.commandList.Get());
+			mResolvingLists.push_back(std::move(resolvingList));
+		}
+
+		mSubmission.push_back(commandLists[i].commandList.Get());
+	}
+
+	mCommandQueue->ExecuteCommandLists(static_cast<UINT>(mSubmission.size()), mSubmission.data());
+	mStateRegistry.DecayStates();
+
+	// A list can be reset as soon as it's submitted, unlike its allocator
+	std::lock_guard<std::mutex> lock(mFreeCommandListsMutex);
+	for (std::size_t i = 0; i < count; i++) {
+		mFreeCommandLists.push_back(std::move(commandLists[i].commandList));
+		mSubmittedAllocators.push_back(std::move(commandLists[i].commandAllocator));
+	}
+	for (CommandList &resolvingList : mResolvingLists) {
+		mFreeCommandLists.push_back(std::move(resolvingList.commandList));
+		mSubmittedAllocators.push_back(std::move(resolvingList.commandAllocator));
+	}
+	mResolvingLists.clear();
+}
+
+
+void D3dRecordingBackend::TakeSubmittedAllocators(std::vector<ComPtr<ID3D12CommandAllocator>> &allocators) {
+	for (auto &allocator : mSubmittedAllocators) {
+		allocators.push_back(std::move(allocator));
+	}
+	mSubmittedAllocators.clear();
+}
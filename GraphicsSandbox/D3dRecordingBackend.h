@@ -0,0 +1,105 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "CommandAllocatorPool.h"
+#include "ResourceStateTracker.h"
+#include "GraphicsTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+// Backend of ParallelCommandRecorder for a D3D12 direct queue.
+//
+// Every command list gets its own allocator from the pool. Lists are reused
+// right after submission, the allocators are kept until the caller takes them
+// to release with the label of the frame.
+//
+// Every list tracks the states of the resources it uses. The states a list
+// expects at its beginning are resolved at submission, and the transitions
+// that are needed go into a list submitted right before it.
+//
+// BeginCommandList is thread-safe, other methods are called by one thread
+class D3dRecordingBackend {
+public:
+	struct CommandList {
+		ComPtr<ID3D12GraphicsCommandList> commandList;
+		ComPtr<ID3D12CommandAllocator> commandAllocator;
+
+		ResourceStateTracker states;
+		std::vector<TrackedBarrier> trackedBarriers;
+
+		ID3D12GraphicsCommandList* operator -> () const {
+			return commandList.Get();
+		}
+
+		// Records the given barriers and the ones collected by the tracker as one batch
+		void FlushBarriers(std::vector<D3D12_RESOURCE_BARRIER> &barriers);
+
+		// Commands of the backend-neutral interface of FrameRenderer
+
+		void SetViewport(const Viewport &viewport) {
+			const D3D12_VIEWPORT d3dViewport = {
+				viewport.topLeftX, viewport.topLeftY, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth
+			};
+			commandList->RSSetViewports(1, &d3dViewport);
+		}
+
+		void SetScissorRect(const Rect &rect) {
+			const D3D12_RECT d3dRect = { rect.left, rect.top, rect.right, rect.bottom };
+			commandList->RSSetScissorRects(1, &d3dRect);
+		}
+
+		void SetRenderTarget(D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView, D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView) {
+			commandList->OMSetRenderTargets(1, &renderTargetView, FALSE, &depthStencilView);
+		}
+
+		void ClearRenderTarget(D3D12_CPU_DESCRIPTOR_HANDLE renderTargetView, const float color[4]) {
+			commandList->ClearRenderTargetView(renderTargetView, color, 0, nullptr);
+		}
+
+		void ClearDepthStencil(D3D12_CPU_DESCRIPTOR_HANDLE depthStencilView, float depth, std::uint8_t stencil) {
+			commandList->ClearDepthStencilView(
+				depthStencilView, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, depth, stencil, 0, nullptr
+			);
+		}
+	};
+
+public:
+	D3dRecordingBackend(
+		GraphicsDevice &device,
+		CommandAllocatorPool &allocatorPool,
+		ResourceStateRegistry &stateRegistry,
+		ID3D12CommandQueue *commandQueue
+	);
+	D3dRecordingBackend(const D3dRecordingBackend&) = delete;
+
+	D3dRecordingBackend& operator = (const D3dRecordingBackend&) = delete;
+
+	CommandList BeginCommandList();
+	void EndCommandList(CommandList &commandList);
+	void ExecuteCommandLists(CommandList *commandLists, std::size_t count);
+
+	// Moves out the allocators of the lists submitted since the previous call
+	void TakeSubmittedAllocators(std::vector<ComPtr<ID3D12CommandAllocator>> &allocators);
+
+private:
+	static constexpr D3D12_COMMAND_LIST_TYPE COMMAND_LIST_TYPE = D3D12_COMMAND_LIST_TYPE_DIRECT;
+
+	GraphicsDevice &mDevice;
+	CommandAllocatorPool &mAllocatorPool;
+	ResourceStateRegistry &mStateRegistry;
+	ID3D12CommandQueue *mCommandQueue;
+
+	std::mutex mFreeCommandListsMutex;
+	std::vector<ComPtr<ID3D12GraphicsCommandList>> mFreeCommandLists;
+
+	std::vector<ID3D12CommandList*> mSubmission;
+	std::vector<CommandList> mResolvingLists;
+	std::vector<TrackedBarrier> mResolvingBarriers;
+	std::vector<ComPtr<ID3D12CommandAllocator>> mSubmittedAllocators;
+};
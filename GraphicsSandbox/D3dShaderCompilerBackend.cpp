@@ -0,0 +1,70 @@
+#include "D3dShaderCompilerBackend.h"
+
+#include <stdexcept>
+
+
+namespace {
+	void ThrowCompilerError(HRESULT hr, ID3DBlob *errors, const char *file, int line) {
+		if (errors != nullptr && errors->GetBufferSize() > 0) {
+			throw std::runtime_error(std::string(
+				static_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize()
+			));
+		}
+
+		throw D3dException(hr, file, line);
+	}
+}
+
+
+D3dShaderCompilerBackend::D3dShaderCompilerBackend(UINT compileFlags)
+: mCompileFlags(compileFlags) {
+}
+
+
+std::string D3dShaderCompilerBackend::Preprocess(const ShaderSource &source, const ShaderDefines &defines) {
+	std::vector<D3D_SHADER_MACRO> macros;
+	macros.reserve(defines.size() + 1);
+	for (const auto &define : defines) {
+		macros.push_back(D3D_SHADER_MACRO{ define.first.c_str(), define.second.c_str() });
+	}
+	macros.push_back(D3D_SHADER_MACRO{ nullptr, nullptr });
+
+	ComPtr<ID3DBlob> preprocessedSource;
+	ComPtr<ID3DBlob> errors;
+
+	const HRESULT hr = D3DPreprocess(
+		source.text.data(), source.text.size(), source.name.c_str(),
+		macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		&preprocessedSource, &errors
+	);
+	if (FAILED(hr)) {
+		ThrowCompilerError(hr, errors.Get(), __FILE__, __LINE__);
+	}
+
+	// The blob is null-terminated
+	return std::string(static_cast<const char*>(preprocessedSource->GetBufferPointer()));
+}
+
+
+std::vector<std::uint8_t> D3dShaderCompilerBackend::Compile(const ShaderSource &source, const std::string &preprocessedSource) {
+	ComPtr<ID3DBlob> bytecode;
+	ComPtr<ID3DBlob> errors;
+
+	// Defines and includes are already applied
+	const HRESULT hr = D3DCompile(
+		preprocessedSource.data(), preprocessedSource.size(), source.name.c_str(),
+		nullptr, nullptr, source.entryPoint.c_str(), source.profile.c_str(),
+		mCompileFlags, 0, &bytecode, &errors
+	);
+	if (FAILED(hr)) {
+		ThrowCompilerError(hr, errors.Get(), __FILE__, __LINE__);
+	}
+
+	const std::uint8_t *begin = static_cast<const std::uint8_t*>(bytecode->GetBufferPointer());
+	return std::vector<std::uint8_t>(begin, begin + bytecode->GetBufferSize());
+}
+
+
+std::string D3dShaderCompilerBackend::CompilerIdentity() const {
+	return "D3DCompiler_" + std::to_string(D3D_COMPILER_VERSION) + " flags " + std::to_string(mCompileFlags);
+}
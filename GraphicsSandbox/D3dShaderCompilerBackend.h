@@ -0,0 +1,34 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "ShaderPermutations.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// Backend of ShaderPermutationCompiler built on D3DCompiler.
+//
+// Includes are resolved relative to the source name. Errors are thrown as
+// std::runtime_error with the compiler messages.
+//
+// This class is thread-safe
+class D3dShaderCompilerBackend {
+public:
+	explicit D3dShaderCompilerBackend(UINT compileFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3);
+	D3dShaderCompilerBackend(const D3dShaderCompilerBackend&) = delete;
+
+	D3dShaderCompilerBackend& operator = (const D3dShaderCompilerBackend&) = delete;
+
+	std::string Preprocess(const ShaderSource &source, const ShaderDefines &defines);
+
+	std::vector<std::uint8_t> Compile(const ShaderSource &source, const std::string &preprocessedSource);
+
+	// D3DCompiler version and the compile flags
+	std::string CompilerIdentity() const;
+
+private:
+	const UINT mCompileFlags;
+};
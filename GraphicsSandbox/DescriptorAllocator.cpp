@@ -0,0 +1,104 @@
+#include "DescriptorAllocator.h"
+
+#include <stdexcept>
+
+
+namespace {
+	constexpr std::uint64_t INDEX_MASK = 0xFFFFFFFFull;
+
+	std::uint64_t MakeHead(std::uint64_t previousHead, std::uint32_t index) {
+		std::uint64_t tag = (previousHead >> 32) + 1;
+		return (tag << 32) | index;
+	}
+}
+
+
+DescriptorFreeList::DescriptorFreeList(std::uint32_t capacity)
+: mNext(new std::atomic<std::uint32_t>[capacity]), mHead(INVALID_DESCRIPTOR_INDEX) {
+}
+
+
+void DescriptorFreeList::Push(std::uint32_t index) {
+	std::uint64_t head = mHead.load(std::memory_order_relaxed);
+
+	do {
+		mNext[index].store(static_cast<std::uint32_t>(head & INDEX_MASK), std::memory_order_relaxed);
+	} while (!mHead.compare_exchange_weak(
+		head, MakeHead(head, index), std::memory_order_release, std::memory_order_relaxed
+	));
+}
+
+
+std::uint32_t DescriptorFreeList::Pop() {
+	std::uint64_t head = mHead.load(std::memory_order_acquire);
+
+	while (true) {
+		std::uint32_t index = static_cast<std::uint32_t>(head & INDEX_MASK);
+		if (index == INVALID_DESCRIPTOR_INDEX) {
+			return INVALID_DESCRIPTOR_INDEX;
+		}
+
+		// May read a stale link if the index was popped meanwhile, the tag makes the CAS fail then
+		std::uint32_t next = mNext[index].load(std::memory_order_relaxed);
+		if (mHead.compare_exchange_weak(
+			head, MakeHead(head, next), std::memory_order_acquire, std::memory_order_acquire
+		)) {
+			return index;
+		}
+	}
+}
+
+
+PagedDescriptorAllocator::PagedDescriptorAllocator(
+	std::uint32_t descriptorsPerPage,
+	std::uint32_t maxPagesCount,
+	CreatePageFunction createPage
+)
+: mDescriptorsPerPage(descriptorsPerPage),
+  mMaxPagesCount(maxPagesCount),
+  mCreatePage(std::move(createPage)),
+  mFreeList(descriptorsPerPage * maxPagesCount) {
+}
+
+
+std::uint32_t PagedDescriptorAllocator::Allocate() {
+	std::uint32_t index = mFreeList.Pop();
+	if (index != INVALID_DESCRIPTOR_INDEX) {
+		return index;
+	}
+
+	return AddPage();
+}
+
+
+void PagedDescriptorAllocator::Free(std::uint32_t index) {
+	mFreeList.Push(index);
+}
+
+
+std::uint32_t PagedDescriptorAllocator::AddPage() {
+	std::lock_guard<std::mutex> lock(mAddPageMutex);
+
+	// Another thread may have added a page while this one was waiting
+	std::uint32_t index = mFreeList.Pop();
+	if (index != INVALID_DESCRIPTOR_INDEX) {
+		return index;
+	}
+
+	std::uint32_t pageIndex = mPagesCount.load(std::memory_order_relaxed);
+	if (pageIndex == mMaxPagesCount) {
+		throw std::runtime_error("Out of descriptor pages");
+	}
+
+	mCreatePage(pageIndex);
+	mPagesCount.store(pageIndex + 1, std::memory_order_release);
+
+	// The first descriptor goes to the caller, the rest are published in reverse
+	// order, so they are handed out in the order of the page
+	std::uint32_t firstIndex = pageIndex * mDescriptorsPerPage;
+	for (std::uint32_t i = mDescriptorsPerPage - 1; i > 0; i--) {
+		mFreeList.Push(firstIndex + i);
+	}
+
+	return firstIndex;
+}
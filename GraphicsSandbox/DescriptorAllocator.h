@@ -0,0 +1,125 @@
+#pragma once
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+
+// Bookkeeping of descriptor heaps that knows nothing about D3D12.
+// Descriptors are identified by indices, it's up to the caller to map them
+// to heap handles.
+
+
+constexpr std::uint32_t INVALID_DESCRIPTOR_INDEX = UINT32_MAX;
+
+
+// Lock-free stack of free indices below a fixed capacity.
+// The head is tagged with a counter, so the stack is ABA-safe.
+class DescriptorFreeList {
+public:
+	explicit DescriptorFreeList(std::uint32_t capacity);
+	DescriptorFreeList(const DescriptorFreeList&) = delete;
+
+	DescriptorFreeList& operator = (const DescriptorFreeList&) = delete;
+
+	void Push(std::uint32_t index);
+
+	// Returns INVALID_DESCRIPTOR_INDEX if the list is empty
+	std::uint32_t Pop();
+
+private:
+	std::unique_ptr<std::atomic<std::uint32_t>[]> mNext;
+	std::atomic<std::uint64_t> mHead;
+};
+
+
+// Allocator of single persistent descriptors from pages that are added on demand.
+//
+// Allocation and freeing don't take a lock, only adding a page does. The page
+// callback is called under that lock before any index of the page is handed out.
+//
+// This class is thread-safe
+class PagedDescriptorAllocator {
+public:
+	using CreatePageFunction = std::function<void(std::uint32_t pageIndex)>;
+
+public:
+	PagedDescriptorAllocator(
+		std::uint32_t descriptorsPerPage,
+		std::uint32_t maxPagesCount,
+		CreatePageFunction createPage
+	);
+	PagedDescriptorAllocator(const PagedDescriptorAllocator&) = delete;
+
+	PagedDescriptorAllocator& operator = (const PagedDescriptorAllocator&) = delete;
+
+	// Throws std::runtime_error when all pages are used up
+	std::uint32_t Allocate();
+	void Free(std::uint32_t index);
+
+	std::uint32_t DescriptorsPerPage() const {
+		return mDescriptorsPerPage;
+	}
+
+	std::uint32_t PagesCount() const {
+		return mPagesCount.load(std::memory_order_acquire);
+	}
+
+private:
+	std::uint32_t AddPage();
+
+private:
+	const std::uint32_t mDescriptorsPerPage;
+	const std::uint32_t mMaxPagesCount;
+	CreatePageFunction mCreatePage;
+
+	DescriptorFreeList mFreeList;
+
+	std::mutex mAddPageMutex;
+	std::atomic<std::uint32_t> mPagesCount{0};
+};
+
+
+// Allocator of contiguous descriptor ranges that are all freed at once,
+// e.g. the views that live for one frame.
+//
+// Allocation is a single atomic addition and Reset is O(1).
+// Allocate is thread-safe, Reset must not race with it
+class LinearDescriptorAllocator {
+public:
+	explicit LinearDescriptorAllocator(std::uint32_t capacity)
+	: mCapacity(capacity) {
+	}
+
+	LinearDescriptorAllocator(const LinearDescriptorAllocator&) = delete;
+
+	LinearDescriptorAllocator& operator = (const LinearDescriptorAllocator&) = delete;
+
+	// Returns the first index of the range or INVALID_DESCRIPTOR_INDEX if there is no room
+	std::uint32_t Allocate(std::uint32_t count) {
+		std::uint64_t offset = mOffset.fetch_add(count, std::memory_order_relaxed);
+		if (offset + count > mCapacity) {
+			return INVALID_DESCRIPTOR_INDEX;
+		}
+
+		return static_cast<std::uint32_t>(offset);
+	}
+
+	void Reset() {
+		mOffset.store(0, std::memory_order_relaxed);
+	}
+
+	std::uint32_t Capacity() const {
+		return mCapacity;
+	}
+
+private:
+	const std::uint32_t mCapacity;
+
+	// 64-bit, so failed allocations can't wrap it around
+	std::atomic<std::uint64_t> mOffset{0};
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+
+#include "Hash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+// Remembers where descriptor tables were staged during the current frame,
+// so a table made of the same source descriptors is copied only once.
+//
+// Sources are identified by opaque 64-bit values, e.g. CPU descriptor handles.
+// They must not be rewritten between Insert and Clear.
+//
+// This class is not thread-safe
+class DescriptorTableCache {
+public:
+	static constexpr std::uint64_t NOT_FOUND = UINT64_MAX;
+
+public:
+	std::uint64_t Find(const std::uint64_t *sources, std::size_t count) {
+		mScratchKey.assign(sources, sources + count);
+
+		auto it = mOffsets.find(mScratchKey);
+		return it != mOffsets.end() ? it->second : NOT_FOUND;
+	}
+
+	void Insert(const std::uint64_t *sources, std::size_t count, std::uint64_t offset) {
+		mOffsets.emplace(std::vector<std::uint64_t>(sources, sources + count), offset);
+	}
+
+	void Clear() {
+		mOffsets.clear();
+	}
+
+private:
+	struct KeyHash {
+		std::size_t operator () (const std::vector<std::uint64_t> &key) const {
+			return static_cast<std::size_t>(HashBytes(key.data(), key.size() * sizeof(std::uint64_t)));
+		}
+	};
+
+	// Reused by lookups, so they don't allocate
+	std::vector<std::uint64_t> mScratchKey;
+	std::unordered_map<std::vector<std::uint64_t>, std::uint64_t, KeyHash> mOffsets;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+// Runs callbacks on a dedicated thread once their fence labels complete, so
+// the thread that submitted the work doesn't have to park on the fence.
+//
+// Callbacks are run in label order. One added with a label earlier than the
+// one the worker is waiting for runs only after that one completes, so labels
+// are expected to be added in the order they were put. The destructor waits for
+// every label that still has a callback and runs it.
+//
+// Fence is any type with an ordered Label and WaitForLabel(const Label&),
+// e.g. WaitableGpuFence or CpuTimelineFence. OnCompletion is thread-safe
+template <typename Fence>
+class FenceCallbackWorker {
+public:
+	using Label = typename Fence::Label;
+	using Callback = std::function<void()>;
+
+public:
+	explicit FenceCallbackWorker(Fence &fence);
+	FenceCallbackWorker(const FenceCallbackWorker&) = delete;
+	~FenceCallbackWorker();
+
+	FenceCallbackWorker& operator = (const FenceCallbackWorker&) = delete;
+
+	void OnCompletion(const Label &label, Callback callback);
+
+private:
+	struct PendingCallback {
+		Label label;
+		Callback callback;
+
+		// Makes std::priority_queue a min-heap by label
+		bool operator < (const PendingCallback &other) const {
+			return other.label < label;
+		}
+	};
+
+	void Run();
+
+private:
+	Fence &mFence;
+
+	std::mutex mMutex;
+	std::condition_variable mHasWork;
+	std::priority_queue<PendingCallback> mPending;
+	bool mIsStopping = false;
+
+	std::thread mThread;
+};
+
+
+template <typename Fence>
+FenceCallbackWorker<Fence>::FenceCallbackWorker(Fence &fence)
+: mFence(fence), mThread([this] { Run(); }) {
+}
+
+
+template <typename Fence>
+FenceCallbackWorker<Fence>::~FenceCallbackWorker() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mIsStopping = true;
+	}
+
+	mHasWork.notify_one();
+	mThread.join();
+}
+
+
+template <typename Fence>
+void FenceCallbackWorker<Fence>::OnCompletion(const Label &label, Callback callback) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPending.push(PendingCallback{ label, std::move(callback) });
+	}
+
+	mHasWork.notify_one();
+}
+
+
+template <typename Fence>
+void FenceCallbackWorker<Fence>::Run() {
+	while (true) {
+		PendingCallback pending;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mHasWork.wait(lock, [this] { return mIsStopping || !mPending.empty(); });
+
+			if (mPending.empty()) {
+				return;
+			}
+
+			pending = mPending.top();
+			mPending.pop();
+		}
+
+		// Labels complete in order, so callbacks queued behind this one
+		// usually don't wait at all
+		mFence.WaitForLabel(pending.label);
+		pending.callback();
+	}
+}
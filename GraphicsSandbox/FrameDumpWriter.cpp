@@ -0,0 +1,134 @@
+#include "FrameDumpWriter.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+
+FrameDumpWriter::FrameDumpWriter(std::string directory, ImageFileFormat format, std::size_t threadsCount)
+: mDirectory(std::move(directory)), mFormat(format) {
+	threadsCount = std::max<std::size_t>(threadsCount, 1);
+
+	mThreads.reserve(threadsCount);
+	for (std::size_t i = 0; i < threadsCount; i++) {
+		mThreads.emplace_back([this] { Run(); });
+	}
+}
+
+
+FrameDumpWriter::~FrameDumpWriter() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mIsStopping = true;
+	}
+
+	mHasWork.notify_all();
+	for (std::thread &thread : mThreads) {
+		thread.join();
+	}
+}
+
+
+void FrameDumpWriter::Write(std::uint64_t frameNumber, const ImageView &image, Callback onWritten) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQueue.push_back(Frame{ frameNumber, image, std::move(onWritten) });
+		mPendingCount++;
+	}
+
+	mHasWork.notify_one();
+}
+
+
+void FrameDumpWriter::WaitForAll() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	mIsIdle.wait(lock, [this] { return mPendingCount == 0; });
+
+	if (mError) {
+		std::exception_ptr error = mError;
+		mError = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+
+FrameDumpWriter::Statistics FrameDumpWriter::GetStatistics() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStatistics;
+}
+
+
+void FrameDumpWriter::Run() {
+	std::vector<std::uint8_t> buffer;
+	std::string path;
+
+	while (true) {
+		Frame frame;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mHasWork.wait(lock, [this] { return mIsStopping || !mQueue.empty(); });
+
+			if (mQueue.empty()) {
+				return;
+			}
+
+			frame = std::move(mQueue.front());
+			mQueue.pop_front();
+		}
+
+		std::exception_ptr error;
+		std::size_t fileSize = 0;
+		try {
+			fileSize = WriteFile(frame, buffer, path);
+		} catch (...) {
+			error = std::current_exception();
+		}
+
+		if (frame.onWritten) {
+			frame.onWritten();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			if (error) {
+				mStatistics.failedFramesCount++;
+				if (!mError) {
+					mError = error;
+				}
+			} else {
+				mStatistics.framesWrittenCount++;
+				mStatistics.bytesWrittenCount += fileSize;
+			}
+
+			mPendingCount--;
+			if (mPendingCount == 0) {
+				mIsIdle.notify_all();
+			}
+		}
+	}
+}
+
+
+std::size_t FrameDumpWriter::WriteFile(const Frame &frame, std::vector<std::uint8_t> &buffer, std::string &path) {
+	char fileName[64];
+	std::snprintf(fileName, sizeof(fileName), "/frame_%06" PRIu64 "%s", frame.frameNumber, ImageFileExtension(mFormat));
+
+	path.assign(mDirectory);
+	path.append(fileName);
+
+	const std::size_t fileSize = EncodeImage(mFormat, frame.image, buffer);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(fileSize));
+	file.close();
+
+	if (!file) {
+		throw std::runtime_error("Failed to write the frame file " + path);
+	}
+
+	return fileSize;
+}
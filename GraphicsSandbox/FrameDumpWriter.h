@@ -0,0 +1,85 @@
+#pragma once
+
+
+#include "ImageFile.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Pool of threads that encode rendered frames and write them into a directory,
+// one file per frame named by its number, e.g. frame_000042.qoi.
+//
+// The pixels of a frame are read by an encoder thread until its file is written,
+// then the callback of the frame is called on that thread so the memory can be
+// reused. The callback is called even if the frame couldn't be written, the
+// first error is rethrown by WaitForAll.
+//
+// Every thread encodes into a buffer of its own that only grows, so the pool
+// stops allocating after the first frames.
+//
+// This class is thread-safe
+class FrameDumpWriter {
+public:
+	using Callback = std::function<void()>;
+
+	// Totals since creation
+	struct Statistics {
+		std::uint64_t framesWrittenCount = 0;
+		std::uint64_t bytesWrittenCount = 0;
+		std::uint64_t failedFramesCount = 0;
+	};
+
+public:
+	// The directory must exist
+	FrameDumpWriter(std::string directory, ImageFileFormat format, std::size_t threadsCount);
+	FrameDumpWriter(const FrameDumpWriter&) = delete;
+	// Writes the queued frames first
+	~FrameDumpWriter();
+
+	FrameDumpWriter& operator = (const FrameDumpWriter&) = delete;
+
+	// The pixels must stay valid until onWritten is called
+	void Write(std::uint64_t frameNumber, const ImageView &image, Callback onWritten);
+
+	// Waits for the frames queued so far
+	void WaitForAll();
+
+	Statistics GetStatistics();
+
+private:
+	struct Frame {
+		std::uint64_t frameNumber;
+		ImageView image;
+		Callback onWritten;
+	};
+
+	void Run();
+
+	// Returns the size of the file
+	std::size_t WriteFile(const Frame &frame, std::vector<std::uint8_t> &buffer, std::string &path);
+
+private:
+	const std::string mDirectory;
+	const ImageFileFormat mFormat;
+
+	std::mutex mMutex;
+	std::condition_variable mHasWork;
+	std::condition_variable mIsIdle;
+	std::deque<Frame> mQueue;
+	// Queued and being written
+	std::size_t mPendingCount = 0;
+	bool mIsStopping = false;
+	std::exception_ptr mError;
+	Statistics mStatistics;
+
+	std::vector<std::thread> mThreads;
+};
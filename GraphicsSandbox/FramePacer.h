@@ -0,0 +1,250 @@
+#pragma once
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+
+// Paces the frames of the main loop to a target frame rate and measures the
+// latency from input to present.
+//
+// WaitForFrameStart sleeps until shortly before the deadline of the frame and
+// spins for the rest, because sleeps wake up late by up to the resolution of
+// the system timer. The spin threshold follows the oversleep measured on every
+// sleep, so on a loaded machine the pacer spins longer instead of missing its
+// deadlines. Deadlines are a whole period apart, so lateness doesn't add up over
+// frames; a frame that starts more than a period late starts a new schedule
+// instead of rendering the missed frames in a burst.
+//
+// Without a target frame rate the pacer only measures, e.g. when presentation
+// is paced by vsync or a frame latency waitable object.
+//
+// Clock provides the time, with static dispatch, so the timing can be tested
+// with a simulated clock:
+//   std::int64_t Now()                     - monotonic nanoseconds
+//   void Sleep(std::int64_t nanoseconds)   - may wake up late, but not early
+//   void Relax()                           - one iteration of a spin wait
+//
+// This class is not thread-safe
+template <typename Clock>
+class FramePacer {
+public:
+	using Nanoseconds = std::int64_t;
+
+	// Bounds of the time spent spinning before a deadline
+	static constexpr Nanoseconds MIN_SPIN_THRESHOLD = 100 * 1000;
+	static constexpr Nanoseconds MAX_SPIN_THRESHOLD = 4 * 1000 * 1000;
+
+	// Counters of the last frame
+	struct FrameStatistics {
+		// Between the starts of the previous frame and this one
+		Nanoseconds frameTime = 0;
+		// Of the start after the deadline
+		Nanoseconds lateness = 0;
+		Nanoseconds sleepTime = 0;
+		Nanoseconds spinTime = 0;
+		// From the first input since the previous present, -1 without input
+		Nanoseconds inputToPresentLatency = -1;
+	};
+
+	// Totals since creation
+	struct Statistics {
+		std::uint64_t framesCount = 0;
+		Nanoseconds latenessSum = 0;
+		Nanoseconds maxLateness = 0;
+		// Frames that started more than a period late
+		std::uint64_t missedDeadlinesCount = 0;
+		std::uint64_t inputFramesCount = 0;
+		Nanoseconds inputToPresentLatencySum = 0;
+		Nanoseconds maxInputToPresentLatency = 0;
+	};
+
+public:
+	explicit FramePacer(Clock &clock);
+	FramePacer(const FramePacer&) = delete;
+
+	FramePacer& operator = (const FramePacer&) = delete;
+
+	// Zero or less only measures
+	void SetTargetFrameRate(double framesPerSecond);
+
+	// Returns when the next frame should start
+	void WaitForFrameStart();
+
+	// Called for every input event, only the earliest one since the previous
+	// present counts
+	void OnInput();
+
+	// The same for an event that happened earlier, e.g. when it was queued. The
+	// time is on the clock of the pacer
+	void OnInput(Nanoseconds inputTime);
+
+	// Called right after the frame is presented
+	void OnPresent();
+
+	Nanoseconds SpinThreshold() const {
+		return mSpinThreshold;
+	}
+
+	FrameStatistics LastFrameStatistics() const {
+		return mLastFrameStatistics;
+	}
+
+	Statistics GetStatistics() const {
+		return mStatistics;
+	}
+
+private:
+	void UpdateSpinThreshold(Nanoseconds oversleep);
+
+private:
+	Clock &mClock;
+
+	Nanoseconds mPeriod = 0;
+	Nanoseconds mNextDeadline = 0;
+	bool mHasDeadline = false;
+	Nanoseconds mPreviousFrameStart = 0;
+	bool mHasStarted = false;
+
+	// Smoothed mean and mean deviation of the oversleep, in 1/8 and 1/4 of
+	// nanoseconds like the round-trip estimate of TCP
+	Nanoseconds mScaledOversleepMean;
+	Nanoseconds mScaledOversleepDeviation;
+	Nanoseconds mSpinThreshold;
+
+	Nanoseconds mFirstInputTime = 0;
+	bool mHasInput = false;
+
+	FrameStatistics mLastFrameStatistics;
+	Statistics mStatistics;
+};
+
+
+template <typename Clock>
+constexpr typename FramePacer<Clock>::Nanoseconds FramePacer<Clock>::MIN_SPIN_THRESHOLD;
+
+
+template <typename Clock>
+constexpr typename FramePacer<Clock>::Nanoseconds FramePacer<Clock>::MAX_SPIN_THRESHOLD;
+
+
+template <typename Clock>
+FramePacer<Clock>::FramePacer(Clock &clock)
+: mClock(clock) {
+	// Until the first sleeps are measured, a millisecond of timer resolution is assumed
+	const Nanoseconds initialOversleep = 1000 * 1000;
+	mScaledOversleepMean = initialOversleep * 8;
+	mScaledOversleepDeviation = initialOversleep / 2 * 4;
+	mSpinThreshold = std::min(initialOversleep * 3, MAX_SPIN_THRESHOLD);
+}
+
+
+template <typename Clock>
+void FramePacer<Clock>::SetTargetFrameRate(double framesPerSecond) {
+	mPeriod = framesPerSecond > 0.0 ? static_cast<Nanoseconds>(1e9 / framesPerSecond) : 0;
+
+	// The next frame starts a new schedule
+	mHasDeadline = false;
+}
+
+
+template <typename Clock>
+void FramePacer<Clock>::WaitForFrameStart() {
+	FrameStatistics statistics;
+
+	const Nanoseconds waitStart = mClock.Now();
+	Nanoseconds start = waitStart;
+
+	if (mPeriod > 0) {
+		if (!mHasDeadline) {
+			mNextDeadline = waitStart;
+			mHasDeadline = true;
+		}
+
+		// Sleeps wake up late, they stop a spin threshold before the deadline
+		Nanoseconds now = waitStart;
+		while (mNextDeadline - now > mSpinThreshold) {
+			const Nanoseconds requested = mNextDeadline - now - mSpinThreshold;
+			mClock.Sleep(requested);
+
+			const Nanoseconds wakeUp = mClock.Now();
+			UpdateSpinThreshold(wakeUp - now - requested);
+			now = wakeUp;
+		}
+
+		const Nanoseconds spinStart = now;
+		while (now < mNextDeadline) {
+			mClock.Relax();
+			now = mClock.Now();
+		}
+
+		start = now;
+		statistics.sleepTime = spinStart - waitStart;
+		statistics.spinTime = start - spinStart;
+		statistics.lateness = start - mNextDeadline;
+
+		mNextDeadline += mPeriod;
+		if (mNextDeadline <= start) {
+			mStatistics.missedDeadlinesCount++;
+			mNextDeadline = start + mPeriod;
+		}
+	}
+
+	statistics.frameTime = mHasStarted ? start - mPreviousFrameStart : 0;
+	mPreviousFrameStart = start;
+	mHasStarted = true;
+
+	mStatistics.framesCount++;
+	mStatistics.latenessSum += statistics.lateness;
+	mStatistics.maxLateness = std::max(mStatistics.maxLateness, statistics.lateness);
+
+	mLastFrameStatistics = statistics;
+}
+
+
+template <typename Clock>
+void FramePacer<Clock>::OnInput() {
+	OnInput(mClock.Now());
+}
+
+
+template <typename Clock>
+void FramePacer<Clock>::OnInput(Nanoseconds inputTime) {
+	if (!mHasInput || inputTime < mFirstInputTime) {
+		mFirstInputTime = inputTime;
+		mHasInput = true;
+	}
+}
+
+
+template <typename Clock>
+void FramePacer<Clock>::OnPresent() {
+	if (!mHasInput) {
+		mLastFrameStatistics.inputToPresentLatency = -1;
+		return;
+	}
+
+	const Nanoseconds latency = mClock.Now() - mFirstInputTime;
+	mHasInput = false;
+
+	mLastFrameStatistics.inputToPresentLatency = latency;
+	mStatistics.inputFramesCount++;
+	mStatistics.inputToPresentLatencySum += latency;
+	mStatistics.maxInputToPresentLatency = std::max(mStatistics.maxInputToPresentLatency, latency);
+}
+
+
+template <typename Clock>
+void FramePacer<Clock>::UpdateSpinThreshold(Nanoseconds oversleep) {
+	oversleep = std::max<Nanoseconds>(oversleep, 0);
+
+	// mean += (oversleep - mean) / 8, deviation += (|oversleep - mean| - deviation) / 4
+	const Nanoseconds error = oversleep - mScaledOversleepMean / 8;
+	mScaledOversleepMean += error;
+	mScaledOversleepDeviation += std::abs(error) - mScaledOversleepDeviation / 4;
+
+	// Like the retransmission timeout of TCP: the mean and four deviations
+	const Nanoseconds threshold = mScaledOversleepMean / 8 + mScaledOversleepDeviation;
+	mSpinThreshold = std::min(std::max(threshold, MIN_SPIN_THRESHOLD), MAX_SPIN_THRESHOLD);
+}
@@ -0,0 +1,376 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+
+namespace {
+	// The buffer of the thread and the capture it was bound for, a buffer is
+	// used only while its capture is the one running
+	thread_local void *tThreadBuffer = nullptr;
+	thread_local std::uint64_t tThreadBufferCaptureId = 0;
+
+	// Event of every captured frame, on the thread of BeginFrame
+	const char *const FRAME_EVENT_NAME = "Frame";
+
+	// Tracks come after the threads in the export
+	const std::uint32_t FIRST_TRACK_TID = 1000;
+
+	void WriteJsonString(std::ostream &stream, const char *string) {
+		stream << '"';
+		for (const char *c = string; *c != '\0'; c++) {
+			switch (*c) {
+			case '"':
+				stream << "\\\"";
+				break;
+			case '\\':
+				stream << "\\\\";
+				break;
+			case '\n':
+				stream << "\\n";
+				break;
+			case '\t':
+				stream << "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(*c) < 0x20) {
+					const char *digits = "0123456789abcdef";
+					stream << "\\u00" << digits[*c >> 4] << digits[*c & 0xF];
+				} else {
+					stream << *c;
+				}
+				break;
+			}
+		}
+		stream << '"';
+	}
+
+	void WriteThreadName(std::ostream &stream, std::uint32_t tid, const char *name) {
+		stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+		WriteJsonString(stream, name);
+		stream << "}}";
+	}
+
+	void WriteCompleteEvent(std::ostream &stream, std::uint32_t tid, const char *name, double timestamp, double duration) {
+		stream << "{\"name\":";
+		WriteJsonString(stream, name);
+		stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << timestamp << ",\"dur\":" << duration << '}';
+	}
+}
+
+
+constexpr std::size_t FrameProfiler::DEFAULT_THREAD_EVENTS_COUNT;
+
+
+std::atomic<FrameProfiler*> FrameProfiler::sCapturingProfiler{nullptr};
+std::atomic<std::uint64_t> FrameProfiler::sLastCaptureId{0};
+
+
+FrameProfiler::FrameProfiler(std::size_t threadEventsCount)
+: mThreadEventsCount(threadEventsCount) {
+	if (threadEventsCount == 0) {
+		throw std::invalid_argument("Threads must have room for events");
+	}
+}
+
+
+FrameProfiler::~FrameProfiler() {
+	FrameProfiler *expected = this;
+	sCapturingProfiler.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+}
+
+
+std::int64_t FrameProfiler::SteadyNow() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+
+void FrameProfiler::RequestCapture(std::uint32_t framesCount) {
+	mRequestedFramesCount = framesCount;
+}
+
+
+void FrameProfiler::BeginFrame() {
+	std::uint64_t now = Now();
+
+	if (IsCapturing()) {
+		Record(FRAME_EVENT_NAME, mFrameBeginTicks, now);
+		mCapturedFramesCount++;
+
+		if (mCapturedFramesCount == mCaptureFramesCount) {
+			EndCapture();
+		}
+	}
+
+	if (!IsCapturing() && mRequestedFramesCount > 0) {
+		mCaptureFramesCount = mRequestedFramesCount;
+		mRequestedFramesCount = 0;
+		BeginCapture();
+
+		// The first frame begins with the capture, earlier events are left out
+		now = mCaptureBeginTicks;
+	}
+
+	mFrameBeginTicks = now;
+}
+
+
+void FrameProfiler::NameCurrentThread(std::string name) {
+	const std::thread::id threadId = std::this_thread::get_id();
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = std::find_if(mThreadNames.begin(), mThreadNames.end(), [threadId](const std::pair<std::thread::id, std::string> &threadName) {
+		return threadName.first == threadId;
+	});
+	if (it != mThreadNames.end()) {
+		it->second = std::move(name);
+	} else {
+		mThreadNames.emplace_back(threadId, std::move(name));
+	}
+}
+
+
+std::uint32_t FrameProfiler::Track(const char *name) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = std::find_if(mTracks.begin(), mTracks.end(), [name](const char *trackName) {
+		return std::strcmp(trackName, name) == 0;
+	});
+	if (it != mTracks.end()) {
+		return static_cast<std::uint32_t>(it - mTracks.begin());
+	}
+
+	mTracks.push_back(name);
+
+	return static_cast<std::uint32_t>(mTracks.size() - 1);
+}
+
+
+void FrameProfiler::RecordTrackEvent(
+	std::uint64_t captureId,
+	std::uint32_t track,
+	const char *name,
+	std::int64_t beginNanoseconds,
+	std::int64_t endNanoseconds
+) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (captureId == mCaptureId.load(std::memory_order_relaxed)) {
+		mTrackEvents.push_back({ track, name, beginNanoseconds, endNanoseconds });
+	}
+}
+
+
+void FrameProfiler::Record(const char *name, std::uint64_t beginTicks, std::uint64_t endTicks) {
+	const std::uint64_t captureId = mCaptureId.load(std::memory_order_relaxed);
+
+	ThreadBuffer &buffer = tThreadBufferCaptureId == captureId
+		? *static_cast<ThreadBuffer*>(tThreadBuffer)
+		: BindCurrentThread(captureId);
+
+	// Only this thread writes the count, the export reads it
+	const std::size_t index = buffer.eventsCount.load(std::memory_order_relaxed);
+	if (index == mThreadEventsCount) {
+		buffer.droppedEventsCount.store(
+			buffer.droppedEventsCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed
+		);
+		return;
+	}
+
+	Event &event = buffer.events[index];
+	event.name = name;
+	event.beginTicks = beginTicks;
+	event.endTicks = endTicks;
+	buffer.eventsCount.store(index + 1, std::memory_order_release);
+}
+
+
+void FrameProfiler::WriteChromeTrace(std::ostream &stream) {
+	if (IsCapturing()) {
+		throw std::runtime_error("The capture isn't complete");
+	}
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	const std::uint64_t captureId = mCaptureId.load(std::memory_order_relaxed);
+	if (captureId == 0) {
+		throw std::runtime_error("Nothing was captured");
+	}
+
+	const std::ios::fmtflags flags = stream.flags();
+	const std::streamsize precision = stream.precision();
+	stream << std::fixed << std::setprecision(3);
+
+	stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	bool isFirst = true;
+	auto separate = [&stream, &isFirst] {
+		if (!isFirst) {
+			stream << ",\n";
+		}
+		isFirst = false;
+	};
+
+	// Threads are numbered in the order they first recorded
+	std::uint32_t tid = 0;
+	for (const std::unique_ptr<ThreadBuffer> &buffer : mThreadBuffers) {
+		tid++;
+		if (buffer->captureId != captureId) {
+			continue;
+		}
+
+		auto name = std::find_if(mThreadNames.begin(), mThreadNames.end(), [&buffer](const std::pair<std::thread::id, std::string> &threadName) {
+			return threadName.first == buffer->threadId;
+		});
+		const std::string threadName = name != mThreadNames.end() ? name->second : "Thread " + std::to_string(tid);
+		separate();
+		WriteThreadName(stream, tid, threadName.c_str());
+
+		const std::size_t eventsCount = buffer->eventsCount.load(std::memory_order_acquire);
+		for (std::size_t i = 0; i < eventsCount; i++) {
+			const Event &event = buffer->events[i];
+
+			// Scopes that began before the capture and ended in it
+			if (event.beginTicks < mCaptureBeginTicks) {
+				continue;
+			}
+
+			const double timestamp = TicksToMicroseconds(event.beginTicks);
+			separate();
+			WriteCompleteEvent(stream, tid, event.name, timestamp, TicksToMicroseconds(event.endTicks) - timestamp);
+		}
+	}
+
+	for (std::uint32_t track = 0; track < mTracks.size(); track++) {
+		separate();
+		WriteThreadName(stream, FIRST_TRACK_TID + track, mTracks[track]);
+	}
+
+	for (const TrackEvent &event : mTrackEvents) {
+		separate();
+		WriteCompleteEvent(
+			stream,
+			FIRST_TRACK_TID + event.track,
+			event.name,
+			(event.beginNanoseconds - mCaptureBeginNanoseconds) * 1e-3,
+			(event.endNanoseconds - event.beginNanoseconds) * 1e-3
+		);
+	}
+
+	stream << "\n]}\n";
+
+	stream.flags(flags);
+	stream.precision(precision);
+}
+
+
+void FrameProfiler::SaveChromeTrace(const std::string &path) {
+	std::ofstream file(path, std::ios::trunc);
+	WriteChromeTrace(file);
+	file.close();
+
+	if (!file) {
+		throw std::runtime_error("Failed to write the trace file " + path);
+	}
+}
+
+
+FrameProfiler::CaptureStatistics FrameProfiler::LastCaptureStatistics() {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	const std::uint64_t captureId = mCaptureId.load(std::memory_order_relaxed);
+
+	CaptureStatistics statistics;
+	statistics.framesCount = mCapturedFramesCount;
+	for (const std::unique_ptr<ThreadBuffer> &buffer : mThreadBuffers) {
+		if (captureId != 0 && buffer->captureId == captureId) {
+			statistics.threadsCount++;
+			statistics.eventsCount += buffer->eventsCount.load(std::memory_order_acquire);
+			statistics.droppedEventsCount += buffer->droppedEventsCount.load(std::memory_order_relaxed);
+		}
+	}
+	statistics.trackEventsCount = mTrackEvents.size();
+
+	return statistics;
+}
+
+
+void FrameProfiler::BeginCapture() {
+	if (Capturing() != nullptr) {
+		throw std::runtime_error("Another profiler is capturing");
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// The buffers are reset by their threads when they first record in the capture
+		mCaptureId.store(sLastCaptureId.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_release);
+		mTrackEvents.clear();
+	}
+
+	mCapturedFramesCount = 0;
+	mCaptureBeginNanoseconds = SteadyNow();
+	mCaptureBeginTicks = Now();
+	mCaptureEndTicks = mCaptureBeginTicks;
+	mCaptureEndNanoseconds = mCaptureBeginNanoseconds;
+
+	sCapturingProfiler.store(this, std::memory_order_release);
+}
+
+
+void FrameProfiler::EndCapture() {
+	mCaptureEndNanoseconds = SteadyNow();
+	mCaptureEndTicks = Now();
+
+	sCapturingProfiler.store(nullptr, std::memory_order_release);
+}
+
+
+FrameProfiler::ThreadBuffer& FrameProfiler::BindCurrentThread(std::uint64_t captureId) {
+	const std::thread::id threadId = std::this_thread::get_id();
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = std::find_if(mThreadBuffers.begin(), mThreadBuffers.end(), [threadId](const std::unique_ptr<ThreadBuffer> &buffer) {
+		return buffer->threadId == threadId;
+	});
+
+	ThreadBuffer *buffer;
+	if (it != mThreadBuffers.end()) {
+		buffer = it->get();
+	} else {
+		mThreadBuffers.push_back(std::make_unique<ThreadBuffer>());
+		buffer = mThreadBuffers.back().get();
+		buffer->threadId = threadId;
+		// Zeroed, so the pages are touched here and not by the scopes
+		buffer->events.reset(new Event[mThreadEventsCount]());
+	}
+
+	// Ids only grow, a scope of an older capture never resets a newer one
+	if (buffer->captureId < captureId) {
+		buffer->eventsCount.store(0, std::memory_order_relaxed);
+		buffer->droppedEventsCount.store(0, std::memory_order_relaxed);
+		buffer->captureId = captureId;
+	}
+
+	tThreadBuffer = buffer;
+	tThreadBufferCaptureId = captureId;
+
+	return *buffer;
+}
+
+
+double FrameProfiler::TicksToMicroseconds(std::uint64_t ticks) const {
+	const std::uint64_t captureTicks = mCaptureEndTicks - mCaptureBeginTicks;
+	const double nanosecondsPerTick = captureTicks > 0
+		? double(mCaptureEndNanoseconds - mCaptureBeginNanoseconds) / double(captureTicks)
+		: 1.0;
+
+	return double(static_cast<std::int64_t>(ticks - mCaptureBeginTicks)) * nanosecondsPerTick * 1e-3;
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+	#include <intrin.h>
+	#define FRAME_PROFILER_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+	#define FRAME_PROFILER_RDTSC
+#else
+	#include <chrono>
+#endif
+
+
+// Hierarchical profiler of the CPU time of frames, with the timelines of other
+// processors like the GPU next to the threads, exported as Chrome trace JSON
+// (chrome://tracing or ui.perfetto.dev).
+//
+// Scopes are marked with PROFILE_SCOPE. While a capture is running, a scope
+// costs two reads of the time stamp counter and one event written into a
+// buffer of its thread: every thread writes only into its own buffer and
+// publishes the events with a release store of the count, so recording takes
+// no lock and shares no cache line with the other threads. Without a capture a
+// scope only loads one pointer. Events that don't fit into the buffer of their
+// thread are dropped and counted.
+//
+// Captures span whole frames. RequestCapture asks for a number of frames and
+// BeginFrame, called by the main loop before every frame, starts the capture
+// at the next frame and stops it after the last one. Only one profiler captures
+// at a time, the scopes record into it wherever they are.
+//
+// Events of other timelines are added with their times on the steady clock,
+// e.g. timestamps of a GPU converted with a clock calibration. They may arrive
+// after the capture ends, until the next one begins.
+//
+// Scope names, track names and event names must outlive the profiler, e.g. be
+// string literals. BeginFrame, RequestCapture, the exports and the statistics
+// are called by one thread, other methods are thread-safe
+class FrameProfiler {
+public:
+	// Events that fit into the buffer of a thread in one capture
+	static constexpr std::size_t DEFAULT_THREAD_EVENTS_COUNT = 32 * 1024;
+
+	// Counters of the last capture
+	struct CaptureStatistics {
+		std::uint64_t framesCount = 0;
+		std::uint64_t threadsCount = 0;
+		std::uint64_t eventsCount = 0;
+		std::uint64_t droppedEventsCount = 0;
+		std::uint64_t trackEventsCount = 0;
+	};
+
+public:
+	explicit FrameProfiler(std::size_t threadEventsCount = DEFAULT_THREAD_EVENTS_COUNT);
+	FrameProfiler(const FrameProfiler&) = delete;
+	// No scope may still be recording into the profiler
+	~FrameProfiler();
+
+	FrameProfiler& operator = (const FrameProfiler&) = delete;
+
+	// Ticks of the time stamp counter, or nanoseconds of the steady clock
+	// where there is none
+	static std::uint64_t Now() {
+	#if defined(FRAME_PROFILER_RDTSC)
+		return __rdtsc();
+	#else
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()
+		).count());
+	#endif
+	}
+
+	// Nanoseconds of std::chrono::steady_clock, the time of the track events
+	static std::int64_t SteadyNow();
+
+	// The profiler whose capture is running, null if there is none
+	static FrameProfiler* Capturing() {
+		return sCapturingProfiler.load(std::memory_order_acquire);
+	}
+
+	// The capture starts at the next BeginFrame
+	void RequestCapture(std::uint32_t framesCount);
+
+	// Called by the main loop before every frame
+	void BeginFrame();
+
+	bool IsCapturing() const {
+		return Capturing() == this;
+	}
+
+	// Distinct for every capture of every profiler, 0 before the first one
+	std::uint64_t CaptureId() const {
+		return mCaptureId.load(std::memory_order_acquire);
+	}
+
+	// Named in the export instead of by its number
+	void NameCurrentThread(std::string name);
+
+	// Returns the id of a timeline that isn't a thread, e.g. a command queue,
+	// which is added the first time its name is used
+	std::uint32_t Track(const char *name);
+
+	// Ignored unless the capture is the last one
+	void RecordTrackEvent(
+		std::uint64_t captureId,
+		std::uint32_t track,
+		const char *name,
+		std::int64_t beginNanoseconds,
+		std::int64_t endNanoseconds
+	);
+
+	// Called by the scopes
+	void Record(const char *name, std::uint64_t beginTicks, std::uint64_t endTicks);
+
+	// Exports the last capture, which must be complete
+	void WriteChromeTrace(std::ostream &stream);
+	void SaveChromeTrace(const std::string &path);
+
+	CaptureStatistics LastCaptureStatistics();
+
+private:
+	struct Event {
+		const char *name;
+		std::uint64_t beginTicks;
+		std::uint64_t endTicks;
+	};
+
+	// Written only by its thread
+	struct ThreadBuffer {
+		std::thread::id threadId;
+		std::unique_ptr<Event[]> events;
+		// Published with release, read with acquire by the export
+		std::atomic<std::size_t> eventsCount{0};
+		std::atomic<std::uint64_t> droppedEventsCount{0};
+		// Guarded by mMutex, the capture the events belong to
+		std::uint64_t captureId = 0;
+	};
+
+	struct TrackEvent {
+		std::uint32_t track;
+		const char *name;
+		std::int64_t beginNanoseconds;
+		std::int64_t endNanoseconds;
+	};
+
+	void BeginCapture();
+	void EndCapture();
+
+	// Returns the buffer of the calling thread for the capture
+	ThreadBuffer& BindCurrentThread(std::uint64_t captureId);
+
+	double TicksToMicroseconds(std::uint64_t ticks) const;
+
+private:
+	static std::atomic<FrameProfiler*> sCapturingProfiler;
+	static std::atomic<std::uint64_t> sLastCaptureId;
+
+	const std::size_t mThreadEventsCount;
+
+	std::atomic<std::uint64_t> mCaptureId{0};
+
+	// Owned by the thread of BeginFrame
+	std::uint32_t mRequestedFramesCount = 0;
+	std::uint32_t mCaptureFramesCount = 0;
+	std::uint32_t mCapturedFramesCount = 0;
+	std::uint64_t mFrameBeginTicks = 0;
+
+	// The clocks read together at both ends of the capture, ticks are
+	// converted to nanoseconds by their ratio
+	std::uint64_t mCaptureBeginTicks = 0;
+	std::int64_t mCaptureBeginNanoseconds = 0;
+	std::uint64_t mCaptureEndTicks = 0;
+	std::int64_t mCaptureEndNanoseconds = 0;
+
+	// Guards the members below, never taken by a recording scope unless its
+	// thread records for the first time in the capture
+	std::mutex mMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> mThreadBuffers;
+	std::vector<std::pair<std::thread::id, std::string>> mThreadNames;
+	std::vector<const char*> mTracks;
+	std::vector<TrackEvent> mTrackEvents;
+};
+
+
+// Records the time from its construction until its destruction into the
+// capturing profiler.
+//
+// This class is not thread-safe, it's used by the thread that creates it
+class ProfileScope {
+public:
+	explicit ProfileScope(const char *name)
+	: mName(name), mProfiler(FrameProfiler::Capturing()) {
+		if (mProfiler != nullptr) {
+			mBeginTicks = FrameProfiler::Now();
+		}
+	}
+
+	~ProfileScope() {
+		if (mProfiler != nullptr) {
+			mProfiler->Record(mName, mBeginTicks, FrameProfiler::Now());
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+
+	ProfileScope& operator = (const ProfileScope&) = delete;
+
+private:
+	const char *mName;
+	FrameProfiler *mProfiler;
+	std::uint64_t mBeginTicks = 0;
+};
+
+
+#define PROFILE_SCOPE_CONCATENATE_(a, b) a##b
+#define PROFILE_SCOPE_CONCATENATE(a, b) PROFILE_SCOPE_CONCATENATE_(a, b)
+
+// Profiles the rest of the enclosing block, the name must be a string literal
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_CONCATENATE(profileScope, __LINE__)(name)
@@ -0,0 +1,235 @@
+#pragma once
+
+
+#include "GraphicsTypes.h"
+#include "FrameRing.h"
+#include "FrameProfiler.h"
+#include "JobSystem.h"
+#include "ParallelCommandRecorder.h"
+#include "RenderGraph.h"
+#include "ResourceStateTracker.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Frame loop that doesn't depend on the graphics API: builds the frame graph,
+// records it on the threads of the job system and submits it, running up to
+// framesInFlightCount frames ahead of the device.
+//
+// Backend provides the device, with static dispatch:
+//   Fence                                  - fence of FrameRing, e.g. WaitableGpuFence or CpuTimelineFence
+//   FrameContext                           - default-constructible state of a frame in flight
+//   RecordingBackend                       - backend of ParallelCommandRecorder, whose CommandList has
+//                                              ResourceStateTracker states
+//                                              SetViewport(const Viewport&), SetScissorRect(const Rect&)
+//                                              SetRenderTarget(RenderTargetView, DepthStencilView)
+//                                              ClearRenderTarget(RenderTargetView, const float color[4])
+//                                              ClearDepthStencil(DepthStencilView, float depth, std::uint8_t stencil)
+//   RenderTargetView, DepthStencilView     - copyable handles
+//   GpuScope                               - copyable, a section of a list timed on the device
+//   Fence& GetFence()
+//   RecordingBackend& Recording()
+//   void* BackBuffer()                     - resource of the back buffer of the frame
+//   RenderTargetView BackBufferView()
+//   void PlaceTransientResources(const CompiledRenderGraph&, RenderGraph::ResourceId depthStencilId)
+//   void* DepthStencilBuffer()
+//   DepthStencilView DepthStencilBufferView()
+//   void BeginRecording(CommandList&)      - binds the state shared by every list
+//   void FlushPassBarriers(CommandList&, std::uint32_t pass) - the tracked barriers and the backend's own before a pass
+//   void FlushBarriers(CommandList&)
+//   GpuScope BeginGpuScope(CommandList&, const char *name) - the name is a string literal
+//   void EndGpuScope(CommandList&, const GpuScope&)
+//   Fence::Label Present()                 - presents the back buffer and puts a label after the frame
+//   void EndFrame(FrameContext&, const Fence::Label&) - hands the frame's memory over to the label
+//
+// Resources are identified by their addresses, like in ResourceStateTracker.
+//
+// This class is not thread-safe, RenderFrame must be called from a thread of the job system
+template <typename Backend>
+class FrameRenderer {
+public:
+	using Fence = typename Backend::Fence;
+	using RecordingBackend = typename Backend::RecordingBackend;
+	using CommandList = typename RecordingBackend::CommandList;
+
+	static constexpr std::size_t DEFAULT_FRAMES_IN_FLIGHT_COUNT = 2;
+
+public:
+	FrameRenderer(
+		Backend &backend,
+		JobSystem &jobSystem,
+		std::uint32_t width,
+		std::uint32_t height,
+		std::size_t framesInFlightCount = DEFAULT_FRAMES_IN_FLIGHT_COUNT
+	);
+	~FrameRenderer();
+	FrameRenderer(const FrameRenderer&) = delete;
+
+	FrameRenderer& operator = (const FrameRenderer&) = delete;
+
+	void RenderFrame();
+
+	// Waits for every submitted frame
+	void WaitForAllFrames() {
+		mFrames.WaitForAllFrames();
+	}
+
+	std::uint64_t FrameNumber() const {
+		return mFrames.FrameNumber();
+	}
+
+private:
+	static void ApplyGraphBarriers(
+		const CompiledRenderGraph &graph,
+		const CompiledRenderGraph::BarrierRange &range,
+		void *const *resources,
+		ResourceStateTracker &states
+	);
+
+private:
+	Backend &mBackend;
+
+	FrameRing<Fence, typename Backend::FrameContext> mFrames;
+	RenderGraph mFrameGraph;
+	ParallelCommandRecorder<RecordingBackend> mRecorder;
+
+	Viewport mViewport;
+	Rect mScissorRect;
+};
+
+
+template <typename Backend>
+FrameRenderer<Backend>::FrameRenderer(
+	Backend &backend,
+	JobSystem &jobSystem,
+	std::uint32_t width,
+	std::uint32_t height,
+	std::size_t framesInFlightCount
+)
+: mBackend(backend),
+  mFrames(backend.GetFence(), framesInFlightCount),
+  mRecorder(backend.Recording(), jobSystem) {
+	mViewport.topLeftX = 0.0f;
+	mViewport.topLeftY = 0.0f;
+	mViewport.width = static_cast<float>(width);
+	mViewport.height = static_cast<float>(height);
+	mViewport.minDepth = 0.0f;
+	mViewport.maxDepth = 1.0f;
+
+	mScissorRect.left = 0;
+	mScissorRect.top = 0;
+	mScissorRect.right = static_cast<std::int32_t>(width);
+	mScissorRect.bottom = static_cast<std::int32_t>(height);
+}
+
+
+template <typename Backend>
+FrameRenderer<Backend>::~FrameRenderer() {
+	// Frames in flight still use the memory of their contexts
+	try {
+		mFrames.WaitForAllFrames();
+	} catch (...) {
+	}
+}
+
+
+template <typename Backend>
+void FrameRenderer<Backend>::RenderFrame() {
+	PROFILE_SCOPE("RenderFrame");
+
+	// Waits only if the device hasn't finished the frame that used this context
+	typename Backend::FrameContext &frame = mFrames.BeginFrame();
+
+	mFrameGraph.Reset();
+
+	const RenderGraph::ResourceId backBufferId = mFrameGraph.ImportResource(ResourceState::PRESENT, ResourceState::PRESENT);
+	const RenderGraph::ResourceId depthStencilId = mFrameGraph.CreateResource(ResourceState::DEPTH_WRITE);
+
+	const RenderGraph::PassId mainPass = mFrameGraph.AddPass();
+	mFrameGraph.Write(mainPass, backBufferId, ResourceState::RENDER_TARGET);
+	mFrameGraph.Write(mainPass, depthStencilId, ResourceState::DEPTH_WRITE);
+
+	const CompiledRenderGraph &frameGraph = mFrameGraph.Compile();
+	if (!mFrameGraph.WasReused()) {
+		mBackend.PlaceTransientResources(frameGraph, depthStencilId);
+	}
+
+	void *graphResources[2];
+	graphResources[backBufferId] = mBackend.BackBuffer();
+	graphResources[depthStencilId] = mBackend.DepthStencilBuffer();
+
+	const auto renderTargetView = mBackend.BackBufferView();
+	const auto depthStencilView = mBackend.DepthStencilBufferView();
+
+	mRecorder.AddTask([this, &frameGraph, graphResources, mainPass, renderTargetView, depthStencilView](
+		CommandList &commandList
+	) {
+		PROFILE_SCOPE("Record frame graph");
+
+		mBackend.BeginRecording(commandList);
+
+		commandList.SetViewport(mViewport);
+		commandList.SetScissorRect(mScissorRect);
+
+		for (std::uint32_t i = 0; i < frameGraph.passes.size(); i++) {
+			ApplyGraphBarriers(frameGraph, frameGraph.passBarriers[i], graphResources, commandList.states);
+			mBackend.FlushPassBarriers(commandList, i);
+
+			if (frameGraph.passes[i] == mainPass) {
+				const auto gpuScope = mBackend.BeginGpuScope(commandList, "Main pass");
+
+				commandList.SetRenderTarget(renderTargetView, depthStencilView);
+
+				const float clearColor[] = { 0.0f, 0.4f, 0.2f, 1.0f };
+				commandList.ClearRenderTarget(renderTargetView, clearColor);
+
+				// Aliased memory has undefined contents
+				commandList.ClearDepthStencil(depthStencilView, 1.0f, 0);
+
+				mBackend.EndGpuScope(commandList, gpuScope);
+			}
+
+			// Resources done with the graph start their final transitions, they're
+			// split if more passes are recorded before the end
+			for (std::uint32_t j = frameGraph.finalBarriers.begin; j < frameGraph.finalBarriers.end; j++) {
+				const CompiledRenderGraph::Barrier &barrier = frameGraph.barriers[j];
+				if (frameGraph.resourceLifetimes[barrier.resource].lastPass == i) {
+					commandList.states.BeginTransition(graphResources[barrier.resource], ALL_SUBRESOURCES, barrier.after);
+				}
+			}
+		}
+
+		ApplyGraphBarriers(frameGraph, frameGraph.finalBarriers, graphResources, commandList.states);
+		mBackend.FlushBarriers(commandList);
+	});
+
+	// Tasks are recorded in parallel and submitted in the order they were added
+	mRecorder.RecordAndSubmit();
+
+	PROFILE_SCOPE("Present");
+
+	const auto label = mBackend.Present();
+	mBackend.EndFrame(frame, label);
+	mFrames.EndFrame(label);
+}
+
+
+template <typename Backend>
+void FrameRenderer<Backend>::ApplyGraphBarriers(
+	const CompiledRenderGraph &graph,
+	const CompiledRenderGraph::BarrierRange &range,
+	void *const *resources,
+	ResourceStateTracker &states
+) {
+	for (std::uint32_t i = range.begin; i < range.end; i++) {
+		const CompiledRenderGraph::Barrier &barrier = graph.barriers[i];
+		void *resource = resources[barrier.resource];
+
+		if (barrier.type == CompiledRenderGraph::BarrierType::UAV) {
+			states.UavBarrier(resource);
+		} else {
+			states.Transition(resource, ALL_SUBRESOURCES, barrier.after);
+		}
+	}
+}
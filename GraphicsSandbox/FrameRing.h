@@ -0,0 +1,129 @@
+#pragma once
+
+
+#include "FrameProfiler.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Ring of per-frame contexts that lets the CPU run several frames ahead of the GPU.
+//
+// Every slot keeps the transient state of one frame (command allocators, staging
+// memory and so on) together with the fence label that was put after the frame
+// had been submitted. Beginning a frame waits only for the label of the slot that
+// is about to be reused instead of flushing the whole queue.
+//
+// Fence is any type that provides a copyable Label and WaitForLabel(const Label&),
+// e.g. WaitableGpuFence. It is a template parameter so that the scheduling can be
+// driven by a CPU-side fence without a GPU.
+//
+// This class is not thread-safe
+template <typename Fence, typename FrameContext>
+class FrameRing {
+public:
+	using Label = typename Fence::Label;
+
+public:
+	FrameRing(Fence &fence, std::size_t framesInFlightCount);
+	FrameRing(const FrameRing&) = delete;
+
+	FrameRing& operator = (const FrameRing&) = delete;
+
+	// Waits until the GPU is done with the slot for the next frame and returns it
+	FrameContext& BeginFrame();
+
+	// Associates the label put after the frame submission with the current slot
+	void EndFrame(const Label &label);
+
+	// Waits for every submitted frame, e.g. before releasing resources
+	void WaitForAllFrames();
+
+	FrameContext& CurrentFrame() {
+		return mSlots[mCurrentIndex].context;
+	}
+
+	FrameContext& Frame(std::size_t index) {
+		return mSlots[index].context;
+	}
+
+	std::size_t CurrentFrameIndex() const {
+		return mCurrentIndex;
+	}
+
+	std::size_t FramesInFlightCount() const {
+		return mSlots.size();
+	}
+
+	// Number of frames that have been begun so far
+	std::uint64_t FrameNumber() const {
+		return mFrameNumber;
+	}
+
+private:
+	struct Slot {
+		FrameContext context;
+		Label label;
+		bool isInFlight = false;
+	};
+
+	Fence &mFence;
+	std::vector<Slot> mSlots;
+	std::size_t mCurrentIndex = 0;
+	std::uint64_t mFrameNumber = 0;
+	bool mIsRecording = false;
+};
+
+
+template <typename Fence, typename FrameContext>
+FrameRing<Fence, FrameContext>::FrameRing(Fence &fence, std::size_t framesInFlightCount)
+: mFence(fence), mSlots(framesInFlightCount) {
+	assert(framesInFlightCount > 0);
+}
+
+
+template <typename Fence, typename FrameContext>
+FrameContext& FrameRing<Fence, FrameContext>::BeginFrame() {
+	assert(!mIsRecording);
+
+	if (mFrameNumber > 0) {
+		mCurrentIndex = (mCurrentIndex + 1) % mSlots.size();
+	}
+
+	Slot &slot = mSlots[mCurrentIndex];
+	if (slot.isInFlight) {
+		PROFILE_SCOPE("Wait for frame in flight");
+		mFence.WaitForLabel(slot.label);
+		slot.isInFlight = false;
+	}
+
+	++mFrameNumber;
+	mIsRecording = true;
+
+	return slot.context;
+}
+
+
+template <typename Fence, typename FrameContext>
+void FrameRing<Fence, FrameContext>::EndFrame(const Label &label) {
+	assert(mIsRecording);
+
+	Slot &slot = mSlots[mCurrentIndex];
+	slot.label = label;
+	slot.isInFlight = true;
+
+	mIsRecording = false;
+}
+
+
+template <typename Fence, typename FrameContext>
+void FrameRing<Fence, FrameContext>::WaitForAllFrames() {
+	for (Slot &slot : mSlots) {
+		if (slot.isInFlight) {
+			mFence.WaitForLabel(slot.label);
+			slot.isInFlight = false;
+		}
+	}
+}
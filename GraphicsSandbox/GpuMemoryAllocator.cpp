@@ -0,0 +1,217 @@
+#include "GpuMemoryAllocator.h"
+#include "d3dx12.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+GpuMemoryAllocator::GpuMemoryAllocator(GraphicsDevice &device, UINT64 heapSize)
+: mDevice(device), mHeapSize(heapSize) {
+	D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+	D3D_CHECK(mDevice.GetD3dDevice()->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+	mResourceHeapTier = options.ResourceHeapTier;
+
+	const D3D12_HEAP_TYPE heapTypes[HEAP_TYPES_COUNT] = {
+		D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_TYPE_UPLOAD,
+		D3D12_HEAP_TYPE_READBACK
+	};
+	const D3D12_HEAP_FLAGS categoryFlags[CATEGORIES_COUNT] = {
+		D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES
+	};
+
+	for (UINT i = 0; i < HEAP_TYPES_COUNT; i++) {
+		for (UINT j = 0; j < CATEGORIES_COUNT; j++) {
+			Pool &pool = mPools[i * CATEGORIES_COUNT + j];
+			pool.heapType = heapTypes[i];
+			pool.heapFlags = mResourceHeapTier == D3D12_RESOURCE_HEAP_TIER_1
+				? categoryFlags[j]
+				: D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES;
+		}
+	}
+}
+
+
+ComPtr<ID3D12Resource> GpuMemoryAllocator::CreatePlacedResource(
+	D3D12_HEAP_TYPE heapType,
+	const D3D12_RESOURCE_DESC &desc,
+	D3D12_RESOURCE_STATES initialState,
+	const D3D12_CLEAR_VALUE *clearValue,
+	GpuAllocation &allocation
+) {
+	D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = GetAllocationInfo(desc);
+
+	D3D12_RESOURCE_DESC placedDesc = desc;
+	placedDesc.Alignment = allocationInfo.Alignment;
+
+	allocation = Allocate(heapType, CategoryOf(desc), allocationInfo);
+
+	ComPtr<ID3D12Resource> resource;
+	try {
+		D3D_CHECK(mDevice.GetD3dDevice()->CreatePlacedResource(
+			allocation.heap, allocation.offset, &placedDesc, initialState, clearValue, IID_PPV_ARGS(&resource)
+		));
+	} catch (...) {
+		Free(allocation);
+		throw;
+	}
+
+	return resource;
+}
+
+
+GpuAllocation GpuMemoryAllocator::Allocate(
+	D3D12_HEAP_TYPE heapType,
+	GpuMemoryCategory category,
+	const D3D12_RESOURCE_ALLOCATION_INFO &allocationInfo
+) {
+	GpuAllocation allocation;
+	allocation.poolIndex = PoolIndex(heapType, category);
+	allocation.size = allocationInfo.SizeInBytes;
+
+	Pool &pool = mPools[allocation.poolIndex];
+	std::lock_guard<std::mutex> lock(pool.mutex);
+
+	for (auto &heap : pool.heaps) {
+		allocation.block = heap->blocks.Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+		if (allocation.block.offset != TlsfAllocator::INVALID_OFFSET) {
+			allocation.heap = heap->heap.Get();
+			allocation.offset = allocation.block.offset;
+			return allocation;
+		}
+	}
+
+	// Heaps are aligned for MSAA resources, so the beginning fits any alignment
+	const UINT64 heapSize = std::max(
+		mHeapSize,
+		(allocationInfo.SizeInBytes + D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT - 1)
+			& ~UINT64(D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT - 1)
+	);
+	Heap &heap = CreateHeap(pool, heapSize);
+	allocation.block = heap.blocks.Allocate(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+	allocation.heap = heap.heap.Get();
+	allocation.offset = allocation.block.offset;
+
+	return allocation;
+}
+
+
+void GpuMemoryAllocator::Free(const GpuAllocation &allocation) {
+	Pool &pool = mPools[allocation.poolIndex];
+	std::lock_guard<std::mutex> lock(pool.mutex);
+
+	for (auto it = pool.heaps.begin(); it != pool.heaps.end(); ++it) {
+		Heap &heap = **it;
+		if (heap.heap.Get() != allocation.heap) {
+			continue;
+		}
+
+		heap.blocks.Free(allocation.block);
+
+		// Regular heaps are kept for later allocations
+		if (heap.blocks.IsEmpty() && heap.blocks.Size() > mHeapSize) {
+			pool.heaps.erase(it);
+		}
+
+		return;
+	}
+
+	throw std::logic_error("Allocation doesn't belong to the allocator");
+}
+
+
+D3D12_RESOURCE_ALLOCATION_INFO GpuMemoryAllocator::GetAllocationInfo(const D3D12_RESOURCE_DESC &desc) {
+	D3D12_RESOURCE_DESC alignedDesc = desc;
+
+	const bool mayBeSmall = desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER
+		&& CategoryOf(desc) == GpuMemoryCategory::TEXTURES
+		&& desc.SampleDesc.Count == 1;
+
+	if (mayBeSmall) {
+		// The runtime reports a larger alignment if the texture is too big for it
+		alignedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+
+		D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = mDevice.GetD3dDevice()->GetResourceAllocationInfo(0, 1, &alignedDesc);
+		if (allocationInfo.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+			return allocationInfo;
+		}
+	}
+
+	// Zero picks the default alignment or the MSAA one
+	alignedDesc.Alignment = 0;
+	return mDevice.GetD3dDevice()->GetResourceAllocationInfo(0, 1, &alignedDesc);
+}
+
+
+GpuMemoryCategory GpuMemoryAllocator::CategoryOf(const D3D12_RESOURCE_DESC &desc) {
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+		return GpuMemoryCategory::BUFFERS;
+	}
+
+	const D3D12_RESOURCE_FLAGS renderTargetFlags =
+		D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+
+	return (desc.Flags & renderTargetFlags) != 0 ? GpuMemoryCategory::RENDER_TARGETS : GpuMemoryCategory::TEXTURES;
+}
+
+
+GpuMemoryAllocator::Statistics GpuMemoryAllocator::GetStatistics() {
+	Statistics statistics;
+
+	for (Pool &pool : mPools) {
+		std::lock_guard<std::mutex> lock(pool.mutex);
+
+		for (auto &heap : pool.heaps) {
+			statistics.heapsCount++;
+			statistics.heapsSize += heap->blocks.Size();
+			statistics.allocatedSize += heap->blocks.Size() - heap->blocks.FreeSize();
+			statistics.allocationsCount += heap->blocks.AllocationsCount();
+		}
+	}
+
+	return statistics;
+}
+
+
+UINT GpuMemoryAllocator::PoolIndex(D3D12_HEAP_TYPE heapType, GpuMemoryCategory category) const {
+	UINT heapTypeIndex;
+	switch (heapType) {
+	case D3D12_HEAP_TYPE_DEFAULT:
+		heapTypeIndex = 0;
+		break;
+
+	case D3D12_HEAP_TYPE_UPLOAD:
+		heapTypeIndex = 1;
+		break;
+
+	case D3D12_HEAP_TYPE_READBACK:
+		heapTypeIndex = 2;
+		break;
+
+	default:
+		throw std::logic_error("Custom heaps are not supported by the allocator");
+	}
+
+	// Tier 2 heaps take every category, so one pool is enough
+	const UINT categoryIndex = mResourceHeapTier == D3D12_RESOURCE_HEAP_TIER_1 ? static_cast<UINT>(category) : 0;
+
+	return heapTypeIndex * CATEGORIES_COUNT + categoryIndex;
+}
+
+
+GpuMemoryAllocator::Heap& GpuMemoryAllocator::CreateHeap(Pool &pool, UINT64 size) {
+	std::unique_ptr<Heap> heap = std::make_unique<Heap>(size);
+
+	CD3DX12_HEAP_DESC heapDesc(
+		size,
+		pool.heapType,
+		D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT,
+		pool.heapFlags
+	);
+	D3D_CHECK(mDevice.GetD3dDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap->heap)));
+
+	pool.heaps.push_back(std::move(heap));
+	return *pool.heaps.back();
+}
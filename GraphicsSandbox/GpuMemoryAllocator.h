@@ -0,0 +1,115 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "TlsfAllocator.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+// Resources that D3D12_RESOURCE_HEAP_TIER_1 hardware can't place into one heap
+enum class GpuMemoryCategory {
+	BUFFERS,
+	TEXTURES,
+	// Render target and depth-stencil textures
+	RENDER_TARGETS
+};
+
+
+// Memory of a resource in one of the heaps of GpuMemoryAllocator
+struct GpuAllocation {
+	ID3D12Heap *heap = nullptr;
+	UINT64 offset = 0;
+	UINT64 size = 0;
+
+	UINT poolIndex = 0;
+	TlsfAllocator::Allocation block;
+};
+
+
+// Places resources into large ID3D12Heaps instead of giving each one an implicit heap.
+//
+// Every heap type has its own pool of heaps, and on tier 1 hardware every
+// GpuMemoryCategory has too. Space in a heap is sub-allocated by TlsfAllocator.
+// Textures that allow it get D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT, the rest
+// D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT or the MSAA one. Resources larger
+// than a heap get a heap of their own that is released when they are freed.
+//
+// This class is thread-safe
+class GpuMemoryAllocator {
+public:
+	static constexpr UINT64 DEFAULT_HEAP_SIZE = 64 * 1024 * 1024;
+
+	struct Statistics {
+		UINT heapsCount = 0;
+		UINT64 heapsSize = 0;
+		UINT64 allocatedSize = 0;
+		UINT allocationsCount = 0;
+	};
+
+public:
+	explicit GpuMemoryAllocator(GraphicsDevice &device, UINT64 heapSize = DEFAULT_HEAP_SIZE);
+	GpuMemoryAllocator(const GpuMemoryAllocator&) = delete;
+
+	GpuMemoryAllocator& operator = (const GpuMemoryAllocator&) = delete;
+
+	ComPtr<ID3D12Resource> CreatePlacedResource(
+		D3D12_HEAP_TYPE heapType,
+		const D3D12_RESOURCE_DESC &desc,
+		D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE *clearValue,
+		GpuAllocation &allocation
+	);
+
+	// Memory that several resources can be placed into, e.g. to alias them
+	GpuAllocation Allocate(
+		D3D12_HEAP_TYPE heapType,
+		GpuMemoryCategory category,
+		const D3D12_RESOURCE_ALLOCATION_INFO &allocationInfo
+	);
+
+	// Resources placed into the allocation must not be used by the GPU anymore
+	void Free(const GpuAllocation &allocation);
+
+	// Size and alignment with the smallest placement alignment the resource allows
+	D3D12_RESOURCE_ALLOCATION_INFO GetAllocationInfo(const D3D12_RESOURCE_DESC &desc);
+
+	static GpuMemoryCategory CategoryOf(const D3D12_RESOURCE_DESC &desc);
+
+	Statistics GetStatistics();
+
+private:
+	struct Heap {
+		ComPtr<ID3D12Heap> heap;
+		TlsfAllocator blocks;
+
+		explicit Heap(UINT64 size)
+		: blocks(size) {
+		}
+	};
+
+	struct Pool {
+		D3D12_HEAP_TYPE heapType;
+		D3D12_HEAP_FLAGS heapFlags;
+
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Heap>> heaps;
+	};
+
+	static constexpr UINT HEAP_TYPES_COUNT = 3;
+	static constexpr UINT CATEGORIES_COUNT = 3;
+
+	UINT PoolIndex(D3D12_HEAP_TYPE heapType, GpuMemoryCategory category) const;
+
+	Heap& CreateHeap(Pool &pool, UINT64 size);
+
+private:
+	GraphicsDevice &mDevice;
+	const UINT64 mHeapSize;
+
+	D3D12_RESOURCE_HEAP_TIER mResourceHeapTier;
+	Pool mPools[HEAP_TYPES_COUNT * CATEGORIES_COUNT];
+};
@@ -0,0 +1,146 @@
+#include "GpuProfiler.h"
+
+#include <algorithm>
+
+
+constexpr UINT GpuProfiler::MAX_FRAME_SCOPES_COUNT;
+constexpr UINT GpuProfiler::FRAMES_COUNT;
+constexpr UINT GpuProfiler::NO_QUERY;
+
+
+GpuProfiler::GpuProfiler(GraphicsDevice &device, ID3D12CommandQueue *commandQueue, WaitableGpuFence &fence)
+: mCommandQueue(commandQueue),
+  mFence(fence),
+  mTimestamps(device, QUERIES_COUNT * sizeof(UINT64)) {
+	D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+	queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	queryHeapDesc.Count = QUERIES_COUNT;
+	queryHeapDesc.NodeMask = 0;
+	D3D_CHECK(device.GetD3dDevice()->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&mQueryHeap)));
+
+	D3D_CHECK(mCommandQueue->GetTimestampFrequency(&mTimestampFrequency));
+	WINDOWS_CHECK(QueryPerformanceFrequency(&mQpcFrequency));
+}
+
+
+GpuProfiler::Scope GpuProfiler::BeginScope(ID3D12GraphicsCommandList *commandList, const char *name) {
+	const UINT index = mFrameScopesCount.fetch_add(1, std::memory_order_relaxed);
+	if (index >= MAX_FRAME_SCOPES_COUNT) {
+		return { NO_QUERY };
+	}
+
+	// The frame index changes only between frames, while nothing is recorded
+	mFrames[mCurrentFrameIndex].names[index] = name;
+
+	const UINT beginQuery = (mCurrentFrameIndex * MAX_FRAME_SCOPES_COUNT + index) * 2;
+	commandList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, beginQuery);
+
+	return { beginQuery };
+}
+
+
+void GpuProfiler::EndScope(ID3D12GraphicsCommandList *commandList, const Scope &scope) {
+	if (scope.beginQuery != NO_QUERY) {
+		commandList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, scope.beginQuery + 1);
+	}
+}
+
+
+void GpuProfiler::ResolveFrame(ID3D12GraphicsCommandList *commandList) {
+	FrameProfiler *profiler = FrameProfiler::Capturing();
+	const UINT scopesCount = std::min(mFrameScopesCount.load(std::memory_order_relaxed), MAX_FRAME_SCOPES_COUNT);
+	if (profiler == nullptr || scopesCount == 0) {
+		return;
+	}
+
+	Frame &frame = mFrames[mCurrentFrameIndex];
+	frame.profiler = profiler;
+	frame.captureId = profiler->CaptureId();
+	frame.scopesCount = scopesCount;
+
+	const UINT firstQuery = mCurrentFrameIndex * MAX_FRAME_SCOPES_COUNT * 2;
+	commandList->ResolveQueryData(
+		mQueryHeap.Get(),
+		D3D12_QUERY_TYPE_TIMESTAMP,
+		firstQuery,
+		scopesCount * 2,
+		mTimestamps.Resource(),
+		firstQuery * sizeof(UINT64)
+	);
+}
+
+
+void GpuProfiler::EndFrame(const WaitableGpuFence::Label &label) {
+	mFrames[mCurrentFrameIndex].label = label;
+	mCurrentFrameIndex = (mCurrentFrameIndex + 1) % FRAMES_COUNT;
+
+	for (UINT i = 0; i < FRAMES_COUNT; i++) {
+		Frame &frame = mFrames[i];
+		if (frame.profiler == nullptr) {
+			continue;
+		}
+
+		// The next frame writes over the queries of its slot
+		if (i == mCurrentFrameIndex) {
+			mFence.WaitForLabel(frame.label);
+		} else if (!mFence.IsComplete(frame.label)) {
+			continue;
+		}
+
+		Collect(frame, i);
+	}
+
+	mFrameScopesCount.store(0, std::memory_order_relaxed);
+}
+
+
+void GpuProfiler::CollectAll() {
+	for (UINT i = 0; i < FRAMES_COUNT; i++) {
+		Frame &frame = mFrames[i];
+		if (frame.profiler != nullptr) {
+			mFence.WaitForLabel(frame.label);
+			Collect(frame, i);
+		}
+	}
+}
+
+
+void GpuProfiler::Collect(Frame &frame, UINT frameIndex) {
+	// Taken now, the clocks don't drift apart noticeably within a few frames
+	UINT64 calibrationTimestamp;
+	UINT64 calibrationQpc;
+	D3D_CHECK(mCommandQueue->GetClockCalibration(&calibrationTimestamp, &calibrationQpc));
+	const std::int64_t calibrationNanoseconds = QpcToNanoseconds(calibrationQpc);
+	const double nanosecondsPerTick = 1e9 / double(mTimestampFrequency);
+
+	auto toNanoseconds = [calibrationTimestamp, calibrationNanoseconds, nanosecondsPerTick](UINT64 timestamp) {
+		const std::int64_t ticks = static_cast<std::int64_t>(timestamp - calibrationTimestamp);
+		return calibrationNanoseconds + static_cast<std::int64_t>(double(ticks) * nanosecondsPerTick);
+	};
+
+	const std::uint32_t track = frame.profiler->Track(TRACK_NAME);
+	const UINT64 *timestamps = reinterpret_cast<const UINT64*>(mTimestamps.CpuAddress())
+		+ frameIndex * MAX_FRAME_SCOPES_COUNT * 2;
+
+	for (UINT i = 0; i < frame.scopesCount; i++) {
+		frame.profiler->RecordTrackEvent(
+			frame.captureId,
+			track,
+			frame.names[i],
+			toNanoseconds(timestamps[i * 2]),
+			toNanoseconds(timestamps[i * 2 + 1])
+		);
+	}
+
+	frame.profiler = nullptr;
+}
+
+
+std::int64_t GpuProfiler::QpcToNanoseconds(UINT64 qpc) const {
+	// Like steady_clock, split so the product doesn't overflow
+	const UINT64 frequency = static_cast<UINT64>(mQpcFrequency.QuadPart);
+	const UINT64 seconds = qpc / frequency;
+	const UINT64 remainder = qpc % frequency;
+
+	return static_cast<std::int64_t>(seconds * 1000000000ULL + remainder * 1000000000ULL / frequency);
+}
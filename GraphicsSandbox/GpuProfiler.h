@@ -0,0 +1,100 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "FrameProfiler.h"
+#include "ReadbackBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+
+// Times sections of command lists on the GPU with timestamp queries and adds
+// them to the capture of the FrameProfiler, as the track of the command queue.
+//
+// Scopes always write their queries, they cost two timestamps on the GPU. The
+// queries of a captured frame are resolved into a readback buffer at the end
+// of the frame and read once its label completes, a few frames later, without
+// waiting for the GPU. GetClockCalibration pairs a timestamp of the queue with
+// QueryPerformanceCounter, the clock of std::chrono::steady_clock on Windows,
+// so the scopes line up with the events of the threads.
+//
+// A frame has room for MAX_FRAME_SCOPES_COUNT scopes, the ones past it are
+// dropped. The capturing profiler must outlive the frames it captures.
+//
+// BeginScope and EndScope are thread-safe, they're called by the recording
+// tasks. Other methods are called by one thread
+class GpuProfiler {
+public:
+	static constexpr UINT MAX_FRAME_SCOPES_COUNT = 256;
+	// Frames whose queries may be in flight at once
+	static constexpr UINT FRAMES_COUNT = 4;
+	static constexpr UINT NO_QUERY = UINT_MAX;
+
+	struct Scope {
+		// The end query follows it, NO_QUERY if the scope was dropped
+		UINT beginQuery;
+	};
+
+public:
+	// The queue executes the lists of the scopes, the fence labels its frames
+	GpuProfiler(GraphicsDevice &device, ID3D12CommandQueue *commandQueue, WaitableGpuFence &fence);
+	GpuProfiler(const GpuProfiler&) = delete;
+
+	GpuProfiler& operator = (const GpuProfiler&) = delete;
+
+	// The name must outlive the capture, e.g. be a string literal
+	Scope BeginScope(ID3D12GraphicsCommandList *commandList, const char *name);
+	void EndScope(ID3D12GraphicsCommandList *commandList, const Scope &scope);
+
+	// Tells whether the frame is captured and has scopes
+	bool IsResolveNeeded() const {
+		return FrameProfiler::Capturing() != nullptr && mFrameScopesCount.load(std::memory_order_relaxed) > 0;
+	}
+
+	// Records the resolve of the queries of the frame, after its last scope
+	void ResolveFrame(ID3D12GraphicsCommandList *commandList);
+
+	// Collects the frames whose labels completed, waits only if the frame that
+	// used the queries of the next one is still in flight
+	void EndFrame(const WaitableGpuFence::Label &label);
+
+	// Waits for the captured frames in flight and collects them, e.g. before
+	// the capture is exported
+	void CollectAll();
+
+private:
+	struct Frame {
+		// Null unless the frame was captured and its scopes aren't collected yet
+		FrameProfiler *profiler = nullptr;
+		std::uint64_t captureId = 0;
+		UINT scopesCount = 0;
+		WaitableGpuFence::Label label;
+		std::array<const char*, MAX_FRAME_SCOPES_COUNT> names;
+	};
+
+	void Collect(Frame &frame, UINT frameIndex);
+
+	std::int64_t QpcToNanoseconds(UINT64 qpc) const;
+
+private:
+	// Of the track in the export
+	static constexpr const char *TRACK_NAME = "GPU direct queue";
+	// Two per scope
+	static constexpr UINT QUERIES_COUNT = FRAMES_COUNT * MAX_FRAME_SCOPES_COUNT * 2;
+
+	ID3D12CommandQueue *mCommandQueue;
+	WaitableGpuFence &mFence;
+
+	ComPtr<ID3D12QueryHeap> mQueryHeap;
+	// The queries of every frame, resolved at the same offsets
+	ReadbackBuffer mTimestamps;
+	UINT64 mTimestampFrequency;
+	LARGE_INTEGER mQpcFrequency;
+
+	Frame mFrames[FRAMES_COUNT];
+	UINT mCurrentFrameIndex = 0;
+	std::atomic<UINT> mFrameScopesCount{0};
+};
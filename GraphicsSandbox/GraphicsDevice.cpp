@@ -1,5 +1,7 @@
 #include "GraphicsDevice.h"
 
+#include <algorithm>
+
 
 GraphicsDevice::GraphicsDevice() {
 	#if	defined(_DEBUG)
@@ -20,9 +22,9 @@ GraphicsDevice::GraphicsDevice() {
 
 WaitableGpuFence::WaitableGpuFence(GraphicsDevice& device) {
 	D3D_CHECK(device.GetD3dDevice()->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
-	
-	mEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-	WINDOWS_CHECK(mEvent != nullptr);
+
+	// The render thread is the usual waiter, create its event up front
+	ReleaseEvent(AcquireEvent());
 }
 
 
@@ -30,11 +32,15 @@ WaitableGpuFence::~WaitableGpuFence() {
 	// TODO: Returned value is not handled
 	// Can't throw exceptions from destructor
 	// Issue #16
-	CloseHandle(mEvent);
+	for (HANDLE event : mFreeEvents) {
+		CloseHandle(event);
+	}
 }
 
 
 WaitableGpuFence::Label WaitableGpuFence::PutLabel(ID3D12CommandQueue *commandQueue) {
+	std::lock_guard<std::mutex> lock(mPutLabelMutex);
+
 	UINT64 labelValue = mNextValue++;
 	D3D_CHECK(commandQueue->Signal(mFence.Get(), labelValue));
 
@@ -49,7 +55,28 @@ WaitableGpuFence::Label WaitableGpuFence::PutLabel(ID3D12CommandQueue *commandQu
 }
 
 
+bool WaitableGpuFence::IsComplete(const Label &label) {
+	return mFence->GetCompletedValue() >= ValueOf(label);
+}
+
+
 void WaitableGpuFence::WaitForLabel(const Label &label) {
+	WaitForValue(ValueOf(label));
+}
+
+
+void WaitableGpuFence::WaitForLabels(const Label *labels, std::size_t labelsCount) {
+	// Values of one queue complete in order, so waiting for the latest one is enough
+	UINT64 maxValue = 0;
+	for (std::size_t i = 0; i < labelsCount; i++) {
+		maxValue = std::max(maxValue, ValueOf(labels[i]));
+	}
+
+	WaitForValue(maxValue);
+}
+
+
+UINT64 WaitableGpuFence::ValueOf(const Label &label) {
 	#if defined(_DEBUG)
 		if (label.mOwner != this) {
 			// TODO: need ASSERT statement
@@ -57,8 +84,48 @@ void WaitableGpuFence::WaitForLabel(const Label &label) {
 		}
 	#endif
 
-	if (mFence->GetCompletedValue() < label.mLabelValue) {
-		D3D_CHECK(mFence->SetEventOnCompletion(label.mLabelValue, mEvent));
-		WINDOWS_CHECK(WaitForSingleObject(mEvent, INFINITE) != WAIT_FAILED);
+	return label.mLabelValue;
+}
+
+
+void WaitableGpuFence::WaitForValue(UINT64 value) {
+	if (mFence->GetCompletedValue() >= value) {
+		return;
 	}
+
+	HANDLE event = AcquireEvent();
+
+	HRESULT hr = mFence->SetEventOnCompletion(value, event);
+	DWORD waitResult = SUCCEEDED(hr) ? WaitForSingleObject(event, INFINITE) : WAIT_FAILED;
+	DWORD lastError = GetLastError();
+
+	ReleaseEvent(event);
+
+	D3D_CHECK(hr);
+	if (waitResult == WAIT_FAILED) {
+		throw WindowsException(HRESULT_FROM_WIN32(lastError), __FILE__, __LINE__);
+	}
+}
+
+
+HANDLE WaitableGpuFence::AcquireEvent() {
+	{
+		std::lock_guard<std::mutex> lock(mEventsMutex);
+		if (!mFreeEvents.empty()) {
+			HANDLE event = mFreeEvents.back();
+			mFreeEvents.pop_back();
+			return event;
+		}
+	}
+
+	HANDLE event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	WINDOWS_CHECK(event != nullptr);
+
+	return event;
+}
+
+
+void WaitableGpuFence::ReleaseEvent(HANDLE event) {
+	std::lock_guard<std::mutex> lock(mEventsMutex);
+	mFreeEvents.push_back(event);
 }
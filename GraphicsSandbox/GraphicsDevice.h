@@ -3,6 +3,10 @@
 
 #include "D3dCommon.h"
 
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
 
 class GraphicsDevice {
 public:
@@ -20,7 +24,12 @@ private:
 };
 
 
-// This class is not thread-safe
+// Timeline of labels put on command queues through a single ID3D12Fence.
+// Labels are put in increasing order, so completion of a label means that
+// every label put before it is complete too.
+//
+// All methods are thread-safe. Every waiting thread gets its own event, so
+// any number of threads can wait at the same time.
 class WaitableGpuFence {
 	friend GraphicsDevice;
 
@@ -28,6 +37,11 @@ public:
 	class Label {
 		friend WaitableGpuFence;
 
+	public:
+		bool operator < (const Label &other) const {
+			return mLabelValue < other.mLabelValue;
+		}
+
 	private:
 		UINT64 mLabelValue;
 
@@ -44,10 +58,34 @@ public:
 	WaitableGpuFence& operator = (const WaitableGpuFence&) = delete;
 
 	Label PutLabel(ID3D12CommandQueue *commandQueue);
+
+	// Doesn't block
+	bool IsComplete(const Label &label);
+
 	void WaitForLabel(const Label &label);
 
+	// Returns when all of the labels are complete. Only the latest label is
+	// waited for, which assumes that the labels complete in the order they were
+	// put, i.e. that they are on one queue. PutLabel accepts any queue, and a
+	// queue that runs ahead may signal a later value before an earlier label of
+	// another queue is done
+	void WaitForLabels(const Label *labels, std::size_t labelsCount);
+
+private:
+	UINT64 ValueOf(const Label &label);
+	void WaitForValue(UINT64 value);
+
+	HANDLE AcquireEvent();
+	void ReleaseEvent(HANDLE event);
+
 private:
 	ComPtr<ID3D12Fence> mFence;
-	UINT64 mNextValue = 0;
-	HANDLE mEvent;
+
+	// Guards both the counter and the Signal call, so values are signaled in order
+	std::mutex mPutLabelMutex;
+	// The fence is created with the value 0, so the first label must be greater
+	UINT64 mNextValue = 1;
+
+	std::mutex mEventsMutex;
+	std::vector<HANDLE> mFreeEvents;
 };
@@ -0,0 +1,27 @@
+#pragma once
+
+
+#include <cstdint>
+
+
+// Types shared by the backends, so the code above them builds without D3D12
+
+
+// The same as D3D12_VIEWPORT
+struct Viewport {
+	float topLeftX;
+	float topLeftY;
+	float width;
+	float height;
+	float minDepth;
+	float maxDepth;
+};
+
+
+// The same as D3D12_RECT, right and bottom are exclusive
+struct Rect {
+	std::int32_t left;
+	std::int32_t top;
+	std::int32_t right;
+	std::int32_t bottom;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+// 64-bit MurmurHash64A. Not cryptographic, only meant for hash tables and caches
+inline std::uint64_t HashBytes(const void *data, std::size_t size, std::uint64_t seed = 0) {
+	const std::uint64_t m = 0xC6A4A7935BD1E995ull;
+	const int r = 47;
+
+	std::uint64_t h = seed ^ (size * m);
+
+	const unsigned char *bytes = static_cast<const unsigned char*>(data);
+	const unsigned char *end = bytes + (size & ~std::size_t(7));
+
+	for (; bytes != end; bytes += 8) {
+		std::uint64_t k;
+		std::memcpy(&k, bytes, sizeof(k));
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+
+	// The last bytes in little-endian order, the same as the switch of the
+	// reference, so the hashes of persisted caches don't change
+	const std::size_t tailSize = size & 7;
+	for (std::size_t i = 0; i < tailSize; i++) {
+		h ^= std::uint64_t(bytes[i]) << (8 * i);
+	}
+	if (tailSize != 0) {
+		h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+
+	return h;
+}
+
+
+// Mixes a value into a running hash
+inline std::uint64_t HashCombine(std::uint64_t hash, std::uint64_t value) {
+	return HashBytes(&value, sizeof(value), hash);
+}
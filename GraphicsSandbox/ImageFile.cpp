@@ -0,0 +1,356 @@
+#include "ImageFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace {
+	constexpr std::size_t BYTES_PER_PIXEL = 4;
+
+	constexpr std::size_t QOI_HEADER_SIZE = 14;
+	constexpr std::uint8_t QOI_END_MARKER[] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+	constexpr std::uint8_t QOI_OP_INDEX = 0x00;
+	constexpr std::uint8_t QOI_OP_DIFF = 0x40;
+	constexpr std::uint8_t QOI_OP_LUMA = 0x80;
+	constexpr std::uint8_t QOI_OP_RUN = 0xC0;
+	constexpr std::uint8_t QOI_OP_RGB = 0xFE;
+	constexpr std::uint8_t QOI_OP_RGBA = 0xFF;
+	constexpr std::uint32_t QOI_MAX_RUN = 62;
+
+	constexpr std::uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	// Length, type and CRC
+	constexpr std::size_t PNG_CHUNK_OVERHEAD = 12;
+	constexpr std::size_t PNG_IHDR_SIZE = 13;
+	constexpr std::size_t DEFLATE_STORED_BLOCK_MAX_SIZE = 65535;
+	constexpr std::size_t DEFLATE_STORED_BLOCK_HEADER_SIZE = 5;
+	// Bytes summed before the sums of Adler-32 may overflow 32 bits
+	constexpr std::size_t ADLER32_MAX_RUN = 5552;
+	constexpr std::uint32_t ADLER32_MODULUS = 65521;
+
+
+	std::uint8_t* PutBigEndian32(std::uint8_t *output, std::uint32_t value) {
+		output[0] = static_cast<std::uint8_t>(value >> 24);
+		output[1] = static_cast<std::uint8_t>(value >> 16);
+		output[2] = static_cast<std::uint8_t>(value >> 8);
+		output[3] = static_cast<std::uint8_t>(value);
+
+		return output + 4;
+	}
+
+
+	std::uint8_t* PutBytes(std::uint8_t *output, const void *bytes, std::size_t size) {
+		std::memcpy(output, bytes, size);
+		return output + size;
+	}
+
+
+	std::size_t TightRowSize(const ImageView &image) {
+		return static_cast<std::size_t>(image.width) * BYTES_PER_PIXEL;
+	}
+
+
+	std::size_t EncodeRaw(const ImageView &image, std::vector<std::uint8_t> &buffer) {
+		const std::size_t rowSize = TightRowSize(image);
+		const std::size_t size = rowSize * image.height;
+		if (buffer.size() < size) {
+			buffer.resize(size);
+		}
+
+		if (image.rowPitch == rowSize) {
+			std::memcpy(buffer.data(), image.pixels, size);
+		} else {
+			for (std::uint32_t y = 0; y < image.height; y++) {
+				std::memcpy(buffer.data() + y * rowSize, image.pixels + y * image.rowPitch, rowSize);
+			}
+		}
+
+		return size;
+	}
+
+
+	std::size_t EncodeQoi(const ImageView &image, std::vector<std::uint8_t> &buffer) {
+		// Every pixel as QOI_OP_RGBA
+		const std::size_t pixelsCount = static_cast<std::size_t>(image.width) * image.height;
+		const std::size_t maxSize = QOI_HEADER_SIZE + pixelsCount * (BYTES_PER_PIXEL + 1) + sizeof(QOI_END_MARKER);
+		if (buffer.size() < maxSize) {
+			buffer.resize(maxSize);
+		}
+
+		std::uint8_t *output = buffer.data();
+		output = PutBytes(output, "qoif", 4);
+		output = PutBigEndian32(output, image.width);
+		output = PutBigEndian32(output, image.height);
+		*output++ = 4;
+		// sRGB with linear alpha
+		*output++ = 0;
+
+		// Pixels are compared as 32-bit words, which doesn't depend on the byte order
+		std::array<std::uint32_t, 64> index = {};
+		std::uint8_t previous[4] = { 0, 0, 0, 255 };
+		std::uint32_t previousWord;
+		std::memcpy(&previousWord, previous, 4);
+		std::uint32_t run = 0;
+
+		for (std::uint32_t y = 0; y < image.height; y++) {
+			const std::uint8_t *pixel = image.pixels + y * image.rowPitch;
+			const std::uint8_t *rowEnd = pixel + TightRowSize(image);
+
+			for (; pixel != rowEnd; pixel += BYTES_PER_PIXEL) {
+				std::uint32_t word;
+				std::memcpy(&word, pixel, 4);
+
+				if (word == previousWord) {
+					if (++run == QOI_MAX_RUN) {
+						*output++ = static_cast<std::uint8_t>(QOI_OP_RUN | (run - 1));
+						run = 0;
+					}
+					continue;
+				}
+
+				if (run > 0) {
+					*output++ = static_cast<std::uint8_t>(QOI_OP_RUN | (run - 1));
+					run = 0;
+				}
+
+				const std::uint8_t r = pixel[0];
+				const std::uint8_t g = pixel[1];
+				const std::uint8_t b = pixel[2];
+				const std::uint8_t a = pixel[3];
+				const std::uint32_t hash = (r * 3u + g * 5u + b * 7u + a * 11u) % 64;
+
+				if (index[hash] == word) {
+					*output++ = static_cast<std::uint8_t>(QOI_OP_INDEX | hash);
+				} else if (a == previous[3]) {
+					index[hash] = word;
+
+					// Differences wrap around like the channels do
+					const int dr = static_cast<std::int8_t>(r - previous[0]);
+					const int dg = static_cast<std::int8_t>(g - previous[1]);
+					const int db = static_cast<std::int8_t>(b - previous[2]);
+					const int drg = dr - dg;
+					const int dbg = db - dg;
+
+					if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+						*output++ = static_cast<std::uint8_t>(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+					} else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 && dbg >= -8 && dbg <= 7) {
+						*output++ = static_cast<std::uint8_t>(QOI_OP_LUMA | (dg + 32));
+						*output++ = static_cast<std::uint8_t>((drg + 8) << 4 | (dbg + 8));
+					} else {
+						*output++ = QOI_OP_RGB;
+						*output++ = r;
+						*output++ = g;
+						*output++ = b;
+					}
+				} else {
+					index[hash] = word;
+
+					*output++ = QOI_OP_RGBA;
+					output = PutBytes(output, pixel, 4);
+				}
+
+				std::memcpy(previous, pixel, 4);
+				previousWord = word;
+			}
+		}
+
+		if (run > 0) {
+			*output++ = static_cast<std::uint8_t>(QOI_OP_RUN | (run - 1));
+		}
+
+		output = PutBytes(output, QOI_END_MARKER, sizeof(QOI_END_MARKER));
+
+		return static_cast<std::size_t>(output - buffer.data());
+	}
+
+
+	// Slicing-by-4: table k advances the CRC of a byte by k more zero bytes
+	const std::array<std::array<std::uint32_t, 256>, 4>& Crc32Tables() {
+		static const std::array<std::array<std::uint32_t, 256>, 4> tables = [] {
+			std::array<std::array<std::uint32_t, 256>, 4> result;
+			for (std::uint32_t i = 0; i < 256; i++) {
+				std::uint32_t value = i;
+				for (int bit = 0; bit < 8; bit++) {
+					value = (value & 1) != 0 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				}
+				result[0][i] = value;
+			}
+			for (std::uint32_t i = 0; i < 256; i++) {
+				for (std::size_t k = 1; k < 4; k++) {
+					result[k][i] = result[0][result[k - 1][i] & 0xFF] ^ (result[k - 1][i] >> 8);
+				}
+			}
+			return result;
+		}();
+
+		return tables;
+	}
+
+
+	std::uint32_t Crc32(const std::uint8_t *bytes, std::size_t size) {
+		const std::array<std::array<std::uint32_t, 256>, 4> &tables = Crc32Tables();
+
+		std::uint32_t crc = 0xFFFFFFFFu;
+		for (; size >= 4; bytes += 4, size -= 4) {
+			crc ^= std::uint32_t(bytes[0]) | std::uint32_t(bytes[1]) << 8 | std::uint32_t(bytes[2]) << 16 | std::uint32_t(bytes[3]) << 24;
+			crc = tables[3][crc & 0xFF] ^ tables[2][(crc >> 8) & 0xFF] ^ tables[1][(crc >> 16) & 0xFF] ^ tables[0][crc >> 24];
+		}
+		for (; size > 0; bytes++, size--) {
+			crc = tables[0][(crc ^ *bytes) & 0xFF] ^ (crc >> 8);
+		}
+
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+
+	std::uint32_t UpdateAdler32(std::uint32_t adler, const std::uint8_t *bytes, std::size_t size) {
+		std::uint32_t a = adler & 0xFFFF;
+		std::uint32_t b = adler >> 16;
+
+		while (size > 0) {
+			const std::size_t runSize = std::min(size, ADLER32_MAX_RUN);
+			for (std::size_t i = 0; i < runSize; i++) {
+				a += bytes[i];
+				b += a;
+			}
+
+			a %= ADLER32_MODULUS;
+			b %= ADLER32_MODULUS;
+			bytes += runSize;
+			size -= runSize;
+		}
+
+		return b << 16 | a;
+	}
+
+
+	// Finishes the chunk whose data ends at output, its length is written first
+	std::uint8_t* EndPngChunk(std::uint8_t *chunk, std::uint8_t *output) {
+		const std::size_t dataSize = static_cast<std::size_t>(output - chunk) - 8;
+		PutBigEndian32(chunk, static_cast<std::uint32_t>(dataSize));
+
+		// The CRC covers the type and the data
+		return PutBigEndian32(output, Crc32(chunk + 4, dataSize + 4));
+	}
+
+
+	std::size_t EncodePng(const ImageView &image, std::vector<std::uint8_t> &buffer) {
+		// Every row starts with its filter type
+		const std::size_t rowSize = TightRowSize(image);
+		const std::size_t scanlinesSize = (rowSize + 1) * image.height;
+		const std::size_t blocksCount = std::max<std::size_t>(
+			(scanlinesSize + DEFLATE_STORED_BLOCK_MAX_SIZE - 1) / DEFLATE_STORED_BLOCK_MAX_SIZE, 1
+		);
+		// The zlib stream has a header of 2 bytes and ends with the Adler-32 of the scanlines
+		const std::size_t zlibSize = 2 + scanlinesSize + blocksCount * DEFLATE_STORED_BLOCK_HEADER_SIZE + 4;
+
+		if (zlibSize > 0x7FFFFFFFu) {
+			throw std::invalid_argument("The image is too large for one PNG chunk");
+		}
+
+		const std::size_t maxSize = sizeof(PNG_SIGNATURE) + PNG_CHUNK_OVERHEAD * 3 + PNG_IHDR_SIZE + zlibSize;
+		if (buffer.size() < maxSize) {
+			buffer.resize(maxSize);
+		}
+
+		std::uint8_t *output = PutBytes(buffer.data(), PNG_SIGNATURE, sizeof(PNG_SIGNATURE));
+
+		std::uint8_t *chunk = output;
+		output = PutBytes(output + 4, "IHDR", 4);
+		output = PutBigEndian32(output, image.width);
+		output = PutBigEndian32(output, image.height);
+		// 8 bits per channel, RGBA, deflate, adaptive filtering, no interlacing
+		const std::uint8_t header[] = { 8, 6, 0, 0, 0 };
+		output = PutBytes(output, header, sizeof(header));
+		output = EndPngChunk(chunk, output);
+
+		chunk = output;
+		output = PutBytes(output + 4, "IDAT", 4);
+		// Deflate with a 32 KB window and no preset dictionary, the check bits make it a multiple of 31
+		*output++ = 0x78;
+		*output++ = 0x01;
+
+		std::uint32_t adler = 1;
+
+		std::size_t blockRemaining = 0;
+		std::size_t scanlinesRemaining = scanlinesSize;
+
+		// Scanlines are streamed into the blocks, a block may end in the middle of a row
+		auto putScanlineBytes = [&](const std::uint8_t *bytes, std::size_t size) {
+			while (size > 0) {
+				if (blockRemaining == 0) {
+					blockRemaining = std::min(scanlinesRemaining, DEFLATE_STORED_BLOCK_MAX_SIZE);
+					scanlinesRemaining -= blockRemaining;
+
+					const std::uint16_t length = static_cast<std::uint16_t>(blockRemaining);
+					const std::uint16_t inverseLength = static_cast<std::uint16_t>(~length);
+					*output++ = scanlinesRemaining == 0 ? 1 : 0;
+					*output++ = static_cast<std::uint8_t>(length);
+					*output++ = static_cast<std::uint8_t>(length >> 8);
+					*output++ = static_cast<std::uint8_t>(inverseLength);
+					*output++ = static_cast<std::uint8_t>(inverseLength >> 8);
+				}
+
+				const std::size_t copySize = std::min(size, blockRemaining);
+				std::memcpy(output, bytes, copySize);
+
+				adler = UpdateAdler32(adler, bytes, copySize);
+
+				output += copySize;
+				bytes += copySize;
+				size -= copySize;
+				blockRemaining -= copySize;
+			}
+		};
+
+		const std::uint8_t noFilter = 0;
+		for (std::uint32_t y = 0; y < image.height; y++) {
+			putScanlineBytes(&noFilter, 1);
+			putScanlineBytes(image.pixels + y * image.rowPitch, rowSize);
+		}
+
+		if (scanlinesSize == 0) {
+			// An empty final block
+			const std::uint8_t emptyBlock[] = { 1, 0, 0, 0xFF, 0xFF };
+			output = PutBytes(output, emptyBlock, sizeof(emptyBlock));
+		}
+
+		output = PutBigEndian32(output, adler);
+		output = EndPngChunk(chunk, output);
+
+		chunk = output;
+		output = PutBytes(output + 4, "IEND", 4);
+		output = EndPngChunk(chunk, output);
+
+		return static_cast<std::size_t>(output - buffer.data());
+	}
+}
+
+
+const char* ImageFileExtension(ImageFileFormat format) {
+	switch (format) {
+	case ImageFileFormat::RAW:
+		return ".rgba";
+	case ImageFileFormat::QOI:
+		return ".qoi";
+	case ImageFileFormat::PNG:
+		return ".png";
+	}
+
+	throw std::invalid_argument("Unknown image file format");
+}
+
+
+std::size_t EncodeImage(ImageFileFormat format, const ImageView &image, std::vector<std::uint8_t> &buffer) {
+	switch (format) {
+	case ImageFileFormat::RAW:
+		return EncodeRaw(image, buffer);
+	case ImageFileFormat::QOI:
+		return EncodeQoi(image, buffer);
+	case ImageFileFormat::PNG:
+		return EncodePng(image, buffer);
+	}
+
+	throw std::invalid_argument("Unknown image file format");
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+enum class ImageFileFormat {
+	// Rows of R8G8B8A8 pixels without padding or a header
+	RAW,
+	// The Quite OK Image format, lossless and about as fast to encode as a copy
+	QOI,
+	// Uncompressed deflate blocks, bigger than QOI but readable by every tool
+	PNG
+};
+
+
+// R8G8B8A8 pixels with red in the lowest byte, the layout of back buffers
+// and of SoftwareRenderTarget
+struct ImageView {
+	const std::uint8_t *pixels;
+	std::uint32_t width;
+	std::uint32_t height;
+	// In bytes, at least width * 4
+	std::size_t rowPitch;
+};
+
+
+// E.g. ".qoi"
+const char* ImageFileExtension(ImageFileFormat format);
+
+
+// Encodes the image at the beginning of the buffer and returns the size of the
+// file. The buffer only grows, so encoding into the same one stops allocating
+std::size_t EncodeImage(ImageFileFormat format, const ImageView &image, std::vector<std::uint8_t> &buffer);
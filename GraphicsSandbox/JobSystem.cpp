@@ -0,0 +1,230 @@
+#include "JobSystem.h"
+
+#include <stdexcept>
+
+
+namespace {
+	thread_local JobSystem *tCurrentSystem = nullptr;
+	thread_local void *tCurrentThreadState = nullptr;
+
+	// Before sleeping a worker retries this many times
+	constexpr int IDLE_SPINS_COUNT = 64;
+}
+
+
+JobSystem::ThreadState::ThreadState()
+: deque(JOBS_PER_THREAD), jobs(new Job[JOBS_PER_THREAD]) {
+	static std::atomic<std::uint32_t> seed{0x9E3779B9u};
+	randomState = seed.fetch_add(0x6D2B79F5u, std::memory_order_relaxed) | 1;
+}
+
+
+JobSystem::JobSystem(std::size_t workerThreadsCount) {
+	mThreads.reserve(workerThreadsCount + 1);
+	for (std::size_t i = 0; i < workerThreadsCount + 1; i++) {
+		mThreads.push_back(std::make_unique<ThreadState>());
+	}
+
+	tCurrentSystem = this;
+	tCurrentThreadState = mThreads[0].get();
+
+	mWorkers.reserve(workerThreadsCount);
+	for (std::size_t i = 1; i < workerThreadsCount + 1; i++) {
+		mWorkers.emplace_back([this, i] { RunWorker(i); });
+	}
+}
+
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mIsStopping.store(true, std::memory_order_release);
+	}
+
+	mWakeUp.notify_all();
+	for (std::thread &worker : mWorkers) {
+		worker.join();
+	}
+
+	if (tCurrentSystem == this) {
+		tCurrentSystem = nullptr;
+		tCurrentThreadState = nullptr;
+	}
+}
+
+
+void JobSystem::RunBackground(std::function<void()> function, JobCounter &counter) {
+	if (mWorkers.empty()) {
+		function();
+		return;
+	}
+
+	counter.mUnfinishedCount.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock(mBackgroundJobsMutex);
+		mBackgroundJobs.push_back(BackgroundJob{ std::move(function), &counter });
+	}
+
+	WakeUpWorker();
+}
+
+
+void JobSystem::Wait(JobCounter &counter) {
+	ThreadState &thread = CurrentThread();
+
+	while (!counter.IsDone()) {
+		if (Job *job = FindJob(thread)) {
+			Execute(*job);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+
+JobSystem::ThreadState& JobSystem::CurrentThread() {
+	if (tCurrentSystem != this) {
+		throw std::logic_error("Jobs can be started only by the threads of the job system");
+	}
+
+	return *static_cast<ThreadState*>(tCurrentThreadState);
+}
+
+
+JobSystem::Job& JobSystem::AllocateJob() {
+	ThreadState &thread = CurrentThread();
+
+	Job &job = thread.jobs[thread.nextJobIndex];
+	thread.nextJobIndex = (thread.nextJobIndex + 1) % JOBS_PER_THREAD;
+
+	// The slot wrapped around while its job is still queued, help to finish it
+	while (job.isPending.load(std::memory_order_acquire)) {
+		if (Job *otherJob = FindJob(thread)) {
+			Execute(*otherJob);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	job.isPending.store(true, std::memory_order_relaxed);
+	return job;
+}
+
+
+void JobSystem::Submit(Job &job) {
+	if (!CurrentThread().deque.Push(&job)) {
+		Execute(job);
+		return;
+	}
+
+	WakeUpWorker();
+}
+
+
+void JobSystem::WakeUpWorker() {
+	mQueuedJobsCount.fetch_add(1, std::memory_order_seq_cst);
+	if (mSleepingWorkersCount.load(std::memory_order_seq_cst) > 0) {
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mWakeUp.notify_one();
+	}
+}
+
+
+void JobSystem::Execute(Job &job) {
+	// The slot can be reused as soon as the job starts
+	JobCounter *counter = job.counter;
+	job.invoke(job);
+
+	counter->mUnfinishedCount.fetch_sub(1, std::memory_order_release);
+}
+
+
+JobSystem::Job* JobSystem::FindJob(ThreadState &thread) {
+	Job *job = thread.deque.Pop();
+
+	if (job == nullptr && mThreads.size() > 1) {
+		// xorshift32
+		thread.randomState ^= thread.randomState << 13;
+		thread.randomState ^= thread.randomState >> 17;
+		thread.randomState ^= thread.randomState << 5;
+
+		const std::size_t threadsCount = mThreads.size();
+		const std::size_t firstVictim = thread.randomState % threadsCount;
+
+		for (std::size_t i = 0; i < threadsCount && job == nullptr; i++) {
+			ThreadState &victim = *mThreads[(firstVictim + i) % threadsCount];
+			if (&victim != &thread) {
+				job = victim.deque.Steal();
+			}
+		}
+	}
+
+	if (job != nullptr) {
+		mQueuedJobsCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+
+bool JobSystem::RunBackgroundJob() {
+	BackgroundJob job;
+
+	{
+		std::lock_guard<std::mutex> lock(mBackgroundJobsMutex);
+		if (mBackgroundJobs.empty()) {
+			return false;
+		}
+
+		job = std::move(mBackgroundJobs.front());
+		mBackgroundJobs.pop_front();
+	}
+
+	mQueuedJobsCount.fetch_sub(1, std::memory_order_relaxed);
+
+	job.function();
+	job.counter->mUnfinishedCount.fetch_sub(1, std::memory_order_release);
+
+	return true;
+}
+
+
+void JobSystem::RunWorker(std::size_t threadIndex) {
+	tCurrentSystem = this;
+	tCurrentThreadState = mThreads[threadIndex].get();
+
+	ThreadState &thread = *mThreads[threadIndex];
+	int idleSpins = 0;
+
+	while (!mIsStopping.load(std::memory_order_acquire)) {
+		if (Job *job = FindJob(thread)) {
+			Execute(*job);
+			idleSpins = 0;
+			continue;
+		}
+
+		// Regular jobs go first, the frame may be waiting for them
+		if (RunBackgroundJob()) {
+			idleSpins = 0;
+			continue;
+		}
+
+		if (++idleSpins < IDLE_SPINS_COUNT) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Submitters increment the queued count before checking for sleepers,
+		// so either they see this worker or it sees their job
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mSleepingWorkersCount.fetch_add(1, std::memory_order_seq_cst);
+		mWakeUp.wait(lock, [this] {
+			return mIsStopping.load(std::memory_order_acquire)
+				|| mQueuedJobsCount.load(std::memory_order_seq_cst) > 0;
+		});
+		mSleepingWorkersCount.fetch_sub(1, std::memory_order_relaxed);
+
+		idleSpins = 0;
+	}
+}
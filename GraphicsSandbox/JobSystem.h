@@ -0,0 +1,187 @@
+#pragma once
+
+
+#include "WorkStealingDeque.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// Number of jobs started through it that haven't finished yet
+class JobCounter {
+	friend class JobSystem;
+
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+
+	JobCounter& operator = (const JobCounter&) = delete;
+
+	bool IsDone() const {
+		return mUnfinishedCount.load(std::memory_order_acquire) == 0;
+	}
+
+private:
+	std::atomic<std::uint32_t> mUnfinishedCount{0};
+};
+
+
+// Fixed pool of worker threads that run small jobs.
+//
+// Every thread of the system (the workers and the thread that created it) has
+// its own lock-free deque. New jobs go to the deque of the thread that runs them,
+// idle threads steal from the others. Waiting on a counter runs other jobs
+// instead of blocking, so jobs may start and wait for nested jobs.
+//
+// Long jobs, e.g. compilation, run in the background: only idle workers take
+// them between regular jobs, so they never delay waiting threads.
+//
+// Jobs must not throw. Only the threads of the system may start jobs and wait.
+// A thread can have up to JOBS_PER_THREAD unfinished jobs it started.
+class JobSystem {
+public:
+	static constexpr std::size_t JOBS_PER_THREAD = 4096;
+	static constexpr std::size_t JOB_STORAGE_SIZE = 48;
+
+public:
+	// The calling thread becomes one of the threads of the system
+	explicit JobSystem(std::size_t workerThreadsCount);
+	JobSystem(const JobSystem&) = delete;
+	~JobSystem();
+
+	JobSystem& operator = (const JobSystem&) = delete;
+
+	// Captures of the function must fit into JOB_STORAGE_SIZE bytes
+	template <typename Function>
+	void Run(Function &&function, JobCounter &counter);
+
+	// Any thread may start a background job. Without workers it runs right away
+	void RunBackground(std::function<void()> function, JobCounter &counter);
+
+	// Runs other jobs until the counter is done
+	void Wait(JobCounter &counter);
+
+	// Calls function(index) for every index in [0, count) and waits for all of them
+	template <typename Function>
+	void ParallelFor(std::size_t count, Function &&function);
+
+	// Workers and the creating thread
+	std::size_t ThreadsCount() const {
+		return mThreads.size();
+	}
+
+private:
+	struct Job {
+		void (*invoke)(Job &job);
+		JobCounter *counter;
+		std::atomic<bool> isPending{false};
+		alignas(std::max_align_t) unsigned char storage[JOB_STORAGE_SIZE];
+	};
+
+	struct BackgroundJob {
+		std::function<void()> function;
+		JobCounter *counter;
+	};
+
+	struct ThreadState {
+		ThreadState();
+
+		WorkStealingDeque<Job> deque;
+		std::unique_ptr<Job[]> jobs;
+		std::size_t nextJobIndex = 0;
+		std::uint32_t randomState;
+	};
+
+private:
+	ThreadState& CurrentThread();
+	Job& AllocateJob();
+	void Submit(Job &job);
+	void Execute(Job &job);
+	Job* FindJob(ThreadState &thread);
+	bool RunBackgroundJob();
+	void WakeUpWorker();
+
+	void RunWorker(std::size_t threadIndex);
+
+private:
+	std::vector<std::unique_ptr<ThreadState>> mThreads;
+	std::vector<std::thread> mWorkers;
+
+	std::mutex mBackgroundJobsMutex;
+	std::deque<BackgroundJob> mBackgroundJobs;
+
+	// Jobs that were pushed but not taken yet, background ones included, lets idle workers sleep
+	std::atomic<std::int64_t> mQueuedJobsCount{0};
+	std::atomic<std::uint32_t> mSleepingWorkersCount{0};
+	std::atomic<bool> mIsStopping{false};
+
+	std::mutex mSleepMutex;
+	std::condition_variable mWakeUp;
+};
+
+
+template <typename Function>
+void JobSystem::Run(Function &&function, JobCounter &counter) {
+	using FunctionType = typename std::decay<Function>::type;
+	static_assert(sizeof(FunctionType) <= JOB_STORAGE_SIZE, "Job captures are too big, capture a pointer instead");
+	static_assert(alignof(FunctionType) <= alignof(std::max_align_t), "Job captures are over-aligned");
+
+	Job &job = AllocateJob();
+	new (job.storage) FunctionType(std::forward<Function>(function));
+	job.invoke = [](Job &job) {
+		// Frees the slot before running, so nested jobs never wait for their parent
+		FunctionType &storedFunction = *reinterpret_cast<FunctionType*>(job.storage);
+		FunctionType function(std::move(storedFunction));
+		storedFunction.~FunctionType();
+		job.isPending.store(false, std::memory_order_release);
+
+		function();
+	};
+	job.counter = &counter;
+
+	counter.mUnfinishedCount.fetch_add(1, std::memory_order_relaxed);
+	Submit(job);
+}
+
+
+template <typename Function>
+void JobSystem::ParallelFor(std::size_t count, Function &&function) {
+	if (count == 0) {
+		return;
+	}
+
+	// A few batches per thread to even out uneven iterations
+	const std::size_t batchesCount = std::min(count, ThreadsCount() * 4);
+	const std::size_t batchSize = (count + batchesCount - 1) / batchesCount;
+
+	JobCounter counter;
+	auto *functionPointer = &function;
+
+	for (std::size_t begin = batchSize; begin < count; begin += batchSize) {
+		const std::size_t end = std::min(begin + batchSize, count);
+		Run([functionPointer, begin, end] {
+			for (std::size_t i = begin; i < end; i++) {
+				(*functionPointer)(i);
+			}
+		}, counter);
+	}
+
+	// The first batch is run by the calling thread
+	for (std::size_t i = 0; i < batchSize; i++) {
+		function(i);
+	}
+
+	Wait(counter);
+}
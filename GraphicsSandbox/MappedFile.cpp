@@ -0,0 +1,119 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+	#include "WindowsCommon.h"
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const std::string &path) {
+	Close();
+
+	HANDLE file = CreateFileA(
+		path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+	);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		throw std::runtime_error("Can't get the size of " + path);
+	}
+
+	if (size.QuadPart > 0) {
+		// The view keeps the file mapped after both handles are closed
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr) {
+			throw std::runtime_error("Can't map " + path);
+		}
+
+		void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (view == nullptr) {
+			throw std::runtime_error("Can't map " + path);
+		}
+
+		mData = static_cast<const std::uint8_t*>(view);
+		mSize = static_cast<std::size_t>(size.QuadPart);
+	} else {
+		CloseHandle(file);
+	}
+
+	mIsOpen = true;
+	return true;
+}
+
+
+void MappedFile::Close() {
+	if (mData != nullptr) {
+		UnmapViewOfFile(mData);
+	}
+
+	mData = nullptr;
+	mSize = 0;
+	mIsOpen = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::string &path) {
+	Close();
+
+	const int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(file, &status) != 0) {
+		close(file);
+		throw std::runtime_error("Can't get the size of " + path);
+	}
+
+	if (status.st_size > 0) {
+		// The mapping stays valid after the descriptor is closed
+		void *view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+		close(file);
+		if (view == MAP_FAILED) {
+			throw std::runtime_error("Can't map " + path);
+		}
+
+		mData = static_cast<const std::uint8_t*>(view);
+		mSize = static_cast<std::size_t>(status.st_size);
+	} else {
+		close(file);
+	}
+
+	mIsOpen = true;
+	return true;
+}
+
+
+void MappedFile::Close() {
+	if (mData != nullptr) {
+		munmap(const_cast<std::uint8_t*>(mData), mSize);
+	}
+
+	mData = nullptr;
+	mSize = 0;
+	mIsOpen = false;
+}
+
+#endif
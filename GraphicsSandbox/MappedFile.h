@@ -0,0 +1,44 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// Read-only mapping of a whole file.
+//
+// The mapping is a snapshot: data written to the file later may not be visible
+// through it until the file is opened again.
+//
+// This class is not thread-safe, but any number of threads may read the mapped data
+class MappedFile {
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	~MappedFile();
+
+	MappedFile& operator = (const MappedFile&) = delete;
+
+	// Returns false if the file doesn't exist. An empty file is open with no data
+	bool Open(const std::string &path);
+
+	void Close();
+
+	bool IsOpen() const {
+		return mIsOpen;
+	}
+
+	const std::uint8_t* Data() const {
+		return mData;
+	}
+
+	std::size_t Size() const {
+		return mSize;
+	}
+
+private:
+	const std::uint8_t *mData = nullptr;
+	std::size_t mSize = 0;
+	bool mIsOpen = false;
+};
@@ -0,0 +1,39 @@
+#include "NullFrameBackend.h"
+
+
+NullFrameBackend::NullFrameBackend()
+: mRecordingBackend(mResourceStates) {
+	for (std::uint32_t i = 0; i < SWAP_CHAIN_BUFFERS_COUNT; i++) {
+		mResourceStates.Register(&mBackBuffers[i], 1, ResourceState::PRESENT);
+	}
+}
+
+
+void NullFrameBackend::PlaceTransientResources(const CompiledRenderGraph &/*graph*/, RenderGraph::ResourceId /*depthStencilId*/) {
+	// Nothing is aliased, the buffer stays where it is
+	if (!mIsDepthStencilBufferPlaced) {
+		mResourceStates.Register(&mDepthStencilBuffer, 1, ResourceState::DEPTH_WRITE);
+		mIsDepthStencilBufferPlaced = true;
+	}
+}
+
+
+NullFrameBackend::Fence::Label NullFrameBackend::Present() {
+	const Fence::Label label = mFence.PutLabel();
+	mFence.Signal(label);
+
+	return label;
+}
+
+
+void NullFrameBackend::EndFrame(FrameContext &/*frame*/, const Fence::Label &/*label*/) {
+	mRecordingBackend.TakeSubmittedCommands(mSubmittedCommands);
+
+	const NullRecordingBackend::Statistics statistics = mRecordingBackend.GetStatistics();
+	mLastFrameStatistics.commandListsCount = statistics.commandListsCount - mSubmittedStatistics.commandListsCount;
+	mLastFrameStatistics.commandsCount = statistics.commandsCount - mSubmittedStatistics.commandsCount;
+	mLastFrameStatistics.barriersCount = statistics.barriersCount - mSubmittedStatistics.barriersCount;
+	mSubmittedStatistics = statistics;
+
+	mCurrentBackBufferIndex = (mCurrentBackBufferIndex + 1) % SWAP_CHAIN_BUFFERS_COUNT;
+}
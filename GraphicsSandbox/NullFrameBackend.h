@@ -0,0 +1,119 @@
+#pragma once
+
+
+#include "CpuTimelineFence.h"
+#include "NullRecordingBackend.h"
+#include "RenderGraph.h"
+#include "ResourceStateTracker.h"
+
+#include <cstdint>
+#include <vector>
+
+
+// Backend of FrameRenderer without a device, so the frame loop runs on any
+// platform and its CPU cost can be measured on its own.
+//
+// Commands are recorded and resolved like on a device and then dropped. The
+// device completes every frame as soon as it's presented.
+//
+// BeginRecording and the barrier flushes are thread-safe, they're called by the
+// recording tasks. Other methods are called by one thread
+class NullFrameBackend {
+public:
+	using Fence = CpuTimelineFence;
+	using RecordingBackend = NullRecordingBackend;
+	using CommandList = NullRecordingBackend::CommandList;
+	using RenderTargetView = void*;
+	using DepthStencilView = void*;
+
+	// Nothing is timed without a device
+	struct GpuScope {
+	};
+
+	struct FrameContext {
+	};
+
+	// Counters of the last rendered frame
+	struct FrameStatistics {
+		std::uint64_t commandListsCount = 0;
+		std::uint64_t commandsCount = 0;
+		std::uint64_t barriersCount = 0;
+	};
+
+public:
+	NullFrameBackend();
+	NullFrameBackend(const NullFrameBackend&) = delete;
+
+	NullFrameBackend& operator = (const NullFrameBackend&) = delete;
+
+	Fence& GetFence() {
+		return mFence;
+	}
+
+	RecordingBackend& Recording() {
+		return mRecordingBackend;
+	}
+
+	void* BackBuffer() {
+		return &mBackBuffers[mCurrentBackBufferIndex];
+	}
+
+	RenderTargetView BackBufferView() {
+		return BackBuffer();
+	}
+
+	void PlaceTransientResources(const CompiledRenderGraph &graph, RenderGraph::ResourceId depthStencilId);
+
+	void* DepthStencilBuffer() {
+		return &mDepthStencilBuffer;
+	}
+
+	DepthStencilView DepthStencilBufferView() {
+		return DepthStencilBuffer();
+	}
+
+	void BeginRecording(CommandList &/*commandList*/) {
+	}
+
+	void FlushPassBarriers(CommandList &commandList, std::uint32_t /*pass*/) {
+		commandList.FlushBarriers();
+	}
+
+	void FlushBarriers(CommandList &commandList) {
+		commandList.FlushBarriers();
+	}
+
+	GpuScope BeginGpuScope(CommandList &/*commandList*/, const char */*name*/) {
+		return GpuScope();
+	}
+
+	void EndGpuScope(CommandList &/*commandList*/, const GpuScope &/*scope*/) {
+	}
+
+	Fence::Label Present();
+
+	void EndFrame(FrameContext &frame, const Fence::Label &label);
+
+	FrameStatistics LastFrameStatistics() const {
+		return mLastFrameStatistics;
+	}
+
+private:
+	static constexpr std::uint32_t SWAP_CHAIN_BUFFERS_COUNT = 2;
+
+	CpuTimelineFence mFence;
+	ResourceStateRegistry mResourceStates;
+	NullRecordingBackend mRecordingBackend;
+
+	std::vector<NullCommand> mSubmittedCommands;
+
+	// Stand-ins of the resources, only their addresses are used
+	std::uint8_t mBackBuffers[SWAP_CHAIN_BUFFERS_COUNT];
+	std::uint8_t mDepthStencilBuffer;
+	bool mIsDepthStencilBufferPlaced = false;
+
+	std::uint32_t mCurrentBackBufferIndex = 0;
+
+	NullRecordingBackend::Statistics mSubmittedStatistics;
+	FrameStatistics mLastFrameStatistics;
+};
@@ -0,0 +1,138 @@
+#include "NullRecordingBackend.h"
+
+
+namespace {
+	NullCommand MakeCommand(NullCommand::Type type) {
+		NullCommand command = {};
+		command.type = type;
+		return command;
+	}
+
+
+	NullCommand MakeBarriersCommand(const std::vector<TrackedBarrier> &barriers) {
+		NullCommand command = MakeCommand(NullCommand::Type::BARRIERS);
+		command.barriersCount = static_cast<std::uint32_t>(barriers.size());
+		return command;
+	}
+}
+
+
+void NullRecordingBackend::CommandList::FlushBarriers() {
+	trackedBarriers.clear();
+	states.Flush(trackedBarriers);
+
+	if (!trackedBarriers.empty()) {
+		commands.push_back(MakeBarriersCommand(trackedBarriers));
+	}
+}
+
+
+void NullRecordingBackend::CommandList::SetViewport(const Viewport &viewport) {
+	NullCommand command = MakeCommand(NullCommand::Type::SET_VIEWPORT);
+	command.viewport = viewport;
+	commands.push_back(command);
+}
+
+
+void NullRecordingBackend::CommandList::SetScissorRect(const Rect &rect) {
+	NullCommand command = MakeCommand(NullCommand::Type::SET_SCISSOR_RECT);
+	command.scissorRect = rect;
+	commands.push_back(command);
+}
+
+
+void NullRecordingBackend::CommandList::SetRenderTarget(void *renderTargetView, void *depthStencilView) {
+	NullCommand command = MakeCommand(NullCommand::Type::SET_RENDER_TARGET);
+	command.renderTarget = renderTargetView;
+	command.depthStencil = depthStencilView;
+	commands.push_back(command);
+}
+
+
+void NullRecordingBackend::CommandList::ClearRenderTarget(void *renderTargetView, const float color[4]) {
+	NullCommand command = MakeCommand(NullCommand::Type::CLEAR_RENDER_TARGET);
+	command.renderTarget = renderTargetView;
+	for (int i = 0; i < 4; i++) {
+		command.color[i] = color[i];
+	}
+	commands.push_back(command);
+}
+
+
+void NullRecordingBackend::CommandList::ClearDepthStencil(void *depthStencilView, float depth, std::uint8_t stencil) {
+	NullCommand command = MakeCommand(NullCommand::Type::CLEAR_DEPTH_STENCIL);
+	command.depthStencil = depthStencilView;
+	command.depth = depth;
+	command.stencil = stencil;
+	commands.push_back(command);
+}
+
+
+NullRecordingBackend::NullRecordingBackend(ResourceStateRegistry &stateRegistry)
+: mStateRegistry(stateRegistry) {
+}
+
+
+NullRecordingBackend::CommandList NullRecordingBackend::BeginCommandList() {
+	CommandList result;
+	result.states = ResourceStateTracker(&mStateRegistry);
+
+	std::lock_guard<std::mutex> lock(mFreeCommandsMutex);
+	if (!mFreeCommands.empty()) {
+		result.commands = std::move(mFreeCommands.back());
+		mFreeCommands.pop_back();
+	}
+
+	return result;
+}
+
+
+void NullRecordingBackend::EndCommandList(CommandList &commandList) {
+	commandList.trackedBarriers.clear();
+	commandList.states.Finish(commandList.trackedBarriers);
+
+	if (!commandList.trackedBarriers.empty()) {
+		commandList.commands.push_back(MakeBarriersCommand(commandList.trackedBarriers));
+	}
+}
+
+
+void NullRecordingBackend::ExecuteCommandLists(CommandList *commandLists, std::size_t count) {
+	for (std::size_t i = 0; i < count; i++) {
+		// States are resolved in submission order, so each list sees the ones left by the previous
+		mResolvingBarriers.clear();
+		mStateRegistry.Resolve(commandLists[i].states, mResolvingBarriers);
+		commandLists[i].states.Reset();
+
+		if (!mResolvingBarriers.empty()) {
+			mSubmittedCommands.push_back(MakeBarriersCommand(mResolvingBarriers));
+			// D3dRecordingBackend submits them in a list of their own
+			mStatistics.barriersCount += mResolvingBarriers.size();
+			mStatistics.commandsCount++;
+			mStatistics.commandListsCount++;
+		}
+
+		for (const NullCommand &command : commandLists[i].commands) {
+			if (command.type == NullCommand::Type::BARRIERS) {
+				mStatistics.barriersCount += command.barriersCount;
+			}
+		}
+
+		mSubmittedCommands.insert(mSubmittedCommands.end(), commandLists[i].commands.begin(), commandLists[i].commands.end());
+		mStatistics.commandsCount += commandLists[i].commands.size();
+		mStatistics.commandListsCount++;
+	}
+	mStateRegistry.DecayStates();
+
+	std::lock_guard<std::mutex> lock(mFreeCommandsMutex);
+	for (std::size_t i = 0; i < count; i++) {
+		commandLists[i].commands.clear();
+		mFreeCommands.push_back(std::move(commandLists[i].commands));
+	}
+}
+
+
+void NullRecordingBackend::TakeSubmittedCommands(std::vector<NullCommand> &commands) {
+	commands.clear();
+	std::swap(commands, mSubmittedCommands);
+}
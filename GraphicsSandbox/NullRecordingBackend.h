@@ -0,0 +1,97 @@
+#pragma once
+
+
+#include "GraphicsTypes.h"
+#include "ResourceStateTracker.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+// Command of the backend-neutral interface of FrameRenderer, as recorded by
+// NullRecordingBackend
+struct NullCommand {
+	enum class Type {
+		SET_VIEWPORT,
+		SET_SCISSOR_RECT,
+		SET_RENDER_TARGET,
+		CLEAR_RENDER_TARGET,
+		CLEAR_DEPTH_STENCIL,
+		BARRIERS
+	};
+
+	Type type;
+	// Views are the addresses of the resources
+	void *renderTarget;
+	void *depthStencil;
+	Viewport viewport;
+	Rect scissorRect;
+	float color[4];
+	float depth;
+	std::uint8_t stencil;
+	std::uint32_t barriersCount;
+};
+
+
+// Backend of ParallelCommandRecorder without a device: the lists record their
+// commands into CPU memory, and the submitted ones are kept in submission order
+// until they're taken, e.g. to be replayed or inspected.
+//
+// States are tracked and resolved like in D3dRecordingBackend, the barriers are
+// recorded as BARRIERS commands.
+//
+// BeginCommandList is thread-safe, other methods are called by one thread
+class NullRecordingBackend {
+public:
+	struct CommandList {
+		ResourceStateTracker states;
+		std::vector<TrackedBarrier> trackedBarriers;
+		std::vector<NullCommand> commands;
+
+		void FlushBarriers();
+
+		void SetViewport(const Viewport &viewport);
+		void SetScissorRect(const Rect &rect);
+		void SetRenderTarget(void *renderTargetView, void *depthStencilView);
+		void ClearRenderTarget(void *renderTargetView, const float color[4]);
+		void ClearDepthStencil(void *depthStencilView, float depth, std::uint8_t stencil);
+	};
+
+	struct Statistics {
+		std::uint64_t commandListsCount = 0;
+		std::uint64_t commandsCount = 0;
+		std::uint64_t barriersCount = 0;
+	};
+
+public:
+	explicit NullRecordingBackend(ResourceStateRegistry &stateRegistry);
+	NullRecordingBackend(const NullRecordingBackend&) = delete;
+
+	NullRecordingBackend& operator = (const NullRecordingBackend&) = delete;
+
+	CommandList BeginCommandList();
+	void EndCommandList(CommandList &commandList);
+	void ExecuteCommandLists(CommandList *commandLists, std::size_t count);
+
+	// Swaps the commands submitted since the previous call into the vector, so
+	// passing the same vector every time doesn't allocate
+	void TakeSubmittedCommands(std::vector<NullCommand> &commands);
+
+	// Totals since creation
+	Statistics GetStatistics() const {
+		return mStatistics;
+	}
+
+private:
+	ResourceStateRegistry &mStateRegistry;
+
+	std::mutex mFreeCommandsMutex;
+	std::vector<std::vector<NullCommand>> mFreeCommands;
+
+	std::vector<TrackedBarrier> mResolvingBarriers;
+	std::vector<NullCommand> mSubmittedCommands;
+
+	Statistics mStatistics;
+};
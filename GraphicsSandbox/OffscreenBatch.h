@@ -0,0 +1,52 @@
+#pragma once
+
+
+#include "FrameRenderer.h"
+
+#include <chrono>
+#include <cstdint>
+
+
+// Result of RunOffscreenBatch
+struct OffscreenBatchReport {
+	std::uint64_t framesCount = 0;
+	// From the beginning of the first frame until the file of the last one is written
+	double seconds = 0.0;
+	// Frames that waited for a target because the writer fell behind
+	std::uint64_t readbackStallsCount = 0;
+
+	double FramesPerSecond() const {
+		return seconds > 0.0 ? double(framesCount) / seconds : 0.0;
+	}
+};
+
+
+// Renders a batch of frames with an offscreen backend and waits until all of
+// them are on the disk, so the frame rate covers the whole pipeline.
+//
+// Backend is the one of FrameRenderer, with readbacks:
+//   void WaitForReadbacks()
+//   ReadbackStatistics()                   - ReadbackRing statistics
+//
+// Must be called from a thread of the job system
+template <typename Backend>
+OffscreenBatchReport RunOffscreenBatch(FrameRenderer<Backend> &renderer, Backend &backend, std::uint64_t framesCount) {
+	using Clock = std::chrono::steady_clock;
+
+	const std::uint64_t initialStallsCount = backend.ReadbackStatistics().stallsCount;
+	const Clock::time_point start = Clock::now();
+
+	for (std::uint64_t i = 0; i < framesCount; i++) {
+		renderer.RenderFrame();
+	}
+
+	renderer.WaitForAllFrames();
+	backend.WaitForReadbacks();
+
+	OffscreenBatchReport report;
+	report.framesCount = framesCount;
+	report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	report.readbackStallsCount = backend.ReadbackStatistics().stallsCount - initialStallsCount;
+
+	return report;
+}
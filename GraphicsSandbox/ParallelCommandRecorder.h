@@ -0,0 +1,115 @@
+#pragma once
+
+
+#include "JobSystem.h"
+#include "FrameProfiler.h"
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+// Records the work of a frame on several threads and submits it in one call.
+//
+// The frame is split into recording tasks. Each task is recorded into its own
+// command list by whichever thread of the job system picks it up, and the lists
+// are submitted in the order the tasks were added, so the result doesn't depend
+// on scheduling.
+//
+// Backend provides the command lists:
+//   CommandList                      - default-constructible, movable
+//   CommandList BeginCommandList()   - must be thread-safe
+//   void EndCommandList(CommandList &commandList)
+//   void ExecuteCommandLists(CommandList *commandLists, std::size_t count)
+//
+// AddTask and RecordAndSubmit must be called from one thread of the job system
+template <typename Backend>
+class ParallelCommandRecorder {
+public:
+	using CommandList = typename Backend::CommandList;
+	using RecordingTask = std::function<void(CommandList &commandList)>;
+
+public:
+	ParallelCommandRecorder(Backend &backend, JobSystem &jobSystem);
+	ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+
+	ParallelCommandRecorder& operator = (const ParallelCommandRecorder&) = delete;
+
+	void AddTask(RecordingTask task);
+
+	// Records all added tasks, the calling thread takes part.
+	// Exceptions thrown by the tasks are rethrown here and nothing is submitted
+	void RecordAndSubmit();
+
+private:
+	void RecordTask(std::size_t taskIndex);
+
+private:
+	Backend &mBackend;
+	JobSystem &mJobSystem;
+
+	std::vector<RecordingTask> mTasks;
+	std::vector<CommandList> mCommandLists;
+
+	std::mutex mErrorMutex;
+	std::exception_ptr mError;
+};
+
+
+template <typename Backend>
+ParallelCommandRecorder<Backend>::ParallelCommandRecorder(Backend &backend, JobSystem &jobSystem)
+: mBackend(backend), mJobSystem(jobSystem) {
+}
+
+
+template <typename Backend>
+void ParallelCommandRecorder<Backend>::AddTask(RecordingTask task) {
+	mTasks.push_back(std::move(task));
+}
+
+
+template <typename Backend>
+void ParallelCommandRecorder<Backend>::RecordAndSubmit() {
+	PROFILE_SCOPE("Record and submit");
+
+	mCommandLists.clear();
+	mCommandLists.resize(mTasks.size());
+
+	mJobSystem.ParallelFor(mTasks.size(), [this](std::size_t taskIndex) {
+		RecordTask(taskIndex);
+	});
+
+	mTasks.clear();
+
+	std::exception_ptr error;
+	std::swap(error, mError);
+
+	if (error) {
+		mCommandLists.clear();
+		std::rethrow_exception(error);
+	}
+
+	mBackend.ExecuteCommandLists(mCommandLists.data(), mCommandLists.size());
+	mCommandLists.clear();
+}
+
+
+template <typename Backend>
+void ParallelCommandRecorder<Backend>::RecordTask(std::size_t taskIndex) {
+	// Jobs must not throw, the first error is kept for RecordAndSubmit
+	try {
+		PROFILE_SCOPE("Record task");
+
+		CommandList &commandList = mCommandLists[taskIndex];
+		commandList = mBackend.BeginCommandList();
+		mTasks[taskIndex](commandList);
+		mBackend.EndCommandList(commandList);
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(mErrorMutex);
+		if (!mError) {
+			mError = std::current_exception();
+		}
+	}
+}
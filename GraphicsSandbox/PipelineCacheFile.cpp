@@ -0,0 +1,9 @@
+#include "PipelineCacheFile.h"
+
+
+constexpr std::uint32_t PipelineCacheFile::MAGIC;
+
+
+PipelineCacheFile::PipelineCacheFile()
+: mFile(MAGIC) {
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+
+#include "BlobCacheFile.h"
+#include "PipelineKey.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// Blobs of compiled pipelines keyed by PipelineKey, stored in a BlobCacheFile.
+//
+// A file that doesn't parse is treated as empty, so a bad cache only costs a
+// cold start.
+//
+// This class is not thread-safe
+class PipelineCacheFile {
+public:
+	PipelineCacheFile();
+	PipelineCacheFile(const PipelineCacheFile&) = delete;
+
+	PipelineCacheFile& operator = (const PipelineCacheFile&) = delete;
+
+	// Returns false if the file is missing or invalid, the cache is empty then
+	bool Load(const std::string &path) {
+		return mFile.Load(path);
+	}
+
+	// Writes a temporary file first, so a failed save doesn't corrupt the old one
+	void Save(const std::string &path) {
+		mFile.Save(path);
+	}
+
+	// The blob stays valid until the next Load or Save
+	bool Find(const PipelineKey &key, BlobCacheFile::Blob &blob) const {
+		return mFile.Find(key.bytes.data(), key.bytes.size(), key.hash, blob);
+	}
+
+	void Insert(const PipelineKey &key, const void *blob, std::size_t size) {
+		mFile.Insert(key.bytes.data(), key.bytes.size(), key.hash, blob, size);
+	}
+
+	std::size_t EntriesCount() const {
+		return mFile.EntriesCount();
+	}
+
+private:
+	// Not the one of the files before entries were padded, which don't parse anymore
+	static constexpr std::uint32_t MAGIC = 0x32505350; // "PSP2"
+
+	BlobCacheFile mFile;
+};
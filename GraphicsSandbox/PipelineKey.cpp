@@ -0,0 +1,78 @@
+#include "PipelineKey.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+
+void PipelineKeyBuilder::BeginSubobject(std::uint32_t type) {
+	if (!mSubobjects.empty()) {
+		mSubobjects.back().end = mFields.size();
+	}
+
+	mSubobjects.push_back(Subobject{ type, mFields.size(), mFields.size() });
+}
+
+
+void PipelineKeyBuilder::AddBytes(const void *data, std::size_t size) {
+	assert(!mSubobjects.empty());
+
+	const std::uint8_t *bytes = static_cast<const std::uint8_t*>(data);
+	mFields.insert(mFields.end(), bytes, bytes + size);
+}
+
+
+void PipelineKeyBuilder::AddSubobject(
+	std::uint32_t type,
+	const void *data,
+	std::size_t size,
+	const void *defaultData,
+	std::size_t defaultSize
+) {
+	if (size == defaultSize && (size == 0 || std::memcmp(data, defaultData, size) == 0)) {
+		return;
+	}
+
+	BeginSubobject(type);
+	AddBytes(data, size);
+}
+
+
+PipelineKey PipelineKeyBuilder::Build() {
+	if (!mSubobjects.empty()) {
+		mSubobjects.back().end = mFields.size();
+	}
+
+	// Stable, so the key is the same however the subobjects were ordered,
+	// as long as every type appears once
+	std::stable_sort(mSubobjects.begin(), mSubobjects.end(), [](const Subobject &a, const Subobject &b) {
+		return a.type < b.type;
+	});
+
+	PipelineKey key;
+	key.bytes.reserve(mFields.size() + mSubobjects.size() * 2 * sizeof(std::uint32_t));
+
+	for (const Subobject &subobject : mSubobjects) {
+		const std::uint32_t size = static_cast<std::uint32_t>(subobject.end - subobject.begin);
+
+		const std::uint8_t *type = reinterpret_cast<const std::uint8_t*>(&subobject.type);
+		key.bytes.insert(key.bytes.end(), type, type + sizeof(subobject.type));
+
+		const std::uint8_t *sizeBytes = reinterpret_cast<const std::uint8_t*>(&size);
+		key.bytes.insert(key.bytes.end(), sizeBytes, sizeBytes + sizeof(size));
+
+		key.bytes.insert(key.bytes.end(), mFields.begin() + subobject.begin, mFields.begin() + subobject.end);
+	}
+
+	key.hash = HashBytes(key.bytes.data(), key.bytes.size());
+
+	Reset();
+
+	return key;
+}
+
+
+void PipelineKeyBuilder::Reset() {
+	mSubobjects.clear();
+	mFields.clear();
+}
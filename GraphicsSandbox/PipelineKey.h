@@ -0,0 +1,83 @@
+#pragma once
+
+
+#include "Hash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Canonical description of a pipeline that doesn't depend on where its parts
+// are in memory, usable as a key across runs
+struct PipelineKey {
+	std::uint64_t hash = 0;
+	std::vector<std::uint8_t> bytes;
+
+	bool operator == (const PipelineKey &other) const {
+		return hash == other.hash && bytes == other.bytes;
+	}
+
+	bool operator != (const PipelineKey &other) const {
+		return !(*this == other);
+	}
+};
+
+
+struct PipelineKeyHash {
+	std::size_t operator () (const PipelineKey &key) const {
+		return static_cast<std::size_t>(key.hash);
+	}
+};
+
+
+// Builds a PipelineKey from subobjects given in any order.
+//
+// The caller adds fields one by one, so padding never gets into the key, and
+// data behind pointers by content, e.g. as the hash of shader bytecode.
+// Subobjects are sorted by type, so their order in the stream doesn't matter.
+// Scratch memory is kept between keys.
+//
+// This class is not thread-safe
+class PipelineKeyBuilder {
+public:
+	PipelineKeyBuilder() = default;
+	PipelineKeyBuilder(const PipelineKeyBuilder&) = delete;
+
+	PipelineKeyBuilder& operator = (const PipelineKeyBuilder&) = delete;
+
+	void BeginSubobject(std::uint32_t type);
+
+	void AddBytes(const void *data, std::size_t size);
+
+	template <typename T>
+	void AddField(const T &value) {
+		AddBytes(&value, sizeof(value));
+	}
+
+	// Adds a whole subobject unless its fields are the ones of its default,
+	// so a default subobject has the key of a missing one
+	void AddSubobject(
+		std::uint32_t type,
+		const void *data,
+		std::size_t size,
+		const void *defaultData,
+		std::size_t defaultSize
+	);
+
+	// Returns the key of the subobjects added since the previous call
+	PipelineKey Build();
+
+	// Discards the subobjects added since the previous key
+	void Reset();
+
+private:
+	struct Subobject {
+		std::uint32_t type;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	std::vector<Subobject> mSubobjects;
+	std::vector<std::uint8_t> mFields;
+};
@@ -0,0 +1,495 @@
+#include "PipelineStateCache.h"
+#include "d3dx12.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+
+namespace {
+	using Bytes = std::vector<std::uint8_t>;
+
+
+	template <typename T>
+	void Encode(Bytes &bytes, const T &value) {
+		// Structs are encoded field by field to leave their padding out
+		static_assert(std::is_scalar<T>::value, "Only scalars can be encoded as they are");
+
+		const std::uint8_t *begin = reinterpret_cast<const std::uint8_t*>(&value);
+		bytes.insert(bytes.end(), begin, begin + sizeof(value));
+	}
+
+
+	void EncodeString(Bytes &bytes, const char *string) {
+		// The terminating zero separates consecutive strings
+		const char *begin = string != nullptr ? string : "";
+		bytes.insert(bytes.end(), begin, begin + std::strlen(begin) + 1);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_SHADER_BYTECODE &shader) {
+		Encode(bytes, static_cast<std::uint64_t>(shader.BytecodeLength));
+		if (shader.BytecodeLength > 0) {
+			Encode(bytes, HashBytes(shader.pShaderBytecode, shader.BytecodeLength));
+		}
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_INPUT_LAYOUT_DESC &inputLayout) {
+		Encode(bytes, inputLayout.NumElements);
+		for (UINT i = 0; i < inputLayout.NumElements; i++) {
+			const D3D12_INPUT_ELEMENT_DESC &element = inputLayout.pInputElementDescs[i];
+			EncodeString(bytes, element.SemanticName);
+			Encode(bytes, element.SemanticIndex);
+			Encode(bytes, element.Format);
+			Encode(bytes, element.InputSlot);
+			Encode(bytes, element.AlignedByteOffset);
+			Encode(bytes, element.InputSlotClass);
+			Encode(bytes, element.InstanceDataStepRate);
+		}
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_STREAM_OUTPUT_DESC &streamOutput) {
+		Encode(bytes, streamOutput.NumEntries);
+		for (UINT i = 0; i < streamOutput.NumEntries; i++) {
+			const D3D12_SO_DECLARATION_ENTRY &entry = streamOutput.pSODeclaration[i];
+			Encode(bytes, entry.Stream);
+			EncodeString(bytes, entry.SemanticName);
+			Encode(bytes, entry.SemanticIndex);
+			Encode(bytes, entry.StartComponent);
+			Encode(bytes, entry.ComponentCount);
+			Encode(bytes, entry.OutputSlot);
+		}
+
+		Encode(bytes, streamOutput.NumStrides);
+		for (UINT i = 0; i < streamOutput.NumStrides; i++) {
+			Encode(bytes, streamOutput.pBufferStrides[i]);
+		}
+
+		Encode(bytes, streamOutput.RasterizedStream);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_BLEND_DESC &blend) {
+		Encode(bytes, blend.AlphaToCoverageEnable);
+		Encode(bytes, blend.IndependentBlendEnable);
+
+		// The rest of the render targets are ignored unless blending is independent
+		const UINT renderTargetsCount = blend.IndependentBlendEnable ? D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT : 1;
+		for (UINT i = 0; i < renderTargetsCount; i++) {
+			const D3D12_RENDER_TARGET_BLEND_DESC &renderTarget = blend.RenderTarget[i];
+			Encode(bytes, renderTarget.BlendEnable);
+			Encode(bytes, renderTarget.LogicOpEnable);
+			Encode(bytes, renderTarget.SrcBlend);
+			Encode(bytes, renderTarget.DestBlend);
+			Encode(bytes, renderTarget.BlendOp);
+			Encode(bytes, renderTarget.SrcBlendAlpha);
+			Encode(bytes, renderTarget.DestBlendAlpha);
+			Encode(bytes, renderTarget.BlendOpAlpha);
+			Encode(bytes, renderTarget.LogicOp);
+			Encode(bytes, renderTarget.RenderTargetWriteMask);
+		}
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_RASTERIZER_DESC &rasterizer) {
+		Encode(bytes, rasterizer.FillMode);
+		Encode(bytes, rasterizer.CullMode);
+		Encode(bytes, rasterizer.FrontCounterClockwise);
+		Encode(bytes, rasterizer.DepthBias);
+		Encode(bytes, rasterizer.DepthBiasClamp);
+		Encode(bytes, rasterizer.SlopeScaledDepthBias);
+		Encode(bytes, rasterizer.DepthClipEnable);
+		Encode(bytes, rasterizer.MultisampleEnable);
+		Encode(bytes, rasterizer.AntialiasedLineEnable);
+		Encode(bytes, rasterizer.ForcedSampleCount);
+		Encode(bytes, rasterizer.ConservativeRaster);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_DEPTH_STENCILOP_DESC &stencilOp) {
+		Encode(bytes, stencilOp.StencilFailOp);
+		Encode(bytes, stencilOp.StencilDepthFailOp);
+		Encode(bytes, stencilOp.StencilPassOp);
+		Encode(bytes, stencilOp.StencilFunc);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_DEPTH_STENCIL_DESC1 &depthStencil) {
+		Encode(bytes, depthStencil.DepthEnable);
+		Encode(bytes, depthStencil.DepthWriteMask);
+		Encode(bytes, depthStencil.DepthFunc);
+		Encode(bytes, depthStencil.StencilEnable);
+		Encode(bytes, depthStencil.StencilReadMask);
+		Encode(bytes, depthStencil.StencilWriteMask);
+		Encode(bytes, depthStencil.FrontFace);
+		Encode(bytes, depthStencil.BackFace);
+		Encode(bytes, depthStencil.DepthBoundsTestEnable);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_RT_FORMAT_ARRAY &renderTargetFormats) {
+		// Formats past the number of render targets are ignored
+		Encode(bytes, renderTargetFormats.NumRenderTargets);
+		for (UINT i = 0; i < renderTargetFormats.NumRenderTargets; i++) {
+			Encode(bytes, renderTargetFormats.RTFormats[i]);
+		}
+	}
+
+
+	void Encode(Bytes &bytes, const DXGI_SAMPLE_DESC &sampleDesc) {
+		Encode(bytes, sampleDesc.Count);
+		Encode(bytes, sampleDesc.Quality);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_VIEW_INSTANCING_DESC &viewInstancing) {
+		Encode(bytes, viewInstancing.ViewInstanceCount);
+		for (UINT i = 0; i < viewInstancing.ViewInstanceCount; i++) {
+			Encode(bytes, viewInstancing.pViewInstanceLocations[i].ViewportArrayIndex);
+			Encode(bytes, viewInstancing.pViewInstanceLocations[i].RenderTargetArrayIndex);
+		}
+		Encode(bytes, viewInstancing.Flags);
+	}
+
+
+	// Adds the subobjects of a stream to the key in their canonical form.
+	// A subobject equal to its default is left out, as if it were missing from
+	// the stream, and the legacy depth-stencil subobject is added as the new one
+	class StreamCanonicalizer : public ID3DX12PipelineParserCallbacks {
+	public:
+		StreamCanonicalizer(PipelineKeyBuilder &builder, const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc)
+		: mBuilder(builder),
+		  mStream(static_cast<const std::uint8_t*>(streamDesc.pPipelineStateSubobjectStream)) {
+		}
+
+		ID3D12RootSignature* RootSignature() const {
+			return mRootSignature;
+		}
+
+		bool HasCachedBlob() const {
+			return mHasCachedBlob;
+		}
+
+		// SIZE_MAX if the stream has no cached blob subobject
+		SIZE_T CachedBlobOffset() const {
+			return mCachedBlobOffset;
+		}
+
+		void FlagsCb(D3D12_PIPELINE_STATE_FLAGS flags) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_FLAGS, flags, D3D12_PIPELINE_STATE_FLAG_NONE);
+		}
+
+		void NodeMaskCb(UINT nodeMask) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_NODE_MASK, nodeMask, 0u);
+		}
+
+		void RootSignatureCb(ID3D12RootSignature *rootSignature) override {
+			// Added by the cache, which knows the hashes
+			mRootSignature = rootSignature;
+		}
+
+		void InputLayoutCb(const D3D12_INPUT_LAYOUT_DESC &inputLayout) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_INPUT_LAYOUT, inputLayout, D3D12_INPUT_LAYOUT_DESC{});
+		}
+
+		void IBStripCutValueCb(D3D12_INDEX_BUFFER_STRIP_CUT_VALUE value) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_IB_STRIP_CUT_VALUE, value, D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED);
+		}
+
+		void PrimitiveTopologyTypeCb(D3D12_PRIMITIVE_TOPOLOGY_TYPE topologyType) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_PRIMITIVE_TOPOLOGY, topologyType, D3D12_PRIMITIVE_TOPOLOGY_TYPE_UNDEFINED);
+		}
+
+		void VSCb(const D3D12_SHADER_BYTECODE &shader) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_VS, shader, D3D12_SHADER_BYTECODE{});
+		}
+
+		void GSCb(const D3D12_SHADER_BYTECODE &shader) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_GS, shader, D3D12_SHADER_BYTECODE{});
+		}
+
+		void StreamOutputCb(const D3D12_STREAM_OUTPUT_DESC &streamOutput) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_STREAM_OUTPUT, streamOutput, D3D12_STREAM_OUTPUT_DESC{});
+		}
+
+		void HSCb(const D3D12_SHADER_BYTECODE &shader) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_HS, shader, D3D12_SHADER_BYTECODE{});
+		}
+
+		void DSCb(const D3D12_SHADER_BYTECODE &shader) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_DS, shader, D3D12_SHADER_BYTECODE{});
+		}
+
+		void PSCb(const D3D12_SHADER_BYTECODE &shader) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_PS, shader, D3D12_SHADER_BYTECODE{});
+		}
+
+		void CSCb(const D3D12_SHADER_BYTECODE &shader) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_CS, shader, D3D12_SHADER_BYTECODE{});
+		}
+
+		void BlendStateCb(const D3D12_BLEND_DESC &blend) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_BLEND, blend, D3D12_BLEND_DESC(CD3DX12_BLEND_DESC(D3D12_DEFAULT)));
+		}
+
+		void DepthStencilStateCb(const D3D12_DEPTH_STENCIL_DESC &depthStencil) override {
+			DepthStencilState1Cb(CD3DX12_DEPTH_STENCIL_DESC1(depthStencil));
+		}
+
+		void DepthStencilState1Cb(const D3D12_DEPTH_STENCIL_DESC1 &depthStencil) override {
+			Add(
+				D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_DEPTH_STENCIL1,
+				depthStencil,
+				D3D12_DEPTH_STENCIL_DESC1(CD3DX12_DEPTH_STENCIL_DESC1(D3D12_DEFAULT))
+			);
+		}
+
+		void DSVFormatCb(DXGI_FORMAT format) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_DEPTH_STENCIL_FORMAT, format, DXGI_FORMAT_UNKNOWN);
+		}
+
+		void RasterizerStateCb(const D3D12_RASTERIZER_DESC &rasterizer) override {
+			Add(
+				D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_RASTERIZER,
+				rasterizer,
+				D3D12_RASTERIZER_DESC(CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT))
+			);
+		}
+
+		void RTVFormatsCb(const D3D12_RT_FORMAT_ARRAY &formats) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_RENDER_TARGET_FORMATS, formats, D3D12_RT_FORMAT_ARRAY{});
+		}
+
+		void SampleDescCb(const DXGI_SAMPLE_DESC &sampleDesc) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_SAMPLE_DESC, sampleDesc, DXGI_SAMPLE_DESC{ 1, 0 });
+		}
+
+		void SampleMaskCb(UINT sampleMask) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_SAMPLE_MASK, sampleMask, UINT_MAX);
+		}
+
+		void ViewInstancingCb(const D3D12_VIEW_INSTANCING_DESC &viewInstancing) override {
+			Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_VIEW_INSTANCING, viewInstancing, D3D12_VIEW_INSTANCING_DESC{});
+		}
+
+		void CachedPSOCb(const D3D12_CACHED_PIPELINE_STATE &cachedBlob) override {
+			// Doesn't change the pipeline, only how fast it is created. The parser
+			// passes the subobject in the stream, so a stored blob can be put into it
+			mHasCachedBlob = cachedBlob.CachedBlobSizeInBytes > 0;
+			mCachedBlobOffset = reinterpret_cast<const std::uint8_t*>(&cachedBlob) - mStream;
+		}
+
+	private:
+		template <typename T>
+		void Add(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE type, const T &value, const T &defaultValue) {
+			mValue.clear();
+			Encode(mValue, value);
+
+			mDefaultValue.clear();
+			Encode(mDefaultValue, defaultValue);
+
+			mBuilder.AddSubobject(type, mValue.data(), mValue.size(), mDefaultValue.data(), mDefaultValue.size());
+		}
+
+	private:
+		PipelineKeyBuilder &mBuilder;
+		const std::uint8_t *mStream;
+		ID3D12RootSignature *mRootSignature = nullptr;
+		bool mHasCachedBlob = false;
+		SIZE_T mCachedBlobOffset = SIZE_MAX;
+
+		Bytes mValue;
+		Bytes mDefaultValue;
+	};
+
+
+	// Blobs of another driver or adapter. Other errors, E_INVALIDARG included, are
+	// thrown, an invalid stream fails the same way without the blob
+	bool IsRejectedBlob(HRESULT hr) {
+		return hr == D3D12_ERROR_DRIVER_VERSION_MISMATCH || hr == D3D12_ERROR_ADAPTER_NOT_FOUND;
+	}
+}
+
+
+PipelineStateCache::PipelineStateCache(GraphicsDevice &device, std::string filePath)
+: mFilePath(std::move(filePath)) {
+	D3D_CHECK(device.GetD3dDevice().As(&mDevice));
+
+	// A missing or outdated file only means that every pipeline is compiled
+	mFile.Load(mFilePath);
+}
+
+
+ComPtr<ID3D12PipelineState> PipelineStateCache::GetOrCreate(const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc) {
+	++mRequestsCount;
+
+	CachedBlobSubobject cachedBlob;
+	const PipelineKey key = BuildKey(streamDesc, cachedBlob);
+
+	bool isCreated;
+	ComPtr<ID3D12PipelineState> pipelineState = mPipelineStates.GetOrCreate(
+		key,
+		[&]() { return Create(key, streamDesc, cachedBlob); },
+		isCreated
+	);
+
+	if (!isCreated) {
+		++mSharedCount;
+	}
+
+	return pipelineState;
+}
+
+
+void PipelineStateCache::Save() {
+	std::lock_guard<std::mutex> lock(mFileMutex);
+
+	if (mIsFileChanged) {
+		mFile.Save(mFilePath);
+		mIsFileChanged = false;
+	}
+}
+
+
+void PipelineStateCache::SetRootSignatureHash(ID3D12RootSignature *rootSignature, std::uint64_t hash) {
+	std::lock_guard<std::mutex> lock(mRootSignatureHashesMutex);
+	mRootSignatureHashes[rootSignature] = hash;
+}
+
+
+void PipelineStateCache::RemoveRootSignatureHash(ID3D12RootSignature *rootSignature) {
+	std::lock_guard<std::mutex> lock(mRootSignatureHashesMutex);
+	mRootSignatureHashes.erase(rootSignature);
+}
+
+
+PipelineStateCache::Statistics PipelineStateCache::GetStatistics() {
+	Statistics statistics;
+	statistics.requestsCount = mRequestsCount;
+	statistics.sharedCount = mSharedCount;
+	statistics.createdCount = mCreatedCount;
+	statistics.fileHitsCount = mFileHitsCount;
+	statistics.rejectedBlobsCount = mRejectedBlobsCount;
+
+	return statistics;
+}
+
+
+PipelineKey PipelineStateCache::BuildKey(const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc) {
+	CachedBlobSubobject cachedBlob;
+	return BuildKey(streamDesc, cachedBlob);
+}
+
+
+PipelineKey PipelineStateCache::BuildKey(
+	const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc,
+	CachedBlobSubobject &cachedBlob
+) {
+	// Keeps its scratch memory between the keys built by the thread
+	thread_local PipelineKeyBuilder builder;
+
+	StreamCanonicalizer canonicalizer(builder, streamDesc);
+
+	try {
+		D3D_CHECK(D3DX12ParsePipelineStream(streamDesc, &canonicalizer));
+
+		if (canonicalizer.RootSignature() != nullptr) {
+			std::uint64_t rootSignatureHash;
+			{
+				std::lock_guard<std::mutex> lock(mRootSignatureHashesMutex);
+
+				auto it = mRootSignatureHashes.find(canonicalizer.RootSignature());
+				if (it == mRootSignatureHashes.end()) {
+					throw std::logic_error("The root signature of the pipeline has no hash");
+				}
+
+				rootSignatureHash = it->second;
+			}
+
+			builder.BeginSubobject(D3D12_PIPELINE_STATE_SUBOBJECT_TYPE_ROOT_SIGNATURE);
+			builder.AddField(rootSignatureHash);
+		}
+	} catch (...) {
+		builder.Reset();
+		throw;
+	}
+
+	cachedBlob.hasBlob = canonicalizer.HasCachedBlob();
+	cachedBlob.offset = canonicalizer.CachedBlobOffset();
+	return builder.Build();
+}
+
+
+ComPtr<ID3D12PipelineState> PipelineStateCache::Create(
+	const PipelineKey &key,
+	const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc,
+	const CachedBlobSubobject &cachedBlob
+) {
+	std::vector<std::uint8_t> blob;
+	if (!cachedBlob.hasBlob) {
+		std::lock_guard<std::mutex> lock(mFileMutex);
+
+		// Copied, Save remaps the file
+		BlobCacheFile::Blob storedBlob;
+		if (mFile.Find(key, storedBlob)) {
+			const std::uint8_t *bytes = static_cast<const std::uint8_t*>(storedBlob.data);
+			blob.assign(bytes, bytes + storedBlob.size);
+		}
+	}
+
+	ComPtr<ID3D12PipelineState> pipelineState;
+
+	if (!blob.empty()) {
+		const D3D12_CACHED_PIPELINE_STATE fileBlob = { blob.data(), blob.size() };
+
+		// A stream may have only one cached blob subobject, an empty one is
+		// filled in. Otherwise the subobject goes right after the stream, as
+		// subobjects are aligned to pointers
+		const SIZE_T streamSize = cachedBlob.offset != NO_CACHED_BLOB_SUBOBJECT
+			? streamDesc.SizeInBytes
+			: streamDesc.SizeInBytes + sizeof(CD3DX12_PIPELINE_STATE_STREAM_CACHED_PSO);
+
+		std::vector<void*> stream((streamSize + sizeof(void*) - 1) / sizeof(void*));
+		std::uint8_t *streamBytes = reinterpret_cast<std::uint8_t*>(stream.data());
+		std::memcpy(streamBytes, streamDesc.pPipelineStateSubobjectStream, streamDesc.SizeInBytes);
+
+		if (cachedBlob.offset != NO_CACHED_BLOB_SUBOBJECT) {
+			std::memcpy(streamBytes + cachedBlob.offset, &fileBlob, sizeof(fileBlob));
+		} else {
+			const CD3DX12_PIPELINE_STATE_STREAM_CACHED_PSO subobject(fileBlob);
+			std::memcpy(streamBytes + streamDesc.SizeInBytes, &subobject, sizeof(subobject));
+		}
+
+		const D3D12_PIPELINE_STATE_STREAM_DESC cachedStreamDesc = { streamSize, stream.data() };
+
+		const HRESULT hr = mDevice->CreatePipelineState(&cachedStreamDesc, IID_PPV_ARGS(&pipelineState));
+		if (SUCCEEDED(hr)) {
+			++mFileHitsCount;
+			++mCreatedCount;
+			return pipelineState;
+		}
+
+		if (!IsRejectedBlob(hr)) {
+			throw D3dException(hr, __FILE__, __LINE__);
+		}
+
+		// The new blob replaces it
+		++mRejectedBlobsCount;
+	}
+
+	D3D_CHECK(mDevice->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&pipelineState)));
+	++mCreatedCount;
+
+	ComPtr<ID3DBlob> createdBlob;
+	if (SUCCEEDED(pipelineState->GetCachedBlob(&createdBlob))) {
+		std::lock_guard<std::mutex> lock(mFileMutex);
+
+		mFile.Insert(key, createdBlob->GetBufferPointer(), createdBlob->GetBufferSize());
+		mIsFileChanged = true;
+	}
+
+	return pipelineState;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "PipelineKey.h"
+#include "PipelineCacheFile.h"
+#include "SharedObjectCache.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+// Pipeline states keyed by the canonical form of their pipeline state streams.
+//
+// Streams that differ only in the order of subobjects, in subobjects set to
+// their defaults or in the addresses of shaders and input layouts get the same
+// pipeline, which is created once even if several threads request it at the same
+// time. Blobs of created pipelines are kept in a file, so the driver can skip
+// compilation in the next runs. A blob the driver rejects, e.g. after a driver
+// update, is replaced by a new one.
+//
+// Root signatures are part of the key by their serialized contents, so they must
+// be registered with SetRootSignatureHash before they are used in a stream.
+//
+// This class is thread-safe
+class PipelineStateCache {
+public:
+	struct Statistics {
+		UINT requestsCount = 0;
+		// Requests served by a pipeline that was already created or being created
+		UINT sharedCount = 0;
+		UINT createdCount = 0;
+		// Created pipelines whose blob was found in the file
+		UINT fileHitsCount = 0;
+		UINT rejectedBlobsCount = 0;
+	};
+
+public:
+	// The file is loaded if it exists, it is only written by Save
+	PipelineStateCache(GraphicsDevice &device, std::string filePath);
+	PipelineStateCache(const PipelineStateCache&) = delete;
+
+	PipelineStateCache& operator = (const PipelineStateCache&) = delete;
+
+	ComPtr<ID3D12PipelineState> GetOrCreate(const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc);
+
+	// Returns the key GetOrCreate would use for the stream
+	PipelineKey BuildKey(const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc);
+
+	// Writes the blobs to the file if there are new ones
+	void Save();
+
+	// The hash identifies the root signature across runs, e.g. the hash of its serialized blob
+	void SetRootSignatureHash(ID3D12RootSignature *rootSignature, std::uint64_t hash);
+
+	void RemoveRootSignatureHash(ID3D12RootSignature *rootSignature);
+
+	Statistics GetStatistics();
+
+private:
+	// Cached blob subobject of a stream
+	struct CachedBlobSubobject {
+		// Set if the caller has passed a blob of its own
+		bool hasBlob;
+		// Offset of the D3D12_CACHED_PIPELINE_STATE in the stream,
+		// NO_CACHED_BLOB_SUBOBJECT if the stream has no such subobject
+		SIZE_T offset;
+	};
+
+	static constexpr SIZE_T NO_CACHED_BLOB_SUBOBJECT = SIZE_MAX;
+
+	PipelineKey BuildKey(const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc, CachedBlobSubobject &cachedBlob);
+
+	ComPtr<ID3D12PipelineState> Create(
+		const PipelineKey &key,
+		const D3D12_PIPELINE_STATE_STREAM_DESC &streamDesc,
+		const CachedBlobSubobject &cachedBlob
+	);
+
+private:
+	ComPtr<ID3D12Device2> mDevice;
+	const std::string mFilePath;
+
+	std::mutex mRootSignatureHashesMutex;
+	std::unordered_map<ID3D12RootSignature*, std::uint64_t> mRootSignatureHashes;
+
+	SharedObjectCache<PipelineKey, ComPtr<ID3D12PipelineState>, PipelineKeyHash> mPipelineStates;
+
+	std::mutex mFileMutex;
+	PipelineCacheFile mFile;
+	bool mIsFileChanged = false;
+
+	std::atomic<UINT> mRequestsCount{0};
+	std::atomic<UINT> mSharedCount{0};
+	std::atomic<UINT> mCreatedCount{0};
+	std::atomic<UINT> mFileHitsCount{0};
+	std::atomic<UINT> mRejectedBlobsCount{0};
+};
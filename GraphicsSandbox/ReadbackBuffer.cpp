@@ -0,0 +1,25 @@
+#include "ReadbackBuffer.h"
+#include "d3dx12.h"
+
+
+ReadbackBuffer::ReadbackBuffer(GraphicsDevice &device, UINT64 size) {
+	// Buffers in readback heaps are created in the copy destination state and stay in it
+	D3D_CHECK(device.GetD3dDevice()->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(size),
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(&mResource)
+	));
+
+	// Nullptr range: the whole buffer may be read
+	D3D_CHECK(mResource->Map(0, nullptr, reinterpret_cast<void**>(&mCpuAddress)));
+}
+
+
+ReadbackBuffer::~ReadbackBuffer() {
+	// The CPU doesn't write readback memory
+	CD3DX12_RANGE writtenRange(0, 0);
+	mResource->Unmap(0, &writtenRange);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+
+#include <cstdint>
+
+
+// Buffer in a readback heap that stays mapped until it's destroyed.
+//
+// The CPU may read it only after the fence label of the copy into it completes
+class ReadbackBuffer {
+public:
+	ReadbackBuffer(GraphicsDevice &device, UINT64 size);
+	ReadbackBuffer(const ReadbackBuffer&) = delete;
+
+	ReadbackBuffer& operator = (const ReadbackBuffer&) = delete;
+
+	~ReadbackBuffer();
+
+	ID3D12Resource* Resource() const {
+		return mResource.Get();
+	}
+
+	const std::uint8_t* CpuAddress() const {
+		return mCpuAddress;
+	}
+
+private:
+	ComPtr<ID3D12Resource> mResource;
+	std::uint8_t *mCpuAddress = nullptr;
+};
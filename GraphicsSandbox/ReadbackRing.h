@@ -0,0 +1,154 @@
+#pragma once
+
+
+#include "FenceCallbackWorker.h"
+#include "FrameDumpWriter.h"
+#include "ImageFile.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+
+// Slots of offscreen frames on their way from the device to the disk.
+//
+// A slot is acquired before the frame is rendered into it and submitted with the
+// label of the frame. Once the label completes, a thread of FenceCallbackWorker
+// hands the pixels over to FrameDumpWriter, and the slot is free again once the
+// file is written. Neither the submitting thread nor the device wait for the
+// readback: Acquire blocks only if every slot is still on its way, which bounds
+// the memory and applies back-pressure when the encoders fall behind.
+//
+// The memory of the slots is owned by the backend, the ring only tracks them.
+// Slots are acquired in the order they were freed.
+//
+// Fence is the fence of FenceCallbackWorker. This class is thread-safe
+template <typename Fence>
+class ReadbackRing {
+public:
+	using Label = typename Fence::Label;
+
+	// Totals since creation
+	struct Statistics {
+		std::uint64_t submittedFramesCount = 0;
+		// Acquisitions that waited for a slot
+		std::uint64_t stallsCount = 0;
+	};
+
+public:
+	ReadbackRing(Fence &fence, FrameDumpWriter &writer, std::size_t slotsCount);
+	ReadbackRing(const ReadbackRing&) = delete;
+	// Waits for the submitted frames
+	~ReadbackRing();
+
+	ReadbackRing& operator = (const ReadbackRing&) = delete;
+
+	std::size_t SlotsCount() const {
+		return mSlotsCount;
+	}
+
+	// Returns the index of a free slot
+	std::size_t Acquire();
+
+	// The image must stay valid until the slot is acquired again
+	void Submit(std::size_t slot, const Label &label, std::uint64_t frameNumber, const ImageView &image);
+
+	// Waits until the files of the submitted frames are written
+	void WaitForAll();
+
+	Statistics GetStatistics();
+
+private:
+	void Release(std::size_t slot);
+
+private:
+	FrameDumpWriter &mWriter;
+	const std::size_t mSlotsCount;
+
+	std::mutex mMutex;
+	std::condition_variable mSlotReleased;
+	std::deque<std::size_t> mFreeSlots;
+	std::size_t mSubmittedSlotsCount = 0;
+	Statistics mStatistics;
+
+	// Destroyed first, its thread uses the members above
+	FenceCallbackWorker<Fence> mCallbacks;
+};
+
+
+template <typename Fence>
+ReadbackRing<Fence>::ReadbackRing(Fence &fence, FrameDumpWriter &writer, std::size_t slotsCount)
+: mWriter(writer), mSlotsCount(slotsCount), mCallbacks(fence) {
+	for (std::size_t i = 0; i < slotsCount; i++) {
+		mFreeSlots.push_back(i);
+	}
+}
+
+
+template <typename Fence>
+ReadbackRing<Fence>::~ReadbackRing() {
+	// The writer still reads the memory of the slots
+	std::unique_lock<std::mutex> lock(mMutex);
+	mSlotReleased.wait(lock, [this] { return mSubmittedSlotsCount == 0; });
+}
+
+
+template <typename Fence>
+std::size_t ReadbackRing<Fence>::Acquire() {
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if (mFreeSlots.empty()) {
+		mStatistics.stallsCount++;
+		mSlotReleased.wait(lock, [this] { return !mFreeSlots.empty(); });
+	}
+
+	const std::size_t slot = mFreeSlots.front();
+	mFreeSlots.pop_front();
+
+	return slot;
+}
+
+
+template <typename Fence>
+void ReadbackRing<Fence>::Submit(std::size_t slot, const Label &label, std::uint64_t frameNumber, const ImageView &image) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSubmittedSlotsCount++;
+		mStatistics.submittedFramesCount++;
+	}
+
+	mCallbacks.OnCompletion(label, [this, slot, frameNumber, image] {
+		mWriter.Write(frameNumber, image, [this, slot] { Release(slot); });
+	});
+}
+
+
+template <typename Fence>
+void ReadbackRing<Fence>::WaitForAll() {
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mSlotReleased.wait(lock, [this] { return mSubmittedSlotsCount == 0; });
+	}
+
+	// Rethrows the errors of the writes
+	mWriter.WaitForAll();
+}
+
+
+template <typename Fence>
+typename ReadbackRing<Fence>::Statistics ReadbackRing<Fence>::GetStatistics() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStatistics;
+}
+
+
+template <typename Fence>
+void ReadbackRing<Fence>::Release(std::size_t slot) {
+	// Notified under the lock, the destructor may return as soon as it's released
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFreeSlots.push_back(slot);
+	mSubmittedSlotsCount--;
+	mSlotReleased.notify_all();
+}
@@ -0,0 +1,234 @@
+#include "RenderGraph.h"
+#include "FrameProfiler.h"
+
+#include <cassert>
+
+
+void RenderGraph::Reset() {
+	mResources.clear();
+	mPasses.clear();
+	mUses.clear();
+}
+
+
+RenderGraph::ResourceId RenderGraph::ImportResource(ResourceState initialState, ResourceState finalState) {
+	mResources.push_back(Resource{ initialState, finalState, true });
+	return static_cast<ResourceId>(mResources.size() - 1);
+}
+
+
+RenderGraph::ResourceId RenderGraph::CreateResource(ResourceState initialState) {
+	mResources.push_back(Resource{ initialState, initialState, false });
+	return static_cast<ResourceId>(mResources.size() - 1);
+}
+
+
+RenderGraph::PassId RenderGraph::AddPass(bool hasSideEffects) {
+	const std::uint32_t usesCount = static_cast<std::uint32_t>(mUses.size());
+
+	mPasses.push_back(Pass{ hasSideEffects, usesCount, usesCount });
+	return static_cast<PassId>(mPasses.size() - 1);
+}
+
+
+void RenderGraph::Read(PassId pass, ResourceId resource, ResourceState state) {
+	AddUse(pass, resource, state, false);
+}
+
+
+void RenderGraph::Write(PassId pass, ResourceId resource, ResourceState state) {
+	AddUse(pass, resource, state, true);
+}
+
+
+const CompiledRenderGraph& RenderGraph::Compile() {
+	PROFILE_SCOPE("Compile frame graph");
+
+	mWasReused = mIsCompiled
+		&& mResources == mCompiledResources
+		&& mPasses == mCompiledPasses
+		&& mUses == mCompiledUses;
+
+	if (mWasReused) {
+		mStatistics.reusedCompilationsCount++;
+		return mCompiled;
+	}
+
+	Cull();
+	Schedule();
+
+	mCompiledResources = mResources;
+	mCompiledPasses = mPasses;
+	mCompiledUses = mUses;
+	mIsCompiled = true;
+
+	mStatistics.compilationsCount++;
+	return mCompiled;
+}
+
+
+void RenderGraph::AddUse(PassId pass, ResourceId resource, ResourceState state, bool isWrite) {
+	assert(pass + 1 == mPasses.size());
+	assert(resource < mResources.size());
+
+	mUses.push_back(Use{ resource, state, isWrite });
+	mPasses[pass].usesEnd = static_cast<std::uint32_t>(mUses.size());
+}
+
+
+void RenderGraph::Cull() {
+	mIsPassAlive.assign(mPasses.size(), false);
+	mIsResourceNeeded.assign(mResources.size(), false);
+
+	for (ResourceId resource = 0; resource < mResources.size(); resource++) {
+		mIsResourceNeeded[resource] = mResources[resource].isImported;
+	}
+
+	// A pass is needed if a later needed pass or an output reads what it writes
+	for (PassId pass = static_cast<PassId>(mPasses.size()); pass-- > 0;) {
+		bool isAlive = mPasses[pass].hasSideEffects;
+		for (std::uint32_t i = mPasses[pass].usesBegin; i < mPasses[pass].usesEnd && !isAlive; i++) {
+			isAlive = mUses[i].isWrite && mIsResourceNeeded[mUses[i].resource];
+		}
+
+		if (!isAlive) {
+			continue;
+		}
+
+		mIsPassAlive[pass] = true;
+		for (std::uint32_t i = mPasses[pass].usesBegin; i < mPasses[pass].usesEnd; i++) {
+			if (!mUses[i].isWrite) {
+				mIsResourceNeeded[mUses[i].resource] = true;
+			}
+		}
+	}
+
+	mCompiled.passes.clear();
+	for (PassId pass = 0; pass < mPasses.size(); pass++) {
+		if (mIsPassAlive[pass]) {
+			mCompiled.passes.push_back(pass);
+		}
+	}
+}
+
+
+void RenderGraph::Schedule() {
+	mCompiled.barriers.clear();
+	mCompiled.passBarriers.clear();
+	mCompiled.resourceLifetimes.assign(
+		mResources.size(), CompiledRenderGraph::Lifetime{ UINT32_MAX, UINT32_MAX }
+	);
+
+	mCurrentStates.resize(mResources.size());
+	for (ResourceId resource = 0; resource < mResources.size(); resource++) {
+		mCurrentStates[resource] = mResources[resource].initialState;
+	}
+	mWasWrittenAsUav.assign(mResources.size(), false);
+
+	for (std::uint32_t scheduleIndex = 0; scheduleIndex < mCompiled.passes.size(); scheduleIndex++) {
+		const PassId pass = mCompiled.passes[scheduleIndex];
+		const std::uint32_t barriersBegin = static_cast<std::uint32_t>(mCompiled.barriers.size());
+
+		for (std::uint32_t i = mPasses[pass].usesBegin; i < mPasses[pass].usesEnd; i++) {
+			const ResourceId resource = mUses[i].resource;
+
+			CompiledRenderGraph::Lifetime &lifetime = mCompiled.resourceLifetimes[resource];
+			if (lifetime.lastPass == scheduleIndex) {
+				// Another use of the pass has handled the resource
+				continue;
+			}
+
+			if (lifetime.firstPass == UINT32_MAX) {
+				lifetime.firstPass = scheduleIndex;
+			}
+			lifetime.lastPass = scheduleIndex;
+
+			ResourceState state;
+			bool isWrite;
+			FindPassState(pass, resource, state, isWrite);
+
+			ResourceState &currentState = mCurrentStates[resource];
+
+			if (!isWrite && IsReadOnlyState(state)) {
+				if (!ContainsState(currentState, state)) {
+					const ResourceState combinedState = CombineReadStates(scheduleIndex, resource, state);
+					AddTransition(resource, currentState, combinedState);
+					currentState = combinedState;
+				}
+			} else if (currentState != state) {
+				AddTransition(resource, currentState, state);
+				currentState = state;
+			} else if (state == ResourceState::UNORDERED_ACCESS && mWasWrittenAsUav[resource]) {
+				mCompiled.barriers.push_back(CompiledRenderGraph::Barrier{
+					CompiledRenderGraph::BarrierType::UAV, resource, state, state
+				});
+			}
+
+			mWasWrittenAsUav[resource] = isWrite && state == ResourceState::UNORDERED_ACCESS;
+		}
+
+		mCompiled.passBarriers.push_back(CompiledRenderGraph::BarrierRange{
+			barriersBegin, static_cast<std::uint32_t>(mCompiled.barriers.size())
+		});
+	}
+
+	mCompiled.finalBarriers.begin = static_cast<std::uint32_t>(mCompiled.barriers.size());
+	for (ResourceId resource = 0; resource < mResources.size(); resource++) {
+		if (mCurrentStates[resource] != mResources[resource].finalState) {
+			AddTransition(resource, mCurrentStates[resource], mResources[resource].finalState);
+		}
+	}
+	mCompiled.finalBarriers.end = static_cast<std::uint32_t>(mCompiled.barriers.size());
+}
+
+
+bool RenderGraph::FindPassState(PassId pass, ResourceId resource, ResourceState &state, bool &isWrite) const {
+	bool isUsed = false;
+	state = ResourceState::COMMON;
+	isWrite = false;
+
+	for (std::uint32_t i = mPasses[pass].usesBegin; i < mPasses[pass].usesEnd; i++) {
+		const Use &use = mUses[i];
+		if (use.resource != resource) {
+			continue;
+		}
+
+		if (use.isWrite) {
+			// Reads in the same pass must be in the state of the write
+			state = use.state;
+			isWrite = true;
+		} else if (!isWrite) {
+			state = state | use.state;
+		}
+
+		isUsed = true;
+	}
+
+	return isUsed;
+}
+
+
+ResourceState RenderGraph::CombineReadStates(std::uint32_t scheduleIndex, ResourceId resource, ResourceState state) const {
+	for (std::uint32_t i = scheduleIndex + 1; i < mCompiled.passes.size(); i++) {
+		ResourceState passState;
+		bool isWrite;
+		if (!FindPassState(mCompiled.passes[i], resource, passState, isWrite)) {
+			continue;
+		}
+
+		if (isWrite || !IsReadOnlyState(passState)) {
+			break;
+		}
+
+		state = state | passState;
+	}
+
+	return state;
+}
+
+
+void RenderGraph::AddTransition(ResourceId resource, ResourceState before, ResourceState after) {
+	mCompiled.barriers.push_back(CompiledRenderGraph::Barrier{
+		CompiledRenderGraph::BarrierType::TRANSITION, resource, before, after
+	});
+}
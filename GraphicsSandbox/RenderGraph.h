@@ -0,0 +1,172 @@
+#pragma once
+
+
+#include "ResourceState.h"
+
+#include <cstdint>
+#include <vector>
+
+
+// Schedule of a RenderGraph: the passes that survived culling, in order, and the
+// barriers to execute before each of them and after the last one
+struct CompiledRenderGraph {
+	enum class BarrierType {
+		TRANSITION,
+		// Orders unordered access writes of two passes in the same state
+		UAV
+	};
+
+	struct Barrier {
+		BarrierType type;
+		std::uint32_t resource;
+		ResourceState before;
+		ResourceState after;
+	};
+
+	// Where the barriers of a scheduled pass are in the barriers vector
+	struct BarrierRange {
+		std::uint32_t begin;
+		std::uint32_t end;
+	};
+
+	// Schedule indices of the first and the last pass that use a resource,
+	// e.g. to alias transient resources. UINT32_MAX if no scheduled pass uses it
+	struct Lifetime {
+		std::uint32_t firstPass;
+		std::uint32_t lastPass;
+	};
+
+	std::vector<std::uint32_t> passes;
+	std::vector<Barrier> barriers;
+	std::vector<BarrierRange> passBarriers;
+	BarrierRange finalBarriers;
+	std::vector<Lifetime> resourceLifetimes;
+};
+
+
+// Frame described as passes that read and write resources.
+//
+// The graph is built anew every frame. Compile culls the passes whose writes are
+// never read by another pass or an output, orders the rest as they were added and
+// computes the transitions between them. Reads of the same resource in different
+// read-only states are combined into one transition. The result is reused while
+// the shape of the graph stays the same.
+//
+// Imported resources come in a known state and are returned to their final state.
+// Created resources start and end in their initial state.
+//
+// This class is not thread-safe
+class RenderGraph {
+public:
+	using ResourceId = std::uint32_t;
+	using PassId = std::uint32_t;
+
+	struct Statistics {
+		std::uint32_t compilationsCount = 0;
+		std::uint32_t reusedCompilationsCount = 0;
+	};
+
+public:
+	RenderGraph() = default;
+	RenderGraph(const RenderGraph&) = delete;
+
+	RenderGraph& operator = (const RenderGraph&) = delete;
+
+	// Starts building the graph of a new frame
+	void Reset();
+
+	// Imported resources are outputs, their writes are never culled
+	ResourceId ImportResource(ResourceState initialState, ResourceState finalState);
+	ResourceId CreateResource(ResourceState initialState);
+
+	// Passes with side effects, e.g. readbacks, are never culled
+	PassId AddPass(bool hasSideEffects = false);
+
+	// Uses are declared for the last added pass
+	void Read(PassId pass, ResourceId resource, ResourceState state);
+	void Write(PassId pass, ResourceId resource, ResourceState state);
+
+	const CompiledRenderGraph& Compile();
+
+	// True if the last Compile reused the previous result
+	bool WasReused() const {
+		return mWasReused;
+	}
+
+	Statistics GetStatistics() const {
+		return mStatistics;
+	}
+
+private:
+	struct Resource {
+		ResourceState initialState;
+		ResourceState finalState;
+		bool isImported;
+
+		bool operator == (const Resource &other) const {
+			return initialState == other.initialState
+				&& finalState == other.finalState
+				&& isImported == other.isImported;
+		}
+	};
+
+	struct Pass {
+		bool hasSideEffects;
+		// Where the uses of the pass are in the uses vector
+		std::uint32_t usesBegin;
+		std::uint32_t usesEnd;
+
+		bool operator == (const Pass &other) const {
+			return hasSideEffects == other.hasSideEffects
+				&& usesBegin == other.usesBegin
+				&& usesEnd == other.usesEnd;
+		}
+	};
+
+	struct Use {
+		ResourceId resource;
+		ResourceState state;
+		bool isWrite;
+
+		bool operator == (const Use &other) const {
+			return resource == other.resource
+				&& state == other.state
+				&& isWrite == other.isWrite;
+		}
+	};
+
+	void AddUse(PassId pass, ResourceId resource, ResourceState state, bool isWrite);
+
+	void Cull();
+	void Schedule();
+
+	// Combined state of the uses of a resource in a pass, isWrite is set if any of
+	// them writes. Returns false if the pass doesn't use the resource
+	bool FindPassState(PassId pass, ResourceId resource, ResourceState &state, bool &isWrite) const;
+
+	// Read-only state that covers the reads from the pass until the next write
+	ResourceState CombineReadStates(std::uint32_t scheduleIndex, ResourceId resource, ResourceState state) const;
+
+	void AddTransition(ResourceId resource, ResourceState before, ResourceState after);
+
+private:
+	std::vector<Resource> mResources;
+	std::vector<Pass> mPasses;
+	std::vector<Use> mUses;
+
+	// Shape of the compiled graph
+	std::vector<Resource> mCompiledResources;
+	std::vector<Pass> mCompiledPasses;
+	std::vector<Use> mCompiledUses;
+	bool mIsCompiled = false;
+	bool mWasReused = false;
+
+	CompiledRenderGraph mCompiled;
+	Statistics mStatistics;
+
+	// Scratch state of a compilation
+	std::vector<bool> mIsPassAlive;
+	std::vector<bool> mIsResourceNeeded;
+	std::vector<ResourceState> mCurrentStates;
+	std::vector<bool> mWasWrittenAsUav;
+};
@@ -2,46 +2,60 @@
 
 
 #include "D3dCommon.h"
-#include "GraphicsDevice.h"
+#include "JobSystem.h"
+#include "D3dFrameBackend.h"
+#include "FrameRenderer.h"
+#include "FrameDumpWriter.h"
+#include "OffscreenBatch.h"
 
+#include <cstdint>
 
+
+// Frame loop of FrameRenderer on the D3D12 backend, presenting to a window or
+// rendering offscreen into files
 class RenderingSystem {
 public:
-	RenderingSystem(HWND hWnd, UINT width, UINT height);
-	~RenderingSystem();
-
-	void RenderFrame();
+	static constexpr UINT DEFAULT_FRAMES_IN_FLIGHT_COUNT = 2;
 
-private:
-    void FlushCommandQueue();
-
-private:
-    static constexpr DXGI_FORMAT BACK_BUFFER_FORMAT = DXGI_FORMAT_R8G8B8A8_UNORM;
-    static constexpr DXGI_FORMAT DEPTH_STENCIL_FORMAT = DXGI_FORMAT_D32_FLOAT_S8X24_UINT;
-    static constexpr UINT SWAP_CHAIN_BUFFERS_COUNT = 2;
-    static constexpr UINT DEPTH_STENCIL_BUFFERS_COUNT = 1;
+	using FrameStatistics = D3dFrameBackend::FrameStatistics;
 
-    GraphicsDevice mDevice;
-
-    WaitableGpuFence mFence;
-
-    ComPtr<ID3D12CommandQueue> mCommandQueue;
-    ComPtr<ID3D12CommandAllocator> mDirectCmdListAlloc;
-    ComPtr<ID3D12GraphicsCommandList> mCommandList;
+public:
+	RenderingSystem(
+		HWND hWnd,
+		UINT width,
+		UINT height,
+		JobSystem &jobSystem,
+		UINT framesInFlightCount = DEFAULT_FRAMES_IN_FLIGHT_COUNT
+	);
+
+	// Offscreen, the writer must outlive the system
+	RenderingSystem(
+		UINT width,
+		UINT height,
+		JobSystem &jobSystem,
+		FrameDumpWriter &frameWriter,
+		UINT framesInFlightCount = DEFAULT_FRAMES_IN_FLIGHT_COUNT
+	);
+
+	// Blocks until the swap chain is ready for a new frame
+	void WaitForFrameLatency();
+
+	// Presents on vertical blanks if enabled, the default
+	void SetVsyncEnabled(bool isEnabled);
 
-    D3D12_VIEWPORT mViewport;
-    D3D12_RECT mScissorRect;
+	void RenderFrame();
 
-    ComPtr<IDXGISwapChain4> mSwapChain;
-    UINT mCurrentBackBufferIndex;
+	// Offscreen, renders the frames and waits until their files are written
+	OffscreenBatchReport RenderBatch(std::uint64_t framesCount);
 
-    ComPtr<ID3D12DescriptorHeap> mRtvHeap;
-    ComPtr<ID3D12DescriptorHeap> mDsvHeap;
+	FrameStatistics LastFrameStatistics();
 
-    UINT mRtvDescriptorSize;
-    UINT mDsvDescriptorSize;
-    UINT mCbvSrvUavDescriptorSize;
+	// Adds the GPU scopes of the captured frames in flight to the capture of
+	// the FrameProfiler, before it's exported
+	void CollectGpuProfile();
 
-    ComPtr<ID3D12Resource> mSwapChainBuffer[SWAP_CHAIN_BUFFERS_COUNT];
-    ComPtr<ID3D12Resource> mDepthStencilBuffer;
+private:
+    D3dFrameBackend mBackend;
+    // Destroyed first, it waits for the frames in flight
+    FrameRenderer<D3dFrameBackend> mRenderer;
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+
+#include <cstdint>
+
+
+// Resource states with the values of D3D12_RESOURCE_STATES, so they can be cast
+// to them, while the code that uses them builds without D3D12
+enum class ResourceState : std::uint32_t {
+	COMMON = 0,
+	VERTEX_AND_CONSTANT_BUFFER = 0x1,
+	INDEX_BUFFER = 0x2,
+	RENDER_TARGET = 0x4,
+	UNORDERED_ACCESS = 0x8,
+	DEPTH_WRITE = 0x10,
+	DEPTH_READ = 0x20,
+	NON_PIXEL_SHADER_RESOURCE = 0x40,
+	PIXEL_SHADER_RESOURCE = 0x80,
+	STREAM_OUT = 0x100,
+	INDIRECT_ARGUMENT = 0x200,
+	COPY_DEST = 0x400,
+	COPY_SOURCE = 0x800,
+	RESOLVE_DEST = 0x1000,
+	RESOLVE_SOURCE = 0x2000,
+	PRESENT = 0
+};
+
+
+constexpr ResourceState READ_ONLY_RESOURCE_STATES = static_cast<ResourceState>(
+	0x1 | 0x2 | 0x20 | 0x40 | 0x80 | 0x200 | 0x800 | 0x2000
+);
+
+
+inline ResourceState operator | (ResourceState a, ResourceState b) {
+	return static_cast<ResourceState>(static_cast<std::uint32_t>(a) | static_cast<std::uint32_t>(b));
+}
+
+
+inline ResourceState operator & (ResourceState a, ResourceState b) {
+	return static_cast<ResourceState>(static_cast<std::uint32_t>(a) & static_cast<std::uint32_t>(b));
+}
+
+
+// Several read-only states can be combined, a write state can't be combined with anything
+inline bool IsReadOnlyState(ResourceState state) {
+	return state != ResourceState::COMMON && (state & READ_ONLY_RESOURCE_STATES) == state;
+}
+
+
+// True if a resource in the state can be used in the other one without a transition
+inline bool ContainsState(ResourceState state, ResourceState other) {
+	return state == other || (IsReadOnlyState(other) && (state & other) == other);
+}
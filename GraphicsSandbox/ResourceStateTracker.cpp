@@ -0,0 +1,363 @@
+#include "ResourceStateTracker.h"
+
+#include <cassert>
+#include <stdexcept>
+
+
+namespace {
+	bool CanPromote(StatePromotion promotion, ResourceState state) {
+		if (promotion == StatePromotion::ANY_STATE) {
+			return true;
+		}
+
+		const ResourceState shaderResourceAndCopySourceStates = ResourceState::NON_PIXEL_SHADER_RESOURCE
+			| ResourceState::PIXEL_SHADER_RESOURCE
+			| ResourceState::COPY_SOURCE;
+
+		return state == ResourceState::COPY_DEST
+			|| (state != ResourceState::COMMON && (state & shaderResourceAndCopySourceStates) == state);
+	}
+}
+
+
+void ResourceStateRegistry::Register(
+	void *resource,
+	std::uint32_t subresourcesCount,
+	ResourceState state,
+	StatePromotion promotion
+) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	RegisteredResource &registered = mResources[resource];
+	registered.promotion = promotion;
+	registered.states.assign(subresourcesCount, state);
+	registered.isDecaying.assign(subresourcesCount, false);
+}
+
+
+void ResourceStateRegistry::Unregister(void *resource) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mResources.erase(resource);
+}
+
+
+std::uint32_t ResourceStateRegistry::SubresourcesCount(void *resource) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return static_cast<std::uint32_t>(FindRegistered(resource).states.size());
+}
+
+
+void ResourceStateRegistry::Resolve(const ResourceStateTracker &tracker, std::vector<TrackedBarrier> &barriers) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (const ResourceStateTracker::Requirement &requirement : tracker.mRequirements) {
+		RegisteredResource &registered = FindRegistered(requirement.resource);
+
+		// The list records exact states, so a combined read state isn't enough
+		const ResourceState state = registered.states[requirement.subresource];
+		if (state == requirement.state) {
+			continue;
+		}
+
+		if (state == ResourceState::COMMON && CanPromote(registered.promotion, requirement.state)) {
+			registered.isDecaying[requirement.subresource] = registered.promotion == StatePromotion::ANY_STATE
+				|| IsReadOnlyState(requirement.state);
+			continue;
+		}
+
+		barriers.push_back(TrackedBarrier{
+			TrackedBarrier::Type::TRANSITION,
+			TrackedBarrier::Split::NONE,
+			requirement.resource,
+			requirement.subresource,
+			state,
+			requirement.state
+		});
+		registered.isDecaying[requirement.subresource] = registered.promotion == StatePromotion::ANY_STATE;
+	}
+
+	for (const auto &resource : tracker.mResources) {
+		auto it = mResources.find(resource.first);
+		if (it == mResources.end()) {
+			continue;
+		}
+
+		RegisteredResource &registered = it->second;
+		const auto &subresources = resource.second.subresources;
+		for (std::uint32_t i = 0; i < subresources.size(); i++) {
+			if (subresources[i].state == ResourceStateTracker::UNKNOWN_STATE) {
+				continue;
+			}
+
+			registered.states[i] = subresources[i].state;
+			if (registered.promotion == StatePromotion::ANY_STATE) {
+				registered.isDecaying[i] = true;
+			} else if (subresources[i].isTransitioned) {
+				registered.isDecaying[i] = false;
+			}
+		}
+	}
+}
+
+
+void ResourceStateRegistry::DecayStates() {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for (auto &resource : mResources) {
+		RegisteredResource &registered = resource.second;
+		for (std::size_t i = 0; i < registered.states.size(); i++) {
+			if (registered.isDecaying[i]) {
+				registered.states[i] = ResourceState::COMMON;
+				registered.isDecaying[i] = false;
+			}
+		}
+	}
+}
+
+
+ResourceStateRegistry::RegisteredResource& ResourceStateRegistry::FindRegistered(void *resource) {
+	auto it = mResources.find(resource);
+	if (it == mResources.end()) {
+		throw std::logic_error("Resource state isn't registered");
+	}
+
+	return it->second;
+}
+
+
+ResourceStateTracker::ResourceStateTracker(ResourceStateRegistry *registry)
+: mRegistry(registry) {
+}
+
+
+void ResourceStateTracker::Transition(void *resource, std::uint32_t subresource, ResourceState state) {
+	Resource &tracked = FindResource(resource);
+
+	if (subresource != ALL_SUBRESOURCES) {
+		TransitionSubresource(resource, tracked, subresource, state);
+		return;
+	}
+
+	for (std::uint32_t i = 0; i < tracked.subresources.size(); i++) {
+		TransitionSubresource(resource, tracked, i, state);
+	}
+}
+
+
+void ResourceStateTracker::BeginTransition(void *resource, std::uint32_t subresource, ResourceState state) {
+	Resource &tracked = FindResource(resource);
+
+	if (subresource != ALL_SUBRESOURCES) {
+		BeginTransitionSubresource(resource, tracked, subresource, state);
+		return;
+	}
+
+	for (std::uint32_t i = 0; i < tracked.subresources.size(); i++) {
+		BeginTransitionSubresource(resource, tracked, i, state);
+	}
+}
+
+
+void ResourceStateTracker::UavBarrier(void *resource) {
+	mPendingBarriers.push_back(PendingBarrier{
+		TrackedBarrier{
+			TrackedBarrier::Type::UAV,
+			TrackedBarrier::Split::NONE,
+			resource,
+			ALL_SUBRESOURCES,
+			ResourceState::UNORDERED_ACCESS,
+			ResourceState::UNORDERED_ACCESS
+		},
+		nullptr,
+		false
+	});
+}
+
+
+void ResourceStateTracker::Flush(std::vector<TrackedBarrier> &barriers) {
+	for (std::size_t i = 0; i < mPendingBarriers.size(); i++) {
+		const PendingBarrier &pending = mPendingBarriers[i];
+		if (pending.isRemoved) {
+			continue;
+		}
+
+		// Transitions of every subresource to the same state become one barrier
+		const TrackedBarrier &barrier = pending.barrier;
+		std::size_t runEnd = i + 1;
+		if (barrier.type == TrackedBarrier::Type::TRANSITION && barrier.subresource == 0) {
+			while (
+				runEnd < mPendingBarriers.size()
+				&& !mPendingBarriers[runEnd].isRemoved
+				&& mPendingBarriers[runEnd].barrier.type == barrier.type
+				&& mPendingBarriers[runEnd].barrier.split == barrier.split
+				&& mPendingBarriers[runEnd].barrier.resource == barrier.resource
+				&& mPendingBarriers[runEnd].barrier.subresource == runEnd - i
+				&& mPendingBarriers[runEnd].barrier.before == barrier.before
+				&& mPendingBarriers[runEnd].barrier.after == barrier.after
+			) {
+				runEnd++;
+			}
+		}
+
+		if (runEnd - i > 1 && runEnd - i == mResources[barrier.resource].subresources.size()) {
+			TrackedBarrier allSubresources = barrier;
+			allSubresources.subresource = ALL_SUBRESOURCES;
+			barriers.push_back(allSubresources);
+			i = runEnd - 1;
+		} else {
+			barriers.push_back(barrier);
+		}
+	}
+
+	for (PendingBarrier &pending : mPendingBarriers) {
+		if (pending.subresource != nullptr) {
+			pending.subresource->pendingBarrier = NO_BARRIER;
+			pending.subresource->isTransitioned |= !pending.isRemoved;
+		}
+	}
+
+	mPendingBarriers.clear();
+	mFlushesCount++;
+}
+
+
+void ResourceStateTracker::Finish(std::vector<TrackedBarrier> &barriers) {
+	for (auto &resource : mResources) {
+		auto &subresources = resource.second.subresources;
+		for (std::uint32_t i = 0; i < subresources.size(); i++) {
+			if (subresources[i].isSplit) {
+				EndSplit(resource.first, i, subresources[i]);
+			}
+		}
+	}
+
+	Flush(barriers);
+}
+
+
+void ResourceStateTracker::Reset() {
+	mResources.clear();
+	mPendingBarriers.clear();
+	mRequirements.clear();
+}
+
+
+ResourceStateTracker::Resource& ResourceStateTracker::FindResource(void *resource) {
+	auto it = mResources.find(resource);
+	if (it != mResources.end()) {
+		return it->second;
+	}
+
+	assert(mRegistry != nullptr);
+
+	Resource &tracked = mResources[resource];
+	tracked.subresources.resize(mRegistry->SubresourcesCount(resource));
+
+	return tracked;
+}
+
+
+void ResourceStateTracker::TransitionSubresource(
+	void *resource,
+	Resource &tracked,
+	std::uint32_t subresource,
+	ResourceState state
+) {
+	assert(subresource < tracked.subresources.size());
+	Subresource &current = tracked.subresources[subresource];
+
+	if (current.isSplit) {
+		const bool isExpected = current.splitState == state;
+		EndSplit(resource, subresource, current);
+
+		if (isExpected) {
+			return;
+		}
+	}
+
+	if (current.state == UNKNOWN_STATE) {
+		mRequirements.push_back(Requirement{ resource, subresource, state });
+		current.state = state;
+		return;
+	}
+
+	if (ContainsState(current.state, state)) {
+		return;
+	}
+
+	if (current.pendingBarrier != NO_BARRIER) {
+		PendingBarrier &pending = mPendingBarriers[current.pendingBarrier];
+		pending.barrier.after = state;
+
+		if (pending.barrier.before == state) {
+			pending.isRemoved = true;
+			current.pendingBarrier = NO_BARRIER;
+		}
+
+		current.state = state;
+		return;
+	}
+
+	AddBarrier(TrackedBarrier::Split::NONE, resource, subresource, current.state, state, &current);
+	current.pendingBarrier = static_cast<std::uint32_t>(mPendingBarriers.size() - 1);
+	current.state = state;
+}
+
+
+void ResourceStateTracker::BeginTransitionSubresource(
+	void *resource,
+	Resource &tracked,
+	std::uint32_t subresource,
+	ResourceState state
+) {
+	assert(subresource < tracked.subresources.size());
+	Subresource &current = tracked.subresources[subresource];
+
+	// The state before a split must be known during recording
+	if (current.isSplit || current.state == UNKNOWN_STATE || current.state == state) {
+		return;
+	}
+
+	AddBarrier(TrackedBarrier::Split::BEGIN_ONLY, resource, subresource, current.state, state, nullptr);
+
+	current.isSplit = true;
+	current.splitState = state;
+	current.splitFlush = mFlushesCount;
+	current.splitBarrier = static_cast<std::uint32_t>(mPendingBarriers.size() - 1);
+}
+
+
+void ResourceStateTracker::EndSplit(void *resource, std::uint32_t subresource, Subresource &tracked) {
+	if (tracked.splitFlush == mFlushesCount) {
+		// Nothing was recorded in between, a whole barrier is enough. It's the
+		// last one of the subresource in the batch, later transitions merge into
+		// it instead of the barrier pending before the split
+		PendingBarrier &pending = mPendingBarriers[tracked.splitBarrier];
+		pending.barrier.split = TrackedBarrier::Split::NONE;
+		pending.subresource = &tracked;
+		tracked.pendingBarrier = tracked.splitBarrier;
+	} else {
+		AddBarrier(TrackedBarrier::Split::END_ONLY, resource, subresource, tracked.state, tracked.splitState, nullptr);
+		tracked.pendingBarrier = NO_BARRIER;
+		tracked.isTransitioned = true;
+	}
+
+	tracked.state = tracked.splitState;
+	tracked.isSplit = false;
+}
+
+
+void ResourceStateTracker::AddBarrier(
+	TrackedBarrier::Split split,
+	void *resource,
+	std::uint32_t subresource,
+	ResourceState before,
+	ResourceState after,
+	Subresource *tracked
+) {
+	mPendingBarriers.push_back(PendingBarrier{
+		TrackedBarrier{ TrackedBarrier::Type::TRANSITION, split, resource, subresource, before, after },
+		tracked,
+		false
+	});
+}
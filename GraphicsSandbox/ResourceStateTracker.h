@@ -0,0 +1,196 @@
+#pragma once
+
+
+#include "ResourceState.h"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+// D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+constexpr std::uint32_t ALL_SUBRESOURCES = 0xffffffff;
+
+
+// Barrier in a form that maps to D3D12_RESOURCE_BARRIER one to one
+struct TrackedBarrier {
+	enum class Type {
+		TRANSITION,
+		UAV
+	};
+
+	// Values of D3D12_RESOURCE_BARRIER_FLAGS
+	enum class Split {
+		NONE = 0,
+		BEGIN_ONLY = 1,
+		END_ONLY = 2
+	};
+
+	Type type;
+	Split split;
+	void *resource;
+	std::uint32_t subresource;
+	ResourceState before;
+	ResourceState after;
+};
+
+
+// Which states a resource in the COMMON state is promoted to by its first use
+// without a barrier, and when it decays back to COMMON
+enum class StatePromotion {
+	// Textures without simultaneous access: to shader resource and copy states.
+	// Only the ones promoted to read-only states decay
+	TEXTURE,
+	// Buffers and textures with simultaneous access: to any state, and they
+	// always decay
+	ANY_STATE
+};
+
+
+class ResourceStateTracker;
+
+
+// States of resources between command lists, in the order the lists are submitted.
+//
+// Resources are identified by their addresses, e.g. ID3D12Resource pointers, and
+// must be registered before command lists use them.
+//
+// Implicit promotion and decay follow the rules of D3D12: the first use of a
+// subresource in the COMMON state needs no barrier if it can be promoted to the
+// state, and decaying subresources are in the COMMON state again once the
+// ExecuteCommandLists call that used them completes.
+//
+// This class is thread-safe
+class ResourceStateRegistry {
+public:
+	ResourceStateRegistry() = default;
+	ResourceStateRegistry(const ResourceStateRegistry&) = delete;
+
+	ResourceStateRegistry& operator = (const ResourceStateRegistry&) = delete;
+
+	void Register(
+		void *resource,
+		std::uint32_t subresourcesCount,
+		ResourceState state,
+		StatePromotion promotion = StatePromotion::TEXTURE
+	);
+	void Unregister(void *resource);
+
+	std::uint32_t SubresourcesCount(void *resource);
+
+	// Called at submission of the list the tracker recorded. Appends transitions
+	// to the states the list expects at its beginning and stores the states the
+	// list leaves the resources in
+	void Resolve(const ResourceStateTracker &tracker, std::vector<TrackedBarrier> &barriers);
+
+	// Called after the lists of one ExecuteCommandLists call are resolved, the
+	// lists submitted later see the decayed states
+	void DecayStates();
+
+private:
+	struct RegisteredResource {
+		StatePromotion promotion;
+		std::vector<ResourceState> states;
+		// Subresources that return to COMMON at the end of the submission
+		std::vector<bool> isDecaying;
+	};
+
+	RegisteredResource& FindRegistered(void *resource);
+
+private:
+	std::mutex mMutex;
+	std::unordered_map<void*, RegisteredResource> mResources;
+};
+
+
+// States of the subresources used by one command list.
+//
+// Transitions are collected until Flush and come out as one batch. Transitions
+// of a subresource within a batch are merged, and the ones that bring it back to
+// its state are dropped. The state of a subresource at the first use in the list
+// isn't known during recording, so the first use only records a requirement that
+// ResourceStateRegistry resolves at submission.
+//
+// BeginTransition tells that a subresource will need a state later. If a batch
+// is flushed before the transition, it is split into BEGIN_ONLY and END_ONLY
+// barriers, so the GPU can do it while the work in between runs.
+//
+// This class is not thread-safe
+class ResourceStateTracker {
+	friend ResourceStateRegistry;
+
+public:
+	explicit ResourceStateTracker(ResourceStateRegistry *registry = nullptr);
+
+	void Transition(void *resource, std::uint32_t subresource, ResourceState state);
+	void BeginTransition(void *resource, std::uint32_t subresource, ResourceState state);
+	void UavBarrier(void *resource);
+
+	// Moves out the barriers collected since the previous flush
+	void Flush(std::vector<TrackedBarrier> &barriers);
+
+	// Ends the split barriers in progress and flushes, must be called before the
+	// list is closed
+	void Finish(std::vector<TrackedBarrier> &barriers);
+
+	void Reset();
+
+private:
+	static constexpr std::uint32_t NO_BARRIER = UINT32_MAX;
+
+	// Not a valid D3D12 state
+	static constexpr ResourceState UNKNOWN_STATE = static_cast<ResourceState>(0xffffffff);
+
+	struct Subresource {
+		ResourceState state = UNKNOWN_STATE;
+		// Pending barrier that later transitions can be merged into
+		std::uint32_t pendingBarrier = NO_BARRIER;
+		// A barrier of the list changed the state, so it isn't a promoted one
+		bool isTransitioned = false;
+
+		bool isSplit = false;
+		ResourceState splitState;
+		std::uint64_t splitFlush;
+		std::uint32_t splitBarrier;
+	};
+
+	struct Resource {
+		std::vector<Subresource> subresources;
+	};
+
+	struct PendingBarrier {
+		TrackedBarrier barrier;
+		Subresource *subresource;
+		bool isRemoved;
+	};
+
+	struct Requirement {
+		void *resource;
+		std::uint32_t subresource;
+		ResourceState state;
+	};
+
+	Resource& FindResource(void *resource);
+
+	void TransitionSubresource(void *resource, Resource &tracked, std::uint32_t subresource, ResourceState state);
+	void BeginTransitionSubresource(void *resource, Resource &tracked, std::uint32_t subresource, ResourceState state);
+	void EndSplit(void *resource, std::uint32_t subresource, Subresource &tracked);
+
+	void AddBarrier(
+		TrackedBarrier::Split split,
+		void *resource,
+		std::uint32_t subresource,
+		ResourceState before,
+		ResourceState after,
+		Subresource *tracked
+	);
+
+private:
+	ResourceStateRegistry *mRegistry;
+
+	std::unordered_map<void*, Resource> mResources;
+	std::vector<PendingBarrier> mPendingBarriers;
+	std::vector<Requirement> mRequirements;
+	std::uint64_t mFlushesCount = 0;
+};
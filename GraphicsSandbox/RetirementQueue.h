@@ -0,0 +1,57 @@
+#pragma once
+
+
+#include <cstddef>
+#include <deque>
+#include <utility>
+
+
+// Queue of items that the GPU may still be using.
+//
+// An item is released together with the fence label put after its last use and
+// becomes available again only when that label completes. Items are expected to
+// be released in label order, so only the oldest one has to be checked.
+//
+// Fence is any type with a Label and IsComplete(const Label&), e.g.
+// WaitableGpuFence or CpuTimelineFence.
+//
+// This class is not thread-safe
+template <typename Fence, typename Item>
+class RetirementQueue {
+public:
+	using Label = typename Fence::Label;
+
+public:
+	explicit RetirementQueue(Fence &fence)
+	: mFence(&fence) {
+	}
+
+	void Release(Item item, const Label &label) {
+		mRetiring.push_back(RetiringItem{ std::move(item), label });
+	}
+
+	// Moves the oldest item out if its label is complete
+	bool TryAcquire(Item &item) {
+		if (mRetiring.empty() || !mFence->IsComplete(mRetiring.front().label)) {
+			return false;
+		}
+
+		item = std::move(mRetiring.front().item);
+		mRetiring.pop_front();
+
+		return true;
+	}
+
+	std::size_t RetiringCount() const {
+		return mRetiring.size();
+	}
+
+private:
+	struct RetiringItem {
+		Item item;
+		Label label;
+	};
+
+	Fence *mFence;
+	std::deque<RetiringItem> mRetiring;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+
+
+// Sub-allocator of a fixed-size ring whose space is reclaimed by fence labels.
+//
+// Ranges are allocated at the tail. Retire closes the ranges allocated since the
+// previous call with a label, and they are reclaimed from the head once the label
+// completes. A range never wraps around the end, the skipped tail is reclaimed
+// together with it.
+//
+// Fence is any type with a Label, IsComplete(const Label&) and
+// WaitForLabel(const Label&), e.g. WaitableGpuFence or CpuTimelineFence.
+// Offsets and sizes are in arbitrary units: bytes, descriptors, ...
+//
+// This class is not thread-safe
+template <typename Fence>
+class RingAllocator {
+public:
+	using Label = typename Fence::Label;
+
+	static constexpr std::uint64_t INVALID_OFFSET = UINT64_MAX;
+
+public:
+	RingAllocator(Fence &fence, std::uint64_t capacity)
+	: mFence(fence), mCapacity(capacity) {
+	}
+
+	RingAllocator(const RingAllocator&) = delete;
+
+	RingAllocator& operator = (const RingAllocator&) = delete;
+
+	// Alignment must be a power of two. Reclaims completed ranges if there is no
+	// room, returns INVALID_OFFSET if there is still no room
+	std::uint64_t Allocate(std::uint64_t size, std::uint64_t alignment = 1);
+
+	// Ranges allocated since the previous call are reclaimed once the label completes
+	void Retire(const Label &label);
+
+	void ReclaimCompleted();
+
+	// Blocks until the oldest retired ranges can be reclaimed.
+	// Returns false if nothing is retired
+	bool WaitAndReclaimOldest();
+
+	std::uint64_t Capacity() const {
+		return mCapacity;
+	}
+
+	std::uint64_t UsedSize() const {
+		return mTail - mHead;
+	}
+
+private:
+	std::uint64_t TryAllocate(std::uint64_t size, std::uint64_t alignment);
+
+private:
+	struct RetiredRange {
+		Label label;
+		std::uint64_t end;
+	};
+
+	Fence &mFence;
+	const std::uint64_t mCapacity;
+
+	// Both only grow, the position in the ring is the value modulo capacity
+	std::uint64_t mHead = 0;
+	std::uint64_t mTail = 0;
+
+	std::deque<RetiredRange> mRetired;
+};
+
+
+template <typename Fence>
+std::uint64_t RingAllocator<Fence>::Allocate(std::uint64_t size, std::uint64_t alignment) {
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	std::uint64_t offset = TryAllocate(size, alignment);
+	if (offset == INVALID_OFFSET) {
+		ReclaimCompleted();
+		offset = TryAllocate(size, alignment);
+	}
+
+	return offset;
+}
+
+
+template <typename Fence>
+void RingAllocator<Fence>::Retire(const Label &label) {
+	if (!mRetired.empty() && mRetired.back().end == mTail) {
+		// Nothing was allocated, the previous range covers everything
+		mRetired.back().label = label;
+		return;
+	}
+
+	mRetired.push_back(RetiredRange{ label, mTail });
+}
+
+
+template <typename Fence>
+void RingAllocator<Fence>::ReclaimCompleted() {
+	while (!mRetired.empty() && mFence.IsComplete(mRetired.front().label)) {
+		mHead = mRetired.front().end;
+		mRetired.pop_front();
+	}
+}
+
+
+template <typename Fence>
+bool RingAllocator<Fence>::WaitAndReclaimOldest() {
+	if (mRetired.empty()) {
+		return false;
+	}
+
+	mFence.WaitForLabel(mRetired.front().label);
+	ReclaimCompleted();
+
+	return true;
+}
+
+
+template <typename Fence>
+std::uint64_t RingAllocator<Fence>::TryAllocate(std::uint64_t size, std::uint64_t alignment) {
+	if (mHead == mTail) {
+		// The ring is empty, start over from the beginning so any size fits
+		mTail += (mCapacity - mTail % mCapacity) % mCapacity;
+		mHead = mTail;
+	}
+
+	const std::uint64_t position = mTail % mCapacity;
+	std::uint64_t offset = (position + alignment - 1) & ~(alignment - 1);
+
+	if (offset + size > mCapacity) {
+		// Skips the rest of the ring, the beginning is aligned for any alignment
+		offset = 0;
+	}
+
+	const std::uint64_t padding = offset >= position ? offset - position : mCapacity - position;
+	if (UsedSize() + padding + size > mCapacity) {
+		return INVALID_OFFSET;
+	}
+
+	mTail += padding + size;
+	return offset;
+}
@@ -0,0 +1,241 @@
+#include "RootSignatureCache.h"
+#include "d3dx12.h"
+
+#include <stdexcept>
+#include <type_traits>
+
+
+namespace {
+	using Bytes = std::vector<std::uint8_t>;
+
+
+	template <typename T>
+	void Encode(Bytes &bytes, const T &value) {
+		// Structs are encoded field by field to leave their padding out
+		static_assert(std::is_scalar<T>::value, "Only scalars can be encoded as they are");
+
+		const std::uint8_t *begin = reinterpret_cast<const std::uint8_t*>(&value);
+		bytes.insert(bytes.end(), begin, begin + sizeof(value));
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_STATIC_SAMPLER_DESC &sampler) {
+		Encode(bytes, sampler.Filter);
+		Encode(bytes, sampler.AddressU);
+		Encode(bytes, sampler.AddressV);
+		Encode(bytes, sampler.AddressW);
+		Encode(bytes, sampler.MipLODBias);
+		Encode(bytes, sampler.MaxAnisotropy);
+		Encode(bytes, sampler.ComparisonFunc);
+		Encode(bytes, sampler.BorderColor);
+		Encode(bytes, sampler.MinLOD);
+		Encode(bytes, sampler.MaxLOD);
+		Encode(bytes, sampler.ShaderRegister);
+		Encode(bytes, sampler.RegisterSpace);
+		Encode(bytes, sampler.ShaderVisibility);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_DESCRIPTOR_RANGE &range) {
+		Encode(bytes, range.RangeType);
+		Encode(bytes, range.NumDescriptors);
+		Encode(bytes, range.BaseShaderRegister);
+		Encode(bytes, range.RegisterSpace);
+		Encode(bytes, range.OffsetInDescriptorsFromTableStart);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_DESCRIPTOR_RANGE1 &range) {
+		Encode(bytes, range.RangeType);
+		Encode(bytes, range.NumDescriptors);
+		Encode(bytes, range.BaseShaderRegister);
+		Encode(bytes, range.RegisterSpace);
+		Encode(bytes, range.Flags);
+		Encode(bytes, range.OffsetInDescriptorsFromTableStart);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_ROOT_CONSTANTS &constants) {
+		Encode(bytes, constants.ShaderRegister);
+		Encode(bytes, constants.RegisterSpace);
+		Encode(bytes, constants.Num32BitValues);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_ROOT_DESCRIPTOR &descriptor) {
+		Encode(bytes, descriptor.ShaderRegister);
+		Encode(bytes, descriptor.RegisterSpace);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_ROOT_DESCRIPTOR1 &descriptor) {
+		Encode(bytes, descriptor.ShaderRegister);
+		Encode(bytes, descriptor.RegisterSpace);
+		Encode(bytes, descriptor.Flags);
+	}
+
+
+	// Both versions of the description have the same layout apart from the types
+	// of ranges and descriptors
+	template <typename RootSignatureDesc>
+	void EncodeDesc(Bytes &bytes, const RootSignatureDesc &desc) {
+		Encode(bytes, desc.NumParameters);
+		for (UINT i = 0; i < desc.NumParameters; i++) {
+			const auto &parameter = desc.pParameters[i];
+			Encode(bytes, parameter.ParameterType);
+			Encode(bytes, parameter.ShaderVisibility);
+
+			switch (parameter.ParameterType) {
+			case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+				Encode(bytes, parameter.DescriptorTable.NumDescriptorRanges);
+				for (UINT j = 0; j < parameter.DescriptorTable.NumDescriptorRanges; j++) {
+					Encode(bytes, parameter.DescriptorTable.pDescriptorRanges[j]);
+				}
+				break;
+
+			case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+				Encode(bytes, parameter.Constants);
+				break;
+
+			default:
+				Encode(bytes, parameter.Descriptor);
+				break;
+			}
+		}
+
+		Encode(bytes, desc.NumStaticSamplers);
+		for (UINT i = 0; i < desc.NumStaticSamplers; i++) {
+			Encode(bytes, desc.pStaticSamplers[i]);
+		}
+
+		Encode(bytes, desc.Flags);
+	}
+
+
+	void Encode(Bytes &bytes, const D3D12_VERSIONED_ROOT_SIGNATURE_DESC &desc) {
+		Encode(bytes, desc.Version);
+
+		if (desc.Version == D3D_ROOT_SIGNATURE_VERSION_1_0) {
+			EncodeDesc(bytes, desc.Desc_1_0);
+		} else {
+			EncodeDesc(bytes, desc.Desc_1_1);
+		}
+	}
+}
+
+
+RootSignatureCache::RootSignatureCache(GraphicsDevice &device, PipelineStateCache &pipelineStates, std::string filePath)
+: mDevice(device.GetD3dDevice()), mPipelineStates(pipelineStates), mFilePath(std::move(filePath)), mFile(FILE_MAGIC) {
+	D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
+	featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+
+	// Runtimes that don't know version 1.1 fail the query
+	if (FAILED(mDevice->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(featureData)))) {
+		featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+	}
+
+	mHighestVersion = featureData.HighestVersion;
+
+	// A missing or outdated file only means that every signature is serialized
+	mFile.Load(mFilePath);
+}
+
+
+RootSignatureCache::~RootSignatureCache() {
+	std::lock_guard<std::mutex> lock(mCreatedMutex);
+	for (ID3D12RootSignature *rootSignature : mCreated) {
+		mPipelineStates.RemoveRootSignatureHash(rootSignature);
+	}
+}
+
+
+ComPtr<ID3D12RootSignature> RootSignatureCache::GetOrCreate(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC &desc) {
+	++mRequestsCount;
+
+	// The serialized blob depends on the version it's converted to
+	Bytes key;
+	Encode(key, mHighestVersion);
+	Encode(key, desc);
+
+	bool isCreated;
+	ComPtr<ID3D12RootSignature> rootSignature = mRootSignatures.GetOrCreate(
+		key,
+		[&]() { return Create(key, desc); },
+		isCreated
+	);
+
+	if (!isCreated) {
+		++mSharedCount;
+	}
+
+	return rootSignature;
+}
+
+
+void RootSignatureCache::Save() {
+	std::lock_guard<std::mutex> lock(mFileMutex);
+
+	if (mFile.HasNewEntries()) {
+		mFile.Save(mFilePath);
+	}
+}
+
+
+RootSignatureCache::Statistics RootSignatureCache::GetStatistics() {
+	Statistics statistics;
+	statistics.requestsCount = mRequestsCount;
+	statistics.sharedCount = mSharedCount;
+	statistics.signaturesCount = static_cast<UINT>(mRootSignatures.Size());
+	statistics.fileHitsCount = mFileHitsCount;
+
+	return statistics;
+}
+
+
+ComPtr<ID3D12RootSignature> RootSignatureCache::Create(const Bytes &key, const D3D12_VERSIONED_ROOT_SIGNATURE_DESC &desc) {
+	const std::uint64_t keyHash = HashBytes(key.data(), key.size());
+
+	ComPtr<ID3D12RootSignature> rootSignature;
+
+	{
+		// Held while creating, Save can replace the mapping the blob is in
+		std::lock_guard<std::mutex> lock(mFileMutex);
+
+		BlobCacheFile::Blob blob;
+		if (mFile.Find(key.data(), key.size(), keyHash, blob)) {
+			// A corrupted blob fails creation, the signature is serialized again then
+			if (SUCCEEDED(mDevice->CreateRootSignature(0, blob.data, blob.size, IID_PPV_ARGS(&rootSignature)))) {
+				++mFileHitsCount;
+			}
+		}
+	}
+
+	if (!rootSignature) {
+		ComPtr<ID3DBlob> blob;
+		ComPtr<ID3DBlob> errors;
+
+		const HRESULT hr = D3DX12SerializeVersionedRootSignature(&desc, mHighestVersion, &blob, &errors);
+		if (FAILED(hr)) {
+			if (errors) {
+				throw std::runtime_error(static_cast<const char*>(errors->GetBufferPointer()));
+			}
+
+			throw D3dException(hr, __FILE__, __LINE__);
+		}
+
+		D3D_CHECK(mDevice->CreateRootSignature(
+			0, blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&rootSignature)
+		));
+
+		std::lock_guard<std::mutex> lock(mFileMutex);
+		mFile.Insert(key.data(), key.size(), keyHash, blob->GetBufferPointer(), blob->GetBufferSize());
+	}
+
+	// Pipelines that use the signature are keyed by its description
+	mPipelineStates.SetRootSignatureHash(rootSignature.Get(), keyHash);
+
+	std::lock_guard<std::mutex> lock(mCreatedMutex);
+	mCreated.push_back(rootSignature.Get());
+
+	return rootSignature;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "PipelineStateCache.h"
+#include "BlobCacheFile.h"
+#include "SharedObjectCache.h"
+#include "Hash.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+// Root signatures shared by every pipeline with the same description.
+//
+// Descriptions are compared by content, so signatures built separately for
+// different pipelines end up as one object. Serialized blobs are kept in a
+// memory-mapped file, so the next runs create the signatures without
+// serializing them. Every signature is registered with the pipeline state
+// cache under the hash of its description.
+//
+// This class is thread-safe
+class RootSignatureCache {
+public:
+	struct Statistics {
+		UINT requestsCount = 0;
+		// Requests served by a signature that was already created, each one saves a rebind
+		// between pipelines that use it
+		UINT sharedCount = 0;
+		UINT signaturesCount = 0;
+		// Signatures created from the blobs in the file
+		UINT fileHitsCount = 0;
+	};
+
+public:
+	// The file is loaded if it exists, it is only written by Save
+	RootSignatureCache(GraphicsDevice &device, PipelineStateCache &pipelineStates, std::string filePath);
+	RootSignatureCache(const RootSignatureCache&) = delete;
+	~RootSignatureCache();
+
+	RootSignatureCache& operator = (const RootSignatureCache&) = delete;
+
+	ComPtr<ID3D12RootSignature> GetOrCreate(const D3D12_VERSIONED_ROOT_SIGNATURE_DESC &desc);
+
+	// Writes the blobs to the file if there are new ones
+	void Save();
+
+	Statistics GetStatistics();
+
+private:
+	struct KeyHash {
+		std::size_t operator () (const std::vector<std::uint8_t> &key) const {
+			return static_cast<std::size_t>(HashBytes(key.data(), key.size()));
+		}
+	};
+
+private:
+	ComPtr<ID3D12RootSignature> Create(const std::vector<std::uint8_t> &key, const D3D12_VERSIONED_ROOT_SIGNATURE_DESC &desc);
+
+private:
+	static constexpr std::uint32_t FILE_MAGIC = 0x43535452; // "RTSC"
+
+	ComPtr<ID3D12Device> mDevice;
+	PipelineStateCache &mPipelineStates;
+	const std::string mFilePath;
+	D3D_ROOT_SIGNATURE_VERSION mHighestVersion;
+
+	SharedObjectCache<std::vector<std::uint8_t>, ComPtr<ID3D12RootSignature>, KeyHash> mRootSignatures;
+
+	std::mutex mFileMutex;
+	BlobCacheFile mFile;
+
+	// Registered with the pipeline state cache, unregistered on destruction
+	std::mutex mCreatedMutex;
+	std::vector<ID3D12RootSignature*> mCreated;
+
+	std::atomic<UINT> mRequestsCount{0};
+	std::atomic<UINT> mSharedCount{0};
+	std::atomic<UINT> mFileHitsCount{0};
+};
@@ -0,0 +1,40 @@
+#include "ShaderCache.h"
+#include "Hash.h"
+
+#include <vector>
+
+
+ShaderCache::ShaderCache(const std::string &packPath, const std::string &indexPath)
+: mPack(packPath, indexPath) {
+}
+
+
+bool ShaderCache::Find(const ShaderKey &key, Bytecode &bytecode) {
+	const std::vector<std::uint8_t> keyBytes = key.Serialize();
+
+	if (mPack.Find(keyBytes.data(), keyBytes.size(), HashBytes(keyBytes.data(), keyBytes.size()), bytecode)) {
+		++mHitsCount;
+		return true;
+	}
+
+	++mMissesCount;
+	return false;
+}
+
+
+void ShaderCache::Store(const ShaderKey &key, const void *bytecode, std::size_t size) {
+	const std::vector<std::uint8_t> keyBytes = key.Serialize();
+
+	mPack.Append(keyBytes.data(), keyBytes.size(), HashBytes(keyBytes.data(), keyBytes.size()), bytecode, size);
+	++mStoredCount;
+}
+
+
+ShaderCache::Statistics ShaderCache::GetStatistics() {
+	Statistics statistics;
+	statistics.hitsCount = mHitsCount;
+	statistics.missesCount = mMissesCount;
+	statistics.storedCount = mStoredCount;
+
+	return statistics;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+
+#include "ShaderKey.h"
+#include "ShaderPackFile.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// Compiled shader bytecode kept across runs in a ShaderPackFile.
+//
+// This class is thread-safe
+class ShaderCache {
+public:
+	using Bytecode = ShaderPackFile::Blob;
+
+	struct Statistics {
+		std::uint32_t hitsCount = 0;
+		std::uint32_t missesCount = 0;
+		std::uint32_t storedCount = 0;
+	};
+
+public:
+	ShaderCache(const std::string &packPath, const std::string &indexPath);
+	ShaderCache(const ShaderCache&) = delete;
+
+	ShaderCache& operator = (const ShaderCache&) = delete;
+
+	bool Find(const ShaderKey &key, Bytecode &bytecode);
+
+	void Store(const ShaderKey &key, const void *bytecode, std::size_t size);
+
+	Statistics GetStatistics();
+
+private:
+	ShaderPackFile mPack;
+
+	std::atomic<std::uint32_t> mHitsCount{0};
+	std::atomic<std::uint32_t> mMissesCount{0};
+	std::atomic<std::uint32_t> mStoredCount{0};
+};
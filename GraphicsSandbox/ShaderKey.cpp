@@ -0,0 +1,40 @@
+#include "ShaderKey.h"
+
+#include <algorithm>
+
+
+namespace {
+	void Append(std::vector<std::uint8_t> &bytes, std::uint64_t value) {
+		for (int i = 0; i < 8; i++) {
+			bytes.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+		}
+	}
+
+
+	void Append(std::vector<std::uint8_t> &bytes, const std::string &string) {
+		// Length-prefixed, so no two sequences of strings encode the same
+		Append(bytes, static_cast<std::uint64_t>(string.size()));
+		bytes.insert(bytes.end(), string.begin(), string.end());
+	}
+}
+
+
+std::vector<std::uint8_t> ShaderKey::Serialize() const {
+	std::vector<std::pair<std::string, std::string>> sortedDefines = defines;
+	std::sort(sortedDefines.begin(), sortedDefines.end());
+
+	std::vector<std::uint8_t> bytes;
+	Append(bytes, sourceHash);
+	Append(bytes, includesHash);
+	Append(bytes, profile);
+	Append(bytes, entryPoint);
+	Append(bytes, compiler);
+
+	Append(bytes, static_cast<std::uint64_t>(sortedDefines.size()));
+	for (const auto &define : sortedDefines) {
+		Append(bytes, define.first);
+		Append(bytes, define.second);
+	}
+
+	return bytes;
+}
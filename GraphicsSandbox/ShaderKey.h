@@ -0,0 +1,27 @@
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Everything that decides the bytecode a shader compiles to.
+//
+// The include tree is given by one hash, e.g. the hashes of the included files
+// combined in the order they're included, so a changed header invalidates the
+// shaders that include it. The compiler is identified by a string of its
+// version and options, so bytecode of another compiler or other flags, e.g. a
+// debug build, is never found.
+struct ShaderKey {
+	std::uint64_t sourceHash = 0;
+	std::uint64_t includesHash = 0;
+	std::vector<std::pair<std::string, std::string>> defines;
+	std::string entryPoint;
+	std::string profile;
+	std::string compiler;
+
+	// The same for keys that differ only in the order of their defines
+	std::vector<std::uint8_t> Serialize() const;
+};
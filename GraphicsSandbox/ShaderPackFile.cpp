@@ -0,0 +1,192 @@
+#include "ShaderPackFile.h"
+
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+
+namespace {
+	constexpr std::size_t ENTRY_ALIGNMENT = 8;
+}
+
+
+ShaderPackFile::ShaderPackFile(const std::string &packPath, const std::string &indexPath)
+: mPackPath(packPath), mIndexPath(indexPath) {
+	Open();
+}
+
+
+bool ShaderPackFile::Find(const void *key, std::size_t keySize, std::uint64_t keyHash, Blob &blob) {
+	std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+	const Entry *entry = FindEntry(key, keySize, keyHash);
+	if (entry == nullptr) {
+		return false;
+	}
+
+	blob.data = std::shared_ptr<const std::uint8_t>(entry->key, entry->key.get() + entry->keySize);
+	blob.size = entry->blobSize;
+
+	return true;
+}
+
+
+void ShaderPackFile::Append(
+	const void *key,
+	std::size_t keySize,
+	std::uint64_t keyHash,
+	const void *blob,
+	std::size_t blobSize
+) {
+	std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+
+	if (FindEntry(key, keySize, keyHash) != nullptr) {
+		return;
+	}
+
+	auto memory = std::make_shared<std::vector<std::uint8_t>>(keySize + blobSize);
+	std::memcpy(memory->data(), key, keySize);
+	std::memcpy(memory->data() + keySize, blob, blobSize);
+
+	const IndexRecord record = {
+		keyHash, mPackSize, static_cast<std::uint32_t>(keySize), static_cast<std::uint32_t>(blobSize)
+	};
+
+	const std::size_t paddingSize = (ENTRY_ALIGNMENT - (keySize + blobSize) % ENTRY_ALIGNMENT) % ENTRY_ALIGNMENT;
+	const char padding[ENTRY_ALIGNMENT] = {};
+
+	// The record is written only once the blob is in the pack
+	mPackWriter.write(reinterpret_cast<const char*>(memory->data()), memory->size());
+	mPackWriter.write(padding, paddingSize);
+	mPackWriter.flush();
+	if (!mPackWriter) {
+		throw std::runtime_error("Can't write shader pack " + mPackPath);
+	}
+
+	mIndexWriter.write(reinterpret_cast<const char*>(&record), sizeof(record));
+	mIndexWriter.flush();
+	if (!mIndexWriter) {
+		throw std::runtime_error("Can't write shader pack index " + mIndexPath);
+	}
+
+	mPackSize += memory->size() + paddingSize;
+
+	Entry entry;
+	entry.key = std::shared_ptr<const std::uint8_t>(memory, memory->data());
+	entry.keySize = keySize;
+	entry.blobSize = blobSize;
+
+	mIndex.emplace(keyHash, std::move(entry));
+}
+
+
+std::size_t ShaderPackFile::EntriesCount() {
+	std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+	return mIndex.size();
+}
+
+
+void ShaderPackFile::Open() {
+	mMappedPack = std::make_shared<MappedFile>();
+
+	FileHeader header;
+	bool isValid = mMappedPack->Open(mPackPath) && mMappedPack->Size() >= sizeof(header);
+	if (isValid) {
+		std::memcpy(&header, mMappedPack->Data(), sizeof(header));
+		isValid = header.magic == PACK_MAGIC && header.version == VERSION;
+	}
+
+	std::ifstream indexReader(mIndexPath, std::ios::binary);
+	isValid = isValid && indexReader.read(reinterpret_cast<char*>(&header), sizeof(header))
+		&& header.magic == INDEX_MAGIC && header.version == VERSION;
+
+	if (!isValid) {
+		indexReader.close();
+		Create();
+		return;
+	}
+
+	const std::size_t packSize = mMappedPack->Size();
+	std::vector<IndexRecord> records;
+
+	IndexRecord record;
+	while (indexReader.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+		// A record past the end of the pack was written by a newer process or the files don't match
+		if (record.offset < sizeof(FileHeader) || record.offset > packSize
+			|| packSize - record.offset < std::uint64_t(record.keySize) + record.blobSize) {
+			break;
+		}
+
+		records.push_back(record);
+	}
+
+	// Either the whole file was read or a record was invalid or cut off by a crash
+	const bool isIndexComplete = indexReader.eof() && indexReader.gcount() == 0;
+	indexReader.close();
+
+	for (const IndexRecord &validRecord : records) {
+		Entry entry;
+		entry.key = std::shared_ptr<const std::uint8_t>(mMappedPack, mMappedPack->Data() + validRecord.offset);
+		entry.keySize = validRecord.keySize;
+		entry.blobSize = validRecord.blobSize;
+
+		mIndex.emplace(validRecord.keyHash, std::move(entry));
+	}
+
+	if (!isIndexComplete) {
+		// Appends must not follow a broken record, the index is rewritten with the valid ones
+		std::ofstream indexWriter(mIndexPath, std::ios::binary | std::ios::trunc);
+		const FileHeader indexHeader = { INDEX_MAGIC, VERSION };
+		indexWriter.write(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
+		indexWriter.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(IndexRecord));
+		if (!indexWriter) {
+			throw std::runtime_error("Can't write shader pack index " + mIndexPath);
+		}
+	}
+
+	mPackWriter.open(mPackPath, std::ios::binary | std::ios::app);
+	mIndexWriter.open(mIndexPath, std::ios::binary | std::ios::app);
+	if (!mPackWriter || !mIndexWriter) {
+		throw std::runtime_error("Can't open shader pack " + mPackPath);
+	}
+
+	mPackSize = packSize;
+}
+
+
+void ShaderPackFile::Create() {
+	// A mapped file can't be truncated on Windows
+	mIndex.clear();
+	mMappedPack = std::make_shared<MappedFile>();
+
+	const FileHeader packHeader = { PACK_MAGIC, VERSION };
+	const FileHeader indexHeader = { INDEX_MAGIC, VERSION };
+
+	mPackWriter.open(mPackPath, std::ios::binary | std::ios::trunc);
+	mPackWriter.write(reinterpret_cast<const char*>(&packHeader), sizeof(packHeader));
+	mPackWriter.flush();
+
+	mIndexWriter.open(mIndexPath, std::ios::binary | std::ios::trunc);
+	mIndexWriter.write(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
+	mIndexWriter.flush();
+
+	if (!mPackWriter || !mIndexWriter) {
+		throw std::runtime_error("Can't create shader pack " + mPackPath);
+	}
+
+	mPackSize = sizeof(packHeader);
+}
+
+
+const ShaderPackFile::Entry* ShaderPackFile::FindEntry(const void *key, std::size_t keySize, std::uint64_t keyHash) const {
+	auto range = mIndex.equal_range(keyHash);
+	for (auto it = range.first; it != range.second; ++it) {
+		const Entry &entry = it->second;
+		if (entry.keySize == keySize && std::memcmp(entry.key.get(), key, keySize) == 0) {
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+
+// Append-only pack of blobs keyed by arbitrary bytes, with an index in a separate file.
+//
+// Opening reads only the index, blobs are read through a mapping of the pack.
+// New blobs are appended to the pack and then their record to the index, so a
+// crash in between leaves an unindexed tail that's never read. Blobs appended
+// since the file was opened are served from memory.
+//
+// A blob keeps the memory it points to alive, it stays valid after the pack is closed.
+//
+// One process may write the pack at a time. Any number of threads may find blobs
+// at the same time, appends wait for them.
+//
+// This class is thread-safe
+class ShaderPackFile {
+public:
+	struct Blob {
+		std::shared_ptr<const std::uint8_t> data;
+		std::size_t size = 0;
+	};
+
+public:
+	// Creates the files if they're missing, empties them if they're invalid
+	ShaderPackFile(const std::string &packPath, const std::string &indexPath);
+	ShaderPackFile(const ShaderPackFile&) = delete;
+
+	ShaderPackFile& operator = (const ShaderPackFile&) = delete;
+
+	bool Find(const void *key, std::size_t keySize, std::uint64_t keyHash, Blob &blob);
+
+	// Does nothing if the key is already in the pack
+	void Append(const void *key, std::size_t keySize, std::uint64_t keyHash, const void *blob, std::size_t blobSize);
+
+	std::size_t EntriesCount();
+
+private:
+	static constexpr std::uint32_t PACK_MAGIC = 0x4B415053; // "SPAK"
+	static constexpr std::uint32_t INDEX_MAGIC = 0x58444953; // "SIDX"
+	static constexpr std::uint32_t VERSION = 1;
+
+	struct FileHeader {
+		std::uint32_t magic;
+		std::uint32_t version;
+	};
+
+	struct IndexRecord {
+		std::uint64_t keyHash;
+		// Of the key, the blob follows it
+		std::uint64_t offset;
+		std::uint32_t keySize;
+		std::uint32_t blobSize;
+	};
+
+	struct Entry {
+		// The mapped pack or the memory of an appended blob
+		std::shared_ptr<const std::uint8_t> key;
+		std::size_t keySize;
+		std::size_t blobSize;
+	};
+
+private:
+	void Open();
+	void Create();
+
+	// Must be called under the lock
+	const Entry* FindEntry(const void *key, std::size_t keySize, std::uint64_t keyHash) const;
+
+private:
+	const std::string mPackPath;
+	const std::string mIndexPath;
+
+	std::shared_timed_mutex mMutex;
+	std::shared_ptr<MappedFile> mMappedPack;
+	std::unordered_multimap<std::uint64_t, Entry> mIndex;
+
+	std::ofstream mPackWriter;
+	std::ofstream mIndexWriter;
+	std::uint64_t mPackSize = 0;
+};
@@ -0,0 +1,252 @@
+#pragma once
+
+
+#include "JobSystem.h"
+#include "ShaderPermutations.h"
+#include "ShaderCache.h"
+#include "Hash.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// Compiles every permutation of a shader on the threads of the job system.
+//
+// Permutations are preprocessed first, and the ones whose preprocessed source
+// is the same, e.g. because a define isn't used, are compiled once. The
+// preprocessed source already has the includes and defines in it, so its hash
+// is also the key of the bytecode in the optional shader cache.
+//
+// Backend does the compilation:
+//   std::string Preprocess(const ShaderSource &source, const ShaderDefines &defines)
+//   std::vector<std::uint8_t> Compile(const ShaderSource &source, const std::string &preprocessedSource)
+//   std::string CompilerIdentity() const
+// CompilerIdentity goes into the cache keys, it must change with anything
+// else that changes the bytecode, e.g. the compiler version and flags.
+// Both must be thread-safe and report errors by throwing an exception derived
+// from std::exception.
+//
+// Compile must be called from a thread of the job system
+template <typename Backend>
+class ShaderPermutationCompiler {
+public:
+	struct Permutation {
+		ShaderDefines defines;
+		ShaderCache::Bytecode bytecode;
+		// Set if preprocessing or compilation failed
+		std::string errors;
+
+		bool IsCompiled() const {
+			return bytecode.data != nullptr;
+		}
+	};
+
+	struct Report {
+		std::size_t permutationsCount = 0;
+		std::size_t preprocessedCount = 0;
+		// Permutations left after removing the ones with the same preprocessed source
+		std::size_t uniqueCount = 0;
+		std::size_t cacheHitsCount = 0;
+		std::size_t compiledCount = 0;
+		std::size_t failedCount = 0;
+		double preprocessingSeconds = 0.0;
+		double compilationSeconds = 0.0;
+		double wallSeconds = 0.0;
+
+		// Share of the preprocessed permutations that didn't need compilation of their own
+		double DedupRatio() const {
+			return preprocessedCount > 0 ? 1.0 - double(uniqueCount) / double(preprocessedCount) : 0.0;
+		}
+	};
+
+public:
+	// The cache may be nullptr
+	ShaderPermutationCompiler(Backend &backend, JobSystem &jobSystem, ShaderCache *cache = nullptr);
+	ShaderPermutationCompiler(const ShaderPermutationCompiler&) = delete;
+
+	ShaderPermutationCompiler& operator = (const ShaderPermutationCompiler&) = delete;
+
+	// The permutations are in the order of ExpandShaderPermutations
+	std::vector<Permutation> Compile(const ShaderSource &source, const std::vector<ShaderPermutationAxis> &axes, Report &report);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct UniqueSource {
+		ShaderKey key;
+		std::string preprocessedSource;
+		ShaderCache::Bytecode bytecode;
+		std::string errors;
+	};
+
+private:
+	static double SecondsSince(Clock::time_point start) {
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	static std::string ErrorMessage(std::exception_ptr error);
+
+private:
+	Backend &mBackend;
+	JobSystem &mJobSystem;
+	ShaderCache *mCache;
+};
+
+
+template <typename Backend>
+ShaderPermutationCompiler<Backend>::ShaderPermutationCompiler(Backend &backend, JobSystem &jobSystem, ShaderCache *cache)
+: mBackend(backend), mJobSystem(jobSystem), mCache(cache) {
+}
+
+
+template <typename Backend>
+std::vector<typename ShaderPermutationCompiler<Backend>::Permutation> ShaderPermutationCompiler<Backend>::Compile(
+	const ShaderSource &source,
+	const std::vector<ShaderPermutationAxis> &axes,
+	Report &report
+) {
+	const Clock::time_point start = Clock::now();
+
+	report = Report();
+
+	std::vector<Permutation> permutations;
+	for (ShaderDefines &defines : ExpandShaderPermutations(axes)) {
+		permutations.push_back(Permutation{ std::move(defines), ShaderCache::Bytecode(), std::string() });
+	}
+
+	report.permutationsCount = permutations.size();
+
+	const std::string compiler = mBackend.CompilerIdentity();
+
+	std::vector<std::string> preprocessedSources(permutations.size());
+
+	mJobSystem.ParallelFor(permutations.size(), [&](std::size_t i) {
+		try {
+			preprocessedSources[i] = mBackend.Preprocess(source, permutations[i].defines);
+		} catch (...) {
+			permutations[i].errors = ErrorMessage(std::current_exception());
+		}
+	});
+
+	report.preprocessingSeconds = SecondsSince(start);
+
+	// Permutations that preprocess to the same source share the first one's result
+	std::vector<UniqueSource> uniqueSources;
+	std::vector<std::size_t> uniqueIndices(permutations.size(), SIZE_MAX);
+	std::unordered_multimap<std::uint64_t, std::size_t> uniqueByHash;
+
+	for (std::size_t i = 0; i < permutations.size(); i++) {
+		if (!permutations[i].errors.empty()) {
+			continue;
+		}
+
+		report.preprocessedCount++;
+
+		const std::string &preprocessedSource = preprocessedSources[i];
+		const std::uint64_t hash = HashBytes(preprocessedSource.data(), preprocessedSource.size());
+
+		auto range = uniqueByHash.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (uniqueSources[it->second].preprocessedSource == preprocessedSource) {
+				uniqueIndices[i] = it->second;
+				break;
+			}
+		}
+
+		if (uniqueIndices[i] == SIZE_MAX) {
+			UniqueSource uniqueSource;
+			uniqueSource.key.sourceHash = hash;
+			uniqueSource.key.entryPoint = source.entryPoint;
+			uniqueSource.key.profile = source.profile;
+			uniqueSource.key.compiler = compiler;
+			uniqueSource.preprocessedSource = std::move(preprocessedSources[i]);
+
+			uniqueIndices[i] = uniqueSources.size();
+			uniqueByHash.emplace(hash, uniqueSources.size());
+			uniqueSources.push_back(std::move(uniqueSource));
+		}
+	}
+
+	report.uniqueCount = uniqueSources.size();
+
+	const Clock::time_point compilationStart = Clock::now();
+
+	std::vector<char> isCacheHit(uniqueSources.size(), 0);
+
+	mJobSystem.ParallelFor(uniqueSources.size(), [&](std::size_t i) {
+		UniqueSource &uniqueSource = uniqueSources[i];
+
+		if (mCache != nullptr && mCache->Find(uniqueSource.key, uniqueSource.bytecode)) {
+			isCacheHit[i] = 1;
+			return;
+		}
+
+		try {
+			auto bytecode = std::make_shared<std::vector<std::uint8_t>>(
+				mBackend.Compile(source, uniqueSource.preprocessedSource)
+			);
+
+			uniqueSource.bytecode.data = std::shared_ptr<const std::uint8_t>(bytecode, bytecode->data());
+			uniqueSource.bytecode.size = bytecode->size();
+		} catch (...) {
+			uniqueSource.errors = ErrorMessage(std::current_exception());
+			return;
+		}
+
+		if (mCache != nullptr) {
+			// A cache that can't be written only costs a compilation in the next run
+			try {
+				mCache->Store(uniqueSource.key, uniqueSource.bytecode.data.get(), uniqueSource.bytecode.size);
+			} catch (...) {
+			}
+		}
+	});
+
+	report.compilationSeconds = SecondsSince(compilationStart);
+
+	for (std::size_t i = 0; i < uniqueSources.size(); i++) {
+		if (isCacheHit[i]) {
+			report.cacheHitsCount++;
+		} else if (uniqueSources[i].errors.empty()) {
+			report.compiledCount++;
+		}
+	}
+
+	for (std::size_t i = 0; i < permutations.size(); i++) {
+		if (uniqueIndices[i] != SIZE_MAX) {
+			const UniqueSource &uniqueSource = uniqueSources[uniqueIndices[i]];
+			permutations[i].bytecode = uniqueSource.bytecode;
+			permutations[i].errors = uniqueSource.errors;
+		}
+
+		if (!permutations[i].IsCompiled()) {
+			report.failedCount++;
+		}
+	}
+
+	report.wallSeconds = SecondsSince(start);
+
+	return permutations;
+}
+
+
+template <typename Backend>
+std::string ShaderPermutationCompiler<Backend>::ErrorMessage(std::exception_ptr error) {
+	try {
+		std::rethrow_exception(error);
+	} catch (const std::exception &exception) {
+		// Empty errors mean success
+		if (exception.what()[0] != '\0') {
+			return exception.what();
+		}
+	} catch (...) {
+	}
+
+	return "Unknown error";
+}
@@ -0,0 +1,26 @@
+#include "ShaderPermutations.h"
+
+
+std::vector<ShaderDefines> ExpandShaderPermutations(const std::vector<ShaderPermutationAxis> &axes) {
+	std::size_t permutationsCount = 1;
+	for (const ShaderPermutationAxis &axis : axes) {
+		permutationsCount *= axis.values.size();
+	}
+
+	std::vector<ShaderDefines> permutations(permutationsCount);
+
+	for (std::size_t i = 0; i < permutationsCount; i++) {
+		ShaderDefines &defines = permutations[i];
+		defines.resize(axes.size());
+
+		// The index is a number whose digits are the value indices, the last axis is the lowest digit
+		std::size_t remainder = i;
+		for (std::size_t axisIndex = axes.size(); axisIndex-- > 0;) {
+			const ShaderPermutationAxis &axis = axes[axisIndex];
+			defines[axisIndex] = std::make_pair(axis.name, axis.values[remainder % axis.values.size()]);
+			remainder /= axis.values.size();
+		}
+	}
+
+	return permutations;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+
+// A define that takes one of several values, each value makes a permutation
+struct ShaderPermutationAxis {
+	std::string name;
+	std::vector<std::string> values;
+};
+
+
+struct ShaderSource {
+	// Used in error messages and to resolve relative includes
+	std::string name;
+	std::string text;
+	std::string entryPoint;
+	std::string profile;
+};
+
+
+// Every combination of the axis values, the first axis changes the slowest.
+// An axis without values makes no permutations
+std::vector<ShaderDefines> ExpandShaderPermutations(const std::vector<ShaderPermutationAxis> &axes);
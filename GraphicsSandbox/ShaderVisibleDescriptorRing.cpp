@@ -0,0 +1,92 @@
+#include "ShaderVisibleDescriptorRing.h"
+#include "d3dx12.h"
+
+
+ShaderVisibleDescriptorRing::ShaderVisibleDescriptorRing(
+	GraphicsDevice &device,
+	WaitableGpuFence &fence,
+	D3D12_DESCRIPTOR_HEAP_TYPE type,
+	UINT descriptorsCount,
+	UINT persistentDescriptorsCount
+)
+: mDevice(device),
+  mType(type),
+  mDescriptorSize(device.GetD3dDevice()->GetDescriptorHandleIncrementSize(type)),
+  mPersistentDescriptorsCount(persistentDescriptorsCount),
+  mRing(fence, descriptorsCount - persistentDescriptorsCount) {
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+	heapDesc.Type = type;
+	heapDesc.NumDescriptors = descriptorsCount;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	heapDesc.NodeMask = 0;
+	D3D_CHECK(mDevice.GetD3dDevice()->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+
+	mCpuStart = mHeap->GetCPUDescriptorHandleForHeapStart();
+	mGpuStart = mHeap->GetGPUDescriptorHandleForHeapStart();
+}
+
+
+D3D12_CPU_DESCRIPTOR_HANDLE ShaderVisibleDescriptorRing::PersistentCpuHandle(UINT index) const {
+	return CD3DX12_CPU_DESCRIPTOR_HANDLE(mCpuStart, static_cast<INT>(index), mDescriptorSize);
+}
+
+
+D3D12_GPU_DESCRIPTOR_HANDLE ShaderVisibleDescriptorRing::PersistentGpuHandle(UINT index) const {
+	return CD3DX12_GPU_DESCRIPTOR_HANDLE(mGpuStart, static_cast<INT>(index), mDescriptorSize);
+}
+
+
+D3D12_GPU_DESCRIPTOR_HANDLE ShaderVisibleDescriptorRing::StageTable(const D3D12_CPU_DESCRIPTOR_HANDLE *sources, UINT count) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mSourceKey.clear();
+	for (UINT i = 0; i < count; i++) {
+		mSourceKey.push_back(sources[i].ptr);
+	}
+
+	std::uint64_t offset = mTableCache.Find(mSourceKey.data(), count);
+	if (offset != DescriptorTableCache::NOT_FOUND) {
+		mFrameStatistics.deduplicatedTablesCount++;
+		return CD3DX12_GPU_DESCRIPTOR_HANDLE(mGpuStart, static_cast<INT>(offset), mDescriptorSize);
+	}
+
+	offset = mRing.Allocate(count);
+	while (offset == RingAllocator<WaitableGpuFence>::INVALID_OFFSET) {
+		if (!mRing.WaitAndReclaimOldest()) {
+			throw std::runtime_error("Descriptor tables of one frame don't fit into the ring");
+		}
+		offset = mRing.Allocate(count);
+	}
+
+	// The ring follows the persistent descriptors
+	offset += mPersistentDescriptorsCount;
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE destination(mCpuStart, static_cast<INT>(offset), mDescriptorSize);
+
+	// Null range sizes mean that every source is a range of one descriptor
+	mDevice.GetD3dDevice()->CopyDescriptors(1, &destination, &count, count, sources, nullptr, mType);
+
+	mTableCache.Insert(mSourceKey.data(), count, offset);
+
+	mFrameStatistics.stagedTablesCount++;
+	mFrameStatistics.stagingCopiesCount += count;
+
+	return CD3DX12_GPU_DESCRIPTOR_HANDLE(mGpuStart, static_cast<INT>(offset), mDescriptorSize);
+}
+
+
+void ShaderVisibleDescriptorRing::EndFrame(const WaitableGpuFence::Label &label) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mRing.Retire(label);
+	mTableCache.Clear();
+
+	mLastFrameStatistics = mFrameStatistics;
+	mFrameStatistics = Statistics();
+}
+
+
+ShaderVisibleDescriptorRing::Statistics ShaderVisibleDescriptorRing::LastFrameStatistics() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mLastFrameStatistics;
+}
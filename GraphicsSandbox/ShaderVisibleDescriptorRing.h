@@ -0,0 +1,81 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "RingAllocator.h"
+#include "DescriptorTableCache.h"
+
+#include <mutex>
+#include <vector>
+
+
+// One large shader-visible descriptor heap used as a ring.
+//
+// Descriptor tables are staged by copying CPU descriptors into the ring, and the
+// range of a frame is reclaimed once its fence label completes. A table made of
+// the same descriptors is copied only once per frame.
+//
+// The beginning of the heap can be reserved for persistent descriptors that are
+// managed by the caller, only one heap of the type can be bound at a time.
+//
+// This class is thread-safe
+class ShaderVisibleDescriptorRing {
+public:
+	struct Statistics {
+		UINT stagedTablesCount = 0;
+		UINT deduplicatedTablesCount = 0;
+		// Descriptors copied into the ring
+		UINT stagingCopiesCount = 0;
+	};
+
+public:
+	ShaderVisibleDescriptorRing(
+		GraphicsDevice &device,
+		WaitableGpuFence &fence,
+		D3D12_DESCRIPTOR_HEAP_TYPE type,
+		UINT descriptorsCount,
+		UINT persistentDescriptorsCount = 0
+	);
+	ShaderVisibleDescriptorRing(const ShaderVisibleDescriptorRing&) = delete;
+
+	ShaderVisibleDescriptorRing& operator = (const ShaderVisibleDescriptorRing&) = delete;
+
+	ID3D12DescriptorHeap* Heap() const {
+		return mHeap.Get();
+	}
+
+	UINT PersistentDescriptorsCount() const {
+		return mPersistentDescriptorsCount;
+	}
+
+	D3D12_CPU_DESCRIPTOR_HANDLE PersistentCpuHandle(UINT index) const;
+	D3D12_GPU_DESCRIPTOR_HANDLE PersistentGpuHandle(UINT index) const;
+
+	// Source descriptors must not be rewritten until the end of the frame.
+	// Blocks if the ring is full until the GPU finishes an older frame
+	D3D12_GPU_DESCRIPTOR_HANDLE StageTable(const D3D12_CPU_DESCRIPTOR_HANDLE *sources, UINT count);
+
+	// Tables staged since the previous call are reclaimed once the label completes
+	void EndFrame(const WaitableGpuFence::Label &label);
+
+	Statistics LastFrameStatistics();
+
+private:
+	GraphicsDevice &mDevice;
+	const D3D12_DESCRIPTOR_HEAP_TYPE mType;
+	const UINT mDescriptorSize;
+	const UINT mPersistentDescriptorsCount;
+
+	ComPtr<ID3D12DescriptorHeap> mHeap;
+	D3D12_CPU_DESCRIPTOR_HANDLE mCpuStart;
+	D3D12_GPU_DESCRIPTOR_HANDLE mGpuStart;
+
+	std::mutex mMutex;
+	RingAllocator<WaitableGpuFence> mRing;
+	DescriptorTableCache mTableCache;
+	std::vector<std::uint64_t> mSourceKey;
+
+	Statistics mFrameStatistics;
+	Statistics mLastFrameStatistics;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+
+// Map from keys to objects that are created once and shared by every request.
+//
+// Concurrent requests for the same key wait for the first one to create the
+// object instead of creating it again. If creation throws, every waiting request
+// gets the exception and the key can be requested again.
+//
+// Value must be copyable, e.g. a ComPtr.
+//
+// This class is thread-safe
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SharedObjectCache {
+public:
+	SharedObjectCache() = default;
+	SharedObjectCache(const SharedObjectCache&) = delete;
+
+	SharedObjectCache& operator = (const SharedObjectCache&) = delete;
+
+	// Sets isCreated if this request created the object
+	Value GetOrCreate(const Key &key, const std::function<Value()> &create, bool &isCreated);
+
+	// Returns false if the object doesn't exist or is still being created
+	bool TryGet(const Key &key, Value &value);
+
+	std::size_t Size() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mObjects.size();
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		mObjects.clear();
+	}
+
+private:
+	std::mutex mMutex;
+	std::unordered_map<Key, std::shared_future<Value>, Hash> mObjects;
+};
+
+
+template <typename Key, typename Value, typename Hash>
+Value SharedObjectCache<Key, Value, Hash>::GetOrCreate(
+	const Key &key,
+	const std::function<Value()> &create,
+	bool &isCreated
+) {
+	std::promise<Value> promise;
+	std::shared_future<Value> future;
+	isCreated = false;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		auto it = mObjects.find(key);
+		if (it != mObjects.end()) {
+			future = it->second;
+		} else {
+			future = promise.get_future().share();
+			mObjects.emplace(key, future);
+			isCreated = true;
+		}
+	}
+
+	if (isCreated) {
+		// Created outside the lock, requests for other keys don't wait
+		try {
+			promise.set_value(create());
+		} catch (...) {
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mObjects.erase(key);
+			}
+
+			promise.set_exception(std::current_exception());
+		}
+	}
+
+	return future.get();
+}
+
+
+template <typename Key, typename Value, typename Hash>
+bool SharedObjectCache<Key, Value, Hash>::TryGet(const Key &key, Value &value) {
+	std::shared_future<Value> future;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		auto it = mObjects.find(key);
+		if (it == mObjects.end()) {
+			return false;
+		}
+
+		future = it->second;
+	}
+
+	// Failed entries are erased before their exception is set, so a ready one has a value
+	if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		return false;
+	}
+
+	value = future.get();
+	return true;
+}
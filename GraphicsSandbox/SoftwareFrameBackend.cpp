@@ -0,0 +1,107 @@
+#include "SoftwareFrameBackend.h"
+#include "FrameProfiler.h"
+
+#include <cassert>
+#include <stdexcept>
+
+
+constexpr std::size_t SoftwareFrameBackend::DEFAULT_TARGETS_COUNT;
+
+
+SoftwareFrameBackend::SoftwareFrameBackend(
+	std::uint32_t width,
+	std::uint32_t height,
+	JobSystem &jobSystem,
+	FrameDumpWriter &frameWriter,
+	std::size_t targetsCount
+)
+: mRecordingBackend(mResourceStates),
+  mRasterizer(jobSystem),
+  mReadbacks(mFence, frameWriter, targetsCount) {
+	if (targetsCount == 0) {
+		throw std::invalid_argument("At least one target is needed");
+	}
+
+	// Registered by address, so the vector never reallocates
+	mTargets.reserve(targetsCount);
+	for (std::size_t i = 0; i < targetsCount; i++) {
+		mTargets.emplace_back(width, height);
+		mResourceStates.Register(&mTargets[i], 1, ResourceState::PRESENT);
+	}
+
+	mCurrentTargetIndex = mReadbacks.Acquire();
+}
+
+
+void SoftwareFrameBackend::PlaceTransientResources(const CompiledRenderGraph &/*graph*/, RenderGraph::ResourceId /*depthStencilId*/) {
+	// Nothing is aliased, the buffer stays where it is
+	if (!mIsDepthStencilBufferPlaced) {
+		mResourceStates.Register(&mDepthStencilBuffer, 1, ResourceState::DEPTH_WRITE);
+		mIsDepthStencilBufferPlaced = true;
+	}
+}
+
+
+SoftwareFrameBackend::Fence::Label SoftwareFrameBackend::Present() {
+	SoftwareRenderTarget &target = mTargets[mCurrentTargetIndex];
+
+	mRecordingBackend.TakeSubmittedCommands(mSubmittedCommands);
+	ReplayCommands(target);
+
+	// The rasterizer finishes the frame before returning, so it's complete right away
+	const Fence::Label label = mFence.PutLabel();
+	mFence.Signal(label);
+
+	const ImageView image = {
+		reinterpret_cast<const std::uint8_t*>(target.Colors()),
+		target.Width(),
+		target.Height(),
+		static_cast<std::size_t>(target.RowPitch()) * sizeof(std::uint32_t)
+	};
+	mReadbacks.Submit(mCurrentTargetIndex, label, mPresentedFramesCount, image);
+	mPresentedFramesCount++;
+
+	return label;
+}
+
+
+void SoftwareFrameBackend::EndFrame(FrameContext &/*frame*/, const Fence::Label &/*label*/) {
+	mLastFrameStatistics.commandsCount = mSubmittedCommands.size();
+	mLastFrameStatistics.pixelsShadedCount = mRasterizer.LastFrameStatistics().pixelsShadedCount;
+
+	mCurrentTargetIndex = mReadbacks.Acquire();
+}
+
+
+void SoftwareFrameBackend::ReplayCommands(SoftwareRenderTarget &target) {
+	PROFILE_SCOPE("Rasterize frame");
+
+	// The state set before the render target applies to it
+	mRasterizer.BeginFrame(target);
+
+	for (const NullCommand &command : mSubmittedCommands) {
+		switch (command.type) {
+		case NullCommand::Type::SET_VIEWPORT:
+			mRasterizer.SetViewport(command.viewport);
+			break;
+		case NullCommand::Type::SET_SCISSOR_RECT:
+			mRasterizer.SetScissorRect(command.scissorRect);
+			break;
+		case NullCommand::Type::SET_RENDER_TARGET:
+			// Frames render only into their back buffer
+			assert(command.renderTarget == &target);
+			break;
+		case NullCommand::Type::CLEAR_RENDER_TARGET:
+			mRasterizer.ClearColor(command.color);
+			break;
+		case NullCommand::Type::CLEAR_DEPTH_STENCIL:
+			mRasterizer.ClearDepth(command.depth);
+			break;
+		case NullCommand::Type::BARRIERS:
+			// Targets are plain memory
+			break;
+		}
+	}
+
+	mRasterizer.EndFrame();
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+
+#include "CpuTimelineFence.h"
+#include "FrameDumpWriter.h"
+#include "JobSystem.h"
+#include "NullRecordingBackend.h"
+#include "ReadbackRing.h"
+#include "RenderGraph.h"
+#include "ResourceStateTracker.h"
+#include "SoftwareRasterizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Offscreen backend of FrameRenderer that renders with the software rasterizer,
+// for batch jobs on machines without a D3D12 device or a window.
+//
+// Commands are recorded with NullRecordingBackend and replayed into the
+// rasterizer at Present. Every frame goes into one of a ring of targets which is
+// handed over to a FrameDumpWriter once the frame completes, and is rendered
+// into again once its file is written. The rasterizer is the device here, so
+// frames complete as soon as they're presented, but the targets are tracked by
+// their labels like readback buffers of a GPU.
+//
+// BeginRecording and the barrier flushes are thread-safe, they're called by the
+// recording tasks. Other methods are called by one thread, which must be a
+// thread of the job system
+class SoftwareFrameBackend {
+public:
+	using Fence = CpuTimelineFence;
+	using RecordingBackend = NullRecordingBackend;
+	using CommandList = NullRecordingBackend::CommandList;
+	// Addresses of the targets
+	using RenderTargetView = void*;
+	using DepthStencilView = void*;
+
+	// The rasterizer times itself with CPU scopes
+	struct GpuScope {
+	};
+
+	struct FrameContext {
+	};
+
+	// Counters of the last rendered frame
+	struct FrameStatistics {
+		std::uint64_t commandsCount = 0;
+		std::uint64_t pixelsShadedCount = 0;
+	};
+
+	static constexpr std::size_t DEFAULT_TARGETS_COUNT = 3;
+
+public:
+	// The writer must outlive the backend
+	SoftwareFrameBackend(
+		std::uint32_t width,
+		std::uint32_t height,
+		JobSystem &jobSystem,
+		FrameDumpWriter &frameWriter,
+		std::size_t targetsCount = DEFAULT_TARGETS_COUNT
+	);
+	SoftwareFrameBackend(const SoftwareFrameBackend&) = delete;
+
+	SoftwareFrameBackend& operator = (const SoftwareFrameBackend&) = delete;
+
+	Fence& GetFence() {
+		return mFence;
+	}
+
+	RecordingBackend& Recording() {
+		return mRecordingBackend;
+	}
+
+	void* BackBuffer() {
+		return &mTargets[mCurrentTargetIndex];
+	}
+
+	RenderTargetView BackBufferView() {
+		return BackBuffer();
+	}
+
+	void PlaceTransientResources(const CompiledRenderGraph &graph, RenderGraph::ResourceId depthStencilId);
+
+	// Depths are stored in the targets, the buffer only stands in for them in the graph
+	void* DepthStencilBuffer() {
+		return &mDepthStencilBuffer;
+	}
+
+	DepthStencilView DepthStencilBufferView() {
+		return DepthStencilBuffer();
+	}
+
+	void BeginRecording(CommandList &/*commandList*/) {
+	}
+
+	void FlushPassBarriers(CommandList &commandList, std::uint32_t /*pass*/) {
+		commandList.FlushBarriers();
+	}
+
+	void FlushBarriers(CommandList &commandList) {
+		commandList.FlushBarriers();
+	}
+
+	GpuScope BeginGpuScope(CommandList &/*commandList*/, const char */*name*/) {
+		return GpuScope();
+	}
+
+	void EndGpuScope(CommandList &/*commandList*/, const GpuScope &/*scope*/) {
+	}
+
+	// Rasterizes the frame and queues its readback
+	Fence::Label Present();
+
+	// Waits if every target is still being written
+	void EndFrame(FrameContext &frame, const Fence::Label &label);
+
+	// Waits until the files of the presented frames are written, rethrows the
+	// errors of the writer
+	void WaitForReadbacks() {
+		mReadbacks.WaitForAll();
+	}
+
+	ReadbackRing<Fence>::Statistics ReadbackStatistics() {
+		return mReadbacks.GetStatistics();
+	}
+
+	FrameStatistics LastFrameStatistics() const {
+		return mLastFrameStatistics;
+	}
+
+private:
+	void ReplayCommands(SoftwareRenderTarget &target);
+
+private:
+	CpuTimelineFence mFence;
+	ResourceStateRegistry mResourceStates;
+	NullRecordingBackend mRecordingBackend;
+	SoftwareRasterizer mRasterizer;
+
+	std::vector<NullCommand> mSubmittedCommands;
+
+	std::vector<SoftwareRenderTarget> mTargets;
+	std::uint8_t mDepthStencilBuffer;
+	bool mIsDepthStencilBufferPlaced = false;
+
+	// Reads the targets, so it's destroyed before them
+	ReadbackRing<Fence> mReadbacks;
+	std::size_t mCurrentTargetIndex;
+	std::uint64_t mPresentedFramesCount = 0;
+
+	FrameStatistics mLastFrameStatistics;
+};
@@ -0,0 +1,750 @@
+#include "SoftwareRasterizer.h"
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SOFTWARE_RASTERIZER_SSE2
+#endif
+
+
+namespace {
+	// Bits of subpixel precision of snapped positions
+	constexpr std::int32_t SUBPIXEL_BITS = 4;
+	constexpr std::int32_t SUBPIXELS_PER_PIXEL = 1 << SUBPIXEL_BITS;
+	constexpr std::int32_t HALF_PIXEL = SUBPIXELS_PER_PIXEL / 2;
+
+	// Triangles are clipped to it in x and y instead of to the viewport. Snapped
+	// coordinates within it take 19 bits, so the edge functions over a tile fit into 32
+	constexpr double GUARD_BAND_BOUND = 16000.0;
+
+	// Below it the setup of a job costs more than it saves
+	constexpr std::size_t MIN_CHUNK_TRIANGLES = 256;
+
+	// Clip space planes, dot(plane, position) >= 0 inside
+	constexpr std::size_t CLIP_PLANES_COUNT = 6;
+	// Each plane adds one vertex at most
+	constexpr std::size_t MAX_CLIPPED_VERTICES_COUNT = 3 + CLIP_PLANES_COUNT;
+
+
+	std::uint32_t PackColor(const float color[4]) {
+		std::uint32_t result = 0;
+		for (int i = 0; i < 4; i++) {
+			const float value = std::min(std::max(color[i], 0.0f), 1.0f);
+			result |= static_cast<std::uint32_t>(value * 255.0f + 0.5f) << (i * 8);
+		}
+
+		return result;
+	}
+
+
+	std::int32_t FloorDivide(std::int64_t value, std::int32_t divisor) {
+		std::int64_t result = value / divisor;
+		if (value % divisor != 0 && value < 0) {
+			result--;
+		}
+
+		return static_cast<std::int32_t>(result);
+	}
+
+
+	float Dot(const float plane[4], const float position[4]) {
+		return plane[0] * position[0] + plane[1] * position[1] + plane[2] * position[2] + plane[3] * position[3];
+	}
+
+
+	SoftwareVertex Lerp(const SoftwareVertex &from, const SoftwareVertex &to, float t) {
+		SoftwareVertex result;
+		for (int i = 0; i < 4; i++) {
+			result.position[i] = from.position[i] + (to.position[i] - from.position[i]) * t;
+			result.color[i] = from.color[i] + (to.color[i] - from.color[i]) * t;
+		}
+
+		return result;
+	}
+
+
+	// Sutherland-Hodgman, returns the number of vertices left
+	std::size_t ClipPolygon(const float plane[4], const SoftwareVertex *input, std::size_t inputCount, SoftwareVertex *output) {
+		std::size_t outputCount = 0;
+
+		for (std::size_t i = 0; i < inputCount; i++) {
+			const SoftwareVertex &current = input[i];
+			const SoftwareVertex &next = input[(i + 1) % inputCount];
+
+			const float currentDistance = Dot(plane, current.position);
+			const float nextDistance = Dot(plane, next.position);
+
+			if (currentDistance >= 0.0f) {
+				output[outputCount++] = current;
+			}
+			if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+				output[outputCount++] = Lerp(current, next, currentDistance / (currentDistance - nextDistance));
+			}
+		}
+
+		return outputCount;
+	}
+
+
+	void FillRows(std::uint32_t *rows, std::uint32_t pitch, std::uint32_t width, std::uint32_t height, std::uint32_t value) {
+		for (std::uint32_t y = 0; y < height; y++) {
+			std::fill(rows + y * pitch, rows + y * pitch + width, value);
+		}
+	}
+
+
+	void FillRows(float *rows, std::uint32_t pitch, std::uint32_t width, std::uint32_t height, float value) {
+		for (std::uint32_t y = 0; y < height; y++) {
+			std::fill(rows + y * pitch, rows + y * pitch + width, value);
+		}
+	}
+}
+
+
+constexpr std::uint32_t SoftwareRasterizer::TILE_SIZE;
+constexpr float SoftwareRasterizer::MAX_VIEWPORT_BOUND;
+
+
+SoftwareRenderTarget::SoftwareRenderTarget(std::uint32_t width, std::uint32_t height)
+: mWidth(width),
+  mHeight(height),
+  mRowPitch((width + 3) & ~3u),
+  mColors(std::size_t(mRowPitch) * height),
+  mDepths(std::size_t(mRowPitch) * height) {
+}
+
+
+SoftwareRasterizer::SoftwareRasterizer(JobSystem &jobSystem)
+: mJobSystem(jobSystem) {
+}
+
+
+void SoftwareRasterizer::BeginFrame(SoftwareRenderTarget &target) {
+	assert(mTarget == nullptr);
+
+	mTarget = &target;
+	mTilesCountX = (target.Width() + TILE_SIZE - 1) / TILE_SIZE;
+	mTilesCountY = (target.Height() + TILE_SIZE - 1) / TILE_SIZE;
+
+	Viewport viewport;
+	viewport.topLeftX = 0.0f;
+	viewport.topLeftY = 0.0f;
+	viewport.width = static_cast<float>(target.Width());
+	viewport.height = static_cast<float>(target.Height());
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	SetViewport(viewport);
+
+	Rect scissorRect;
+	scissorRect.left = 0;
+	scissorRect.top = 0;
+	scissorRect.right = static_cast<std::int32_t>(target.Width());
+	scissorRect.bottom = static_cast<std::int32_t>(target.Height());
+	SetScissorRect(scissorRect);
+
+	SetCullMode(SoftwareCullMode::BACK);
+	SetDepthTestEnabled(true);
+}
+
+
+void SoftwareRasterizer::SetViewport(const Viewport &viewport) {
+	if (viewport.topLeftX < -MAX_VIEWPORT_BOUND || viewport.topLeftX + viewport.width > MAX_VIEWPORT_BOUND
+		|| viewport.topLeftY < -MAX_VIEWPORT_BOUND || viewport.topLeftY + viewport.height > MAX_VIEWPORT_BOUND) {
+		throw std::invalid_argument("The viewport is out of the supported bounds");
+	}
+
+	mState.viewport = viewport;
+	mIsStateRecorded = false;
+}
+
+
+void SoftwareRasterizer::SetScissorRect(const Rect &rect) {
+	mState.scissorRect = rect;
+	mIsStateRecorded = false;
+}
+
+
+void SoftwareRasterizer::SetCullMode(SoftwareCullMode cullMode) {
+	mState.cullMode = cullMode;
+	mIsStateRecorded = false;
+}
+
+
+void SoftwareRasterizer::SetDepthTestEnabled(bool isEnabled) {
+	mState.isDepthTestEnabled = isEnabled;
+	mIsStateRecorded = false;
+}
+
+
+void SoftwareRasterizer::ClearColor(const float color[4]) {
+	Clear clear;
+	clear.firstTriangle = static_cast<std::uint32_t>(mTriangleStates.size());
+	clear.isColor = true;
+	clear.color = PackColor(color);
+	clear.depth = 0.0f;
+	mClears.push_back(clear);
+}
+
+
+void SoftwareRasterizer::ClearDepth(float depth) {
+	Clear clear;
+	clear.firstTriangle = static_cast<std::uint32_t>(mTriangleStates.size());
+	clear.isColor = false;
+	clear.color = 0;
+	clear.depth = depth;
+	mClears.push_back(clear);
+}
+
+
+void SoftwareRasterizer::DrawTriangles(const SoftwareVertex *vertices, std::size_t verticesCount) {
+	assert(verticesCount % 3 == 0);
+
+	if (!mIsStateRecorded) {
+		mStates.push_back(mState);
+		mIsStateRecorded = true;
+	}
+
+	mVertices.insert(mVertices.end(), vertices, vertices + verticesCount);
+	mTriangleStates.insert(mTriangleStates.end(), verticesCount / 3, static_cast<std::uint32_t>(mStates.size() - 1));
+}
+
+
+void SoftwareRasterizer::EndFrame() {
+	assert(mTarget != nullptr);
+
+	const std::size_t trianglesCount = mTriangleStates.size();
+	const std::size_t tilesCount = std::size_t(mTilesCountX) * mTilesCountY;
+
+	mUsedChunksCount = std::min(
+		(trianglesCount + MIN_CHUNK_TRIANGLES - 1) / MIN_CHUNK_TRIANGLES, mJobSystem.ThreadsCount()
+	);
+	if (mChunks.size() < mUsedChunksCount) {
+		mChunks.resize(mUsedChunksCount);
+	}
+
+	// Chunks are contiguous, so the bins of a tile keep the recorded order when
+	// they're walked chunk by chunk
+	const std::size_t chunkSize = mUsedChunksCount > 0 ? (trianglesCount + mUsedChunksCount - 1) / mUsedChunksCount : 0;
+	mJobSystem.ParallelFor(mUsedChunksCount, [this, chunkSize, trianglesCount](std::size_t i) {
+		SetUpChunk(mChunks[i], i * chunkSize, std::min((i + 1) * chunkSize, trianglesCount));
+	});
+
+	mTilePixelsShadedCounts.assign(tilesCount, 0);
+	mJobSystem.ParallelFor(tilesCount, [this](std::size_t i) {
+		RasterizeTile(static_cast<std::uint32_t>(i));
+	});
+
+	FrameStatistics statistics;
+	statistics.trianglesCount = trianglesCount;
+	for (std::size_t i = 0; i < mUsedChunksCount; i++) {
+		statistics.trianglesSetUpCount += mChunks[i].triangles.size();
+		for (const std::vector<std::uint32_t> &bin : mChunks[i].bins) {
+			statistics.binnedTrianglesCount += bin.size();
+		}
+	}
+	for (std::uint64_t pixelsCount : mTilePixelsShadedCounts) {
+		statistics.pixelsShadedCount += pixelsCount;
+	}
+	mLastFrameStatistics = statistics;
+
+	mStates.clear();
+	mVertices.clear();
+	mTriangleStates.clear();
+	mClears.clear();
+	mIsStateRecorded = false;
+	mTarget = nullptr;
+}
+
+
+void SoftwareRasterizer::SetUpChunk(Chunk &chunk, std::size_t firstTriangle, std::size_t endTriangle) {
+	PROFILE_SCOPE("Set up triangles");
+
+	const std::size_t tilesCount = std::size_t(mTilesCountX) * mTilesCountY;
+
+	chunk.triangles.clear();
+	chunk.bins.resize(tilesCount);
+	for (std::vector<std::uint32_t> &bin : chunk.bins) {
+		bin.clear();
+	}
+
+	for (std::size_t i = firstTriangle; i < endTriangle; i++) {
+		const std::size_t firstSetUp = chunk.triangles.size();
+		SetUpTriangle(chunk, static_cast<std::uint32_t>(i), mStates[mTriangleStates[i]], &mVertices[i * 3]);
+
+		for (std::size_t j = firstSetUp; j < chunk.triangles.size(); j++) {
+			const SetupTriangle &triangle = chunk.triangles[j];
+
+			const std::uint32_t firstTileX = triangle.minX / TILE_SIZE;
+			const std::uint32_t lastTileX = triangle.maxX / TILE_SIZE;
+			const std::uint32_t firstTileY = triangle.minY / TILE_SIZE;
+			const std::uint32_t lastTileY = triangle.maxY / TILE_SIZE;
+
+			for (std::uint32_t tileY = firstTileY; tileY <= lastTileY; tileY++) {
+				for (std::uint32_t tileX = firstTileX; tileX <= lastTileX; tileX++) {
+					chunk.bins[tileY * mTilesCountX + tileX].push_back(static_cast<std::uint32_t>(j));
+				}
+			}
+		}
+	}
+}
+
+
+void SoftwareRasterizer::SetUpTriangle(Chunk &chunk, std::uint32_t sourceIndex, const State &state, const SoftwareVertex *vertices) {
+	const Viewport &viewport = state.viewport;
+	if (viewport.width <= 0.0f || viewport.height <= 0.0f) {
+		return;
+	}
+
+	// Pixels whose centers are inside the viewport, the scissor rect and the target
+	const std::int32_t boundsMinX = std::max({
+		static_cast<std::int32_t>(std::ceil(viewport.topLeftX - 0.5f)), state.scissorRect.left, 0
+	});
+	const std::int32_t boundsMinY = std::max({
+		static_cast<std::int32_t>(std::ceil(viewport.topLeftY - 0.5f)), state.scissorRect.top, 0
+	});
+	const std::int32_t boundsMaxX = std::min({
+		static_cast<std::int32_t>(std::ceil(viewport.topLeftX + viewport.width - 0.5f)),
+		state.scissorRect.right,
+		static_cast<std::int32_t>(mTarget->Width())
+	}) - 1;
+	const std::int32_t boundsMaxY = std::min({
+		static_cast<std::int32_t>(std::ceil(viewport.topLeftY + viewport.height - 0.5f)),
+		state.scissorRect.bottom,
+		static_cast<std::int32_t>(mTarget->Height())
+	}) - 1;
+
+	if (boundsMinX > boundsMaxX || boundsMinY > boundsMaxY) {
+		return;
+	}
+
+	const double halfWidth = viewport.width * 0.5;
+	const double halfHeight = viewport.height * 0.5;
+	const double centerX = viewport.topLeftX + halfWidth;
+	const double centerY = viewport.topLeftY + halfHeight;
+
+	// Guard band in units of the viewport
+	const float guardX = static_cast<float>((GUARD_BAND_BOUND - std::abs(centerX)) / halfWidth);
+	const float guardY = static_cast<float>((GUARD_BAND_BOUND - std::abs(centerY)) / halfHeight);
+
+	const float planes[CLIP_PLANES_COUNT][4] = {
+		{ 0.0f, 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, -1.0f, 1.0f },
+		{ 1.0f, 0.0f, 0.0f, guardX },
+		{ -1.0f, 0.0f, 0.0f, guardX },
+		{ 0.0f, 1.0f, 0.0f, guardY },
+		{ 0.0f, -1.0f, 0.0f, guardY }
+	};
+
+	SoftwareVertex polygon[MAX_CLIPPED_VERTICES_COUNT];
+	SoftwareVertex clipped[MAX_CLIPPED_VERTICES_COUNT];
+	std::copy(vertices, vertices + 3, polygon);
+	std::size_t polygonSize = 3;
+
+	for (const float *plane : planes) {
+		bool isInside = true;
+		for (std::size_t i = 0; i < polygonSize; i++) {
+			isInside = isInside && Dot(plane, polygon[i].position) >= 0.0f;
+		}
+		if (isInside) {
+			continue;
+		}
+
+		polygonSize = ClipPolygon(plane, polygon, polygonSize, clipped);
+		if (polygonSize < 3) {
+			return;
+		}
+		std::copy(clipped, clipped + polygonSize, polygon);
+	}
+
+	// Projected vertices
+	std::int32_t snappedX[MAX_CLIPPED_VERTICES_COUNT];
+	std::int32_t snappedY[MAX_CLIPPED_VERTICES_COUNT];
+	double depths[MAX_CLIPPED_VERTICES_COUNT];
+	double inverseWs[MAX_CLIPPED_VERTICES_COUNT];
+
+	for (std::size_t i = 0; i < polygonSize; i++) {
+		const float *position = polygon[i].position;
+		if (position[3] <= 0.0f) {
+			return;
+		}
+
+		const double inverseW = 1.0 / position[3];
+		const double x = centerX + position[0] * inverseW * halfWidth;
+		const double y = centerY - position[1] * inverseW * halfHeight;
+
+		snappedX[i] = static_cast<std::int32_t>(std::floor(x * SUBPIXELS_PER_PIXEL + 0.5));
+		snappedY[i] = static_cast<std::int32_t>(std::floor(y * SUBPIXELS_PER_PIXEL + 0.5));
+		depths[i] = viewport.minDepth + position[2] * inverseW * (viewport.maxDepth - viewport.minDepth);
+		inverseWs[i] = inverseW;
+	}
+
+	// The clipped polygon is convex, it's split into a fan
+	for (std::size_t fan = 1; fan + 1 < polygonSize; fan++) {
+		std::size_t indices[3] = { 0, fan, fan + 1 };
+
+		std::int64_t area = std::int64_t(snappedX[indices[1]] - snappedX[indices[0]]) * (snappedY[indices[2]] - snappedY[indices[0]])
+			- std::int64_t(snappedY[indices[1]] - snappedY[indices[0]]) * (snappedX[indices[2]] - snappedX[indices[0]]);
+
+		// Y points down, so a positive area is clockwise on the screen
+		if (area == 0
+			|| (area > 0 && state.cullMode == SoftwareCullMode::FRONT)
+			|| (area < 0 && state.cullMode == SoftwareCullMode::BACK)) {
+			continue;
+		}
+
+		if (area < 0) {
+			std::swap(indices[1], indices[2]);
+			area = -area;
+		}
+
+		std::int64_t minX = snappedX[indices[0]];
+		std::int64_t minY = snappedY[indices[0]];
+		std::int64_t maxX = minX;
+		std::int64_t maxY = minY;
+		for (std::size_t index : indices) {
+			minX = std::min<std::int64_t>(minX, snappedX[index]);
+			minY = std::min<std::int64_t>(minY, snappedY[index]);
+			maxX = std::max<std::int64_t>(maxX, snappedX[index]);
+			maxY = std::max<std::int64_t>(maxY, snappedY[index]);
+		}
+
+		SetupTriangle triangle;
+		triangle.sourceIndex = sourceIndex;
+		triangle.minX = std::max(FloorDivide(minX - HALF_PIXEL + SUBPIXELS_PER_PIXEL - 1, SUBPIXELS_PER_PIXEL), boundsMinX);
+		triangle.minY = std::max(FloorDivide(minY - HALF_PIXEL + SUBPIXELS_PER_PIXEL - 1, SUBPIXELS_PER_PIXEL), boundsMinY);
+		triangle.maxX = std::min(FloorDivide(maxX - HALF_PIXEL, SUBPIXELS_PER_PIXEL), boundsMaxX);
+		triangle.maxY = std::min(FloorDivide(maxY - HALF_PIXEL, SUBPIXELS_PER_PIXEL), boundsMaxY);
+
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+			continue;
+		}
+
+		// Edge i is opposite to vertex i, its function is the area of the
+		// triangle it makes with a point
+		const double pixelX = double(triangle.minX) * SUBPIXELS_PER_PIXEL + HALF_PIXEL;
+		const double pixelY = double(triangle.minY) * SUBPIXELS_PER_PIXEL + HALF_PIXEL;
+		double barycentrics[3];
+
+		for (int i = 0; i < 3; i++) {
+			const std::size_t from = indices[(i + 1) % 3];
+			const std::size_t to = indices[(i + 2) % 3];
+
+			const std::int32_t dx = snappedX[to] - snappedX[from];
+			const std::int32_t dy = snappedY[to] - snappedY[from];
+
+			triangle.a[i] = -dy;
+			triangle.b[i] = dx;
+			triangle.c[i] = -(std::int64_t(triangle.a[i]) * snappedX[from] + std::int64_t(triangle.b[i]) * snappedY[from]);
+
+			barycentrics[i] = (triangle.a[i] * pixelX + triangle.b[i] * pixelY + double(triangle.c[i])) / double(area);
+
+			// Top-left fill rule: pixel centers on other edges are outside
+			const bool isTopLeft = dy < 0 || (dy == 0 && dx > 0);
+			if (!isTopLeft) {
+				triangle.c[i] -= 1;
+			}
+		}
+
+		const double stepScale = double(SUBPIXELS_PER_PIXEL) / double(area);
+		auto makePlane = [&](double value0, double value1, double value2) {
+			Plane plane;
+			plane.value = static_cast<float>(value0 * barycentrics[0] + value1 * barycentrics[1] + value2 * barycentrics[2]);
+			plane.dx = static_cast<float>(
+				(value0 * triangle.a[0] + value1 * triangle.a[1] + value2 * triangle.a[2]) * stepScale
+			);
+			plane.dy = static_cast<float>(
+				(value0 * triangle.b[0] + value1 * triangle.b[1] + value2 * triangle.b[2]) * stepScale
+			);
+			return plane;
+		};
+
+		triangle.depth = makePlane(depths[indices[0]], depths[indices[1]], depths[indices[2]]);
+		triangle.inverseW = makePlane(inverseWs[indices[0]], inverseWs[indices[1]], inverseWs[indices[2]]);
+		for (int i = 0; i < 4; i++) {
+			triangle.color[i] = makePlane(
+				polygon[indices[0]].color[i] * inverseWs[indices[0]],
+				polygon[indices[1]].color[i] * inverseWs[indices[1]],
+				polygon[indices[2]].color[i] * inverseWs[indices[2]]
+			);
+		}
+
+		triangle.minDepth = std::min(viewport.minDepth, viewport.maxDepth);
+		triangle.maxDepth = std::max(viewport.minDepth, viewport.maxDepth);
+		triangle.isDepthTestEnabled = state.isDepthTestEnabled;
+
+		chunk.triangles.push_back(triangle);
+	}
+}
+
+
+void SoftwareRasterizer::RasterizeTile(std::uint32_t tileIndex) {
+	PROFILE_SCOPE("Rasterize tile");
+
+	const std::int32_t tileX = static_cast<std::int32_t>((tileIndex % mTilesCountX) * TILE_SIZE);
+	const std::int32_t tileY = static_cast<std::int32_t>((tileIndex / mTilesCountX) * TILE_SIZE);
+
+	SoftwareRenderTarget &target = *mTarget;
+	const std::uint32_t pitch = target.RowPitch();
+	const std::uint32_t width = std::min<std::uint32_t>(TILE_SIZE, target.Width() - tileX);
+	const std::uint32_t height = std::min<std::uint32_t>(TILE_SIZE, target.Height() - tileY);
+	const std::size_t tileOffset = std::size_t(tileY) * pitch + tileX;
+
+	auto applyClear = [&](const Clear &clear) {
+		if (clear.isColor) {
+			FillRows(target.Colors() + tileOffset, pitch, width, height, clear.color);
+		} else {
+			FillRows(target.Depths() + tileOffset, pitch, width, height, clear.depth);
+		}
+	};
+
+	std::size_t nextClear = 0;
+	std::uint64_t pixelsShadedCount = 0;
+
+	for (std::size_t i = 0; i < mUsedChunksCount; i++) {
+		const Chunk &chunk = mChunks[i];
+
+		for (std::uint32_t triangleIndex : chunk.bins[tileIndex]) {
+			const SetupTriangle &triangle = chunk.triangles[triangleIndex];
+
+			while (nextClear < mClears.size() && mClears[nextClear].firstTriangle <= triangle.sourceIndex) {
+				applyClear(mClears[nextClear++]);
+			}
+
+			pixelsShadedCount += RasterizeTriangle(triangle, tileX, tileY);
+		}
+	}
+
+	while (nextClear < mClears.size()) {
+		applyClear(mClears[nextClear++]);
+	}
+
+	mTilePixelsShadedCounts[tileIndex] = pixelsShadedCount;
+}
+
+
+std::uint64_t SoftwareRasterizer::RasterizeTriangle(const SetupTriangle &triangle, std::int32_t tileX, std::int32_t tileY) {
+	const std::int32_t x0 = std::max(triangle.minX, tileX);
+	const std::int32_t y0 = std::max(triangle.minY, tileY);
+	const std::int32_t x1 = std::min(triangle.maxX + 1, tileX + std::int32_t(TILE_SIZE));
+	const std::int32_t y1 = std::min(triangle.maxY + 1, tileY + std::int32_t(TILE_SIZE));
+
+	if (x0 >= x1 || y0 >= y1) {
+		return 0;
+	}
+
+	// Pixels are processed in aligned groups of four, the padding of the rows
+	// takes the ones past the end of the target
+	const std::int32_t alignedX0 = x0 & ~3;
+	const std::int32_t alignedX1 = (x1 + 3) & ~3;
+
+	std::int32_t rowValues[3];
+	std::int32_t stepsX[3];
+	std::int32_t stepsY[3];
+
+	for (int i = 0; i < 3; i++) {
+		auto evaluate = [&](std::int32_t x, std::int32_t y) {
+			return std::int64_t(triangle.a[i]) * (x * SUBPIXELS_PER_PIXEL + HALF_PIXEL)
+				+ std::int64_t(triangle.b[i]) * (y * SUBPIXELS_PER_PIXEL + HALF_PIXEL)
+				+ triangle.c[i];
+		};
+
+		const std::int64_t corners[] = {
+			evaluate(alignedX0, y0), evaluate(alignedX1 - 1, y0), evaluate(alignedX0, y1 - 1), evaluate(alignedX1 - 1, y1 - 1)
+		};
+		const std::int64_t minCorner = *std::min_element(std::begin(corners), std::end(corners));
+		const std::int64_t maxCorner = *std::max_element(std::begin(corners), std::end(corners));
+
+		if (maxCorner < 0) {
+			return 0;
+		}
+
+		if (minCorner >= 0) {
+			// The whole area is inside the edge, it's left out
+			rowValues[i] = 0;
+			stepsX[i] = 0;
+			stepsY[i] = 0;
+		} else {
+			// The edge crosses the area, so its values over it fit into 32 bits
+			rowValues[i] = static_cast<std::int32_t>(corners[0]);
+			stepsX[i] = triangle.a[i] * SUBPIXELS_PER_PIXEL;
+			stepsY[i] = triangle.b[i] * SUBPIXELS_PER_PIXEL;
+		}
+	}
+
+	SoftwareRenderTarget &target = *mTarget;
+	const std::uint32_t pitch = target.RowPitch();
+	const bool isDepthTestEnabled = triangle.isDepthTestEnabled;
+
+	std::uint64_t pixelsShadedCount = 0;
+
+#if defined(SOFTWARE_RASTERIZER_SSE2)
+	// Planes of depth, 1 / w and the color over w, stepped by groups instead of
+	// evaluated per pixel
+	const Plane *planes[] = {
+		&triangle.depth, &triangle.inverseW, &triangle.color[0], &triangle.color[1], &triangle.color[2], &triangle.color[3]
+	};
+	constexpr int PLANES_COUNT = 6;
+
+	__m128 planeRows[PLANES_COUNT];
+	__m128 planeGroupSteps[PLANES_COUNT];
+	__m128 planeRowSteps[PLANES_COUNT];
+
+	const __m128 firstOffsets = _mm_add_ps(
+		_mm_set1_ps(float(alignedX0 - triangle.minX)), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)
+	);
+	const float firstRowOffset = float(y0 - triangle.minY);
+
+	for (int i = 0; i < PLANES_COUNT; i++) {
+		const Plane &plane = *planes[i];
+		planeRows[i] = _mm_add_ps(
+			_mm_set1_ps(plane.value + plane.dy * firstRowOffset), _mm_mul_ps(_mm_set1_ps(plane.dx), firstOffsets)
+		);
+		planeGroupSteps[i] = _mm_set1_ps(plane.dx * 4.0f);
+		planeRowSteps[i] = _mm_set1_ps(plane.dy);
+	}
+
+	__m128i rows[3];
+	__m128i groupSteps[3];
+	__m128i rowSteps[3];
+	for (int i = 0; i < 3; i++) {
+		rows[i] = _mm_setr_epi32(rowValues[i], rowValues[i] + stepsX[i], rowValues[i] + 2 * stepsX[i], rowValues[i] + 3 * stepsX[i]);
+		groupSteps[i] = _mm_set1_epi32(4 * stepsX[i]);
+		rowSteps[i] = _mm_set1_epi32(stepsY[i]);
+	}
+
+	const __m128i laneIndices = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i firstColumn = _mm_set1_epi32(x0 - 1);
+	const __m128i endColumn = _mm_set1_epi32(x1);
+	const __m128 minDepth = _mm_set1_ps(triangle.minDepth);
+	const __m128 maxDepth = _mm_set1_ps(triangle.maxDepth);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 unormScale = _mm_set1_ps(255.0f);
+
+	static const std::uint8_t BITS_COUNTS[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+	for (std::int32_t y = y0; y < y1; y++) {
+		__m128i values[3] = { rows[0], rows[1], rows[2] };
+		__m128 planeValues[PLANES_COUNT];
+		std::copy(planeRows, planeRows + PLANES_COUNT, planeValues);
+
+		std::uint32_t *colors = target.Colors() + std::size_t(y) * pitch;
+		float *depths = target.Depths() + std::size_t(y) * pitch;
+
+		for (std::int32_t x = alignedX0; x < alignedX1; x += 4) {
+			const __m128i signs = _mm_or_si128(_mm_or_si128(values[0], values[1]), values[2]);
+			const __m128i columns = _mm_add_epi32(_mm_set1_epi32(x), laneIndices);
+			const __m128i isColumnInside = _mm_and_si128(_mm_cmpgt_epi32(columns, firstColumn), _mm_cmplt_epi32(columns, endColumn));
+			__m128 mask = _mm_castsi128_ps(_mm_andnot_si128(_mm_srai_epi32(signs, 31), isColumnInside));
+
+			// The steps are taken before the group is shaded, so it can be skipped
+			__m128 current[PLANES_COUNT];
+			for (int i = 0; i < PLANES_COUNT; i++) {
+				current[i] = planeValues[i];
+				planeValues[i] = _mm_add_ps(planeValues[i], planeGroupSteps[i]);
+			}
+			for (int i = 0; i < 3; i++) {
+				values[i] = _mm_add_epi32(values[i], groupSteps[i]);
+			}
+
+			if (_mm_movemask_ps(mask) == 0) {
+				continue;
+			}
+
+			const __m128 depth = _mm_min_ps(_mm_max_ps(current[0], minDepth), maxDepth);
+
+			if (isDepthTestEnabled) {
+				const __m128 oldDepth = _mm_loadu_ps(depths + x);
+				mask = _mm_and_ps(mask, _mm_cmplt_ps(depth, oldDepth));
+
+				if (_mm_movemask_ps(mask) == 0) {
+					continue;
+				}
+
+				_mm_storeu_ps(depths + x, _mm_or_ps(_mm_and_ps(mask, depth), _mm_andnot_ps(mask, oldDepth)));
+			}
+
+			const __m128 w = _mm_div_ps(one, current[1]);
+
+			__m128i channels[4];
+			for (int i = 0; i < 4; i++) {
+				const __m128 value = _mm_min_ps(_mm_max_ps(_mm_mul_ps(current[2 + i], w), zero), one);
+				channels[i] = _mm_cvtps_epi32(_mm_mul_ps(value, unormScale));
+			}
+
+			const __m128i color = _mm_or_si128(
+				_mm_or_si128(channels[0], _mm_slli_epi32(channels[1], 8)),
+				_mm_or_si128(_mm_slli_epi32(channels[2], 16), _mm_slli_epi32(channels[3], 24))
+			);
+
+			const __m128i colorMask = _mm_castps_si128(mask);
+			__m128i *colorsAddress = reinterpret_cast<__m128i*>(colors + x);
+			const __m128i oldColor = _mm_loadu_si128(colorsAddress);
+			_mm_storeu_si128(colorsAddress, _mm_or_si128(_mm_and_si128(colorMask, color), _mm_andnot_si128(colorMask, oldColor)));
+
+			pixelsShadedCount += BITS_COUNTS[_mm_movemask_ps(mask)];
+		}
+
+		for (int i = 0; i < 3; i++) {
+			rows[i] = _mm_add_epi32(rows[i], rowSteps[i]);
+		}
+		for (int i = 0; i < PLANES_COUNT; i++) {
+			planeRows[i] = _mm_add_ps(planeRows[i], planeRowSteps[i]);
+		}
+	}
+#else
+	for (std::int32_t y = y0; y < y1; y++) {
+		std::int32_t values[3] = { rowValues[0], rowValues[1], rowValues[2] };
+
+		const float planeY = float(y - triangle.minY);
+		std::uint32_t *colors = target.Colors() + std::size_t(y) * pitch;
+		float *depths = target.Depths() + std::size_t(y) * pitch;
+
+		for (std::int32_t x = alignedX0; x < alignedX1; x++) {
+			const bool isInside = x >= x0 && x < x1 && (values[0] | values[1] | values[2]) >= 0;
+
+			for (int i = 0; i < 3; i++) {
+				values[i] += stepsX[i];
+			}
+
+			if (!isInside) {
+				continue;
+			}
+
+			const float planeX = float(x - triangle.minX);
+
+			float depth = triangle.depth.value + triangle.depth.dx * planeX + triangle.depth.dy * planeY;
+			depth = std::min(std::max(depth, triangle.minDepth), triangle.maxDepth);
+
+			if (isDepthTestEnabled) {
+				if (!(depth < depths[x])) {
+					continue;
+				}
+				depths[x] = depth;
+			}
+
+			const float w = 1.0f / (triangle.inverseW.value + triangle.inverseW.dx * planeX + triangle.inverseW.dy * planeY);
+
+			float color[4];
+			for (int i = 0; i < 4; i++) {
+				const Plane &plane = triangle.color[i];
+				color[i] = (plane.value + plane.dx * planeX + plane.dy * planeY) * w;
+			}
+
+			colors[x] = PackColor(color);
+			pixelsShadedCount++;
+		}
+
+		for (int i = 0; i < 3; i++) {
+			rowValues[i] += stepsY[i];
+		}
+	}
+#endif
+
+	return pixelsShadedCount;
+}
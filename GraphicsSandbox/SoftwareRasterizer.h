@@ -0,0 +1,223 @@
+#pragma once
+
+
+#include "JobSystem.h"
+#include "GraphicsTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Offscreen target of the software rasterizer: R8G8B8A8_UNORM colors with red in
+// the lowest byte, and 32-bit float depths. Rows are padded to whole groups of
+// four pixels, the rasterizer reads and writes them four at a time.
+//
+// This class is not thread-safe
+class SoftwareRenderTarget {
+public:
+	SoftwareRenderTarget(std::uint32_t width, std::uint32_t height);
+
+	std::uint32_t Width() const {
+		return mWidth;
+	}
+
+	std::uint32_t Height() const {
+		return mHeight;
+	}
+
+	// In pixels
+	std::uint32_t RowPitch() const {
+		return mRowPitch;
+	}
+
+	std::uint32_t* Colors() {
+		return mColors.data();
+	}
+
+	const std::uint32_t* Colors() const {
+		return mColors.data();
+	}
+
+	float* Depths() {
+		return mDepths.data();
+	}
+
+	const float* Depths() const {
+		return mDepths.data();
+	}
+
+private:
+	std::uint32_t mWidth;
+	std::uint32_t mHeight;
+	std::uint32_t mRowPitch;
+
+	std::vector<std::uint32_t> mColors;
+	std::vector<float> mDepths;
+};
+
+
+// Position in clip space
+struct SoftwareVertex {
+	float position[4];
+	float color[4];
+};
+
+
+// Front faces are clockwise, like with the default D3D12 rasterizer state
+enum class SoftwareCullMode {
+	NONE,
+	FRONT,
+	BACK
+};
+
+
+// Rasterizer of colored triangle lists into a SoftwareRenderTarget, for machines
+// without a D3D12 device.
+//
+// Commands are recorded between BeginFrame and EndFrame. EndFrame sets up the
+// triangles in parallel, bins them into tiles of TILE_SIZE pixels and rasterizes
+// the tiles in parallel, each tile executing the commands that touch it in the
+// recorded order. Coverage is computed with fixed-point edge functions, four
+// pixels at a time with SSE2.
+//
+// The rules are the ones of D3D12: pixel centers at half-integer coordinates,
+// the top-left fill rule, clipping against the near and far planes, depths
+// mapped to the viewport range and clamped to it, pixels outside the viewport or
+// the scissor rect discarded. Clears don't depend on the viewport or the scissor
+// rect, like ClearRenderTargetView without rects. Colors are interpolated with
+// perspective correction, the depth test is LESS.
+//
+// This class is not thread-safe
+class SoftwareRasterizer {
+public:
+	static constexpr std::uint32_t TILE_SIZE = 64;
+
+	// Viewports must lie within [-MAX_VIEWPORT_BOUND, MAX_VIEWPORT_BOUND], so
+	// snapped coordinates of the guard band fit into 32-bit edge functions
+	static constexpr float MAX_VIEWPORT_BOUND = 8192.0f;
+
+	// Counters of the last frame
+	struct FrameStatistics {
+		std::uint64_t trianglesCount = 0;
+		// After clipping, culling and discarding the ones without pixels
+		std::uint64_t trianglesSetUpCount = 0;
+		std::uint64_t binnedTrianglesCount = 0;
+		std::uint64_t pixelsShadedCount = 0;
+	};
+
+public:
+	explicit SoftwareRasterizer(JobSystem &jobSystem);
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+
+	SoftwareRasterizer& operator = (const SoftwareRasterizer&) = delete;
+
+	// Resets the state: the viewport and the scissor rect cover the target, back
+	// faces are culled, the depth test is enabled
+	void BeginFrame(SoftwareRenderTarget &target);
+
+	void SetViewport(const Viewport &viewport);
+
+	void SetScissorRect(const Rect &rect);
+
+	void SetCullMode(SoftwareCullMode cullMode);
+
+	// Depths are written only when the test is enabled
+	void SetDepthTestEnabled(bool isEnabled);
+
+	void ClearColor(const float color[4]);
+
+	void ClearDepth(float depth);
+
+	// The vertices are copied
+	void DrawTriangles(const SoftwareVertex *vertices, std::size_t verticesCount);
+
+	// Must be called from a thread of the job system
+	void EndFrame();
+
+	FrameStatistics LastFrameStatistics() const {
+		return mLastFrameStatistics;
+	}
+
+private:
+	struct State {
+		Viewport viewport;
+		Rect scissorRect;
+		SoftwareCullMode cullMode;
+		bool isDepthTestEnabled;
+	};
+
+	struct Clear {
+		// Applied before this triangle
+		std::uint32_t firstTriangle;
+		bool isColor;
+		std::uint32_t color;
+		float depth;
+	};
+
+	// Attribute at the pixel minX, minY and its steps per pixel
+	struct Plane {
+		float value;
+		float dx;
+		float dy;
+	};
+
+	struct SetupTriangle {
+		std::uint32_t sourceIndex;
+		// Pixels, inclusive
+		std::int32_t minX;
+		std::int32_t minY;
+		std::int32_t maxX;
+		std::int32_t maxY;
+		// Edge functions in subpixels, inside where a * x + b * y + c >= 0
+		std::int32_t a[3];
+		std::int32_t b[3];
+		std::int64_t c[3];
+		float minDepth;
+		float maxDepth;
+		bool isDepthTestEnabled;
+		// Depth, 1 / w and the color divided by w
+		Plane depth;
+		Plane inverseW;
+		Plane color[4];
+	};
+
+	// Triangles set up by one job and their indices binned by tile
+	struct Chunk {
+		std::vector<SetupTriangle> triangles;
+		std::vector<std::vector<std::uint32_t>> bins;
+	};
+
+private:
+	void SetUpChunk(Chunk &chunk, std::size_t firstTriangle, std::size_t endTriangle);
+
+	void SetUpTriangle(Chunk &chunk, std::uint32_t sourceIndex, const State &state, const SoftwareVertex *vertices);
+
+	void RasterizeTile(std::uint32_t tileIndex);
+
+	std::uint64_t RasterizeTriangle(const SetupTriangle &triangle, std::int32_t tileX, std::int32_t tileY);
+
+private:
+	JobSystem &mJobSystem;
+
+	SoftwareRenderTarget *mTarget = nullptr;
+	std::uint32_t mTilesCountX = 0;
+	std::uint32_t mTilesCountY = 0;
+
+	State mState;
+	bool mIsStateRecorded = false;
+
+	// Recorded commands, kept between frames so they stop allocating
+	std::vector<State> mStates;
+	std::vector<SoftwareVertex> mVertices;
+	// Index of the state of every triangle
+	std::vector<std::uint32_t> mTriangleStates;
+	std::vector<Clear> mClears;
+
+	std::vector<Chunk> mChunks;
+	std::size_t mUsedChunksCount = 0;
+
+	std::vector<std::uint64_t> mTilePixelsShadedCounts;
+
+	FrameStatistics mLastFrameStatistics;
+};
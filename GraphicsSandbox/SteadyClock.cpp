@@ -0,0 +1,30 @@
+#include "SteadyClock.h"
+
+#include <chrono>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define STEADY_CLOCK_SSE2
+#endif
+
+
+std::int64_t SteadyClock::Now() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+
+void SteadyClock::Sleep(std::int64_t nanoseconds) {
+	std::this_thread::sleep_for(std::chrono::nanoseconds(nanoseconds));
+}
+
+
+void SteadyClock::Relax() {
+#if defined(STEADY_CLOCK_SSE2)
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+
+#include <cstdint>
+
+
+// Clock of FramePacer on std::chrono::steady_clock and the sleeps of the
+// system, which are as coarse as its timer, e.g. a millisecond on Windows after
+// timeBeginPeriod(1).
+//
+// All methods are thread-safe
+class SteadyClock {
+public:
+	std::int64_t Now() const;
+
+	void Sleep(std::int64_t nanoseconds);
+
+	// Lets the other hardware thread of the core run while spinning
+	void Relax();
+};
@@ -0,0 +1,159 @@
+#include "SubresourceCopy.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SUBRESOURCE_COPY_SSE2
+#endif
+
+
+namespace {
+	// Below it the setup of streaming costs more than it saves
+	constexpr std::size_t MIN_STREAM_SIZE = 256;
+
+	// Batches smaller than this aren't worth waking up workers for
+	constexpr std::size_t MIN_PARALLEL_SIZE = 1024 * 1024;
+	constexpr std::size_t CHUNK_SIZE = 256 * 1024;
+
+
+	struct CopyChunk {
+		const SubresourceCopy *copy;
+		std::uint32_t slice;
+		std::uint32_t firstRow;
+		std::uint32_t rowsCount;
+	};
+
+
+	void CopyRows(const SubresourceCopy &copy, std::uint32_t slice, std::uint32_t firstRow, std::uint32_t rowsCount) {
+		std::uint8_t *destination = static_cast<std::uint8_t*>(copy.destination)
+			+ slice * copy.destinationSlicePitch + firstRow * copy.destinationRowPitch;
+		const std::uint8_t *source = static_cast<const std::uint8_t*>(copy.source)
+			+ slice * copy.sourceSlicePitch + firstRow * copy.sourceRowPitch;
+
+		if (copy.destinationRowPitch == copy.sourceRowPitch) {
+			// The padding between rows is copied too, it's never read
+			StreamCopy(destination, source, (rowsCount - 1) * copy.sourceRowPitch + copy.rowSize);
+			return;
+		}
+
+		for (std::uint32_t row = 0; row < rowsCount; row++) {
+			StreamCopy(destination + row * copy.destinationRowPitch, source + row * copy.sourceRowPitch, copy.rowSize);
+		}
+	}
+
+
+	bool IsEmpty(const SubresourceCopy &copy) {
+		return copy.rowSize == 0 || copy.rowsCount == 0 || copy.slicesCount == 0;
+	}
+}
+
+
+void StreamCopy(void *destination, const void *source, std::size_t size) {
+#if defined(SUBRESOURCE_COPY_SSE2)
+	if (size < MIN_STREAM_SIZE) {
+		std::memcpy(destination, source, size);
+		return;
+	}
+
+	std::uint8_t *destinationBytes = static_cast<std::uint8_t*>(destination);
+	const std::uint8_t *sourceBytes = static_cast<const std::uint8_t*>(source);
+
+	// Streaming stores need aligned addresses, the head goes through the cache
+	const std::size_t headSize = (16 - reinterpret_cast<std::uintptr_t>(destinationBytes) % 16) % 16;
+	std::memcpy(destinationBytes, sourceBytes, headSize);
+	destinationBytes += headSize;
+	sourceBytes += headSize;
+	size -= headSize;
+
+	// Four registers make a whole 64-byte line
+	std::size_t blocksCount = size / 64;
+	for (; blocksCount > 0; blocksCount--) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sourceBytes));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sourceBytes + 16));
+		const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sourceBytes + 32));
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sourceBytes + 48));
+
+		_mm_stream_si128(reinterpret_cast<__m128i*>(destinationBytes), a);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(destinationBytes + 16), b);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(destinationBytes + 32), c);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(destinationBytes + 48), d);
+
+		destinationBytes += 64;
+		sourceBytes += 64;
+	}
+
+	std::memcpy(destinationBytes, sourceBytes, size % 64);
+
+	// Streaming stores are weakly ordered
+	_mm_sfence();
+#else
+	std::memcpy(destination, source, size);
+#endif
+}
+
+
+void CopySubresource(const SubresourceCopy &copy) {
+	if (IsEmpty(copy)) {
+		return;
+	}
+
+	const bool areSlicesContiguous = copy.destinationRowPitch == copy.sourceRowPitch
+		&& copy.destinationSlicePitch == copy.sourceSlicePitch;
+
+	if (areSlicesContiguous) {
+		// One range from the first row of the first slice to the end of the last row
+		const std::size_t size = (copy.slicesCount - 1) * copy.sourceSlicePitch
+			+ (copy.rowsCount - 1) * copy.sourceRowPitch + copy.rowSize;
+		StreamCopy(copy.destination, copy.source, size);
+		return;
+	}
+
+	for (std::uint32_t slice = 0; slice < copy.slicesCount; slice++) {
+		CopyRows(copy, slice, 0, copy.rowsCount);
+	}
+}
+
+
+void CopySubresources(JobSystem &jobSystem, const SubresourceCopy *copies, std::size_t count) {
+	std::size_t totalSize = 0;
+	for (std::size_t i = 0; i < count; i++) {
+		if (!IsEmpty(copies[i])) {
+			totalSize += copies[i].rowSize * copies[i].rowsCount * copies[i].slicesCount;
+		}
+	}
+
+	if (totalSize < MIN_PARALLEL_SIZE || jobSystem.ThreadsCount() == 1) {
+		for (std::size_t i = 0; i < count; i++) {
+			CopySubresource(copies[i]);
+		}
+		return;
+	}
+
+	// Large slices are split by rows, small ones stay whole, so every chunk is about the same size
+	std::vector<CopyChunk> chunks;
+
+	for (std::size_t i = 0; i < count; i++) {
+		const SubresourceCopy &copy = copies[i];
+		if (IsEmpty(copy)) {
+			continue;
+		}
+
+		const std::uint32_t rowsPerChunk = static_cast<std::uint32_t>(
+			std::max<std::size_t>(1, CHUNK_SIZE / copy.rowSize)
+		);
+
+		for (std::uint32_t slice = 0; slice < copy.slicesCount; slice++) {
+			for (std::uint32_t firstRow = 0; firstRow < copy.rowsCount; firstRow += rowsPerChunk) {
+				chunks.push_back(CopyChunk{ &copy, slice, firstRow, std::min(rowsPerChunk, copy.rowsCount - firstRow) });
+			}
+		}
+	}
+
+	jobSystem.ParallelFor(chunks.size(), [&chunks](std::size_t i) {
+		const CopyChunk &chunk = chunks[i];
+		CopyRows(*chunk.copy, chunk.slice, chunk.firstRow, chunk.rowsCount);
+	});
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+
+#include "JobSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Copy of a subresource between memory layouts, like MemcpySubresource of d3dx12.h.
+// Pitches are in bytes, rowSize is the number of bytes copied from each row
+struct SubresourceCopy {
+	void *destination;
+	std::size_t destinationRowPitch;
+	std::size_t destinationSlicePitch;
+
+	const void *source;
+	std::size_t sourceRowPitch;
+	std::size_t sourceSlicePitch;
+
+	std::size_t rowSize;
+	std::uint32_t rowsCount;
+	std::uint32_t slicesCount;
+};
+
+
+// Copies with non-temporal stores where SSE2 is available, they bypass the cache
+// and fill write-combining buffers with whole lines, which suits upload heaps.
+// The copied data is visible to other devices when the function returns
+void StreamCopy(void *destination, const void *source, std::size_t size);
+
+
+// Copies as few ranges as the layouts allow: the whole subresource when the
+// pitches of both sides match, whole slices when only the row pitches match,
+// row by row otherwise
+void CopySubresource(const SubresourceCopy &copy);
+
+
+// Splits the copies into chunks of rows and spreads them over the threads of
+// the job system. Small batches are copied by the calling thread.
+//
+// Must be called from a thread of the job system
+void CopySubresources(JobSystem &jobSystem, const SubresourceCopy *copies, std::size_t count);
@@ -0,0 +1,69 @@
+#include "TextureFootprints.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace {
+	std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+
+	std::uint64_t DivideRoundingUp(std::uint64_t value, std::uint64_t divisor) {
+		return (value + divisor - 1) / divisor;
+	}
+}
+
+
+std::uint64_t ComputeFootprints(
+	const TextureLayoutDesc &desc,
+	std::uint32_t firstSubresource,
+	std::uint32_t subresourcesCount,
+	std::uint64_t baseOffset,
+	SubresourceFootprint *footprints
+) {
+	if (desc.dimension == TextureDimension::BUFFER) {
+		assert(firstSubresource == 0 && subresourcesCount <= 1);
+
+		if (subresourcesCount == 1) {
+			footprints[0] = SubresourceFootprint{
+				baseOffset, static_cast<std::uint32_t>(desc.width), 1, 1,
+				static_cast<std::uint32_t>(AlignUp(desc.width, TEXTURE_DATA_PITCH_ALIGNMENT)), 1, desc.width
+			};
+		}
+
+		return subresourcesCount == 1 ? desc.width : 0;
+	}
+
+	const std::uint32_t mipLevels = std::max<std::uint32_t>(desc.mipLevels, 1);
+
+	std::uint64_t offset = 0;
+	std::uint64_t totalSize = 0;
+
+	for (std::uint32_t i = 0; i < subresourcesCount; i++) {
+		const std::uint32_t mip = (firstSubresource + i) % mipLevels;
+
+		const std::uint64_t width = std::max<std::uint64_t>(desc.width >> mip, 1);
+		const std::uint32_t height = desc.dimension == TextureDimension::TEXTURE_1D
+			? 1 : std::max<std::uint32_t>(desc.height >> mip, 1);
+		const std::uint32_t depth = desc.dimension == TextureDimension::TEXTURE_3D
+			? std::max<std::uint32_t>(desc.depthOrArraySize >> mip, 1) : 1;
+
+		SubresourceFootprint &footprint = footprints[i];
+		footprint.offset = baseOffset + offset;
+		footprint.width = static_cast<std::uint32_t>(AlignUp(width, desc.blockWidth));
+		footprint.height = static_cast<std::uint32_t>(AlignUp(height, desc.blockHeight));
+		footprint.depth = depth;
+		footprint.rowsCount = static_cast<std::uint32_t>(DivideRoundingUp(height, desc.blockHeight));
+		footprint.rowSize = DivideRoundingUp(width, desc.blockWidth) * desc.bytesPerBlock;
+		footprint.rowPitch = static_cast<std::uint32_t>(AlignUp(footprint.rowSize, TEXTURE_DATA_PITCH_ALIGNMENT));
+
+		const std::uint64_t rowsCount = std::uint64_t(footprint.rowsCount) * depth;
+		totalSize = offset + footprint.rowPitch * (rowsCount - 1) + footprint.rowSize;
+
+		offset = AlignUp(offset + footprint.rowPitch * rowsCount, TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	}
+
+	return totalSize;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+
+#include <cstdint>
+
+
+enum class TextureDimension {
+	BUFFER,
+	TEXTURE_1D,
+	TEXTURE_2D,
+	TEXTURE_3D
+};
+
+
+// Description of a single-plane resource as far as its memory layout goes.
+// Formats are given by their blocks: 1x1 for plain formats, 4x4 for BC
+struct TextureLayoutDesc {
+	TextureDimension dimension;
+	std::uint64_t width;
+	std::uint32_t height;
+	std::uint16_t depthOrArraySize;
+	std::uint16_t mipLevels;
+	std::uint32_t bytesPerBlock;
+	std::uint32_t blockWidth;
+	std::uint32_t blockHeight;
+};
+
+
+// Layout of a subresource in a buffer, the same as D3D12_PLACED_SUBRESOURCE_FOOTPRINT
+// with the number of rows and the size of a row of ID3D12Device::GetCopyableFootprints
+struct SubresourceFootprint {
+	std::uint64_t offset;
+	// Rounded up to whole blocks
+	std::uint32_t width;
+	std::uint32_t height;
+	std::uint32_t depth;
+	std::uint32_t rowPitch;
+	std::uint32_t rowsCount;
+	std::uint64_t rowSize;
+};
+
+
+// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT and D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+constexpr std::uint32_t TEXTURE_DATA_PITCH_ALIGNMENT = 256;
+constexpr std::uint32_t TEXTURE_DATA_PLACEMENT_ALIGNMENT = 512;
+
+
+// Lays out the subresources like ID3D12Device::GetCopyableFootprints, subresource
+// indices are mip + arraySlice * mipLevels. Returns the total size in bytes,
+// which like in D3D12 doesn't include the padding after the last row
+std::uint64_t ComputeFootprints(
+	const TextureLayoutDesc &desc,
+	std::uint32_t firstSubresource,
+	std::uint32_t subresourcesCount,
+	std::uint64_t baseOffset,
+	SubresourceFootprint *footprints
+);
@@ -0,0 +1,289 @@
+#include "TextureUploadBatch.h"
+#include "TextureFootprints.h"
+#include "d3dx12.h"
+
+#include <stdexcept>
+
+
+namespace {
+	// Returns false for formats with several planes or packed pixel pairs, the device lays them out
+	bool GetFormatBlock(DXGI_FORMAT format, UINT &bytesPerBlock, UINT &blockSize) {
+		blockSize = 1;
+
+		switch (format) {
+		case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+		case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		case DXGI_FORMAT_R32G32B32A32_UINT:
+		case DXGI_FORMAT_R32G32B32A32_SINT:
+			bytesPerBlock = 16;
+			return true;
+
+		case DXGI_FORMAT_R32G32B32_TYPELESS:
+		case DXGI_FORMAT_R32G32B32_FLOAT:
+		case DXGI_FORMAT_R32G32B32_UINT:
+		case DXGI_FORMAT_R32G32B32_SINT:
+			bytesPerBlock = 12;
+			return true;
+
+		case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		case DXGI_FORMAT_R16G16B16A16_UNORM:
+		case DXGI_FORMAT_R16G16B16A16_UINT:
+		case DXGI_FORMAT_R16G16B16A16_SNORM:
+		case DXGI_FORMAT_R16G16B16A16_SINT:
+		case DXGI_FORMAT_R32G32_TYPELESS:
+		case DXGI_FORMAT_R32G32_FLOAT:
+		case DXGI_FORMAT_R32G32_UINT:
+		case DXGI_FORMAT_R32G32_SINT:
+			bytesPerBlock = 8;
+			return true;
+
+		case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+		case DXGI_FORMAT_R10G10B10A2_UNORM:
+		case DXGI_FORMAT_R10G10B10A2_UINT:
+		case DXGI_FORMAT_R11G11B10_FLOAT:
+		case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_R8G8B8A8_UINT:
+		case DXGI_FORMAT_R8G8B8A8_SNORM:
+		case DXGI_FORMAT_R8G8B8A8_SINT:
+		case DXGI_FORMAT_R16G16_TYPELESS:
+		case DXGI_FORMAT_R16G16_FLOAT:
+		case DXGI_FORMAT_R16G16_UNORM:
+		case DXGI_FORMAT_R16G16_UINT:
+		case DXGI_FORMAT_R16G16_SNORM:
+		case DXGI_FORMAT_R16G16_SINT:
+		case DXGI_FORMAT_R32_TYPELESS:
+		case DXGI_FORMAT_D32_FLOAT:
+		case DXGI_FORMAT_R32_FLOAT:
+		case DXGI_FORMAT_R32_UINT:
+		case DXGI_FORMAT_R32_SINT:
+		case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8X8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+		case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+			bytesPerBlock = 4;
+			return true;
+
+		case DXGI_FORMAT_R8G8_TYPELESS:
+		case DXGI_FORMAT_R8G8_UNORM:
+		case DXGI_FORMAT_R8G8_UINT:
+		case DXGI_FORMAT_R8G8_SNORM:
+		case DXGI_FORMAT_R8G8_SINT:
+		case DXGI_FORMAT_R16_TYPELESS:
+		case DXGI_FORMAT_R16_FLOAT:
+		case DXGI_FORMAT_D16_UNORM:
+		case DXGI_FORMAT_R16_UNORM:
+		case DXGI_FORMAT_R16_UINT:
+		case DXGI_FORMAT_R16_SNORM:
+		case DXGI_FORMAT_R16_SINT:
+		case DXGI_FORMAT_B5G6R5_UNORM:
+		case DXGI_FORMAT_B5G5R5A1_UNORM:
+		case DXGI_FORMAT_B4G4R4A4_UNORM:
+			bytesPerBlock = 2;
+			return true;
+
+		case DXGI_FORMAT_R8_TYPELESS:
+		case DXGI_FORMAT_R8_UNORM:
+		case DXGI_FORMAT_R8_UINT:
+		case DXGI_FORMAT_R8_SNORM:
+		case DXGI_FORMAT_R8_SINT:
+		case DXGI_FORMAT_A8_UNORM:
+			bytesPerBlock = 1;
+			return true;
+
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC4_TYPELESS:
+		case DXGI_FORMAT_BC4_UNORM:
+		case DXGI_FORMAT_BC4_SNORM:
+			bytesPerBlock = 8;
+			blockSize = 4;
+			return true;
+
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC5_SNORM:
+		case DXGI_FORMAT_BC6H_TYPELESS:
+		case DXGI_FORMAT_BC6H_UF16:
+		case DXGI_FORMAT_BC6H_SF16:
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			bytesPerBlock = 16;
+			blockSize = 4;
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+
+	TextureDimension ToTextureDimension(D3D12_RESOURCE_DIMENSION dimension) {
+		switch (dimension) {
+		case D3D12_RESOURCE_DIMENSION_BUFFER:
+			return TextureDimension::BUFFER;
+		case D3D12_RESOURCE_DIMENSION_TEXTURE1D:
+			return TextureDimension::TEXTURE_1D;
+		case D3D12_RESOURCE_DIMENSION_TEXTURE3D:
+			return TextureDimension::TEXTURE_3D;
+		default:
+			return TextureDimension::TEXTURE_2D;
+		}
+	}
+}
+
+
+TextureUploadBatch::TextureUploadBatch(GraphicsDevice &device, Uploads &uploads, JobSystem &jobSystem)
+: mDevice(device.GetD3dDevice()), mUploads(uploads), mJobSystem(jobSystem) {
+}
+
+
+void TextureUploadBatch::Add(
+	ID3D12Resource *destination,
+	UINT firstSubresource,
+	UINT subresourcesCount,
+	const D3D12_SUBRESOURCE_DATA *data
+) {
+	if (subresourcesCount == 0) {
+		return;
+	}
+
+	const Layout &layout = GetLayout(destination->GetDesc());
+	if (firstSubresource + subresourcesCount > layout.footprints.size()) {
+		throw std::out_of_range("Subresources out of the range of the resource");
+	}
+
+	const D3D12_PLACED_SUBRESOURCE_FOOTPRINT &first = layout.footprints[firstSubresource];
+	const UINT last = firstSubresource + subresourcesCount - 1;
+	const D3D12_SUBRESOURCE_FOOTPRINT &lastFootprint = layout.footprints[last].Footprint;
+
+	const UINT64 stagingSize = layout.footprints[last].Offset - first.Offset
+		+ UINT64(lastFootprint.RowPitch) * (layout.rowsCounts[last] * lastFootprint.Depth - 1) + layout.rowSizes[last];
+
+	const Uploads::Allocation staging = mUploads.AllocateTextureData(stagingSize);
+
+	for (UINT i = firstSubresource; i <= last; i++) {
+		const D3D12_PLACED_SUBRESOURCE_FOOTPRINT &footprint = layout.footprints[i];
+		const UINT64 relativeOffset = footprint.Offset - first.Offset;
+
+		SubresourceCopy dataCopy;
+		dataCopy.destination = staging.cpuAddress + relativeOffset;
+		dataCopy.destinationRowPitch = footprint.Footprint.RowPitch;
+		dataCopy.destinationSlicePitch = std::size_t(footprint.Footprint.RowPitch) * layout.rowsCounts[i];
+		dataCopy.source = data[i - firstSubresource].pData;
+		dataCopy.sourceRowPitch = static_cast<std::size_t>(data[i - firstSubresource].RowPitch);
+		dataCopy.sourceSlicePitch = static_cast<std::size_t>(data[i - firstSubresource].SlicePitch);
+		dataCopy.rowSize = static_cast<std::size_t>(layout.rowSizes[i]);
+		dataCopy.rowsCount = layout.rowsCounts[i];
+		dataCopy.slicesCount = footprint.Footprint.Depth;
+		mDataCopies.push_back(dataCopy);
+
+		PendingCopy pendingCopy;
+		pendingCopy.destination = destination;
+		pendingCopy.subresource = i;
+		pendingCopy.source = staging.buffer->Resource();
+		pendingCopy.footprint = footprint;
+		pendingCopy.footprint.Offset = staging.offset + relativeOffset;
+		pendingCopy.isBuffer = layout.isBuffer;
+		mPendingCopies.push_back(pendingCopy);
+	}
+}
+
+
+void TextureUploadBatch::Record(ID3D12GraphicsCommandList *commandList) {
+	CopySubresources(mJobSystem, mDataCopies.data(), mDataCopies.size());
+
+	for (const PendingCopy &pendingCopy : mPendingCopies) {
+		if (pendingCopy.isBuffer) {
+			commandList->CopyBufferRegion(
+				pendingCopy.destination, 0, pendingCopy.source, pendingCopy.footprint.Offset, pendingCopy.footprint.Footprint.Width
+			);
+			continue;
+		}
+
+		const CD3DX12_TEXTURE_COPY_LOCATION destination(pendingCopy.destination, pendingCopy.subresource);
+		const CD3DX12_TEXTURE_COPY_LOCATION source(pendingCopy.source, pendingCopy.footprint);
+		commandList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+	}
+
+	mDataCopies.clear();
+	mPendingCopies.clear();
+}
+
+
+const TextureUploadBatch::Layout& TextureUploadBatch::GetLayout(const D3D12_RESOURCE_DESC &desc) {
+	const LayoutKey key = {
+		(std::uint64_t(desc.Dimension) << 32) | desc.Format,
+		desc.Width,
+		(std::uint64_t(desc.Height) << 32) | (std::uint64_t(desc.DepthOrArraySize) << 16) | desc.MipLevels,
+		(std::uint64_t(desc.SampleDesc.Count) << 32) | desc.SampleDesc.Quality,
+		(std::uint64_t(desc.Layout) << 32) | desc.Flags,
+		desc.Alignment
+	};
+
+	auto it = mLayouts.find(key);
+	if (it != mLayouts.end()) {
+		return it->second;
+	}
+
+	const bool isBuffer = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
+	const UINT arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D || isBuffer ? 1 : desc.DepthOrArraySize;
+	const UINT subresourcesCount = isBuffer
+		? 1 : desc.MipLevels * arraySize * D3D12GetFormatPlaneCount(mDevice.Get(), desc.Format);
+
+	Layout layout;
+	layout.isBuffer = isBuffer;
+	layout.footprints.resize(subresourcesCount);
+	layout.rowsCounts.resize(subresourcesCount);
+	layout.rowSizes.resize(subresourcesCount);
+
+	UINT bytesPerBlock;
+	UINT blockSize;
+	if (isBuffer || (subresourcesCount == desc.MipLevels * arraySize && GetFormatBlock(desc.Format, bytesPerBlock, blockSize))) {
+		TextureLayoutDesc layoutDesc;
+		layoutDesc.dimension = ToTextureDimension(desc.Dimension);
+		layoutDesc.width = desc.Width;
+		layoutDesc.height = desc.Height;
+		layoutDesc.depthOrArraySize = desc.DepthOrArraySize;
+		layoutDesc.mipLevels = desc.MipLevels;
+		layoutDesc.bytesPerBlock = isBuffer ? 1 : bytesPerBlock;
+		layoutDesc.blockWidth = isBuffer ? 1 : blockSize;
+		layoutDesc.blockHeight = isBuffer ? 1 : blockSize;
+
+		std::vector<SubresourceFootprint> footprints(subresourcesCount);
+		ComputeFootprints(layoutDesc, 0, subresourcesCount, 0, footprints.data());
+
+		for (UINT i = 0; i < subresourcesCount; i++) {
+			D3D12_PLACED_SUBRESOURCE_FOOTPRINT &footprint = layout.footprints[i];
+			footprint.Offset = footprints[i].offset;
+			footprint.Footprint.Format = desc.Format;
+			footprint.Footprint.Width = footprints[i].width;
+			footprint.Footprint.Height = footprints[i].height;
+			footprint.Footprint.Depth = footprints[i].depth;
+			footprint.Footprint.RowPitch = footprints[i].rowPitch;
+
+			layout.rowsCounts[i] = footprints[i].rowsCount;
+			layout.rowSizes[i] = footprints[i].rowSize;
+		}
+	} else {
+		mDevice->GetCopyableFootprints(
+			&desc, 0, subresourcesCount, 0,
+			layout.footprints.data(), layout.rowsCounts.data(), layout.rowSizes.data(), nullptr
+		);
+	}
+
+	return mLayouts.emplace(key, std::move(layout)).first->second;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "JobSystem.h"
+#include "UploadBuffer.h"
+#include "UploadRing.h"
+#include "SubresourceCopy.h"
+#include "Hash.h"
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+// Uploads of many textures and buffers recorded into one command list.
+//
+// Unlike UpdateSubresources of d3dx12.h, nothing is allocated, mapped or
+// queried from the device per upload: footprints are computed once per
+// resource description and cached, staging memory comes from the persistently
+// mapped upload ring, and the data is copied into it in parallel when the
+// batch is recorded. Footprints of single-plane formats are computed on the CPU,
+// the device is only asked for the other ones.
+//
+// This class is not thread-safe
+class TextureUploadBatch {
+public:
+	using Uploads = UploadRing<WaitableGpuFence, UploadBuffer>;
+
+public:
+	TextureUploadBatch(GraphicsDevice &device, Uploads &uploads, JobSystem &jobSystem);
+	TextureUploadBatch(const TextureUploadBatch&) = delete;
+
+	TextureUploadBatch& operator = (const TextureUploadBatch&) = delete;
+
+	// The data must stay valid until Record
+	void Add(ID3D12Resource *destination, UINT firstSubresource, UINT subresourcesCount, const D3D12_SUBRESOURCE_DATA *data);
+
+	// Copies the data of every added upload into staging memory and records the
+	// copies into the list. Destinations must be in the COPY_DEST state.
+	// Must be called from a thread of the job system
+	void Record(ID3D12GraphicsCommandList *commandList);
+
+	std::size_t CachedLayoutsCount() const {
+		return mLayouts.size();
+	}
+
+private:
+	// Footprints of every subresource of a resource, offsets from the first one
+	struct Layout {
+		bool isBuffer;
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints;
+		std::vector<UINT> rowsCounts;
+		std::vector<UINT64> rowSizes;
+	};
+
+	// The fields of a D3D12_RESOURCE_DESC without its padding
+	using LayoutKey = std::array<std::uint64_t, 6>;
+
+	struct LayoutKeyHash {
+		std::size_t operator () (const LayoutKey &key) const {
+			return static_cast<std::size_t>(HashBytes(key.data(), sizeof(key)));
+		}
+	};
+
+	struct PendingCopy {
+		ID3D12Resource *destination;
+		UINT subresource;
+		ID3D12Resource *source;
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+		bool isBuffer;
+	};
+
+private:
+	const Layout& GetLayout(const D3D12_RESOURCE_DESC &desc);
+
+private:
+	ComPtr<ID3D12Device> mDevice;
+	Uploads &mUploads;
+	JobSystem &mJobSystem;
+
+	std::unordered_map<LayoutKey, Layout, LayoutKeyHash> mLayouts;
+
+	// Kept between batches, so they stop allocating once they're big enough
+	std::vector<SubresourceCopy> mDataCopies;
+	std::vector<PendingCopy> mPendingCopies;
+};
@@ -0,0 +1,303 @@
+#include "TlsfAllocator.h"
+
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace {
+	std::uint32_t MostSignificantBit(std::uint64_t value) {
+		assert(value != 0);
+
+		#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return index;
+		#else
+		return 63 - __builtin_clzll(value);
+		#endif
+	}
+
+
+	std::uint32_t LeastSignificantBit(std::uint64_t value) {
+		assert(value != 0);
+
+		#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+		#else
+		return __builtin_ctzll(value);
+		#endif
+	}
+
+
+	std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+
+TlsfAllocator::TlsfAllocator(std::uint64_t size)
+: mSize(size), mFreeSize(size) {
+	assert(size > 0);
+
+	for (auto &heads : mFreeHeads) {
+		for (auto &head : heads) {
+			head = NO_BLOCK;
+		}
+	}
+
+	std::uint32_t block = NewBlock();
+	mBlocks[block].offset = 0;
+	mBlocks[block].size = size;
+	InsertFreeBlock(block);
+}
+
+
+TlsfAllocator::Allocation TlsfAllocator::Allocate(std::uint64_t size, std::uint64_t alignment) {
+	assert(size > 0);
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	Allocation allocation;
+
+	std::uint32_t block = FindFreeBlock(size);
+	if (block != NO_BLOCK) {
+		const Block &candidate = mBlocks[block];
+		if (AlignUp(candidate.offset, alignment) + size > candidate.offset + candidate.size) {
+			block = NO_BLOCK;
+		}
+	}
+
+	if (block == NO_BLOCK && alignment > 1) {
+		// Any block of this size fits wherever it starts
+		block = FindFreeBlock(size + alignment - 1);
+	}
+
+	if (block == NO_BLOCK) {
+		return allocation;
+	}
+
+	RemoveFreeBlock(block);
+
+	const std::uint64_t padding = AlignUp(mBlocks[block].offset, alignment) - mBlocks[block].offset;
+	if (padding > 0) {
+		InsertFreeBlock(SplitFront(block, padding));
+	}
+
+	if (mBlocks[block].size > size) {
+		std::uint32_t used = SplitFront(block, size);
+		InsertFreeBlock(block);
+		block = used;
+	}
+
+	mBlocks[block].isFree = false;
+	mFreeSize -= size;
+	mAllocationsCount++;
+
+	allocation.offset = mBlocks[block].offset;
+	allocation.block = block;
+
+	return allocation;
+}
+
+
+void TlsfAllocator::Free(const Allocation &allocation) {
+	std::uint32_t block = allocation.block;
+	assert(block < mBlocks.size() && !mBlocks[block].isFree && mBlocks[block].offset == allocation.offset);
+
+	mFreeSize += mBlocks[block].size;
+	mAllocationsCount--;
+
+	std::uint32_t next = mBlocks[block].nextPhysical;
+	if (next != NO_BLOCK && mBlocks[next].isFree) {
+		RemoveFreeBlock(next);
+		MergeNext(block);
+	}
+
+	std::uint32_t previous = mBlocks[block].previousPhysical;
+	if (previous != NO_BLOCK && mBlocks[previous].isFree) {
+		RemoveFreeBlock(previous);
+		MergeNext(previous);
+		block = previous;
+	}
+
+	InsertFreeBlock(block);
+}
+
+
+std::uint64_t TlsfAllocator::LargestFreeBlockSize() const {
+	if (mFlBitmap == 0) {
+		return 0;
+	}
+
+	const std::uint32_t fl = MostSignificantBit(mFlBitmap);
+	const std::uint32_t sl = MostSignificantBit(mSlBitmaps[fl]);
+
+	std::uint64_t largestSize = 0;
+	for (std::uint32_t block = mFreeHeads[fl][sl]; block != NO_BLOCK; block = mBlocks[block].nextFree) {
+		if (mBlocks[block].size > largestSize) {
+			largestSize = mBlocks[block].size;
+		}
+	}
+
+	return largestSize;
+}
+
+
+void TlsfAllocator::Mapping(std::uint64_t size, std::uint32_t &fl, std::uint32_t &sl) {
+	if (size < SL_COUNT) {
+		// Small sizes are binned linearly
+		fl = 0;
+		sl = static_cast<std::uint32_t>(size);
+		return;
+	}
+
+	const std::uint32_t msb = MostSignificantBit(size);
+	fl = msb - SL_BITS + 1;
+	sl = static_cast<std::uint32_t>(size >> (msb - SL_BITS)) - SL_COUNT;
+}
+
+
+void TlsfAllocator::MappingSearch(std::uint64_t size, std::uint32_t &fl, std::uint32_t &sl) {
+	if (size >= SL_COUNT) {
+		const std::uint64_t roundUp = (std::uint64_t(1) << (MostSignificantBit(size) - SL_BITS)) - 1;
+		size = size + roundUp < size ? UINT64_MAX : size + roundUp;
+	}
+
+	Mapping(size, fl, sl);
+}
+
+
+std::uint32_t TlsfAllocator::FindFreeBlock(std::uint64_t size) const {
+	if (size > mSize) {
+		return NO_BLOCK;
+	}
+
+	std::uint32_t fl;
+	std::uint32_t sl;
+	MappingSearch(size, fl, sl);
+
+	std::uint32_t slBitmap = mSlBitmaps[fl] & (~0u << sl);
+	if (slBitmap == 0) {
+		const std::uint64_t flBitmap = fl + 1 < 64 ? mFlBitmap & (~std::uint64_t(0) << (fl + 1)) : 0;
+		if (flBitmap == 0) {
+			return NO_BLOCK;
+		}
+
+		fl = LeastSignificantBit(flBitmap);
+		slBitmap = mSlBitmaps[fl];
+	}
+
+	return mFreeHeads[fl][LeastSignificantBit(slBitmap)];
+}
+
+
+void TlsfAllocator::InsertFreeBlock(std::uint32_t block) {
+	std::uint32_t fl;
+	std::uint32_t sl;
+	Mapping(mBlocks[block].size, fl, sl);
+
+	const std::uint32_t head = mFreeHeads[fl][sl];
+
+	mBlocks[block].isFree = true;
+	mBlocks[block].previousFree = NO_BLOCK;
+	mBlocks[block].nextFree = head;
+	if (head != NO_BLOCK) {
+		mBlocks[head].previousFree = block;
+	}
+
+	mFreeHeads[fl][sl] = block;
+	mFlBitmap |= std::uint64_t(1) << fl;
+	mSlBitmaps[fl] |= 1u << sl;
+}
+
+
+void TlsfAllocator::RemoveFreeBlock(std::uint32_t block) {
+	std::uint32_t fl;
+	std::uint32_t sl;
+	Mapping(mBlocks[block].size, fl, sl);
+
+	const std::uint32_t previous = mBlocks[block].previousFree;
+	const std::uint32_t next = mBlocks[block].nextFree;
+
+	if (next != NO_BLOCK) {
+		mBlocks[next].previousFree = previous;
+	}
+
+	if (previous != NO_BLOCK) {
+		mBlocks[previous].nextFree = next;
+	} else {
+		mFreeHeads[fl][sl] = next;
+		if (next == NO_BLOCK) {
+			mSlBitmaps[fl] &= ~(1u << sl);
+			if (mSlBitmaps[fl] == 0) {
+				mFlBitmap &= ~(std::uint64_t(1) << fl);
+			}
+		}
+	}
+
+	mBlocks[block].isFree = false;
+}
+
+
+std::uint32_t TlsfAllocator::SplitFront(std::uint32_t block, std::uint64_t size) {
+	assert(size < mBlocks[block].size);
+
+	// Can reallocate the blocks, so no references are held across it
+	const std::uint32_t front = NewBlock();
+
+	Block &original = mBlocks[block];
+	Block &split = mBlocks[front];
+
+	split.offset = original.offset;
+	split.size = size;
+	split.previousPhysical = original.previousPhysical;
+	split.nextPhysical = block;
+	split.isFree = false;
+
+	if (original.previousPhysical != NO_BLOCK) {
+		mBlocks[original.previousPhysical].nextPhysical = front;
+	}
+
+	original.offset += size;
+	original.size -= size;
+	original.previousPhysical = front;
+
+	return front;
+}
+
+
+void TlsfAllocator::MergeNext(std::uint32_t block) {
+	const std::uint32_t next = mBlocks[block].nextPhysical;
+
+	mBlocks[block].size += mBlocks[next].size;
+	mBlocks[block].nextPhysical = mBlocks[next].nextPhysical;
+	if (mBlocks[next].nextPhysical != NO_BLOCK) {
+		mBlocks[mBlocks[next].nextPhysical].previousPhysical = block;
+	}
+
+	DeleteBlock(next);
+}
+
+
+std::uint32_t TlsfAllocator::NewBlock() {
+	std::uint32_t block;
+	if (!mUnusedBlocks.empty()) {
+		block = mUnusedBlocks.back();
+		mUnusedBlocks.pop_back();
+	} else {
+		block = static_cast<std::uint32_t>(mBlocks.size());
+		mBlocks.emplace_back();
+	}
+
+	mBlocks[block] = Block{ 0, 0, NO_BLOCK, NO_BLOCK, NO_BLOCK, NO_BLOCK, false };
+	return block;
+}
+
+
+void TlsfAllocator::DeleteBlock(std::uint32_t block) {
+	mUnusedBlocks.push_back(block);
+}
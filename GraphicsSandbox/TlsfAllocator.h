@@ -0,0 +1,105 @@
+#pragma once
+
+
+#include <cstdint>
+#include <vector>
+
+
+// Two-level segregated fit allocator of an address range that it doesn't own,
+// e.g. the memory of a GPU heap. Allocation and freeing take constant time.
+//
+// Free blocks are binned by the power of two of their size and by SL_COUNT
+// subdivisions of it. The bookkeeping lives outside of the managed range.
+//
+// This class is not thread-safe
+class TlsfAllocator {
+public:
+	static constexpr std::uint64_t INVALID_OFFSET = UINT64_MAX;
+
+	struct Allocation {
+		std::uint64_t offset = INVALID_OFFSET;
+		std::uint32_t block = 0;
+	};
+
+public:
+	explicit TlsfAllocator(std::uint64_t size);
+	TlsfAllocator(const TlsfAllocator&) = delete;
+
+	TlsfAllocator& operator = (const TlsfAllocator&) = delete;
+
+	// Alignment must be a power of two. Returns INVALID_OFFSET if no free block fits
+	Allocation Allocate(std::uint64_t size, std::uint64_t alignment = 1);
+
+	void Free(const Allocation &allocation);
+
+	std::uint64_t Size() const {
+		return mSize;
+	}
+
+	std::uint64_t FreeSize() const {
+		return mFreeSize;
+	}
+
+	bool IsEmpty() const {
+		return mFreeSize == mSize;
+	}
+
+	std::uint32_t AllocationsCount() const {
+		return mAllocationsCount;
+	}
+
+	// Together with FreeSize tells how fragmented the range is
+	std::uint64_t LargestFreeBlockSize() const;
+
+private:
+	static constexpr std::uint32_t SL_BITS = 4;
+	static constexpr std::uint32_t SL_COUNT = 1 << SL_BITS;
+	static constexpr std::uint32_t FL_COUNT = 64 - SL_BITS + 1;
+	static constexpr std::uint32_t NO_BLOCK = UINT32_MAX;
+
+	struct Block {
+		std::uint64_t offset;
+		std::uint64_t size;
+
+		// Neighbours in the address range
+		std::uint32_t previousPhysical;
+		std::uint32_t nextPhysical;
+
+		// Neighbours in the free list of the bin
+		std::uint32_t previousFree;
+		std::uint32_t nextFree;
+
+		bool isFree;
+	};
+
+	static void Mapping(std::uint64_t size, std::uint32_t &fl, std::uint32_t &sl);
+
+	// Maps to the first bin whose blocks are all at least of the size
+	static void MappingSearch(std::uint64_t size, std::uint32_t &fl, std::uint32_t &sl);
+
+	std::uint32_t FindFreeBlock(std::uint64_t size) const;
+
+	void InsertFreeBlock(std::uint32_t block);
+	void RemoveFreeBlock(std::uint32_t block);
+
+	// Cuts the first size units of the block into a new block and returns it
+	std::uint32_t SplitFront(std::uint32_t block, std::uint64_t size);
+
+	// Merges the next physical block into the block
+	void MergeNext(std::uint32_t block);
+
+	std::uint32_t NewBlock();
+	void DeleteBlock(std::uint32_t block);
+
+private:
+	const std::uint64_t mSize;
+	std::uint64_t mFreeSize;
+	std::uint32_t mAllocationsCount = 0;
+
+	std::vector<Block> mBlocks;
+	std::vector<std::uint32_t> mUnusedBlocks;
+
+	std::uint64_t mFlBitmap = 0;
+	std::uint32_t mSlBitmaps[FL_COUNT] = {};
+	std::uint32_t mFreeHeads[FL_COUNT][SL_COUNT];
+};
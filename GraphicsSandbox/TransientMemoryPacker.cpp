@@ -0,0 +1,89 @@
+#include "TransientMemoryPacker.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace {
+	std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+
+	bool LifetimesOverlap(const TransientResourceLifetime &a, const TransientResourceLifetime &b) {
+		return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+	}
+}
+
+
+std::uint64_t TransientMemoryPacker::Pack(const TransientResourceLifetime *resources, std::size_t count) {
+	mPlacements.resize(count);
+	mOrder.resize(count);
+	mMemorySize = 0;
+
+	for (std::uint32_t i = 0; i < count; i++) {
+		assert(resources[i].firstPass <= resources[i].lastPass);
+		assert(resources[i].alignment > 0 && (resources[i].alignment & (resources[i].alignment - 1)) == 0);
+
+		mOrder[i] = i;
+		mPlacements[i].aliasedResources.clear();
+	}
+
+	// Large resources first leave the gaps between them to the small ones
+	std::sort(mOrder.begin(), mOrder.end(), [resources](std::uint32_t a, std::uint32_t b) {
+		if (resources[a].size != resources[b].size) {
+			return resources[a].size > resources[b].size;
+		}
+
+		return resources[a].firstPass < resources[b].firstPass;
+	});
+
+	for (std::size_t i = 0; i < count; i++) {
+		const std::uint32_t resource = mOrder[i];
+		const TransientResourceLifetime &lifetime = resources[resource];
+
+		mOccupied.clear();
+		for (std::size_t j = 0; j < i; j++) {
+			const std::uint32_t placed = mOrder[j];
+			if (LifetimesOverlap(lifetime, resources[placed])) {
+				mOccupied.push_back(Interval{ mPlacements[placed].offset, mPlacements[placed].offset + resources[placed].size });
+			}
+		}
+
+		std::sort(mOccupied.begin(), mOccupied.end(), [](const Interval &a, const Interval &b) {
+			return a.begin < b.begin;
+		});
+
+		std::uint64_t offset = 0;
+		for (const Interval &interval : mOccupied) {
+			if (interval.end <= offset) {
+				continue;
+			}
+
+			if (interval.begin >= offset + lifetime.size) {
+				break;
+			}
+
+			offset = AlignUp(interval.end, lifetime.alignment);
+		}
+
+		mPlacements[resource].offset = offset;
+		mMemorySize = std::max(mMemorySize, offset + lifetime.size);
+	}
+
+	for (std::uint32_t i = 0; i < count; i++) {
+		const std::uint64_t begin = mPlacements[i].offset;
+		const std::uint64_t end = begin + resources[i].size;
+
+		for (std::uint32_t j = 0; j < count; j++) {
+			const std::uint64_t otherBegin = mPlacements[j].offset;
+			const std::uint64_t otherEnd = otherBegin + resources[j].size;
+
+			if (resources[j].lastPass < resources[i].firstPass && otherBegin < end && begin < otherEnd) {
+				mPlacements[i].aliasedResources.push_back(j);
+			}
+		}
+	}
+
+	return mMemorySize;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Memory requirements of a resource that lives from its first-use pass to its
+// last-use pass, both inclusive
+struct TransientResourceLifetime {
+	std::uint64_t size;
+	std::uint64_t alignment;
+	std::uint32_t firstPass;
+	std::uint32_t lastPass;
+};
+
+
+// Packs resources with disjoint lifetimes into the same memory.
+//
+// Resources are placed from the largest to the smallest, each at the lowest
+// offset that doesn't overlap a resource alive at the same time. Memory of a
+// resource that overlaps the memory of earlier ones must be aliased before its
+// first use, those earlier resources are reported as aliased by it.
+//
+// Scratch memory is kept between calls, so packing a frame of the same size
+// again doesn't allocate.
+//
+// This class is not thread-safe
+class TransientMemoryPacker {
+public:
+	TransientMemoryPacker() = default;
+	TransientMemoryPacker(const TransientMemoryPacker&) = delete;
+
+	TransientMemoryPacker& operator = (const TransientMemoryPacker&) = delete;
+
+	// Alignments must be powers of two. Returns the size of the memory
+	std::uint64_t Pack(const TransientResourceLifetime *resources, std::size_t count);
+
+	std::uint64_t Offset(std::size_t resource) const {
+		return mPlacements[resource].offset;
+	}
+
+	// Resources whose memory the resource takes over at its first pass
+	const std::vector<std::uint32_t>& AliasedResources(std::size_t resource) const {
+		return mPlacements[resource].aliasedResources;
+	}
+
+	std::uint64_t MemorySize() const {
+		return mMemorySize;
+	}
+
+private:
+	struct Placement {
+		std::uint64_t offset;
+		std::vector<std::uint32_t> aliasedResources;
+	};
+
+	struct Interval {
+		std::uint64_t begin;
+		std::uint64_t end;
+	};
+
+	std::vector<Placement> mPlacements;
+	std::uint64_t mMemorySize = 0;
+
+	std::vector<std::uint32_t> mOrder;
+	std::vector<Interval> mOccupied;
+};
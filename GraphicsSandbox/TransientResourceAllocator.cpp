@@ -0,0 +1,195 @@
+#include "TransientResourceAllocator.h"
+#include "d3dx12.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+TransientResourceAllocator::TransientResourceAllocator(
+	GraphicsDevice &device,
+	WaitableGpuFence &fence,
+	GpuMemoryAllocator &memory
+)
+: mDevice(device), mMemory(memory), mRetiringGenerations(fence) {
+}
+
+
+void TransientResourceAllocator::BeginDeclarations() {
+	mDeclarations.clear();
+}
+
+
+UINT TransientResourceAllocator::Declare(
+	const D3D12_RESOURCE_DESC &desc,
+	D3D12_RESOURCE_STATES initialState,
+	const D3D12_CLEAR_VALUE *clearValue,
+	UINT firstPass,
+	UINT lastPass
+) {
+	Declaration declaration = {};
+	declaration.desc = desc;
+	declaration.initialState = initialState;
+	declaration.hasClearValue = clearValue != nullptr;
+	if (clearValue != nullptr) {
+		declaration.clearValue = *clearValue;
+	}
+	declaration.firstPass = firstPass;
+	declaration.lastPass = lastPass;
+
+	mDeclarations.push_back(declaration);
+	return static_cast<UINT>(mDeclarations.size() - 1);
+}
+
+
+bool TransientResourceAllocator::Compile() {
+	const bool isSame = mDeclarations.size() == mCompiledDeclarations.size()
+		&& std::equal(mDeclarations.begin(), mDeclarations.end(), mCompiledDeclarations.begin(), AreSame);
+
+	if (isSame) {
+		return false;
+	}
+
+	// The GPU may still use the previous resources
+	for (auto &resource : mResources) {
+		mReplacedThisFrame.resources.push_back(std::move(resource));
+	}
+	for (auto &allocation : mAllocations) {
+		mReplacedThisFrame.allocations.push_back(allocation);
+	}
+
+	mResources.assign(mDeclarations.size(), nullptr);
+	mAllocations.clear();
+	mAliasedResources.assign(mDeclarations.size(), std::vector<UINT>());
+
+	// Tier 1 heaps can't mix categories, so each one is packed separately
+	for (UINT category = 0; category < CATEGORIES_COUNT; category++) {
+		mLifetimes.clear();
+		mCategoryResources.clear();
+
+		UINT64 alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+		for (UINT id = 0; id < mDeclarations.size(); id++) {
+			const Declaration &declaration = mDeclarations[id];
+			if (static_cast<UINT>(GpuMemoryAllocator::CategoryOf(declaration.desc)) != category) {
+				continue;
+			}
+
+			D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = mMemory.GetAllocationInfo(declaration.desc);
+			alignment = std::max(alignment, allocationInfo.Alignment);
+
+			mLifetimes.push_back(TransientResourceLifetime{
+				allocationInfo.SizeInBytes, allocationInfo.Alignment, declaration.firstPass, declaration.lastPass
+			});
+			mCategoryResources.push_back(id);
+		}
+
+		if (mLifetimes.empty()) {
+			continue;
+		}
+
+		D3D12_RESOURCE_ALLOCATION_INFO memoryInfo;
+		memoryInfo.SizeInBytes = mPacker.Pack(mLifetimes.data(), mLifetimes.size());
+		memoryInfo.Alignment = alignment;
+
+		GpuAllocation allocation = mMemory.Allocate(
+			D3D12_HEAP_TYPE_DEFAULT, static_cast<GpuMemoryCategory>(category), memoryInfo
+		);
+		mAllocations.push_back(allocation);
+
+		for (UINT i = 0; i < mCategoryResources.size(); i++) {
+			const UINT id = mCategoryResources[i];
+			const Declaration &declaration = mDeclarations[id];
+
+			D3D12_RESOURCE_DESC desc = declaration.desc;
+			desc.Alignment = mLifetimes[i].alignment;
+
+			D3D_CHECK(mDevice.GetD3dDevice()->CreatePlacedResource(
+				allocation.heap,
+				allocation.offset + mPacker.Offset(i),
+				&desc,
+				declaration.initialState,
+				declaration.hasClearValue ? &declaration.clearValue : nullptr,
+				IID_PPV_ARGS(&mResources[id])
+			));
+
+			for (std::uint32_t aliased : mPacker.AliasedResources(i)) {
+				mAliasedResources[id].push_back(mCategoryResources[aliased]);
+			}
+		}
+	}
+
+	mCompiledDeclarations = mDeclarations;
+	return true;
+}
+
+
+void TransientResourceAllocator::AppendAliasingBarriers(UINT pass, std::vector<D3D12_RESOURCE_BARRIER> &barriers) const {
+	for (UINT id = 0; id < mCompiledDeclarations.size(); id++) {
+		if (mCompiledDeclarations[id].firstPass != pass) {
+			continue;
+		}
+
+		// Null stands for any resource, including the ones of the previous frame
+		const std::vector<UINT> &aliased = mAliasedResources[id];
+		ID3D12Resource *before = aliased.size() == 1 ? mResources[aliased.front()].Get() : nullptr;
+
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, mResources[id].Get()));
+	}
+}
+
+
+void TransientResourceAllocator::EndFrame(const WaitableGpuFence::Label &label) {
+	Generation completed;
+	while (mRetiringGenerations.TryAcquire(completed)) {
+		Free(completed);
+	}
+
+	if (!mReplacedThisFrame.resources.empty() || !mReplacedThisFrame.allocations.empty()) {
+		mRetiringGenerations.Release(std::move(mReplacedThisFrame), label);
+		mReplacedThisFrame = Generation();
+	}
+}
+
+
+UINT64 TransientResourceAllocator::MemorySize() const {
+	UINT64 memorySize = 0;
+	for (const GpuAllocation &allocation : mAllocations) {
+		memorySize += allocation.size;
+	}
+
+	return memorySize;
+}
+
+
+bool TransientResourceAllocator::AreSame(const Declaration &a, const Declaration &b) {
+	const bool areSameDescs = a.desc.Dimension == b.desc.Dimension
+		&& a.desc.Alignment == b.desc.Alignment
+		&& a.desc.Width == b.desc.Width
+		&& a.desc.Height == b.desc.Height
+		&& a.desc.DepthOrArraySize == b.desc.DepthOrArraySize
+		&& a.desc.MipLevels == b.desc.MipLevels
+		&& a.desc.Format == b.desc.Format
+		&& a.desc.SampleDesc.Count == b.desc.SampleDesc.Count
+		&& a.desc.SampleDesc.Quality == b.desc.SampleDesc.Quality
+		&& a.desc.Layout == b.desc.Layout
+		&& a.desc.Flags == b.desc.Flags;
+
+	const bool areSameClearValues = a.hasClearValue == b.hasClearValue
+		&& (!a.hasClearValue || std::memcmp(&a.clearValue, &b.clearValue, sizeof(D3D12_CLEAR_VALUE)) == 0);
+
+	return areSameDescs
+		&& areSameClearValues
+		&& a.initialState == b.initialState
+		&& a.firstPass == b.firstPass
+		&& a.lastPass == b.lastPass;
+}
+
+
+void TransientResourceAllocator::Free(Generation &generation) {
+	// Placed resources go first, then the memory under them
+	generation.resources.clear();
+
+	for (const GpuAllocation &allocation : generation.allocations) {
+		mMemory.Free(allocation);
+	}
+	generation.allocations.clear();
+}
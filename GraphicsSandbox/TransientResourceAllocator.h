@@ -0,0 +1,100 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+#include "GpuMemoryAllocator.h"
+#include "RetirementQueue.h"
+#include "TransientMemoryPacker.h"
+
+#include <vector>
+
+
+// Resources that live only between two passes of a frame and share placed memory.
+//
+// Resources are declared with the passes of their first and last use, and Compile
+// packs the ones with disjoint lifetimes into the same memory. Every resource
+// needs an aliasing barrier before its first pass, and that pass has to clear,
+// discard or fully overwrite it. A resource must be back in its initial state
+// after its last pass.
+//
+// Compile keeps the resources of the previous call if the declarations are the
+// same, replaced ones are released once the label of the frame completes.
+//
+// This class is not thread-safe
+class TransientResourceAllocator {
+public:
+	TransientResourceAllocator(GraphicsDevice &device, WaitableGpuFence &fence, GpuMemoryAllocator &memory);
+	TransientResourceAllocator(const TransientResourceAllocator&) = delete;
+
+	TransientResourceAllocator& operator = (const TransientResourceAllocator&) = delete;
+
+	// Forgets the declarations of the previous frame
+	void BeginDeclarations();
+
+	// Returns the id of the resource
+	UINT Declare(
+		const D3D12_RESOURCE_DESC &desc,
+		D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE *clearValue,
+		UINT firstPass,
+		UINT lastPass
+	);
+
+	// Returns true if the resources were recreated, so views of them must be too
+	bool Compile();
+
+	ID3D12Resource* Resource(UINT id) const {
+		return mResources[id].Get();
+	}
+
+	// Barriers that must be executed before the pass
+	void AppendAliasingBarriers(UINT pass, std::vector<D3D12_RESOURCE_BARRIER> &barriers) const;
+
+	// Resources replaced since the previous call are released once the label completes
+	void EndFrame(const WaitableGpuFence::Label &label);
+
+	// Memory taken by the resources of the last Compile
+	UINT64 MemorySize() const;
+
+private:
+	static constexpr UINT CATEGORIES_COUNT = 3;
+
+	struct Declaration {
+		D3D12_RESOURCE_DESC desc;
+		D3D12_RESOURCE_STATES initialState;
+		bool hasClearValue;
+		D3D12_CLEAR_VALUE clearValue;
+		UINT firstPass;
+		UINT lastPass;
+	};
+
+	struct Generation {
+		std::vector<ComPtr<ID3D12Resource>> resources;
+		std::vector<GpuAllocation> allocations;
+	};
+
+	static bool AreSame(const Declaration &a, const Declaration &b);
+
+	void Free(Generation &generation);
+
+private:
+	GraphicsDevice &mDevice;
+	GpuMemoryAllocator &mMemory;
+
+	std::vector<Declaration> mDeclarations;
+	std::vector<Declaration> mCompiledDeclarations;
+
+	std::vector<ComPtr<ID3D12Resource>> mResources;
+	std::vector<GpuAllocation> mAllocations;
+
+	// Resources that may alias each resource at its first pass
+	std::vector<std::vector<UINT>> mAliasedResources;
+
+	TransientMemoryPacker mPacker;
+	std::vector<TransientResourceLifetime> mLifetimes;
+	std::vector<UINT> mCategoryResources;
+
+	Generation mReplacedThisFrame;
+	RetirementQueue<WaitableGpuFence, Generation> mRetiringGenerations;
+};
@@ -0,0 +1,24 @@
+#include "UploadBuffer.h"
+#include "d3dx12.h"
+
+
+UploadBuffer::UploadBuffer(GraphicsDevice &device, UINT64 size) {
+	D3D_CHECK(device.GetD3dDevice()->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(size),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&mResource)
+	));
+
+	// The CPU doesn't read upload memory
+	CD3DX12_RANGE readRange(0, 0);
+	D3D_CHECK(mResource->Map(0, &readRange, reinterpret_cast<void**>(&mCpuAddress)));
+}
+
+
+UploadBuffer::~UploadBuffer() {
+	// Resources in upload heaps may stay mapped while the GPU uses them
+	mResource->Unmap(0, nullptr);
+}
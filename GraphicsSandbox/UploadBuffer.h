@@ -0,0 +1,35 @@
+#pragma once
+
+
+#include "D3dCommon.h"
+#include "GraphicsDevice.h"
+
+#include <cstdint>
+
+
+// Buffer in an upload heap that stays mapped until it's destroyed
+class UploadBuffer {
+public:
+	UploadBuffer(GraphicsDevice &device, UINT64 size);
+	UploadBuffer(const UploadBuffer&) = delete;
+
+	UploadBuffer& operator = (const UploadBuffer&) = delete;
+
+	~UploadBuffer();
+
+	ID3D12Resource* Resource() const {
+		return mResource.Get();
+	}
+
+	std::uint8_t* CpuAddress() const {
+		return mCpuAddress;
+	}
+
+	std::uint64_t GpuAddress() const {
+		return mResource->GetGPUVirtualAddress();
+	}
+
+private:
+	ComPtr<ID3D12Resource> mResource;
+	std::uint8_t *mCpuAddress = nullptr;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+
+#include "RingAllocator.h"
+#include "RetirementQueue.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+// Persistently mapped buffer for data that the GPU reads once, e.g. per-frame
+// constants and dynamic geometry.
+//
+// Allocations are sub-allocated from one ring buffer and reclaimed when the label
+// of their frame completes. Allocations larger than the dedicated size threshold
+// get a buffer of their own that is released the same way, so they never stall
+// the ring.
+//
+// Buffer is any type with std::uint8_t* CpuAddress() and std::uint64_t GpuAddress()
+// whose memory stays mapped for the lifetime of the object, e.g. UploadBuffer.
+// Fence is the same as for RingAllocator.
+//
+// This class is thread-safe
+template <typename Fence, typename Buffer>
+class UploadRing {
+public:
+	using Label = typename Fence::Label;
+	using BufferFactory = std::function<std::unique_ptr<Buffer>(std::uint64_t size)>;
+
+	// D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT
+	static constexpr std::uint64_t CONSTANT_BUFFER_ALIGNMENT = 256;
+	// D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, rows inside are aligned by
+	// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT (256) by the caller
+	static constexpr std::uint64_t TEXTURE_DATA_ALIGNMENT = 512;
+
+	struct Allocation {
+		Buffer *buffer;
+		std::uint64_t offset;
+		std::uint8_t *cpuAddress;
+		std::uint64_t gpuAddress;
+	};
+
+public:
+	UploadRing(Fence &fence, BufferFactory createBuffer, std::uint64_t capacity, std::uint64_t dedicatedSizeThreshold);
+	UploadRing(const UploadRing&) = delete;
+
+	UploadRing& operator = (const UploadRing&) = delete;
+
+	// Alignment must be a power of two. Blocks if the ring is full until the GPU
+	// finishes an older frame
+	Allocation Allocate(std::uint64_t size, std::uint64_t alignment);
+
+	Allocation AllocateConstants(std::uint64_t size) {
+		return Allocate(size, CONSTANT_BUFFER_ALIGNMENT);
+	}
+
+	Allocation AllocateTextureData(std::uint64_t size) {
+		return Allocate(size, TEXTURE_DATA_ALIGNMENT);
+	}
+
+	// Allocations made since the previous call are reclaimed once the label completes
+	void EndFrame(const Label &label);
+
+	std::uint64_t Capacity() const {
+		return mRing.Capacity();
+	}
+
+private:
+	using DedicatedBuffers = std::vector<std::unique_ptr<Buffer>>;
+
+	static Allocation MakeAllocation(Buffer &buffer, std::uint64_t offset) {
+		return Allocation{ &buffer, offset, buffer.CpuAddress() + offset, buffer.GpuAddress() + offset };
+	}
+
+private:
+	BufferFactory mCreateBuffer;
+	const std::uint64_t mDedicatedSizeThreshold;
+
+	std::unique_ptr<Buffer> mBuffer;
+
+	std::mutex mMutex;
+	RingAllocator<Fence> mRing;
+
+	DedicatedBuffers mDedicatedThisFrame;
+	RetirementQueue<Fence, DedicatedBuffers> mRetiringDedicated;
+};
+
+
+template <typename Fence, typename Buffer>
+UploadRing<Fence, Buffer>::UploadRing(
+	Fence &fence,
+	BufferFactory createBuffer,
+	std::uint64_t capacity,
+	std::uint64_t dedicatedSizeThreshold
+)
+: mCreateBuffer(std::move(createBuffer)),
+  mDedicatedSizeThreshold(dedicatedSizeThreshold),
+  mBuffer(mCreateBuffer(capacity)),
+  mRing(fence, capacity),
+  mRetiringDedicated(fence) {
+}
+
+
+template <typename Fence, typename Buffer>
+typename UploadRing<Fence, Buffer>::Allocation UploadRing<Fence, Buffer>::Allocate(
+	std::uint64_t size,
+	std::uint64_t alignment
+) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if (size > mDedicatedSizeThreshold || size + alignment > mRing.Capacity()) {
+		// A new buffer starts at an address aligned for any upload
+		mDedicatedThisFrame.push_back(mCreateBuffer(size));
+		return MakeAllocation(*mDedicatedThisFrame.back(), 0);
+	}
+
+	std::uint64_t offset = mRing.Allocate(size, alignment);
+	while (offset == RingAllocator<Fence>::INVALID_OFFSET) {
+		if (!mRing.WaitAndReclaimOldest()) {
+			throw std::runtime_error("Uploads of one frame don't fit into the ring");
+		}
+		offset = mRing.Allocate(size, alignment);
+	}
+
+	return MakeAllocation(*mBuffer, offset);
+}
+
+
+template <typename Fence, typename Buffer>
+void UploadRing<Fence, Buffer>::EndFrame(const Label &label) {
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mRing.Retire(label);
+
+	DedicatedBuffers completed;
+	while (mRetiringDedicated.TryAcquire(completed)) {
+		completed.clear();
+	}
+
+	if (!mDedicatedThisFrame.empty()) {
+		mRetiringDedicated.Release(std::move(mDedicatedThisFrame), label);
+		mDedicatedThisFrame.clear();
+	}
+}
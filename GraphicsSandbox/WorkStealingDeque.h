@@ -0,0 +1,93 @@
+#pragma once
+
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+// Fixed-capacity lock-free deque of pointers (Chase-Lev).
+//
+// The owner thread pushes and pops at the bottom, any other thread may steal
+// from the top. Memory orderings follow "Correct and Efficient Work-Stealing
+// for Weak Memory Models" by Le et al., except that Push publishes the item
+// with a release store instead of a separate fence.
+template <typename T>
+class WorkStealingDeque {
+public:
+	// Capacity must be a power of two
+	explicit WorkStealingDeque(std::size_t capacity)
+	: mItems(new std::atomic<T*>[capacity]), mMask(static_cast<std::int64_t>(capacity) - 1) {
+		assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+
+	WorkStealingDeque& operator = (const WorkStealingDeque&) = delete;
+
+	// Owner only. Returns false if the deque is full
+	bool Push(T *item) {
+		std::int64_t bottom = mBottom.load(std::memory_order_relaxed);
+		std::int64_t top = mTop.load(std::memory_order_acquire);
+		if (bottom - top > mMask) {
+			return false;
+		}
+
+		mItems[bottom & mMask].store(item, std::memory_order_relaxed);
+		mBottom.store(bottom + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	// Owner only. Takes the most recently pushed item
+	T* Pop() {
+		std::int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+		mBottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t top = mTop.load(std::memory_order_relaxed);
+
+		if (top > bottom) {
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T *item = mItems[bottom & mMask].load(std::memory_order_relaxed);
+		if (top == bottom) {
+			// The last item, race against thieves for it
+			if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				item = nullptr;
+			}
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		return item;
+	}
+
+	// Any thread. Takes the oldest item, may fail spuriously under contention
+	T* Steal() {
+		std::int64_t top = mTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+		if (top >= bottom) {
+			return nullptr;
+		}
+
+		T *item = mItems[top & mMask].load(std::memory_order_relaxed);
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+
+		return item;
+	}
+
+private:
+	// Keeps the owner's and the thieves' ends on separate cache lines
+	alignas(64) std::atomic<std::int64_t> mTop{0};
+	alignas(64) std::atomic<std::int64_t> mBottom{0};
+
+	std::unique_ptr<std::atomic<T*>[]> mItems;
+	std::int64_t mMask;
+};
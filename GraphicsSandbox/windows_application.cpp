@@ -3,6 +3,7 @@
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
 // Windows Header Files
 #include <windows.h>
+#include <timeapi.h>
 
 // C RunTime Header Files
 #include <stdlib.h>
@@ -11,16 +12,38 @@
 #include <tchar.h>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
 
 #include "resource.h"
 
 #include "RenderingSystem.h"
+#include "JobSystem.h"
+#include "FramePacer.h"
+#include "SteadyClock.h"
+#include "FrameProfiler.h"
+
+// timeBeginPeriod
+#pragma comment(lib, "winmm.lib")
 
 #define MAX_LOADSTRING 100
 
 constexpr UINT clientWidth = 1280;
 constexpr UINT clientHeight = 720;
 
+// Without vsync the frame pacer holds the frame rate
+constexpr bool isVsyncEnabled = true;
+constexpr double targetFrameRate = 144.0;
+
+// The title bar shows the frame rate and the input latency of this period
+constexpr std::int64_t statisticsPeriodNanoseconds = 1000 * 1000 * 1000;
+
+// F9 captures the next frames into a Chrome trace, relative to the working directory
+constexpr UINT profileCaptureKey = VK_F9;
+constexpr std::uint32_t profileCaptureFramesCount = 8;
+constexpr const char *profileTraceFilePath = "FrameProfile.json";
+
 // Global Variables:
 HINSTANCE hInst;                                // current instance
 HWND hWnd;
@@ -32,6 +55,30 @@ ATOM                MyRegisterClass(HINSTANCE hInstance);
 BOOL                InitInstance(HINSTANCE, int);
 LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    About(HWND, UINT, WPARAM, LPARAM);
+bool                IsInputMessage(UINT message);
+std::int64_t        MessageTimeOnClock(const MSG &msg, const SteadyClock &clock);
+void                ShowFrameStatistics(
+                        const FramePacer<SteadyClock>::Statistics &statistics,
+                        const FramePacer<SteadyClock>::Statistics &previousStatistics,
+                        std::int64_t periodNanoseconds
+                    );
+
+
+// Sleeps of the frame pacer wake up within a millisecond instead of a tick of the system timer
+class TimerResolutionScope {
+public:
+    TimerResolutionScope() {
+        timeBeginPeriod(1);
+    }
+
+    ~TimerResolutionScope() {
+        timeEndPeriod(1);
+    }
+
+    TimerResolutionScope(const TimerResolutionScope&) = delete;
+
+    TimerResolutionScope& operator = (const TimerResolutionScope&) = delete;
+};
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
                      _In_opt_ HINSTANCE hPrevInstance,
@@ -55,20 +102,79 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
             return FALSE;
         }
 
-        RenderingSystem renderingSystem(hWnd, clientWidth, clientHeight);
+        // The main thread is one of the threads of the job system too
+        const unsigned int hardwareThreadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+        JobSystem jobSystem(hardwareThreadsCount - 1);
+
+        // Outlives the rendering system, which adds GPU scopes to its captures
+        FrameProfiler profiler;
+        profiler.NameCurrentThread("Main");
+
+        RenderingSystem renderingSystem(hWnd, clientWidth, clientHeight, jobSystem);
+        renderingSystem.SetVsyncEnabled(isVsyncEnabled);
+
+        TimerResolutionScope timerResolution;
+        SteadyClock clock;
+        FramePacer<SteadyClock> framePacer(clock);
+        // With vsync the waitable object of the swap chain paces the frames, the pacer only measures them
+        framePacer.SetTargetFrameRate(isVsyncEnabled ? 0.0 : targetFrameRate);
+
+        std::int64_t statisticsPeriodStart = clock.Now();
+        FramePacer<SteadyClock>::Statistics periodStartStatistics = framePacer.GetStatistics();
 
         // Main sample loop.
         MSG msg = {};
         while (msg.message != WM_QUIT) {
-            // Process any messages in the queue.
-            if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-                TranslateMessage(&msg);
-                DispatchMessage(&msg);
-                continue;
+            const bool wasCapturing = profiler.IsCapturing();
+            profiler.BeginFrame();
+            if (wasCapturing && !profiler.IsCapturing()) {
+                renderingSystem.CollectGpuProfile();
+                profiler.SaveChromeTrace(profileTraceFilePath);
+            }
+
+            // The CPU sleeps until the frame is due instead of spinning on the message queue
+            {
+                PROFILE_SCOPE("Wait for frame start");
+                renderingSystem.WaitForFrameLatency();
+                framePacer.WaitForFrameStart();
+            }
+
+            // Input is processed right before the frame that shows it
+            {
+                PROFILE_SCOPE("Process messages");
+                while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+                    if (msg.message == WM_QUIT) {
+                        break;
+                    }
+
+                    if (IsInputMessage(msg.message)) {
+                        framePacer.OnInput(MessageTimeOnClock(msg, clock));
+                    }
+
+                    if (msg.message == WM_KEYDOWN && msg.wParam == profileCaptureKey) {
+                        profiler.RequestCapture(profileCaptureFramesCount);
+                    }
+
+                    TranslateMessage(&msg);
+                    DispatchMessage(&msg);
+                }
+            }
+
+            if (msg.message == WM_QUIT) {
+                break;
             }
 
-            // Queue is empty
             renderingSystem.RenderFrame();
+            framePacer.OnPresent();
+
+            const std::int64_t now = clock.Now();
+            if (now - statisticsPeriodStart >= statisticsPeriodNanoseconds) {
+                const FramePacer<SteadyClock>::Statistics statistics = framePacer.GetStatistics();
+                ShowFrameStatistics(statistics, periodStartStatistics, now - statisticsPeriodStart);
+
+                statisticsPeriodStart = now;
+                periodStartStatistics = statistics;
+            }
         }
 
         return (int)msg.wParam;
@@ -82,6 +188,92 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 
 
 
+//
+//  FUNCTION: IsInputMessage(UINT)
+//
+//  PURPOSE: Tells whether the message comes from the keyboard or the mouse
+//
+bool IsInputMessage(UINT message)
+{
+    return (message >= WM_KEYFIRST && message <= WM_KEYLAST)
+        || (message >= WM_MOUSEFIRST && message <= WM_MOUSELAST)
+        || message == WM_INPUT;
+}
+
+
+
+//
+//  FUNCTION: MessageTimeOnClock(const MSG &, const SteadyClock &)
+//
+//  PURPOSE: Converts the time the message was posted to the clock of the frame pacer
+//
+//  COMMENTS:
+//
+//        MSG::time comes from GetTickCount, so the latency includes the time the
+//        message waited in the queue, but it is only as precise as a tick of the
+//        system timer, 10 to 16 milliseconds, which timeBeginPeriod doesn't change.
+//        The tick count lags behind, so an age of whole ticks overstates the wait
+//        by up to a tick. A message younger than a tick is taken as received now,
+//        older ones have a tick subtracted from their age.
+//
+std::int64_t MessageTimeOnClock(const MSG &msg, const SteadyClock &clock)
+{
+    // In milliseconds, rounded up
+    static const DWORD tickMilliseconds = [] {
+        DWORD adjustment;
+        DWORD increment;
+        BOOL isAdjustmentDisabled;
+        if (!GetSystemTimeAdjustment(&adjustment, &increment, &isAdjustmentDisabled) || increment == 0) {
+            return DWORD(16);
+        }
+
+        // The increment is in 100-nanosecond units
+        return (increment + 9999) / 10000;
+    }();
+
+    // Unsigned, so the difference is right when the tick count wraps around
+    const DWORD age = GetTickCount() - msg.time;
+    if (age <= tickMilliseconds) {
+        return clock.Now();
+    }
+
+    return clock.Now() - std::int64_t(age - tickMilliseconds) * 1000 * 1000;
+}
+
+
+
+//
+//  FUNCTION: ShowFrameStatistics()
+//
+//  PURPOSE: Shows the frame rate and the input-to-present latency of a period in the title bar
+//
+void ShowFrameStatistics(
+    const FramePacer<SteadyClock>::Statistics &statistics,
+    const FramePacer<SteadyClock>::Statistics &previousStatistics,
+    std::int64_t periodNanoseconds
+)
+{
+    const std::uint64_t framesCount = statistics.framesCount - previousStatistics.framesCount;
+    const double framesPerSecond = framesCount * 1e9 / periodNanoseconds;
+
+    const std::uint64_t inputFramesCount = statistics.inputFramesCount - previousStatistics.inputFramesCount;
+    const std::int64_t latencySum = statistics.inputToPresentLatencySum - previousStatistics.inputToPresentLatencySum;
+
+    WCHAR title[MAX_LOADSTRING + 96];
+    if (inputFramesCount > 0) {
+        swprintf_s(
+            title, L"%s - %.1f fps, input to present %.2f ms",
+            szTitle, framesPerSecond, latencySum * 1e-6 / inputFramesCount
+        );
+    } else {
+        swprintf_s(title, L"%s - %.1f fps", szTitle, framesPerSecond);
+    }
+
+    SetWindowText(hWnd, title);
+}
+
+
+
 //
 //  FUNCTION: MyRegisterClass()
 //
@@ -0,0 +1,116 @@
+#include "TestCommon.h"
+
+#include "AsyncCompileQueue.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	using IntCompileQueue = AsyncCompileQueue<int, int, int>;
+
+
+	// Finds until the status isn't PENDING anymore
+	IntCompileQueue::Status FindCompiled(IntCompileQueue &queue, int key, int &value) {
+		for (;;) {
+			const IntCompileQueue::Status status = queue.Find(key, [key] { return key; }, value);
+			if (status != IntCompileQueue::Status::PENDING) {
+				return status;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+}
+
+
+TEST(CompilesInTheBackground) {
+	for (std::size_t workerThreadsCount : { 0, 2 }) {
+		JobSystem jobSystem(workerThreadsCount);
+		std::atomic<int> compilesCount{0};
+
+		IntCompileQueue queue(jobSystem, [&compilesCount](const int &request) {
+			compilesCount.fetch_add(1);
+			return request * 2;
+		}, 1);
+
+		int value = 0;
+		CHECK(FindCompiled(queue, 21, value) == IntCompileQueue::Status::READY);
+		CHECK(value == 42);
+
+		// Compiled once, later requests take the value
+		CHECK(queue.Find(21, [] { return 0; }, value) == IntCompileQueue::Status::READY);
+		CHECK(compilesCount.load() == 1);
+	}
+}
+
+
+TEST(FailedCompilesArentRetried) {
+	JobSystem jobSystem(1);
+	std::atomic<int> compilesCount{0};
+
+	IntCompileQueue queue(jobSystem, [&compilesCount](const int &) -> int {
+		compilesCount.fetch_add(1);
+		throw std::runtime_error("Compilation failed");
+	}, 1);
+
+	int value = 0;
+	CHECK(FindCompiled(queue, 1, value) == IntCompileQueue::Status::FAILED);
+	CHECK(FindCompiled(queue, 1, value) == IntCompileQueue::Status::FAILED);
+	CHECK(compilesCount.load() == 1);
+
+	queue.EndFrame();
+	CHECK(queue.LastFrameStatistics().failedCount == 1);
+}
+
+
+TEST(LatestFrameCompilesFirst) {
+	JobSystem jobSystem(1);
+	std::atomic<bool> isStarted{false};
+	std::atomic<bool> isBlocked{true};
+	std::vector<int> compileOrder;
+
+	IntCompileQueue queue(jobSystem, [&isStarted, &isBlocked, &compileOrder](const int &request) {
+		// The first compile holds the others in the queue
+		isStarted.store(true);
+		while (isBlocked.load()) {
+			std::this_thread::yield();
+		}
+
+		compileOrder.push_back(request);
+		return request;
+	}, 1);
+
+	int value;
+	CHECK(queue.Find(0, [] { return 0; }, value) == IntCompileQueue::Status::PENDING);
+	while (!isStarted.load()) {
+		std::this_thread::yield();
+	}
+
+	queue.Find(1, [] { return 1; }, value);
+	queue.Find(2, [] { return 2; }, value);
+	queue.EndFrame();
+
+	queue.Find(3, [] { return 3; }, value);
+	queue.EndFrame();
+
+	// Requested again, it goes ahead of the older requests
+	queue.Find(1, [] { return 1; }, value);
+	isBlocked.store(false);
+
+	for (int key = 0; key < 4; key++) {
+		CHECK(FindCompiled(queue, key, value) == IntCompileQueue::Status::READY);
+		CHECK(value == key);
+	}
+
+	CHECK((compileOrder == std::vector<int>{ 0, 1, 3, 2 }));
+}
+
+
+int main() {
+	return RunTests();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+
+// Helpers of the benchmarks, which print one line per measurement
+
+
+// Stops the compiler from optimizing away the value
+template <typename Type>
+inline void KeepValue(const Type &value) {
+#if defined(__GNUC__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const Type *sink;
+	sink = &value;
+#endif
+}
+
+
+// Returns the seconds a call of the function takes on average. It's called in
+// growing batches until a batch takes at least the minimum time
+template <typename Function>
+double MeasureSeconds(Function &&function, double minimumSeconds = 0.2) {
+	using Clock = std::chrono::steady_clock;
+
+	// Warms up caches and lazy initialization
+	function();
+
+	for (std::uint64_t iterationsCount = 1; ; iterationsCount *= 2) {
+		const Clock::time_point begin = Clock::now();
+		for (std::uint64_t i = 0; i < iterationsCount; i++) {
+			function();
+		}
+		const double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+		if (seconds >= minimumSeconds) {
+			return seconds / double(iterationsCount);
+		}
+	}
+}
+
+
+inline void PrintMeasurement(const char *name, double value, const char *unit) {
+	std::printf("%-56s %12.3f %s\n", name, value, unit);
+	std::fflush(stdout);
+}
@@ -0,0 +1,74 @@
+#include "BenchmarkCommon.h"
+
+#include "BindlessHandleTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	const std::uint32_t CAPACITY = 1 << 16;
+	const int CYCLES_PER_THREAD = 1000000;
+
+
+	// Every thread keeps a window of live handles and replaces the oldest one,
+	// like textures streamed in and out
+	void BenchmarkChurn(int threadsCount) {
+		BindlessHandleTable table(CAPACITY);
+
+		const auto begin = std::chrono::steady_clock::now();
+
+		std::vector<std::thread> threads;
+		for (int thread = 0; thread < threadsCount; thread++) {
+			threads.emplace_back([&table] {
+				std::vector<BindlessHandle> liveHandles(256);
+				for (BindlessHandle &handle : liveHandles) {
+					handle = table.Allocate();
+				}
+
+				for (int i = 0; i < CYCLES_PER_THREAD; i++) {
+					BindlessHandle &handle = liveHandles[i % liveHandles.size()];
+					table.Invalidate(handle);
+					table.Recycle(handle.index);
+					handle = table.Allocate();
+				}
+			});
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "Invalidate, recycle and allocate, %d threads", threadsCount);
+		PrintMeasurement(name, seconds / CYCLES_PER_THREAD * 1e9, "ns");
+	}
+}
+
+
+int main() {
+	BenchmarkChurn(1);
+	BenchmarkChurn(static_cast<int>(std::max(2u, std::thread::hardware_concurrency())));
+
+	BindlessHandleTable table(CAPACITY);
+	std::vector<BindlessHandle> handles;
+	for (std::uint32_t i = 0; i < CAPACITY; i++) {
+		handles.push_back(table.Allocate());
+	}
+
+	// Like checking the handles of the draws of a frame
+	std::size_t index = 0;
+	const double validateSeconds = MeasureSeconds([&table, &handles, &index] {
+		for (int i = 0; i < 1000; i++) {
+			KeepValue(table.IsValid(handles[index++ % handles.size()]));
+		}
+	});
+	PrintMeasurement("IsValid", validateSeconds / 1000 * 1e9, "ns");
+
+	return 0;
+}
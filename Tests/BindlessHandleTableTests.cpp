@@ -0,0 +1,116 @@
+#include "TestCommon.h"
+
+#include "BindlessHandleTable.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+TEST(FreedHandleIsStaleAfterReuse) {
+	BindlessHandleTable table(1);
+
+	const BindlessHandle first = table.Allocate();
+	CHECK(first.index == 0);
+	CHECK(table.IsValid(first));
+
+	CHECK(table.Invalidate(first));
+	CHECK(!table.IsValid(first));
+	// Only once
+	CHECK(!table.Invalidate(first));
+
+	table.Recycle(first.index);
+	const BindlessHandle second = table.Allocate();
+
+	// The same slot, and only the new handle is valid
+	CHECK(second.index == first.index);
+	CHECK(second != first);
+	CHECK(table.IsValid(second));
+	CHECK(!table.IsValid(first));
+	CHECK(!table.Invalidate(first));
+	CHECK(table.IsValid(second));
+}
+
+
+TEST(FullTableReturnsAnInvalidHandle) {
+	BindlessHandleTable table(2);
+	CHECK(table.Allocate().index == 0);
+	CHECK(table.Allocate().index == 1);
+
+	const BindlessHandle handle = table.Allocate();
+	CHECK(handle.index == INVALID_DESCRIPTOR_INDEX);
+	CHECK(!table.IsValid(handle));
+	CHECK(!table.IsValid(BindlessHandle()));
+}
+
+
+TEST(OneOfConcurrentInvalidationsWins) {
+	BindlessHandleTable table(64);
+
+	for (int iteration = 0; iteration < 200; iteration++) {
+		const BindlessHandle handle = table.Allocate();
+		std::atomic<int> winsCount{0};
+
+		std::vector<std::thread> threads;
+		for (int thread = 0; thread < 4; thread++) {
+			threads.emplace_back([&table, &winsCount, handle] {
+				if (table.Invalidate(handle)) {
+					winsCount.fetch_add(1);
+				}
+			});
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		CHECK(winsCount.load() == 1);
+		table.Recycle(handle.index);
+	}
+}
+
+
+// Threads churn their own handles and keep the stale ones, none of which may
+// become valid again however often the slots are reused
+TEST(StaleHandlesStayStaleUnderChurn) {
+	BindlessHandleTable table(16);
+	std::atomic<int> failuresCount{0};
+
+	std::vector<std::thread> threads;
+	for (int thread = 0; thread < 4; thread++) {
+		threads.emplace_back([&table, &failuresCount] {
+			std::vector<BindlessHandle> staleHandles;
+
+			for (int i = 0; i < 20000; i++) {
+				const BindlessHandle handle = table.Allocate();
+				if (handle.index == INVALID_DESCRIPTOR_INDEX) {
+					continue;
+				}
+
+				if (!table.IsValid(handle) || !table.Invalidate(handle)) {
+					failuresCount.fetch_add(1);
+				}
+				table.Recycle(handle.index);
+
+				if (i % 100 == 0) {
+					staleHandles.push_back(handle);
+				}
+				for (const BindlessHandle &staleHandle : staleHandles) {
+					if (table.IsValid(staleHandle)) {
+						failuresCount.fetch_add(1);
+					}
+				}
+			}
+		});
+	}
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	CHECK(failuresCount.load() == 0);
+}
+
+
+int main() {
+	return RunTests();
+}
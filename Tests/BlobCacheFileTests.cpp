@@ -0,0 +1,123 @@
+#include "TestCommon.h"
+
+#include "BlobCacheFile.h"
+#include "Hash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+
+namespace {
+	// Written into the working directory of the test
+	const std::string CACHE_PATH = "BlobCacheFileTests.bin";
+	const std::uint32_t MAGIC = 0x54534554; // "TEST"
+
+
+	void Insert(BlobCacheFile &file, const std::string &key, const std::string &blob) {
+		file.Insert(key.data(), key.size(), HashBytes(key.data(), key.size()), blob.data(), blob.size());
+	}
+
+
+	// Returns an empty string if there is no blob for the key
+	std::string Find(const BlobCacheFile &file, const std::string &key) {
+		BlobCacheFile::Blob blob;
+		if (!file.Find(key.data(), key.size(), HashBytes(key.data(), key.size()), blob)) {
+			return std::string();
+		}
+
+		return std::string(static_cast<const char*>(blob.data), blob.size);
+	}
+}
+
+
+TEST(SavedEntriesLoad) {
+	std::remove(CACHE_PATH.c_str());
+
+	BlobCacheFile file(MAGIC);
+	CHECK(!file.Load(CACHE_PATH));
+	CHECK(!file.HasNewEntries());
+
+	Insert(file, "first", "blob");
+	// Odd sizes, the next entry is padded
+	Insert(file, "second key", "longer blob");
+	CHECK(file.HasNewEntries());
+	CHECK(Find(file, "first") == "blob");
+
+	file.Save(CACHE_PATH);
+	CHECK(!file.HasNewEntries());
+	CHECK(Find(file, "second key") == "longer blob");
+
+	BlobCacheFile loadedFile(MAGIC);
+	CHECK(loadedFile.Load(CACHE_PATH));
+	CHECK(loadedFile.EntriesCount() == 2);
+	CHECK(Find(loadedFile, "first") == "blob");
+	CHECK(Find(loadedFile, "second key") == "longer blob");
+	CHECK(Find(loadedFile, "third").empty());
+}
+
+
+// The loaded file is mapped while Save replaces it
+TEST(SaveReplacesTheMappedFile) {
+	std::remove(CACHE_PATH.c_str());
+
+	{
+		BlobCacheFile file(MAGIC);
+		Insert(file, "key", "old blob");
+		file.Save(CACHE_PATH);
+	}
+
+	BlobCacheFile file(MAGIC);
+	CHECK(file.Load(CACHE_PATH));
+	Insert(file, "key", "new blob");
+	Insert(file, "other key", "other blob");
+	file.Save(CACHE_PATH);
+
+	CHECK(file.EntriesCount() == 2);
+	CHECK(Find(file, "key") == "new blob");
+
+	BlobCacheFile loadedFile(MAGIC);
+	CHECK(loadedFile.Load(CACHE_PATH));
+	CHECK(Find(loadedFile, "key") == "new blob");
+	CHECK(Find(loadedFile, "other key") == "other blob");
+
+	// No temporary file is left behind
+	CHECK(!std::ifstream(CACHE_PATH + ".tmp"));
+}
+
+
+TEST(OtherFilesAreEmpty) {
+	{
+		BlobCacheFile file(MAGIC);
+		Insert(file, "key", "blob");
+		file.Save(CACHE_PATH);
+	}
+
+	BlobCacheFile otherFile(MAGIC + 1);
+	CHECK(!otherFile.Load(CACHE_PATH));
+	CHECK(otherFile.EntriesCount() == 0);
+
+	// Cut in the middle of the entry
+	std::string data;
+	{
+		std::ifstream file(CACHE_PATH, std::ios::binary);
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	{
+		std::ofstream file(CACHE_PATH, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), data.size() - 4);
+	}
+
+	BlobCacheFile truncatedFile(MAGIC);
+	CHECK(!truncatedFile.Load(CACHE_PATH));
+	CHECK(truncatedFile.EntriesCount() == 0);
+
+	std::remove(CACHE_PATH.c_str());
+}
+
+
+int main() {
+	return RunTests();
+}
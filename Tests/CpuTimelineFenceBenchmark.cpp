@@ -0,0 +1,154 @@
+#include "BenchmarkCommon.h"
+
+#include "CpuTimelineFence.h"
+#include "FenceCallbackWorker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	const int SIGNALS_COUNT = 2000;
+
+
+	double Microseconds(Clock::duration duration) {
+		return std::chrono::duration<double, std::micro>(duration).count();
+	}
+
+
+	// Time from Signal until the waiters return, every waiter waits for every label
+	void BenchmarkWakeUp(int waitersCount) {
+		CpuTimelineFence fence;
+		std::vector<CpuTimelineFence::Label> labels;
+		for (int i = 0; i < SIGNALS_COUNT; i++) {
+			labels.push_back(fence.PutLabel());
+		}
+
+		std::vector<Clock::time_point> signalTimes(SIGNALS_COUNT);
+		std::vector<std::vector<double>> latencies(waitersCount);
+		std::atomic<int> waitingCount{0};
+
+		std::vector<std::thread> waiters;
+		for (int waiter = 0; waiter < waitersCount; waiter++) {
+			waiters.emplace_back([&fence, &labels, &signalTimes, &latencies, &waitingCount, waiter] {
+				for (int i = 0; i < SIGNALS_COUNT; i++) {
+					waitingCount.fetch_add(1);
+					fence.WaitForLabel(labels[i]);
+					latencies[waiter].push_back(Microseconds(Clock::now() - signalTimes[i]));
+				}
+			});
+		}
+
+		for (int i = 0; i < SIGNALS_COUNT; i++) {
+			// Every waiter is about to wait, so the wake-up is measured instead of a ready label
+			while (waitingCount.load() < waitersCount * (i + 1)) {
+				std::this_thread::yield();
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+			signalTimes[i] = Clock::now();
+			fence.Signal(labels[i]);
+		}
+
+		for (std::thread &waiter : waiters) {
+			waiter.join();
+		}
+
+		std::vector<double> allLatencies;
+		for (const std::vector<double> &waiterLatencies : latencies) {
+			allLatencies.insert(allLatencies.end(), waiterLatencies.begin(), waiterLatencies.end());
+		}
+		std::sort(allLatencies.begin(), allLatencies.end());
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "Wake-up of %d waiters, median", waitersCount);
+		PrintMeasurement(name, allLatencies[allLatencies.size() / 2], "us");
+
+		std::snprintf(name, sizeof(name), "Wake-up of %d waiters, 99th percentile", waitersCount);
+		PrintMeasurement(name, allLatencies[allLatencies.size() * 99 / 100], "us");
+	}
+
+
+	// PutLabel, Signal and IsComplete from every thread at once, like queues
+	// submitting from several recording threads
+	void BenchmarkContention(int threadsCount) {
+		const int OPERATIONS_COUNT = 200000;
+		CpuTimelineFence fence;
+
+		const Clock::time_point begin = Clock::now();
+		std::vector<std::thread> threads;
+		for (int thread = 0; thread < threadsCount; thread++) {
+			threads.emplace_back([&fence, OPERATIONS_COUNT] {
+				for (int i = 0; i < OPERATIONS_COUNT; i++) {
+					const CpuTimelineFence::Label label = fence.PutLabel();
+					fence.Signal(label);
+					KeepValue(fence.IsComplete(label));
+				}
+			});
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+		const double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "Put, signal and check a label, %d threads", threadsCount);
+		PrintMeasurement(name, seconds / (double(OPERATIONS_COUNT) * threadsCount) * 1e9, "ns");
+	}
+
+
+	// Time from Signal until the callback of the label runs
+	void BenchmarkCallbacks() {
+		CpuTimelineFence fence;
+		std::vector<double> latencies;
+		latencies.reserve(SIGNALS_COUNT);
+
+		{
+			FenceCallbackWorker<CpuTimelineFence> worker(fence);
+			for (int i = 0; i < SIGNALS_COUNT; i++) {
+				const CpuTimelineFence::Label label = fence.PutLabel();
+				std::atomic<bool> isRun{false};
+				Clock::time_point signalTime;
+
+				worker.OnCompletion(label, [&latencies, &isRun, &signalTime] {
+					latencies.push_back(Microseconds(Clock::now() - signalTime));
+					isRun.store(true);
+				});
+
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+				signalTime = Clock::now();
+				fence.Signal(label);
+
+				while (!isRun.load()) {
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+		PrintMeasurement("Signal to callback, median", latencies[latencies.size() / 2], "us");
+		PrintMeasurement("Signal to callback, 99th percentile", latencies[latencies.size() * 99 / 100], "us");
+	}
+}
+
+
+int main() {
+	for (int waitersCount : { 1, 4 }) {
+		BenchmarkWakeUp(waitersCount);
+	}
+
+	const int threadsCount = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+	BenchmarkContention(1);
+	BenchmarkContention(threadsCount);
+
+	BenchmarkCallbacks();
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+#include "TestCommon.h"
+
+#include "CpuTimelineFence.h"
+#include "FenceCallbackWorker.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	// Waits for a condition that another thread makes true, false after a timeout
+	template <typename Condition>
+	bool WaitUntil(Condition condition) {
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while (!condition()) {
+			if (std::chrono::steady_clock::now() > deadline) {
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		return true;
+	}
+}
+
+
+TEST(SignalCompletesTheEarlierLabels) {
+	CpuTimelineFence fence;
+	const CpuTimelineFence::Label first = fence.PutLabel();
+	const CpuTimelineFence::Label second = fence.PutLabel();
+	const CpuTimelineFence::Label third = fence.PutLabel();
+
+	CHECK(first < second && second < third);
+	CHECK(!fence.IsComplete(first));
+
+	fence.Signal(second);
+	CHECK(fence.IsComplete(first));
+	CHECK(fence.IsComplete(second));
+	CHECK(!fence.IsComplete(third));
+
+	// Out of order, the earlier label doesn't take the timeline back
+	fence.Signal(first);
+	CHECK(fence.IsComplete(second));
+	CHECK(fence.CompletedValue() == 2);
+
+	fence.Signal(third);
+	CHECK(fence.IsComplete(third));
+
+	// Complete labels don't block
+	fence.WaitForLabel(first);
+	const CpuTimelineFence::Label labels[] = { third, first };
+	fence.WaitForLabels(labels, 2);
+}
+
+
+TEST(WaitersWakeUpOnSignal) {
+	CpuTimelineFence fence;
+	const CpuTimelineFence::Label first = fence.PutLabel();
+	const CpuTimelineFence::Label second = fence.PutLabel();
+
+	std::atomic<int> wokenCount{0};
+	std::vector<std::thread> waiters;
+	for (int i = 0; i < 4; i++) {
+		waiters.emplace_back([&fence, &wokenCount, first, second, i] {
+			if (i % 2 == 0) {
+				fence.WaitForLabel(first);
+			} else {
+				const CpuTimelineFence::Label labels[] = { first, second };
+				fence.WaitForLabels(labels, 2);
+			}
+			wokenCount.fetch_add(1);
+		});
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	CHECK(wokenCount.load() == 0);
+
+	// Only the waiters of the first label
+	fence.Signal(first);
+	CHECK(WaitUntil([&wokenCount] { return wokenCount.load() == 2; }));
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	CHECK(wokenCount.load() == 2);
+
+	fence.Signal(second);
+	for (std::thread &waiter : waiters) {
+		waiter.join();
+	}
+	CHECK(wokenCount.load() == 4);
+}
+
+
+TEST(CallbacksRunOnceAfterTheirLabels) {
+	CpuTimelineFence fence;
+	std::vector<CpuTimelineFence::Label> labels;
+	for (int i = 0; i < 3; i++) {
+		labels.push_back(fence.PutLabel());
+	}
+
+	std::atomic<int> runsCounts[3];
+	for (std::atomic<int> &runsCount : runsCounts) {
+		runsCount.store(0);
+	}
+	std::vector<int> order;
+	std::mutex orderMutex;
+
+	// Checked after the worker is gone, a failure must not leave it waiting
+	bool isRunBeforeSignal = false;
+	bool isRunAfterSignal = false;
+	bool isRunBeyondSignal = false;
+	std::thread gpuThread;
+
+	{
+		FenceCallbackWorker<CpuTimelineFence> worker(fence);
+
+		for (int i = 0; i < 3; i++) {
+			worker.OnCompletion(labels[i], [&runsCounts, &order, &orderMutex, i] {
+				runsCounts[i].fetch_add(1);
+				std::lock_guard<std::mutex> lock(orderMutex);
+				order.push_back(i);
+			});
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		isRunBeforeSignal = runsCounts[0].load() != 0;
+
+		fence.Signal(labels[1]);
+		isRunAfterSignal = WaitUntil([&runsCounts] { return runsCounts[1].load() == 1; });
+		isRunBeyondSignal = runsCounts[2].load() != 0;
+
+		// The destructor runs the callback once its label completes
+		gpuThread = std::thread([&fence, &labels] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			fence.Signal(labels[2]);
+		});
+	}
+	gpuThread.join();
+
+	CHECK(!isRunBeforeSignal);
+	CHECK(isRunAfterSignal);
+	CHECK(!isRunBeyondSignal);
+	for (std::atomic<int> &runsCount : runsCounts) {
+		CHECK(runsCount.load() == 1);
+	}
+	CHECK((order == std::vector<int>{ 0, 1, 2 }));
+}
+
+
+int main() {
+	return RunTests();
+}
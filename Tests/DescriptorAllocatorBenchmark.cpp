@@ -0,0 +1,117 @@
+#include "BenchmarkCommon.h"
+
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	const std::uint32_t DESCRIPTORS_PER_PAGE = 1024;
+	const std::uint32_t PAGES_COUNT = 64;
+	const int PAIRS_PER_THREAD = 1000000;
+
+
+	// The usual alternative, a vector of free indices behind a mutex
+	class LockedFreeList {
+	public:
+		void Push(std::uint32_t index) {
+			std::lock_guard<std::mutex> lock(mMutex);
+			mIndices.push_back(index);
+		}
+
+		std::uint32_t Pop() {
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mIndices.empty()) {
+				return INVALID_DESCRIPTOR_INDEX;
+			}
+
+			const std::uint32_t index = mIndices.back();
+			mIndices.pop_back();
+			return index;
+		}
+
+	private:
+		std::mutex mMutex;
+		std::vector<std::uint32_t> mIndices;
+	};
+
+
+	// Pairs of Pop and Push on every thread at once, each thread keeps a few
+	// indices, like views created and destroyed while streaming
+	template <typename FreeList>
+	void BenchmarkChurn(const char *listName, FreeList &freeList, int threadsCount) {
+		const auto begin = std::chrono::steady_clock::now();
+
+		std::vector<std::thread> threads;
+		for (int thread = 0; thread < threadsCount; thread++) {
+			threads.emplace_back([&freeList] {
+				std::uint32_t held[4];
+				for (std::uint32_t &index : held) {
+					index = freeList.Pop();
+				}
+
+				for (int i = 0; i < PAIRS_PER_THREAD; i++) {
+					std::uint32_t &index = held[i % 4];
+					freeList.Push(index);
+					index = freeList.Pop();
+				}
+
+				for (std::uint32_t index : held) {
+					freeList.Push(index);
+				}
+			});
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%s, free and allocate, %d threads", listName, threadsCount);
+		PrintMeasurement(name, seconds / PAIRS_PER_THREAD * 1e9, "ns");
+	}
+}
+
+
+int main() {
+	const int threadsCount = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+
+	for (int threads : { 1, threadsCount }) {
+		DescriptorFreeList freeList(DESCRIPTORS_PER_PAGE);
+		LockedFreeList lockedFreeList;
+		for (std::uint32_t i = 0; i < DESCRIPTORS_PER_PAGE; i++) {
+			freeList.Push(i);
+			lockedFreeList.Push(i);
+		}
+
+		BenchmarkChurn("Lock-free list", freeList, threads);
+		BenchmarkChurn("Locked vector", lockedFreeList, threads);
+	}
+
+	// Filling pages as they're added, the page callback does nothing
+	const double fillSeconds = MeasureSeconds([] {
+		PagedDescriptorAllocator allocator(DESCRIPTORS_PER_PAGE, PAGES_COUNT, [](std::uint32_t) {});
+		for (std::uint32_t i = 0; i < DESCRIPTORS_PER_PAGE * PAGES_COUNT; i++) {
+			KeepValue(allocator.Allocate());
+		}
+	});
+	PrintMeasurement("Paged allocation with new pages", fillSeconds / (DESCRIPTORS_PER_PAGE * PAGES_COUNT) * 1e9, "ns");
+
+	LinearDescriptorAllocator linearAllocator(1 << 20);
+	const double linearSeconds = MeasureSeconds([&linearAllocator] {
+		linearAllocator.Reset();
+		for (int i = 0; i < 1000; i++) {
+			KeepValue(linearAllocator.Allocate(4));
+		}
+	});
+	PrintMeasurement("Linear allocation", linearSeconds / 1000 * 1e9, "ns");
+
+	return 0;
+}
@@ -0,0 +1,225 @@
+#include "TestCommon.h"
+
+#include "DescriptorAllocator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	const int THREADS_COUNT = 4;
+}
+
+
+TEST(FreeListIsLastInFirstOut) {
+	DescriptorFreeList freeList(8);
+	CHECK(freeList.Pop() == INVALID_DESCRIPTOR_INDEX);
+
+	for (std::uint32_t index : { 3, 5, 7 }) {
+		freeList.Push(index);
+	}
+
+	CHECK(freeList.Pop() == 7);
+	CHECK(freeList.Pop() == 5);
+	freeList.Push(1);
+	CHECK(freeList.Pop() == 1);
+	CHECK(freeList.Pop() == 3);
+	CHECK(freeList.Pop() == INVALID_DESCRIPTOR_INDEX);
+}
+
+
+// Threads pop and push back a few indices at a time and mark which one owns
+// each index, a duplicate would be owned by two threads at once. With fewer
+// indices than the threads hold in total, the list is empty and refilled all
+// the time, which is where an untagged head would hit ABA
+TEST(FreeListFuzz) {
+	for (std::uint32_t capacity : { 4, 64, 1024 }) {
+		DescriptorFreeList freeList(capacity);
+		for (std::uint32_t i = 0; i < capacity; i++) {
+			freeList.Push(i);
+		}
+
+		std::vector<std::atomic<int>> owners(capacity);
+		for (std::atomic<int> &owner : owners) {
+			owner.store(0);
+		}
+		std::atomic<int> duplicatesCount{0};
+
+		std::vector<std::thread> threads;
+		for (int thread = 0; thread < THREADS_COUNT; thread++) {
+			threads.emplace_back([&freeList, &owners, &duplicatesCount, thread] {
+				std::mt19937 random(thread);
+				std::vector<std::uint32_t> held;
+
+				for (int iteration = 0; iteration < 50000; iteration++) {
+					if (held.size() < 3 && random() % 2 == 0) {
+						const std::uint32_t index = freeList.Pop();
+						if (index == INVALID_DESCRIPTOR_INDEX) {
+							continue;
+						}
+
+						int expected = 0;
+						if (!owners[index].compare_exchange_strong(expected, thread + 1)) {
+							duplicatesCount.fetch_add(1);
+						}
+						held.push_back(index);
+					} else if (!held.empty()) {
+						const std::uint32_t index = held.back();
+						held.pop_back();
+						owners[index].store(0);
+						freeList.Push(index);
+					}
+				}
+
+				for (std::uint32_t index : held) {
+					owners[index].store(0);
+					freeList.Push(index);
+				}
+			});
+		}
+
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		CHECK(duplicatesCount.load() == 0);
+
+		// Every index is back exactly once
+		std::vector<int> popsCounts(capacity, 0);
+		for (std::uint32_t index = freeList.Pop(); index != INVALID_DESCRIPTOR_INDEX; index = freeList.Pop()) {
+			CHECK(index < capacity);
+			popsCounts[index]++;
+		}
+		for (int popsCount : popsCounts) {
+			CHECK(popsCount == 1);
+		}
+	}
+}
+
+
+TEST(PagesAreAddedOnDemand) {
+	std::vector<std::uint32_t> createdPages;
+	PagedDescriptorAllocator allocator(4, 2, [&createdPages](std::uint32_t pageIndex) {
+		createdPages.push_back(pageIndex);
+	});
+
+	CHECK(allocator.PagesCount() == 0);
+
+	// In the order of the page
+	for (std::uint32_t i = 0; i < 4; i++) {
+		CHECK(allocator.Allocate() == i);
+	}
+	CHECK((createdPages == std::vector<std::uint32_t>{ 0 }));
+
+	allocator.Free(2);
+	CHECK(allocator.Allocate() == 2);
+	CHECK(allocator.PagesCount() == 1);
+
+	for (std::uint32_t i = 4; i < 8; i++) {
+		CHECK(allocator.Allocate() == i);
+	}
+	CHECK((createdPages == std::vector<std::uint32_t>{ 0, 1 }));
+
+	CHECK_THROWS(allocator.Allocate(), std::runtime_error);
+}
+
+
+// Every index is handed out once, and only after its page was created
+TEST(ConcurrentAllocationsAreUnique) {
+	const std::uint32_t DESCRIPTORS_PER_PAGE = 64;
+	const std::uint32_t PAGES_COUNT = 16;
+
+	std::vector<std::atomic<bool>> isPageCreated(PAGES_COUNT);
+	for (std::atomic<bool> &isCreated : isPageCreated) {
+		isCreated.store(false);
+	}
+
+	PagedDescriptorAllocator allocator(DESCRIPTORS_PER_PAGE, PAGES_COUNT, [&isPageCreated](std::uint32_t pageIndex) {
+		isPageCreated[pageIndex].store(true);
+	});
+
+	std::vector<std::vector<std::uint32_t>> allocated(THREADS_COUNT);
+	std::atomic<int> uncreatedPagesCount{0};
+
+	std::vector<std::thread> threads;
+	for (int thread = 0; thread < THREADS_COUNT; thread++) {
+		threads.emplace_back([&, thread] {
+			for (std::uint32_t i = 0; i < DESCRIPTORS_PER_PAGE * PAGES_COUNT / THREADS_COUNT; i++) {
+				const std::uint32_t index = allocator.Allocate();
+				if (!isPageCreated[index / DESCRIPTORS_PER_PAGE].load()) {
+					uncreatedPagesCount.fetch_add(1);
+				}
+				allocated[thread].push_back(index);
+
+				// Some churn, so the free list is used as well as new pages
+				if (i % 3 == 0) {
+					allocator.Free(allocated[thread].back());
+					allocated[thread].pop_back();
+				}
+			}
+		});
+	}
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	CHECK(uncreatedPagesCount.load() == 0);
+
+	std::vector<int> allocationsCounts(DESCRIPTORS_PER_PAGE * PAGES_COUNT, 0);
+	for (const std::vector<std::uint32_t> &indices : allocated) {
+		for (std::uint32_t index : indices) {
+			allocationsCounts[index]++;
+		}
+	}
+	for (int allocationsCount : allocationsCounts) {
+		CHECK(allocationsCount <= 1);
+	}
+}
+
+
+TEST(LinearRangesDontOverlap) {
+	LinearDescriptorAllocator allocator(1000);
+
+	std::vector<std::atomic<int>> usesCounts(1000);
+	for (std::atomic<int> &usesCount : usesCounts) {
+		usesCount.store(0);
+	}
+
+	std::vector<std::thread> threads;
+	for (int thread = 0; thread < THREADS_COUNT; thread++) {
+		threads.emplace_back([&allocator, &usesCounts] {
+			// More than fit, the last ones fail
+			for (int i = 0; i < 100; i++) {
+				const std::uint32_t first = allocator.Allocate(3);
+				if (first != INVALID_DESCRIPTOR_INDEX) {
+					for (std::uint32_t index = first; index < first + 3; index++) {
+						usesCounts[index].fetch_add(1);
+					}
+				}
+			}
+		});
+	}
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	for (std::size_t i = 0; i < 999; i++) {
+		CHECK(usesCounts[i].load() == 1);
+	}
+	CHECK(allocator.Allocate(1) == INVALID_DESCRIPTOR_INDEX);
+
+	allocator.Reset();
+	CHECK(allocator.Allocate(1000) == 0);
+	CHECK(allocator.Allocate(1) == INVALID_DESCRIPTOR_INDEX);
+}
+
+
+int main() {
+	return RunTests();
+}
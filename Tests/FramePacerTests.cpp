@@ -0,0 +1,191 @@
+#include "TestCommon.h"
+
+#include "FramePacer.h"
+
+#include <cstdint>
+
+
+namespace {
+	// Time passes only in sleeps, spins and the simulated work of the frames
+	class FakeClock {
+	public:
+		std::int64_t Now() const {
+			return mNow;
+		}
+
+		void Sleep(std::int64_t nanoseconds) {
+			mNow += nanoseconds + mOversleep;
+			mSleepsCount++;
+		}
+
+		void Relax() {
+			mNow += RELAX_TIME;
+		}
+
+		void Advance(std::int64_t nanoseconds) {
+			mNow += nanoseconds;
+		}
+
+		void SetOversleep(std::int64_t oversleep) {
+			mOversleep = oversleep;
+		}
+
+		std::uint64_t SleepsCount() const {
+			return mSleepsCount;
+		}
+
+	public:
+		static const std::int64_t RELAX_TIME = 1000;
+
+	private:
+		std::int64_t mNow = 1000 * 1000 * 1000;
+		std::int64_t mOversleep = 0;
+		std::uint64_t mSleepsCount = 0;
+	};
+
+
+	const std::int64_t MILLISECOND = 1000 * 1000;
+	// 100 frames per second
+	const std::int64_t PERIOD = 10 * MILLISECOND;
+}
+
+
+TEST(DeadlinesAdvanceByAPeriod) {
+	FakeClock clock;
+	clock.SetOversleep(200 * 1000);
+	FramePacer<FakeClock> pacer(clock);
+	pacer.SetTargetFrameRate(100.0);
+
+	// The first frame starts the schedule right away
+	pacer.WaitForFrameStart();
+	const std::int64_t firstStart = clock.Now();
+	CHECK(pacer.LastFrameStatistics().lateness == 0);
+
+	for (int frame = 1; frame <= 1000; frame++) {
+		// Work of varying length, always shorter than a period
+		clock.Advance((1 + frame % 7) * MILLISECOND);
+		pacer.WaitForFrameStart();
+
+		// Late by less than a spin, which doesn't add up over the frames
+		const FramePacer<FakeClock>::FrameStatistics statistics = pacer.LastFrameStatistics();
+		CHECK(statistics.lateness >= 0 && statistics.lateness < FakeClock::RELAX_TIME);
+		CHECK(clock.Now() - firstStart - frame * PERIOD == statistics.lateness);
+		CHECK(statistics.sleepTime > 0);
+	}
+
+	CHECK(pacer.GetStatistics().framesCount == 1001);
+	CHECK(pacer.GetStatistics().missedDeadlinesCount == 0);
+}
+
+
+TEST(MissedDeadlineStartsANewSchedule) {
+	FakeClock clock;
+	FramePacer<FakeClock> pacer(clock);
+	pacer.SetTargetFrameRate(100.0);
+
+	pacer.WaitForFrameStart();
+	clock.Advance(2 * MILLISECOND);
+	pacer.WaitForFrameStart();
+
+	// Two and a half periods of work, the frame starts right away
+	clock.Advance(25 * MILLISECOND);
+	const std::uint64_t sleepsCount = clock.SleepsCount();
+	pacer.WaitForFrameStart();
+	const std::int64_t lateStart = clock.Now();
+
+	CHECK(clock.SleepsCount() == sleepsCount);
+	CHECK(pacer.LastFrameStatistics().lateness > PERIOD);
+	CHECK(pacer.GetStatistics().missedDeadlinesCount == 1);
+
+	// The missed frames aren't caught up in a burst, the next one is a period later
+	clock.Advance(2 * MILLISECOND);
+	pacer.WaitForFrameStart();
+
+	CHECK(clock.Now() - lateStart >= PERIOD && clock.Now() - lateStart < PERIOD + FakeClock::RELAX_TIME);
+	CHECK(pacer.LastFrameStatistics().lateness < FakeClock::RELAX_TIME);
+	CHECK(pacer.GetStatistics().missedDeadlinesCount == 1);
+}
+
+
+TEST(SpinThresholdFollowsTheOversleepWithinBounds) {
+	FakeClock clock;
+	FramePacer<FakeClock> pacer(clock);
+	pacer.SetTargetFrameRate(100.0);
+
+	// Exact sleeps bring it down to the minimum
+	for (int frame = 0; frame < 200; frame++) {
+		pacer.WaitForFrameStart();
+		clock.Advance(MILLISECOND);
+	}
+	CHECK(pacer.SpinThreshold() == FramePacer<FakeClock>::MIN_SPIN_THRESHOLD);
+	CHECK(pacer.SpinThreshold() == 100 * 1000);
+
+	// Sleeps that wake up 2 ms late take a longer spin, and the pacer still
+	// makes its deadlines
+	clock.SetOversleep(2 * MILLISECOND);
+	for (int frame = 0; frame < 200; frame++) {
+		pacer.WaitForFrameStart();
+		clock.Advance(MILLISECOND);
+	}
+	CHECK(pacer.SpinThreshold() > 2 * MILLISECOND);
+	CHECK(pacer.SpinThreshold() < FramePacer<FakeClock>::MAX_SPIN_THRESHOLD);
+	CHECK(pacer.LastFrameStatistics().lateness < FakeClock::RELAX_TIME);
+
+	// Oversleeping by more than a frame is capped, spinning doesn't take the period
+	clock.SetOversleep(20 * MILLISECOND);
+	for (int frame = 0; frame < 200; frame++) {
+		pacer.WaitForFrameStart();
+		clock.Advance(MILLISECOND);
+	}
+	CHECK(pacer.SpinThreshold() == FramePacer<FakeClock>::MAX_SPIN_THRESHOLD);
+	CHECK(pacer.SpinThreshold() == 4 * MILLISECOND);
+}
+
+
+TEST(WithoutTargetFrameRateOnlyMeasures) {
+	FakeClock clock;
+	FramePacer<FakeClock> pacer(clock);
+
+	pacer.WaitForFrameStart();
+	clock.Advance(3 * MILLISECOND);
+	pacer.WaitForFrameStart();
+
+	CHECK(clock.SleepsCount() == 0);
+	CHECK(pacer.LastFrameStatistics().frameTime == 3 * MILLISECOND);
+	CHECK(pacer.LastFrameStatistics().lateness == 0);
+}
+
+
+TEST(InputLatencyCountsFromTheEarliestInput) {
+	FakeClock clock;
+	FramePacer<FakeClock> pacer(clock);
+
+	pacer.WaitForFrameStart();
+	pacer.OnPresent();
+	CHECK(pacer.LastFrameStatistics().inputToPresentLatency == -1);
+
+	// Events are seen when the frame processes its messages, later than they happened
+	pacer.WaitForFrameStart();
+	pacer.OnInput(clock.Now() - 5 * MILLISECOND);
+	pacer.OnInput(clock.Now() - 8 * MILLISECOND);
+	pacer.OnInput();
+	clock.Advance(2 * MILLISECOND);
+	pacer.OnPresent();
+	CHECK(pacer.LastFrameStatistics().inputToPresentLatency == 10 * MILLISECOND);
+
+	pacer.WaitForFrameStart();
+	pacer.OnInput();
+	clock.Advance(3 * MILLISECOND);
+	pacer.OnPresent();
+	CHECK(pacer.LastFrameStatistics().inputToPresentLatency == 3 * MILLISECOND);
+
+	const FramePacer<FakeClock>::Statistics statistics = pacer.GetStatistics();
+	CHECK(statistics.inputFramesCount == 2);
+	CHECK(statistics.inputToPresentLatencySum == 13 * MILLISECOND);
+	CHECK(statistics.maxInputToPresentLatency == 10 * MILLISECOND);
+}
+
+
+int main() {
+	return RunTests();
+}
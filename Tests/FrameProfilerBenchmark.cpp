@@ -0,0 +1,111 @@
+#include "BenchmarkCommon.h"
+
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	// Scopes recorded in one batch, fewer than the events a thread buffer holds
+	const int SCOPES_COUNT = 30000;
+
+
+	double SecondsSince(std::chrono::steady_clock::time_point begin) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+
+	void RecordEmptyLoop() {
+		for (int i = 0; i < SCOPES_COUNT; i++) {
+			KeepValue(i);
+		}
+	}
+
+
+	void RecordScopes() {
+		for (int i = 0; i < SCOPES_COUNT; i++) {
+			PROFILE_SCOPE("Scope");
+			KeepValue(i);
+		}
+	}
+
+
+	// Nanoseconds of a scope in captured frames, the best of several captures.
+	// Every thread records the same number of scopes at the same time
+	double MeasureCapturingScope(FrameProfiler &profiler, std::size_t threadsCount) {
+		double bestSeconds = 1e9;
+
+		for (int capture = 0; capture < 50; capture++) {
+			profiler.RequestCapture(1);
+			profiler.BeginFrame();
+
+			std::vector<std::thread> threads;
+			std::vector<double> threadSeconds(threadsCount);
+			for (std::size_t thread = 1; thread < threadsCount; thread++) {
+				threads.emplace_back([&threadSeconds, thread] {
+					const auto begin = std::chrono::steady_clock::now();
+					RecordScopes();
+					threadSeconds[thread] = SecondsSince(begin);
+				});
+			}
+
+			const auto begin = std::chrono::steady_clock::now();
+			RecordScopes();
+			threadSeconds[0] = SecondsSince(begin);
+
+			for (std::thread &thread : threads) {
+				thread.join();
+			}
+
+			profiler.BeginFrame();
+			bestSeconds = std::min(bestSeconds, *std::max_element(threadSeconds.begin(), threadSeconds.end()));
+		}
+
+		return bestSeconds / SCOPES_COUNT * 1e9;
+	}
+}
+
+
+int main() {
+	FrameProfiler profiler;
+
+	const double loopSeconds = MeasureSeconds(RecordEmptyLoop);
+	const double loopNanoseconds = loopSeconds / SCOPES_COUNT * 1e9;
+
+	const double idleSeconds = MeasureSeconds(RecordScopes);
+	PrintMeasurement("PROFILE_SCOPE without a capture", idleSeconds / SCOPES_COUNT * 1e9 - loopNanoseconds, "ns");
+
+	const double timestampsSeconds = MeasureSeconds([] {
+		for (int i = 0; i < SCOPES_COUNT; i++) {
+			const std::uint64_t begin = FrameProfiler::Now();
+			KeepValue(i);
+			KeepValue(FrameProfiler::Now() - begin);
+		}
+	});
+	PrintMeasurement("Two timestamps", timestampsSeconds / SCOPES_COUNT * 1e9 - loopNanoseconds, "ns");
+
+	PrintMeasurement("PROFILE_SCOPE in a capture", MeasureCapturingScope(profiler, 1) - loopNanoseconds, "ns");
+
+	const std::size_t threadsCount = std::max(2u, std::thread::hardware_concurrency());
+	char name[96];
+	std::snprintf(name, sizeof(name), "PROFILE_SCOPE in a capture, %zu threads", threadsCount);
+	PrintMeasurement(name, MeasureCapturingScope(profiler, threadsCount) - loopNanoseconds, "ns");
+
+	// Captures longer than the buffers only count what they drop
+	profiler.RequestCapture(1);
+	profiler.BeginFrame();
+	RecordScopes();
+	RecordScopes();
+	const auto begin = std::chrono::steady_clock::now();
+	RecordScopes();
+	const double droppingSeconds = SecondsSince(begin);
+	profiler.BeginFrame();
+	PrintMeasurement("PROFILE_SCOPE in a capture, buffer full", droppingSeconds / SCOPES_COUNT * 1e9 - loopNanoseconds, "ns");
+
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include "BenchmarkCommon.h"
+
+#include "FrameRenderer.h"
+#include "NullFrameBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	const int FRAMES_COUNT = 1000;
+
+
+	// CPU cost of the frame loop without a device: graph compilation, recording,
+	// barrier resolution and submission of every frame
+	void BenchmarkFrames(std::size_t threadsCount) {
+		using Clock = std::chrono::steady_clock;
+
+		NullFrameBackend backend;
+		JobSystem jobSystem(threadsCount - 1);
+		FrameRenderer<NullFrameBackend> renderer(backend, jobSystem, 1920, 1080);
+
+		// The first frames compile the graph and place the resources
+		for (int i = 0; i < 10; i++) {
+			renderer.RenderFrame();
+		}
+
+		std::vector<double> frameSeconds;
+		frameSeconds.reserve(FRAMES_COUNT);
+
+		for (int i = 0; i < FRAMES_COUNT; i++) {
+			const Clock::time_point begin = Clock::now();
+			renderer.RenderFrame();
+			frameSeconds.push_back(std::chrono::duration<double>(Clock::now() - begin).count());
+		}
+		renderer.WaitForAllFrames();
+
+		double totalSeconds = 0.0;
+		for (double seconds : frameSeconds) {
+			totalSeconds += seconds;
+		}
+		std::sort(frameSeconds.begin(), frameSeconds.end());
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "Frame, %zu threads, mean", threadsCount);
+		PrintMeasurement(name, totalSeconds / FRAMES_COUNT * 1e6, "us");
+		std::snprintf(name, sizeof(name), "Frame, %zu threads, median", threadsCount);
+		PrintMeasurement(name, frameSeconds[FRAMES_COUNT / 2] * 1e6, "us");
+		std::snprintf(name, sizeof(name), "Frame, %zu threads, 99th percentile", threadsCount);
+		PrintMeasurement(name, frameSeconds[FRAMES_COUNT * 99 / 100] * 1e6, "us");
+
+		const NullFrameBackend::FrameStatistics statistics = backend.LastFrameStatistics();
+		std::printf(
+			"  Last frame: %llu command lists, %llu commands, %llu barriers\n",
+			static_cast<unsigned long long>(statistics.commandListsCount),
+			static_cast<unsigned long long>(statistics.commandsCount),
+			static_cast<unsigned long long>(statistics.barriersCount)
+		);
+	}
+}
+
+
+int main() {
+	const std::size_t hardwareThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+
+	BenchmarkFrames(1);
+	if (hardwareThreadsCount > 1) {
+		BenchmarkFrames(hardwareThreadsCount);
+	}
+
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include "BenchmarkCommon.h"
+
+#include "FrameRing.h"
+#include "CpuTimelineFence.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	const int FRAMES_COUNT = 200;
+	const auto CPU_FRAME_TIME = std::chrono::microseconds(2000);
+	const auto GPU_FRAME_TIME = std::chrono::microseconds(3000);
+
+
+	struct FrameContext {
+		Clock::time_point submitTime;
+	};
+
+
+	// Executes the submitted frames one after another, like a command queue
+	class FakeGpu {
+	public:
+		explicit FakeGpu(CpuTimelineFence &fence)
+		: mFence(fence), mThread([this] { Run(); }) {
+		}
+
+		~FakeGpu() {
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mIsStopping = true;
+			}
+			mHasWork.notify_one();
+			mThread.join();
+		}
+
+		void Submit(const CpuTimelineFence::Label &label) {
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mQueue.push_back(label);
+			}
+			mHasWork.notify_one();
+		}
+
+	private:
+		void Run() {
+			while (true) {
+				CpuTimelineFence::Label label;
+				{
+					std::unique_lock<std::mutex> lock(mMutex);
+					mHasWork.wait(lock, [this] { return mIsStopping || !mQueue.empty(); });
+					if (mQueue.empty()) {
+						return;
+					}
+					label = mQueue.front();
+					mQueue.pop_front();
+				}
+
+				std::this_thread::sleep_for(GPU_FRAME_TIME);
+				mFence.Signal(label);
+			}
+		}
+
+	private:
+		CpuTimelineFence &mFence;
+
+		std::mutex mMutex;
+		std::condition_variable mHasWork;
+		std::deque<CpuTimelineFence::Label> mQueue;
+		bool mIsStopping = false;
+
+		std::thread mThread;
+	};
+
+
+	// The CPU records frames while the GPU executes the earlier ones
+	void BenchmarkFramesInFlight(std::size_t framesInFlightCount) {
+		CpuTimelineFence fence;
+		FakeGpu gpu(fence);
+		FrameRing<CpuTimelineFence, FrameContext> ring(fence, framesInFlightCount);
+
+		double latencySum = 0.0;
+		int latenciesCount = 0;
+
+		const Clock::time_point begin = Clock::now();
+		for (int frame = 0; frame < FRAMES_COUNT; frame++) {
+			const bool isReused = ring.FrameNumber() >= framesInFlightCount;
+			FrameContext &context = ring.BeginFrame();
+
+			// The wait has just ended, so the GPU finished the frame of the slot about now
+			if (isReused) {
+				latencySum += std::chrono::duration<double>(Clock::now() - context.submitTime).count();
+				latenciesCount++;
+			}
+
+			std::this_thread::sleep_for(CPU_FRAME_TIME);
+
+			const CpuTimelineFence::Label label = fence.PutLabel();
+			context.submitTime = Clock::now();
+			gpu.Submit(label);
+			ring.EndFrame(label);
+		}
+		ring.WaitForAllFrames();
+		const double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%zu frames in flight, frame time", framesInFlightCount);
+		PrintMeasurement(name, seconds / FRAMES_COUNT * 1e3, "ms");
+
+		// Upper bound of the submit to completion latency, it includes the time
+		// the CPU spent before noticing
+		std::snprintf(name, sizeof(name), "%zu frames in flight, submit to reuse", framesInFlightCount);
+		PrintMeasurement(name, latenciesCount > 0 ? latencySum / latenciesCount * 1e3 : 0.0, "ms");
+	}
+}
+
+
+int main() {
+	std::printf(
+		"CPU frames of %.1f ms, GPU frames of %.1f ms\n",
+		CPU_FRAME_TIME.count() / 1e3, GPU_FRAME_TIME.count() / 1e3
+	);
+
+	for (std::size_t framesInFlightCount : { 1, 2, 3 }) {
+		BenchmarkFramesInFlight(framesInFlightCount);
+	}
+
+	return 0;
+}
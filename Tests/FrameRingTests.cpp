@@ -0,0 +1,120 @@
+#include "TestCommon.h"
+
+#include "FrameRing.h"
+#include "CpuTimelineFence.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	struct FrameContext {
+		int framesCount = 0;
+	};
+
+	using Ring = FrameRing<CpuTimelineFence, FrameContext>;
+}
+
+
+TEST(SlotsAreReusedInOrder) {
+	CpuTimelineFence fence;
+	Ring ring(fence, 3);
+
+	for (int frame = 0; frame < 9; frame++) {
+		FrameContext &context = ring.BeginFrame();
+		CHECK(ring.CurrentFrameIndex() == std::size_t(frame % 3));
+		CHECK(&context == &ring.Frame(frame % 3));
+		context.framesCount++;
+
+		const CpuTimelineFence::Label label = fence.PutLabel();
+		fence.Signal(label);
+		ring.EndFrame(label);
+	}
+
+	CHECK(ring.FrameNumber() == 9);
+	for (std::size_t i = 0; i < 3; i++) {
+		CHECK(ring.Frame(i).framesCount == 3);
+	}
+}
+
+
+// The frames after the reused one may still be running
+TEST(BeginFrameWaitsOnlyForTheReusedSlot) {
+	CpuTimelineFence fence;
+	Ring ring(fence, 3);
+
+	std::vector<CpuTimelineFence::Label> labels;
+	for (int frame = 0; frame < 3; frame++) {
+		ring.BeginFrame();
+		labels.push_back(fence.PutLabel());
+		ring.EndFrame(labels.back());
+	}
+
+	fence.Signal(labels[0]);
+	ring.BeginFrame();
+
+	CHECK(ring.CurrentFrameIndex() == 0);
+	CHECK(!fence.IsComplete(labels[1]));
+	CHECK(!fence.IsComplete(labels[2]));
+
+	ring.EndFrame(fence.PutLabel());
+}
+
+
+TEST(BeginFrameBlocksUntilTheSlotIsSignaled) {
+	CpuTimelineFence fence;
+	Ring ring(fence, 2);
+
+	std::vector<CpuTimelineFence::Label> labels;
+	for (int frame = 0; frame < 2; frame++) {
+		ring.BeginFrame();
+		labels.push_back(fence.PutLabel());
+		ring.EndFrame(labels.back());
+	}
+
+	// Like a GPU that finishes the first frame a while later
+	std::thread gpuThread([&fence, &labels] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		fence.Signal(labels[0]);
+	});
+
+	const auto begin = std::chrono::steady_clock::now();
+	ring.BeginFrame();
+	const auto waitTime = std::chrono::steady_clock::now() - begin;
+	gpuThread.join();
+
+	CHECK(fence.IsComplete(labels[0]));
+	CHECK(!fence.IsComplete(labels[1]));
+	CHECK(waitTime >= std::chrono::milliseconds(15));
+
+	ring.EndFrame(fence.PutLabel());
+}
+
+
+TEST(WaitForAllFramesWaitsForEverySlot) {
+	CpuTimelineFence fence;
+	Ring ring(fence, 3);
+
+	CpuTimelineFence::Label lastLabel;
+	for (int frame = 0; frame < 3; frame++) {
+		ring.BeginFrame();
+		lastLabel = fence.PutLabel();
+		ring.EndFrame(lastLabel);
+	}
+
+	std::thread gpuThread([&fence, lastLabel] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		fence.Signal(lastLabel);
+	});
+
+	ring.WaitForAllFrames();
+	gpuThread.join();
+
+	CHECK(fence.IsComplete(lastLabel));
+}
+
+
+int main() {
+	return RunTests();
+}
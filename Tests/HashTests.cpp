@@ -0,0 +1,53 @@
+#include "TestCommon.h"
+
+#include "Hash.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Hashes end up in persisted caches, their values must never change
+TEST(HashesAreStable) {
+	const char *text = "The quick brown fox jumps over the lazy dog";
+
+	struct Expected {
+		std::size_t size;
+		std::uint64_t hash;
+	};
+
+	// Every tail length and a few whole blocks
+	const Expected expectedHashes[] = {
+		{ 0, 0x0000000000000000ull },
+		{ 1, 0x7A307FB51B9741CDull },
+		{ 3, 0x27BA74C43DB50F9Full },
+		{ 7, 0xAFBE39782B9A85ADull },
+		{ 8, 0xB70636B16E9FC04Bull },
+		{ 9, 0x773228AF5AF3FD32ull },
+		{ 15, 0xE0C5FAF4E404D319ull },
+		{ 16, 0x79D0DB6B5A1EE2EAull },
+		{ 43, 0x5589CA33042A861Bull },
+	};
+
+	for (const Expected &expected : expectedHashes) {
+		CHECK(HashBytes(text, expected.size) == expected.hash);
+	}
+
+	CHECK(HashBytes(text, 13, 0x1234) == 0xA5905CB292D72567ull);
+}
+
+
+TEST(HashDependsOnEveryByte) {
+	unsigned char bytes[23] = {};
+	const std::uint64_t hash = HashBytes(bytes, sizeof(bytes));
+
+	for (std::size_t i = 0; i < sizeof(bytes); i++) {
+		bytes[i] = 1;
+		CHECK(HashBytes(bytes, sizeof(bytes)) != hash);
+		bytes[i] = 0;
+	}
+}
+
+
+int main() {
+	return RunTests();
+}
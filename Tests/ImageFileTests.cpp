@@ -0,0 +1,295 @@
+#include "TestCommon.h"
+
+#include "ImageFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace {
+	// R8G8B8A8 pixels with some padding after every row
+	struct TestImage {
+		std::vector<std::uint8_t> pixels;
+		ImageView view;
+	};
+
+
+	// Rows of one color, small and large steps, alpha changes and colors that
+	// repeat, so every QOI operation is used
+	TestImage MakeImage(std::uint32_t width, std::uint32_t height) {
+		TestImage image;
+		const std::size_t rowPitch = width * 4 + 12;
+		image.pixels.assign(rowPitch * height, 0xEE);
+		image.view = ImageView{ image.pixels.data(), width, height, rowPitch };
+
+		std::uint32_t random = 12345;
+		for (std::uint32_t y = 0; y < height; y++) {
+			for (std::uint32_t x = 0; x < width; x++) {
+				std::uint8_t *pixel = &image.pixels[y * rowPitch + x * 4];
+				random = random * 1664525u + 1013904223u;
+
+				switch (y % 5) {
+				case 0:
+					pixel[0] = 10;
+					pixel[1] = 20;
+					pixel[2] = 30;
+					pixel[3] = 255;
+					break;
+				case 1:
+					pixel[0] = static_cast<std::uint8_t>(x);
+					pixel[1] = static_cast<std::uint8_t>(x * 3);
+					pixel[2] = static_cast<std::uint8_t>(x * 2);
+					pixel[3] = 255;
+					break;
+				case 2:
+					pixel[0] = static_cast<std::uint8_t>(random >> 8);
+					pixel[1] = static_cast<std::uint8_t>(random >> 16);
+					pixel[2] = static_cast<std::uint8_t>(random >> 24);
+					pixel[3] = static_cast<std::uint8_t>(x % 7 == 0 ? random : 255);
+					break;
+				default:
+					pixel[0] = x % 3 == 0 ? 200 : 50;
+					pixel[1] = x % 3 == 1 ? 100 : 60;
+					pixel[2] = static_cast<std::uint8_t>(y);
+					pixel[3] = 255;
+					break;
+				}
+			}
+		}
+
+		return image;
+	}
+
+
+	std::uint32_t GetBigEndian32(const std::uint8_t *bytes) {
+		return std::uint32_t(bytes[0]) << 24 | std::uint32_t(bytes[1]) << 16 | std::uint32_t(bytes[2]) << 8 | bytes[3];
+	}
+
+
+	// Decoder of the QOI specification, written apart from the encoder.
+	// Returns tight rows of R8G8B8A8 pixels, empty if the file is malformed
+	std::vector<std::uint8_t> DecodeQoi(const std::uint8_t *file, std::size_t size, std::uint32_t &width, std::uint32_t &height) {
+		if (size < 22 || std::memcmp(file, "qoif", 4) != 0 || file[12] != 4) {
+			return {};
+		}
+
+		width = GetBigEndian32(file + 4);
+		height = GetBigEndian32(file + 8);
+
+		std::vector<std::uint8_t> pixels(std::size_t(width) * height * 4);
+		std::array<std::array<std::uint8_t, 4>, 64> index = {};
+		std::array<std::uint8_t, 4> pixel = { 0, 0, 0, 255 };
+
+		std::size_t position = 14;
+		std::uint32_t run = 0;
+
+		for (std::size_t i = 0; i < pixels.size(); i += 4) {
+			if (run > 0) {
+				run--;
+			} else {
+				if (position >= size - 8) {
+					return {};
+				}
+
+				const std::uint8_t op = file[position++];
+				if (op == 0xFE) {
+					pixel[0] = file[position++];
+					pixel[1] = file[position++];
+					pixel[2] = file[position++];
+				} else if (op == 0xFF) {
+					std::memcpy(pixel.data(), file + position, 4);
+					position += 4;
+				} else if ((op & 0xC0) == 0x00) {
+					pixel = index[op];
+				} else if ((op & 0xC0) == 0x40) {
+					pixel[0] = static_cast<std::uint8_t>(pixel[0] + ((op >> 4) & 3) - 2);
+					pixel[1] = static_cast<std::uint8_t>(pixel[1] + ((op >> 2) & 3) - 2);
+					pixel[2] = static_cast<std::uint8_t>(pixel[2] + (op & 3) - 2);
+				} else if ((op & 0xC0) == 0x80) {
+					const int dg = (op & 0x3F) - 32;
+					const std::uint8_t next = file[position++];
+					pixel[0] = static_cast<std::uint8_t>(pixel[0] + dg - 8 + (next >> 4));
+					pixel[1] = static_cast<std::uint8_t>(pixel[1] + dg);
+					pixel[2] = static_cast<std::uint8_t>(pixel[2] + dg - 8 + (next & 0xF));
+				} else {
+					run = op & 0x3F;
+				}
+
+				index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64] = pixel;
+			}
+
+			std::memcpy(&pixels[i], pixel.data(), 4);
+		}
+
+		const std::uint8_t endMarker[] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+		if (position + 8 != size || std::memcmp(file + position, endMarker, 8) != 0) {
+			return {};
+		}
+
+		return pixels;
+	}
+
+
+	// Bit by bit, apart from the table-driven one of the encoder
+	std::uint32_t Crc32(const std::uint8_t *bytes, std::size_t size) {
+		std::uint32_t crc = 0xFFFFFFFFu;
+		for (std::size_t i = 0; i < size; i++) {
+			crc ^= bytes[i];
+			for (int bit = 0; bit < 8; bit++) {
+				crc = (crc & 1) != 0 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+			}
+		}
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+
+	std::uint32_t Adler32(const std::vector<std::uint8_t> &bytes) {
+		std::uint32_t a = 1;
+		std::uint32_t b = 0;
+		for (std::uint8_t byte : bytes) {
+			a = (a + byte) % 65521;
+			b = (b + a) % 65521;
+		}
+		return b << 16 | a;
+	}
+
+
+	// Every row without its padding, preceded by the filter type 0
+	std::vector<std::uint8_t> MakeScanlines(const ImageView &image) {
+		std::vector<std::uint8_t> scanlines;
+		for (std::uint32_t y = 0; y < image.height; y++) {
+			const std::uint8_t *row = image.pixels + y * image.rowPitch;
+			scanlines.push_back(0);
+			scanlines.insert(scanlines.end(), row, row + image.width * 4);
+		}
+		return scanlines;
+	}
+
+
+	// Checks the chunks of the file and their CRCs, and the stored deflate
+	// blocks of the image data
+	void CheckPng(const std::vector<std::uint8_t> &file, const ImageView &image) {
+		const std::uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		CHECK(file.size() > sizeof(signature));
+		CHECK(std::memcmp(file.data(), signature, sizeof(signature)) == 0);
+
+		std::vector<std::string> chunkTypes;
+		std::vector<std::uint8_t> zlibStream;
+		std::size_t position = sizeof(signature);
+
+		while (position < file.size()) {
+			CHECK(position + 12 <= file.size());
+			const std::uint32_t length = GetBigEndian32(&file[position]);
+			CHECK(position + 12 + length <= file.size());
+
+			const std::uint8_t *type = &file[position + 4];
+			const std::uint8_t *data = type + 4;
+			CHECK(GetBigEndian32(data + length) == Crc32(type, length + 4));
+
+			chunkTypes.emplace_back(reinterpret_cast<const char*>(type), 4);
+			if (chunkTypes.back() == "IHDR") {
+				CHECK(length == 13);
+				CHECK(GetBigEndian32(data) == image.width);
+				CHECK(GetBigEndian32(data + 4) == image.height);
+				// 8 bits per channel, RGBA, deflate, adaptive filtering, no interlacing
+				const std::uint8_t header[] = { 8, 6, 0, 0, 0 };
+				CHECK(std::memcmp(data + 8, header, sizeof(header)) == 0);
+			} else if (chunkTypes.back() == "IDAT") {
+				zlibStream.insert(zlibStream.end(), data, data + length);
+			} else {
+				CHECK(length == 0);
+			}
+
+			position += 12 + length;
+		}
+
+		CHECK((chunkTypes == std::vector<std::string>{ "IHDR", "IDAT", "IEND" }));
+
+		// Deflate with a 32 KB window, the check bits make the header a multiple of 31
+		CHECK(zlibStream.size() >= 2 + 5 + 4);
+		CHECK(zlibStream[0] == 0x78);
+		CHECK((zlibStream[0] * 256 + zlibStream[1]) % 31 == 0);
+
+		std::vector<std::uint8_t> scanlines;
+		std::size_t blockPosition = 2;
+		bool isFinalBlock = false;
+		while (!isFinalBlock) {
+			CHECK(blockPosition + 5 <= zlibStream.size() - 4);
+			const std::uint8_t *block = &zlibStream[blockPosition];
+
+			// Stored blocks only
+			CHECK((block[0] & ~1) == 0);
+			isFinalBlock = block[0] == 1;
+
+			const std::uint16_t blockLength = static_cast<std::uint16_t>(block[1] | block[2] << 8);
+			const std::uint16_t inverseLength = static_cast<std::uint16_t>(block[3] | block[4] << 8);
+			CHECK(static_cast<std::uint16_t>(~blockLength) == inverseLength);
+			CHECK(blockPosition + 5 + blockLength <= zlibStream.size() - 4);
+
+			scanlines.insert(scanlines.end(), block + 5, block + 5 + blockLength);
+			blockPosition += 5 + blockLength;
+		}
+
+		CHECK(blockPosition + 4 == zlibStream.size());
+		CHECK(scanlines == MakeScanlines(image));
+		CHECK(GetBigEndian32(&zlibStream[blockPosition]) == Adler32(scanlines));
+	}
+}
+
+
+TEST(QoiDecodesToTheImage) {
+	const TestImage image = MakeImage(97, 10);
+
+	std::vector<std::uint8_t> buffer;
+	const std::size_t size = EncodeImage(ImageFileFormat::QOI, image.view, buffer);
+
+	std::uint32_t width = 0;
+	std::uint32_t height = 0;
+	const std::vector<std::uint8_t> pixels = DecodeQoi(buffer.data(), size, width, height);
+	CHECK(width == 97);
+	CHECK(height == 10);
+
+	std::vector<std::uint8_t> expectedPixels;
+	for (std::uint32_t y = 0; y < height; y++) {
+		const std::uint8_t *row = image.view.pixels + y * image.view.rowPitch;
+		expectedPixels.insert(expectedPixels.end(), row, row + width * 4);
+	}
+	CHECK(pixels == expectedPixels);
+
+	// Runs and repeated colors take much less than the pixels
+	CHECK(size < expectedPixels.size() / 2);
+}
+
+
+TEST(PngChunksAreValid) {
+	const TestImage image = MakeImage(5, 3);
+
+	std::vector<std::uint8_t> buffer;
+	const std::size_t size = EncodeImage(ImageFileFormat::PNG, image.view, buffer);
+	CheckPng(std::vector<std::uint8_t>(buffer.begin(), buffer.begin() + size), image.view);
+}
+
+
+TEST(PngDataSpansSeveralDeflateBlocks) {
+	// More scanline bytes than one stored block holds
+	const TestImage image = MakeImage(300, 120);
+
+	std::vector<std::uint8_t> buffer;
+	const std::size_t size = EncodeImage(ImageFileFormat::PNG, image.view, buffer);
+	CheckPng(std::vector<std::uint8_t>(buffer.begin(), buffer.begin() + size), image.view);
+
+	// Encoding again into the same buffer gives the same file
+	const std::vector<std::uint8_t> firstFile(buffer.begin(), buffer.begin() + size);
+	CHECK(EncodeImage(ImageFileFormat::PNG, image.view, buffer) == size);
+	CHECK(std::equal(firstFile.begin(), firstFile.end(), buffer.begin()));
+}
+
+
+int main() {
+	return RunTests();
+}
@@ -0,0 +1,83 @@
+#include "BenchmarkCommon.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Overhead of a job that does nothing, started and waited for in batches
+static void BenchmarkEmptyJobs(JobSystem &jobSystem, const std::string &suffix) {
+	const int JOBS_COUNT = 1000;
+
+	const double seconds = MeasureSeconds([&jobSystem] {
+		JobCounter counter;
+		for (int i = 0; i < JOBS_COUNT; i++) {
+			jobSystem.Run([] {}, counter);
+		}
+		jobSystem.Wait(counter);
+	});
+
+	PrintMeasurement(("Empty job" + suffix).c_str(), seconds / JOBS_COUNT * 1e9, "ns");
+}
+
+
+// Latency from fanning out a small batch of jobs until all of them are joined,
+// like one stage of a frame
+static void BenchmarkFanOutFanIn(JobSystem &jobSystem, const std::string &suffix) {
+	const std::size_t jobsCount = jobSystem.ThreadsCount() * 4;
+
+	const double seconds = MeasureSeconds([&jobSystem, jobsCount] {
+		jobSystem.ParallelFor(jobsCount, [](std::size_t index) {
+			KeepValue(index);
+		});
+	});
+
+	PrintMeasurement(("Fan-out and fan-in" + suffix).c_str(), seconds * 1e6, "us");
+}
+
+
+// Time of a ParallelFor over work that splits evenly
+static double MeasureParallelWork(JobSystem &jobSystem) {
+	const std::size_t ITEMS_COUNT = 4096;
+	const int ITEM_ITERATIONS_COUNT = 2000;
+
+	return MeasureSeconds([&jobSystem, ITEMS_COUNT, ITEM_ITERATIONS_COUNT] {
+		jobSystem.ParallelFor(ITEMS_COUNT, [ITEM_ITERATIONS_COUNT](std::size_t index) {
+			double value = double(index);
+			for (int i = 0; i < ITEM_ITERATIONS_COUNT; i++) {
+				value = std::sqrt(value + 1.0);
+			}
+			KeepValue(value);
+		});
+	});
+}
+
+
+int main() {
+	const std::size_t hardwareThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+	std::printf("Hardware threads: %zu\n", hardwareThreadsCount);
+
+	double singleThreadSeconds = 0.0;
+	for (std::size_t threadsCount = 1; threadsCount <= hardwareThreadsCount; threadsCount *= 2) {
+		JobSystem jobSystem(threadsCount - 1);
+		const std::string suffix = ", " + std::to_string(threadsCount) + " threads";
+
+		BenchmarkEmptyJobs(jobSystem, suffix);
+		BenchmarkFanOutFanIn(jobSystem, suffix);
+
+		const double seconds = MeasureParallelWork(jobSystem);
+		if (threadsCount == 1) {
+			singleThreadSeconds = seconds;
+		}
+		PrintMeasurement(("Parallel work speedup" + suffix).c_str(), singleThreadSeconds / seconds, "x");
+	}
+
+	return 0;
+}
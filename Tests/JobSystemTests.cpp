@@ -0,0 +1,153 @@
+#include "TestCommon.h"
+
+#include "JobSystem.h"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+// Configurations of the tests, without workers the creating thread runs everything
+static const std::size_t WORKER_THREADS_COUNTS[] = { 0, 1, 3 };
+
+
+TEST(RunCompletesEveryJob) {
+	for (std::size_t workerThreadsCount : WORKER_THREADS_COUNTS) {
+		JobSystem jobSystem(workerThreadsCount);
+		CHECK(jobSystem.ThreadsCount() == workerThreadsCount + 1);
+
+		std::atomic<int> runsCount{0};
+		JobCounter counter;
+		CHECK(counter.IsDone());
+
+		for (int i = 0; i < 1000; i++) {
+			jobSystem.Run([&runsCount] { runsCount.fetch_add(1, std::memory_order_relaxed); }, counter);
+		}
+		jobSystem.Wait(counter);
+
+		CHECK(counter.IsDone());
+		CHECK(runsCount.load() == 1000);
+	}
+}
+
+
+TEST(NestedJobsWaitForTheirChildren) {
+	for (std::size_t workerThreadsCount : WORKER_THREADS_COUNTS) {
+		JobSystem jobSystem(workerThreadsCount);
+		std::atomic<int> childRunsCount{0};
+		std::atomic<int> mismatchesCount{0};
+
+		JobCounter counter;
+		// More than JOBS_PER_THREAD, the slots of the creating thread wrap around
+		for (int i = 0; i < 10000; i++) {
+			jobSystem.Run([&jobSystem, &childRunsCount, &mismatchesCount] {
+				std::atomic<int> childValue{0};
+				JobCounter childCounter;
+				jobSystem.Run([&childValue] { childValue.store(1, std::memory_order_relaxed); }, childCounter);
+				jobSystem.Wait(childCounter);
+
+				if (childValue.load(std::memory_order_relaxed) != 1) {
+					mismatchesCount.fetch_add(1, std::memory_order_relaxed);
+				}
+				childRunsCount.fetch_add(1, std::memory_order_relaxed);
+			}, counter);
+		}
+		jobSystem.Wait(counter);
+
+		CHECK(mismatchesCount.load() == 0);
+		CHECK(childRunsCount.load() == 10000);
+	}
+}
+
+
+TEST(ParallelForVisitsEveryIndexOnce) {
+	for (std::size_t workerThreadsCount : WORKER_THREADS_COUNTS) {
+		JobSystem jobSystem(workerThreadsCount);
+
+		for (std::size_t count : { 0, 1, 2, 7, 1000, 100000 }) {
+			std::vector<std::atomic<int>> visitsCounts(count);
+			for (std::atomic<int> &visitsCount : visitsCounts) {
+				visitsCount.store(0);
+			}
+
+			jobSystem.ParallelFor(count, [&visitsCounts](std::size_t index) {
+				visitsCounts[index].fetch_add(1, std::memory_order_relaxed);
+			});
+
+			for (const std::atomic<int> &visitsCount : visitsCounts) {
+				CHECK(visitsCount.load() == 1);
+			}
+		}
+	}
+}
+
+
+TEST(NestedParallelFor) {
+	for (std::size_t workerThreadsCount : WORKER_THREADS_COUNTS) {
+		JobSystem jobSystem(workerThreadsCount);
+		std::atomic<int> visitsCount{0};
+
+		jobSystem.ParallelFor(16, [&jobSystem, &visitsCount](std::size_t) {
+			jobSystem.ParallelFor(64, [&visitsCount](std::size_t) {
+				visitsCount.fetch_add(1, std::memory_order_relaxed);
+			});
+		});
+
+		CHECK(visitsCount.load() == 16 * 64);
+	}
+}
+
+
+TEST(BackgroundJobsComplete) {
+	for (std::size_t workerThreadsCount : WORKER_THREADS_COUNTS) {
+		JobSystem jobSystem(workerThreadsCount);
+		std::atomic<int> runsCount{0};
+
+		JobCounter counter;
+		for (int i = 0; i < 100; i++) {
+			jobSystem.RunBackground([&runsCount] { runsCount.fetch_add(1, std::memory_order_relaxed); }, counter);
+		}
+		jobSystem.Wait(counter);
+
+		CHECK(runsCount.load() == 100);
+	}
+}
+
+
+TEST(BackgroundJobsFromOtherThreads) {
+	JobSystem jobSystem(2);
+	std::atomic<int> runsCount{0};
+	JobCounter counter;
+
+	std::thread otherThread([&jobSystem, &runsCount, &counter] {
+		for (int i = 0; i < 100; i++) {
+			jobSystem.RunBackground([&runsCount] { runsCount.fetch_add(1, std::memory_order_relaxed); }, counter);
+		}
+	});
+	otherThread.join();
+
+	jobSystem.Wait(counter);
+	CHECK(runsCount.load() == 100);
+}
+
+
+TEST(Stress) {
+	for (std::size_t workerThreadsCount : WORKER_THREADS_COUNTS) {
+		JobSystem jobSystem(workerThreadsCount);
+		std::atomic<std::uint64_t> sum{0};
+
+		for (int round = 0; round < 200; round++) {
+			jobSystem.ParallelFor(1000, [&sum](std::size_t index) {
+				sum.fetch_add(index, std::memory_order_relaxed);
+			});
+		}
+
+		CHECK(sum.load() == 200ull * (999ull * 1000ull / 2));
+	}
+}
+
+
+int main() {
+	return RunTests();
+}
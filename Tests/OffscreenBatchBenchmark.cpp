@@ -0,0 +1,70 @@
+#include "BenchmarkCommon.h"
+
+#include "FrameDumpWriter.h"
+#include "OffscreenBatch.h"
+#include "SoftwareFrameBackend.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+
+namespace {
+	// Frame files are written into the working directory of the benchmark and removed
+	const std::uint64_t FRAMES_COUNT = 2000;
+	const std::uint32_t WIDTH = 320;
+	const std::uint32_t HEIGHT = 180;
+
+
+	void RemoveFrameFiles(ImageFileFormat format) {
+		for (std::uint64_t i = 0; i < FRAMES_COUNT; i++) {
+			char path[64];
+			std::snprintf(path, sizeof(path), "./frame_%06" PRIu64 "%s", i, ImageFileExtension(format));
+			std::remove(path);
+		}
+	}
+
+
+	// The whole pipeline: software rendering, readback into the ring of targets
+	// and encoding on the threads of the writer
+	void BenchmarkBatch(ImageFileFormat format, std::size_t targetsCount, std::size_t writerThreadsCount) {
+		const std::size_t hardwareThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+
+		JobSystem jobSystem(hardwareThreadsCount - 1);
+		FrameDumpWriter writer(".", format, writerThreadsCount);
+		SoftwareFrameBackend backend(WIDTH, HEIGHT, jobSystem, writer, targetsCount);
+		FrameRenderer<SoftwareFrameBackend> renderer(backend, jobSystem, WIDTH, HEIGHT);
+
+		const OffscreenBatchReport report = RunOffscreenBatch(renderer, backend, FRAMES_COUNT);
+		const FrameDumpWriter::Statistics statistics = writer.GetStatistics();
+
+		char name[96];
+		std::snprintf(
+			name, sizeof(name), "%s, %zu targets, %zu writer threads",
+			ImageFileExtension(format), targetsCount, writerThreadsCount
+		);
+		PrintMeasurement(name, report.FramesPerSecond(), "frames/s");
+		PrintMeasurement("  Readback stalls", double(report.readbackStallsCount), "frames");
+		PrintMeasurement("  File size", double(statistics.bytesWrittenCount) / double(FRAMES_COUNT) / 1024.0, "KiB");
+
+		RemoveFrameFiles(format);
+	}
+}
+
+
+int main() {
+	std::printf("%" PRIu64 " frames of %ux%u\n", FRAMES_COUNT, WIDTH, HEIGHT);
+
+	const std::size_t writerThreadsCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+	for (ImageFileFormat format : { ImageFileFormat::QOI, ImageFileFormat::PNG }) {
+		for (std::size_t targetsCount : { std::size_t(2), SoftwareFrameBackend::DEFAULT_TARGETS_COUNT, std::size_t(8) }) {
+			BenchmarkBatch(format, targetsCount, writerThreadsCount);
+		}
+	}
+
+	return 0;
+}
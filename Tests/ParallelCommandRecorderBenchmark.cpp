@@ -0,0 +1,98 @@
+#include "BenchmarkCommon.h"
+
+#include "ParallelCommandRecorder.h"
+#include "NullRecordingBackend.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	using Recorder = ParallelCommandRecorder<NullRecordingBackend>;
+
+
+	// Every command tells the task and its place in it, so the submission order can be checked
+	void AddTasks(Recorder &recorder, int tasksCount, int commandsCount) {
+		for (int task = 0; task < tasksCount; task++) {
+			recorder.AddTask([task, commandsCount](NullRecordingBackend::CommandList &commandList) {
+				for (int command = 0; command < commandsCount; command++) {
+					commandList.SetViewport(Viewport{ float(task), float(command), 1.0f, 1.0f, 0.0f, 1.0f });
+				}
+			});
+		}
+	}
+
+
+	bool IsInTaskOrder(const std::vector<NullCommand> &commands, int tasksCount, int commandsCount) {
+		if (commands.size() != std::size_t(tasksCount) * commandsCount) {
+			return false;
+		}
+
+		for (std::size_t i = 0; i < commands.size(); i++) {
+			const Viewport &viewport = commands[i].viewport;
+			if (viewport.topLeftX != float(i / commandsCount) || viewport.topLeftY != float(i % commandsCount)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	// Returns false if the commands weren't submitted in the order of AddTask
+	bool BenchmarkRecording(JobSystem &jobSystem, int tasksCount, int commandsCount) {
+		ResourceStateRegistry stateRegistry;
+		NullRecordingBackend backend(stateRegistry);
+		Recorder recorder(backend, jobSystem);
+		std::vector<NullCommand> commands;
+
+		AddTasks(recorder, tasksCount, commandsCount);
+		recorder.RecordAndSubmit();
+		backend.TakeSubmittedCommands(commands);
+		if (!IsInTaskOrder(commands, tasksCount, commandsCount)) {
+			std::printf("%d tasks of %d commands weren't submitted in order\n", tasksCount, commandsCount);
+			return false;
+		}
+
+		const double seconds = MeasureSeconds([&recorder, &backend, &commands, tasksCount, commandsCount] {
+			AddTasks(recorder, tasksCount, commandsCount);
+			recorder.RecordAndSubmit();
+			backend.TakeSubmittedCommands(commands);
+		});
+
+		char name[96];
+		std::snprintf(
+			name, sizeof(name), "%d tasks of %d commands, %zu threads, frame",
+			tasksCount, commandsCount, jobSystem.ThreadsCount()
+		);
+		PrintMeasurement(name, seconds * 1e6, "us");
+
+		std::snprintf(
+			name, sizeof(name), "%d tasks of %d commands, %zu threads, commands",
+			tasksCount, commandsCount, jobSystem.ThreadsCount()
+		);
+		PrintMeasurement(name, double(tasksCount) * commandsCount / seconds / 1e6, "M/s");
+
+		return IsInTaskOrder(commands, tasksCount, commandsCount);
+	}
+}
+
+
+int main() {
+	const unsigned int threadsCount = std::thread::hardware_concurrency();
+	bool isInOrder = true;
+
+	for (std::size_t workerThreadsCount : { std::size_t(0), std::size_t(threadsCount > 1 ? threadsCount - 1 : 1) }) {
+		JobSystem jobSystem(workerThreadsCount);
+
+		for (int tasksCount : { 16, 256 }) {
+			for (int commandsCount : { 100, 1000 }) {
+				isInOrder &= BenchmarkRecording(jobSystem, tasksCount, commandsCount);
+			}
+		}
+	}
+
+	return isInOrder ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+#include "BenchmarkCommon.h"
+
+#include "PipelineCacheFile.h"
+#include "PipelineKey.h"
+#include "SharedObjectCache.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+namespace {
+	// Written into the working directory of the benchmark
+	const std::string CACHE_PATH = "PipelineCacheBenchmark.bin";
+
+	const std::uint32_t PIPELINES_COUNT = 10000;
+	// Like the blob of a mid-sized graphics pipeline
+	const std::size_t BLOB_SIZE = 8192;
+
+
+	// Subobjects of a graphics pipeline as the stream canonicalizer encodes them,
+	// most of them left at their defaults
+	struct PipelineDescription {
+		std::uint64_t vertexShaderHash;
+		std::uint64_t pixelShaderHash;
+		std::uint64_t rootSignatureHash;
+		std::uint32_t renderTargetFormats[8];
+		std::uint32_t depthStencilFormat;
+		std::uint32_t blendState[10];
+		std::uint32_t rasterizerState[11];
+		std::uint32_t sampleMask;
+	};
+
+
+	PipelineDescription MakeDescription(std::uint32_t index) {
+		PipelineDescription description = {};
+		description.vertexShaderHash = 0x1000 + index / 16;
+		description.pixelShaderHash = 0x2000 + index;
+		description.rootSignatureHash = 0x3000 + index % 8;
+		description.renderTargetFormats[0] = 28;
+		description.renderTargetFormats[1] = index % 3 == 0 ? 10 : 0;
+		description.depthStencilFormat = 40;
+		description.blendState[0] = index % 5 == 0 ? 1 : 0;
+		description.rasterizerState[0] = 3;
+		description.rasterizerState[1] = index % 2 == 0 ? 3 : 1;
+		description.sampleMask = UINT32_MAX;
+		return description;
+	}
+
+
+	template <typename T>
+	void AddSubobject(PipelineKeyBuilder &builder, std::uint32_t type, const T &value, const T &defaultValue) {
+		builder.AddSubobject(type, &value, sizeof(value), &defaultValue, sizeof(defaultValue));
+	}
+
+
+	PipelineKey BuildKey(PipelineKeyBuilder &builder, const PipelineDescription &description) {
+		static const PipelineDescription defaults = [] {
+			PipelineDescription defaults = {};
+			defaults.rasterizerState[0] = 3;
+			defaults.rasterizerState[1] = 3;
+			defaults.sampleMask = UINT32_MAX;
+			return defaults;
+		}();
+
+		AddSubobject(builder, 1, description.rootSignatureHash, defaults.rootSignatureHash);
+		AddSubobject(builder, 2, description.vertexShaderHash, defaults.vertexShaderHash);
+		AddSubobject(builder, 3, description.pixelShaderHash, defaults.pixelShaderHash);
+		AddSubobject(builder, 10, description.blendState, defaults.blendState);
+		AddSubobject(builder, 11, description.sampleMask, defaults.sampleMask);
+		AddSubobject(builder, 12, description.rasterizerState, defaults.rasterizerState);
+		AddSubobject(builder, 19, description.renderTargetFormats, defaults.renderTargetFormats);
+		AddSubobject(builder, 20, description.depthStencilFormat, defaults.depthStencilFormat);
+		return builder.Build();
+	}
+
+
+	// Every pipeline is looked up in the file and, for a cold cache, compiled and inserted.
+	// Compilation itself is left out, it's the driver's part of the startup
+	double MeasureStartupSeconds(const std::vector<PipelineDescription> &descriptions, std::uint32_t &hitsCount) {
+		const std::vector<std::uint8_t> compiledBlob(BLOB_SIZE, 0xCD);
+
+		const auto begin = std::chrono::steady_clock::now();
+
+		PipelineCacheFile file;
+		file.Load(CACHE_PATH);
+
+		PipelineKeyBuilder builder;
+		std::vector<std::uint8_t> blob;
+		hitsCount = 0;
+		bool isFileChanged = false;
+
+		for (const PipelineDescription &description : descriptions) {
+			const PipelineKey key = BuildKey(builder, description);
+
+			BlobCacheFile::Blob storedBlob;
+			if (file.Find(key, storedBlob)) {
+				const std::uint8_t *bytes = static_cast<const std::uint8_t*>(storedBlob.data);
+				blob.assign(bytes, bytes + storedBlob.size);
+				hitsCount++;
+			} else {
+				file.Insert(key, compiledBlob.data(), compiledBlob.size());
+				isFileChanged = true;
+			}
+		}
+
+		if (isFileChanged) {
+			file.Save(CACHE_PATH);
+		}
+
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+}
+
+
+int main() {
+	std::vector<PipelineDescription> descriptions;
+	for (std::uint32_t i = 0; i < PIPELINES_COUNT; i++) {
+		descriptions.push_back(MakeDescription(i));
+	}
+
+	PipelineKeyBuilder builder;
+
+	std::uint32_t index = 0;
+	const double buildSeconds = MeasureSeconds([&builder, &descriptions, &index] {
+		KeepValue(BuildKey(builder, descriptions[index++ % PIPELINES_COUNT]).hash);
+	});
+	PrintMeasurement("Build a key", buildSeconds * 1e9, "ns");
+
+	// Pipelines created in this run, like the in-memory map of PipelineStateCache
+	SharedObjectCache<PipelineKey, std::uint32_t, PipelineKeyHash> pipelines;
+	for (std::uint32_t i = 0; i < PIPELINES_COUNT; i++) {
+		bool isCreated;
+		pipelines.GetOrCreate(BuildKey(builder, descriptions[i]), [i] { return i; }, isCreated);
+	}
+
+	const double lookupSeconds = MeasureSeconds([&builder, &descriptions, &pipelines, &index] {
+		std::uint32_t pipeline = 0;
+		KeepValue(pipelines.TryGet(BuildKey(builder, descriptions[index++ % PIPELINES_COUNT]), pipeline));
+		KeepValue(pipeline);
+	});
+	char name[96];
+	std::snprintf(name, sizeof(name), "Build a key and find one of %u created pipelines", PIPELINES_COUNT);
+	PrintMeasurement(name, lookupSeconds * 1e9, "ns");
+
+	std::remove(CACHE_PATH.c_str());
+
+	std::uint32_t hitsCount;
+	const double coldSeconds = MeasureStartupSeconds(descriptions, hitsCount);
+	std::snprintf(name, sizeof(name), "Cold startup of %u pipelines, %u file hits", PIPELINES_COUNT, hitsCount);
+	PrintMeasurement(name, coldSeconds * 1e3, "ms");
+
+	const double warmSeconds = MeasureStartupSeconds(descriptions, hitsCount);
+	std::snprintf(name, sizeof(name), "Warm startup of %u pipelines, %u file hits", PIPELINES_COUNT, hitsCount);
+	PrintMeasurement(name, warmSeconds * 1e3, "ms");
+
+	std::remove(CACHE_PATH.c_str());
+
+	return 0;
+}
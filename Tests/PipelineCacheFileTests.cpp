@@ -0,0 +1,135 @@
+#include "TestCommon.h"
+
+#include "PipelineCacheFile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+	// Written into the working directory of the test
+	const std::string CACHE_PATH = "PipelineCacheFileTests.bin";
+
+
+	PipelineKey MakeKey(std::uint8_t value) {
+		PipelineKeyBuilder builder;
+		builder.BeginSubobject(1);
+		builder.AddField(value);
+		return builder.Build();
+	}
+}
+
+
+TEST(SubobjectOrderDoesntChangeTheKey) {
+	const std::uint32_t format = 28;
+	const std::uint64_t shaderHash = 0x1234;
+
+	PipelineKeyBuilder builder;
+	builder.BeginSubobject(2);
+	builder.AddField(format);
+	builder.BeginSubobject(1);
+	builder.AddField(shaderHash);
+	const PipelineKey key = builder.Build();
+
+	builder.BeginSubobject(1);
+	builder.AddField(shaderHash);
+	builder.BeginSubobject(2);
+	builder.AddField(format);
+	CHECK(builder.Build() == key);
+
+	// The fields stay with their subobjects
+	builder.BeginSubobject(1);
+	builder.AddField(format);
+	builder.BeginSubobject(2);
+	builder.AddField(shaderHash);
+	CHECK(builder.Build() != key);
+}
+
+
+TEST(DefaultSubobjectsDontChangeTheKey) {
+	const std::uint32_t sampleMask = UINT32_MAX;
+	const std::uint32_t defaultSampleMask = UINT32_MAX;
+	const std::uint32_t format = 28;
+	const std::uint32_t defaultFormat = 0;
+
+	PipelineKeyBuilder builder;
+	builder.AddSubobject(2, &format, sizeof(format), &defaultFormat, sizeof(defaultFormat));
+	const PipelineKey key = builder.Build();
+
+	builder.AddSubobject(3, &sampleMask, sizeof(sampleMask), &defaultSampleMask, sizeof(defaultSampleMask));
+	builder.AddSubobject(2, &format, sizeof(format), &defaultFormat, sizeof(defaultFormat));
+	CHECK(builder.Build() == key);
+
+	// Empty subobjects are defaults too, e.g. an input layout without elements
+	builder.AddSubobject(4, nullptr, 0, nullptr, 0);
+	builder.AddSubobject(2, &format, sizeof(format), &defaultFormat, sizeof(defaultFormat));
+	CHECK(builder.Build() == key);
+
+	const std::uint32_t otherSampleMask = 1;
+	builder.AddSubobject(3, &otherSampleMask, sizeof(otherSampleMask), &defaultSampleMask, sizeof(defaultSampleMask));
+	builder.AddSubobject(2, &format, sizeof(format), &defaultFormat, sizeof(defaultFormat));
+	CHECK(builder.Build() != key);
+}
+
+
+TEST(SavedEntriesLoad) {
+	std::remove(CACHE_PATH.c_str());
+
+	PipelineCacheFile file;
+	CHECK(!file.Load(CACHE_PATH));
+
+	const std::vector<std::uint8_t> blob = { 1, 2, 3 };
+	file.Insert(MakeKey(1), blob.data(), blob.size());
+	file.Save(CACHE_PATH);
+
+	PipelineCacheFile loadedFile;
+	CHECK(loadedFile.Load(CACHE_PATH));
+	CHECK(loadedFile.EntriesCount() == 1);
+	BlobCacheFile::Blob foundBlob;
+	CHECK(loadedFile.Find(MakeKey(1), foundBlob));
+	CHECK(foundBlob.size == blob.size() && std::memcmp(foundBlob.data, blob.data(), blob.size()) == 0);
+	CHECK(!loadedFile.Find(MakeKey(2), foundBlob));
+}
+
+
+TEST(SaveReplacesTheExistingFile) {
+	std::remove(CACHE_PATH.c_str());
+
+	PipelineCacheFile file;
+	const std::vector<std::uint8_t> blob = { 4, 5 };
+	file.Insert(MakeKey(1), blob.data(), blob.size());
+	file.Save(CACHE_PATH);
+
+	file.Insert(MakeKey(2), blob.data(), blob.size());
+	file.Save(CACHE_PATH);
+
+	PipelineCacheFile loadedFile;
+	CHECK(loadedFile.Load(CACHE_PATH));
+	CHECK(loadedFile.EntriesCount() == 2);
+
+	// No temporary file is left behind
+	CHECK(!std::ifstream(CACHE_PATH + ".tmp"));
+}
+
+
+TEST(DamagedFileIsEmpty) {
+	{
+		std::ofstream file(CACHE_PATH, std::ios::binary | std::ios::trunc);
+		file << "not a pipeline cache";
+	}
+
+	PipelineCacheFile file;
+	CHECK(!file.Load(CACHE_PATH));
+	CHECK(file.EntriesCount() == 0);
+
+	std::remove(CACHE_PATH.c_str());
+}
+
+
+int main() {
+	return RunTests();
+}
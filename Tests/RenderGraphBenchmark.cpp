@@ -0,0 +1,86 @@
+#include "BenchmarkCommon.h"
+
+#include "RenderGraph.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+
+// Synthetic frame: every pass reads the outputs of two earlier passes and writes
+// one texture, every fourth one is a compute pass that writes a buffer twice in a
+// row. Outputs of the passes whose index ends in 7 aren't read, so those are culled
+static void BuildFrame(RenderGraph &graph, std::uint32_t passesCount, ResourceState backBufferFinalState) {
+	graph.Reset();
+
+	const RenderGraph::ResourceId backBuffer = graph.ImportResource(ResourceState::PRESENT, backBufferFinalState);
+
+	std::vector<RenderGraph::ResourceId> outputs;
+	for (std::uint32_t i = 0; i < passesCount; i++) {
+		const bool isCompute = i % 4 == 3;
+		const ResourceState writeState = isCompute ? ResourceState::UNORDERED_ACCESS : ResourceState::RENDER_TARGET;
+		const ResourceState readState = isCompute
+			? ResourceState::NON_PIXEL_SHADER_RESOURCE
+			: ResourceState::PIXEL_SHADER_RESOURCE;
+
+		const RenderGraph::ResourceId output = graph.CreateResource(writeState);
+		const RenderGraph::PassId pass = graph.AddPass();
+
+		for (std::uint32_t distance : { 1u, 5u }) {
+			if (outputs.size() >= distance && (outputs.size() - distance) % 10 != 7) {
+				graph.Read(pass, outputs[outputs.size() - distance], readState);
+			}
+		}
+
+		graph.Write(pass, i + 1 == passesCount ? backBuffer : output, writeState);
+		if (isCompute) {
+			const RenderGraph::PassId secondPass = graph.AddPass();
+			graph.Read(secondPass, output, ResourceState::UNORDERED_ACCESS);
+			graph.Write(secondPass, output, ResourceState::UNORDERED_ACCESS);
+		}
+
+		outputs.push_back(output);
+	}
+}
+
+
+int main() {
+	for (std::uint32_t passesCount : { 25u, 100u, 400u }) {
+		RenderGraph graph;
+
+		BuildFrame(graph, passesCount, ResourceState::PRESENT);
+		const CompiledRenderGraph &compiled = graph.Compile();
+
+		std::printf(
+			"%u passes, %zu scheduled, %zu barriers\n",
+			passesCount + passesCount / 4, compiled.passes.size(), compiled.barriers.size()
+		);
+
+		const double buildSeconds = MeasureSeconds([&graph, passesCount] {
+			BuildFrame(graph, passesCount, ResourceState::PRESENT);
+		});
+		PrintMeasurement("  Build", buildSeconds * 1e6, "us");
+
+		// Alternating final states change the shape every frame
+		bool isOddFrame = false;
+		const double compileSeconds = MeasureSeconds([&graph, passesCount, &isOddFrame] {
+			isOddFrame = !isOddFrame;
+			BuildFrame(graph, passesCount, isOddFrame ? ResourceState::COPY_SOURCE : ResourceState::PRESENT);
+			KeepValue(graph.Compile().barriers.size());
+		});
+		PrintMeasurement("  Build and compile", compileSeconds * 1e6, "us");
+
+		const double reuseSeconds = MeasureSeconds([&graph, passesCount] {
+			BuildFrame(graph, passesCount, ResourceState::PRESENT);
+			KeepValue(graph.Compile().barriers.size());
+		});
+		PrintMeasurement("  Build and reuse the compiled graph", reuseSeconds * 1e6, "us");
+
+		const RenderGraph::Statistics statistics = graph.GetStatistics();
+		std::printf(
+			"  Compilations %u, reused %u\n", statistics.compilationsCount, statistics.reusedCompilationsCount
+		);
+	}
+
+	return 0;
+}
@@ -0,0 +1,195 @@
+#include "TestCommon.h"
+
+#include "RenderGraph.h"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace {
+	using Barrier = CompiledRenderGraph::Barrier;
+	using BarrierType = CompiledRenderGraph::BarrierType;
+
+
+	std::vector<Barrier> BarriersOf(const CompiledRenderGraph &graph, const CompiledRenderGraph::BarrierRange &range) {
+		return std::vector<Barrier>(graph.barriers.begin() + range.begin, graph.barriers.begin() + range.end);
+	}
+
+
+	bool IsTransition(const Barrier &barrier, std::uint32_t resource, ResourceState before, ResourceState after) {
+		return barrier.type == BarrierType::TRANSITION
+			&& barrier.resource == resource
+			&& barrier.before == before
+			&& barrier.after == after;
+	}
+
+
+	// Shadow map, main pass and post-processing into the back buffer
+	void BuildFrame(RenderGraph &graph, ResourceState backBufferFinalState) {
+		graph.Reset();
+
+		const auto backBuffer = graph.ImportResource(ResourceState::PRESENT, backBufferFinalState);
+		const auto shadowMap = graph.CreateResource(ResourceState::DEPTH_WRITE);
+		const auto color = graph.CreateResource(ResourceState::RENDER_TARGET);
+
+		const auto shadowPass = graph.AddPass();
+		graph.Write(shadowPass, shadowMap, ResourceState::DEPTH_WRITE);
+
+		const auto mainPass = graph.AddPass();
+		graph.Read(mainPass, shadowMap, ResourceState::PIXEL_SHADER_RESOURCE);
+		graph.Write(mainPass, color, ResourceState::RENDER_TARGET);
+
+		const auto postPass = graph.AddPass();
+		graph.Read(postPass, color, ResourceState::PIXEL_SHADER_RESOURCE);
+		graph.Write(postPass, backBuffer, ResourceState::RENDER_TARGET);
+	}
+}
+
+
+TEST(PassesWhoseWritesAreNeverReadAreCulled) {
+	RenderGraph graph;
+
+	const auto output = graph.ImportResource(ResourceState::COMMON, ResourceState::COMMON);
+	const auto used = graph.CreateResource(ResourceState::COMMON);
+	const auto unused = graph.CreateResource(ResourceState::COMMON);
+	const auto readByUnusedPass = graph.CreateResource(ResourceState::COMMON);
+
+	const auto usedPass = graph.AddPass();
+	graph.Write(usedPass, used, ResourceState::RENDER_TARGET);
+
+	// Both passes of the chain are culled, the second one has no reader
+	const auto chainBeginPass = graph.AddPass();
+	graph.Write(chainBeginPass, readByUnusedPass, ResourceState::RENDER_TARGET);
+	const auto chainEndPass = graph.AddPass();
+	graph.Read(chainEndPass, readByUnusedPass, ResourceState::PIXEL_SHADER_RESOURCE);
+	graph.Write(chainEndPass, unused, ResourceState::RENDER_TARGET);
+
+	const auto outputPass = graph.AddPass();
+	graph.Read(outputPass, used, ResourceState::PIXEL_SHADER_RESOURCE);
+	graph.Write(outputPass, output, ResourceState::RENDER_TARGET);
+
+	const auto sideEffectPass = graph.AddPass(true);
+
+	const CompiledRenderGraph &compiled = graph.Compile();
+
+	CHECK((compiled.passes == std::vector<std::uint32_t>{ usedPass, outputPass, sideEffectPass }));
+	CHECK(compiled.passBarriers.size() == 3);
+	CHECK(compiled.resourceLifetimes[unused].firstPass == UINT32_MAX);
+	CHECK(compiled.resourceLifetimes[readByUnusedPass].firstPass == UINT32_MAX);
+	CHECK(compiled.resourceLifetimes[used].firstPass == 0);
+	CHECK(compiled.resourceLifetimes[used].lastPass == 1);
+}
+
+
+TEST(ReadsInDifferentStatesAreCombined) {
+	RenderGraph graph;
+
+	const auto output = graph.ImportResource(ResourceState::COMMON, ResourceState::COMMON);
+	const auto texture = graph.CreateResource(ResourceState::RENDER_TARGET);
+
+	const auto writePass = graph.AddPass();
+	graph.Write(writePass, texture, ResourceState::RENDER_TARGET);
+
+	const auto pixelReadPass = graph.AddPass();
+	graph.Read(pixelReadPass, texture, ResourceState::PIXEL_SHADER_RESOURCE);
+	graph.Write(pixelReadPass, output, ResourceState::UNORDERED_ACCESS);
+
+	const auto computeReadPass = graph.AddPass();
+	graph.Read(computeReadPass, texture, ResourceState::NON_PIXEL_SHADER_RESOURCE);
+	graph.Write(computeReadPass, output, ResourceState::UNORDERED_ACCESS);
+
+	const CompiledRenderGraph &compiled = graph.Compile();
+	CHECK(compiled.passes.size() == 3);
+
+	const ResourceState readStates = ResourceState::PIXEL_SHADER_RESOURCE | ResourceState::NON_PIXEL_SHADER_RESOURCE;
+
+	// One transition into both read states before the first read
+	const std::vector<Barrier> firstReadBarriers = BarriersOf(compiled, compiled.passBarriers[1]);
+	CHECK(firstReadBarriers.size() == 2);
+	CHECK(IsTransition(firstReadBarriers[0], texture, ResourceState::RENDER_TARGET, readStates));
+	CHECK(IsTransition(firstReadBarriers[1], output, ResourceState::COMMON, ResourceState::UNORDERED_ACCESS));
+
+	// Nothing to do for the texture before the second read
+	const std::vector<Barrier> secondReadBarriers = BarriersOf(compiled, compiled.passBarriers[2]);
+	CHECK(secondReadBarriers.size() == 1);
+	CHECK(secondReadBarriers[0].resource == output);
+	CHECK(secondReadBarriers[0].type == BarrierType::UAV);
+}
+
+
+TEST(ConsecutiveUavWritesAreSeparatedByUavBarriers) {
+	RenderGraph graph;
+
+	const auto output = graph.ImportResource(ResourceState::COMMON, ResourceState::COMMON);
+	const auto buffer = graph.CreateResource(ResourceState::UNORDERED_ACCESS);
+
+	const auto firstWritePass = graph.AddPass();
+	graph.Write(firstWritePass, buffer, ResourceState::UNORDERED_ACCESS);
+
+	const auto secondWritePass = graph.AddPass();
+	graph.Read(secondWritePass, buffer, ResourceState::UNORDERED_ACCESS);
+	graph.Write(secondWritePass, buffer, ResourceState::UNORDERED_ACCESS);
+
+	const auto readPass = graph.AddPass();
+	graph.Read(readPass, buffer, ResourceState::NON_PIXEL_SHADER_RESOURCE);
+	graph.Write(readPass, output, ResourceState::COPY_DEST);
+
+	const CompiledRenderGraph &compiled = graph.Compile();
+	CHECK(compiled.passes.size() == 3);
+
+	CHECK(BarriersOf(compiled, compiled.passBarriers[0]).empty());
+
+	const std::vector<Barrier> secondWriteBarriers = BarriersOf(compiled, compiled.passBarriers[1]);
+	CHECK(secondWriteBarriers.size() == 1);
+	CHECK(secondWriteBarriers[0].type == BarrierType::UAV);
+	CHECK(secondWriteBarriers[0].resource == buffer);
+
+	const std::vector<Barrier> readBarriers = BarriersOf(compiled, compiled.passBarriers[2]);
+	CHECK(readBarriers.size() == 2);
+	CHECK(IsTransition(
+		readBarriers[0], buffer, ResourceState::UNORDERED_ACCESS, ResourceState::NON_PIXEL_SHADER_RESOURCE
+	));
+}
+
+
+TEST(FinalBarriersRestoreTheFinalStates) {
+	RenderGraph graph;
+	BuildFrame(graph, ResourceState::PRESENT);
+
+	const CompiledRenderGraph &compiled = graph.Compile();
+	CHECK(compiled.passes.size() == 3);
+
+	// Back buffer to its final state, created resources to their initial ones
+	const std::vector<Barrier> finalBarriers = BarriersOf(compiled, compiled.finalBarriers);
+	CHECK(finalBarriers.size() == 3);
+	CHECK(IsTransition(finalBarriers[0], 0, ResourceState::RENDER_TARGET, ResourceState::PRESENT));
+	CHECK(IsTransition(finalBarriers[1], 1, ResourceState::PIXEL_SHADER_RESOURCE, ResourceState::DEPTH_WRITE));
+	CHECK(IsTransition(finalBarriers[2], 2, ResourceState::PIXEL_SHADER_RESOURCE, ResourceState::RENDER_TARGET));
+}
+
+
+TEST(IdenticalRebuildIsReused) {
+	RenderGraph graph;
+
+	BuildFrame(graph, ResourceState::PRESENT);
+	const std::vector<Barrier> firstBarriers = graph.Compile().barriers;
+	CHECK(!graph.WasReused());
+
+	BuildFrame(graph, ResourceState::PRESENT);
+	const CompiledRenderGraph &reused = graph.Compile();
+	CHECK(graph.WasReused());
+	CHECK(reused.barriers.size() == firstBarriers.size());
+
+	// A different final state changes the shape
+	BuildFrame(graph, ResourceState::COPY_SOURCE);
+	graph.Compile();
+	CHECK(!graph.WasReused());
+
+	CHECK(graph.GetStatistics().compilationsCount == 2);
+	CHECK(graph.GetStatistics().reusedCompilationsCount == 1);
+}
+
+
+int main() {
+	return RunTests();
+}
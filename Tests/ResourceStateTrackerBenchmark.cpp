@@ -0,0 +1,81 @@
+#include "BenchmarkCommon.h"
+
+#include "ResourceStateTracker.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+
+// Textures with mip chains and array slices, e.g. 64 textures of 12 mips
+// and 4 slices are 3072 subresources
+struct TrackedTextures {
+	std::vector<int> textures;
+	std::uint32_t subresourcesCount;
+};
+
+
+// Records the transitions of a frame that renders into every subresource,
+// reads it in the next pass and copies it out, batched per pass
+static void RecordFrame(ResourceStateRegistry &registry, TrackedTextures &tracked, std::vector<TrackedBarrier> &barriers) {
+	ResourceStateTracker tracker(&registry);
+	barriers.clear();
+
+	for (int &texture : tracked.textures) {
+		void *resource = &texture;
+		for (std::uint32_t i = 0; i < tracked.subresourcesCount; i++) {
+			tracker.Transition(resource, i, ResourceState::RENDER_TARGET);
+		}
+	}
+	tracker.Flush(barriers);
+
+	for (int &texture : tracked.textures) {
+		void *resource = &texture;
+		tracker.Transition(resource, ALL_SUBRESOURCES, ResourceState::PIXEL_SHADER_RESOURCE);
+		tracker.BeginTransition(resource, ALL_SUBRESOURCES, ResourceState::COPY_SOURCE);
+	}
+	tracker.Flush(barriers);
+
+	for (int &texture : tracked.textures) {
+		void *resource = &texture;
+		tracker.Transition(resource, ALL_SUBRESOURCES, ResourceState::COPY_SOURCE);
+		tracker.Transition(resource, ALL_SUBRESOURCES, ResourceState::RENDER_TARGET);
+	}
+	tracker.Finish(barriers);
+
+	std::vector<TrackedBarrier> resolvingBarriers;
+	registry.Resolve(tracker, resolvingBarriers);
+	registry.DecayStates();
+}
+
+
+int main() {
+	for (std::uint32_t texturesCount : { 16, 64, 256 }) {
+		TrackedTextures tracked;
+		tracked.textures.resize(texturesCount);
+		tracked.subresourcesCount = 12 * 4;
+
+		ResourceStateRegistry registry;
+		for (int &texture : tracked.textures) {
+			registry.Register(&texture, tracked.subresourcesCount, ResourceState::RENDER_TARGET);
+		}
+
+		std::vector<TrackedBarrier> barriers;
+		const double seconds = MeasureSeconds([&registry, &tracked, &barriers] {
+			RecordFrame(registry, tracked, barriers);
+		});
+
+		const std::uint32_t subresourcesCount = texturesCount * tracked.subresourcesCount;
+		// Four transitions per subresource, split and merged ones included
+		const double transitionsCount = 4.0 * subresourcesCount;
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "Frame of %u subresources, %zu barriers out", subresourcesCount, barriers.size());
+		PrintMeasurement(name, seconds * 1e6, "us");
+
+		std::snprintf(name, sizeof(name), "Per transition of %u subresources", subresourcesCount);
+		PrintMeasurement(name, seconds / transitionsCount * 1e9, "ns");
+	}
+
+	return 0;
+}
@@ -0,0 +1,481 @@
+#include "TestCommon.h"
+
+#include "ResourceStateTracker.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+namespace {
+	bool IsTransition(
+		const TrackedBarrier &barrier,
+		void *resource,
+		std::uint32_t subresource,
+		ResourceState before,
+		ResourceState after,
+		TrackedBarrier::Split split = TrackedBarrier::Split::NONE
+	) {
+		return barrier.type == TrackedBarrier::Type::TRANSITION
+			&& barrier.split == split
+			&& barrier.resource == resource
+			&& barrier.subresource == subresource
+			&& barrier.before == before
+			&& barrier.after == after;
+	}
+}
+
+
+TEST(MergesTransitionsWithinABatch) {
+	int texture;
+	ResourceStateRegistry registry;
+	registry.Register(&texture, 1, ResourceState::RENDER_TARGET);
+
+	ResourceStateTracker tracker(&registry);
+	std::vector<TrackedBarrier> barriers;
+
+	// The first use is a requirement, resolved at submission
+	tracker.Transition(&texture, 0, ResourceState::RENDER_TARGET);
+	tracker.Transition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Transition(&texture, 0, ResourceState::COPY_SOURCE);
+	tracker.Flush(barriers);
+
+	CHECK(barriers.size() == 1);
+	CHECK(IsTransition(barriers[0], &texture, 0, ResourceState::RENDER_TARGET, ResourceState::COPY_SOURCE));
+
+	// Back to the state before the batch, nothing to do
+	barriers.clear();
+	tracker.Transition(&texture, 0, ResourceState::RENDER_TARGET);
+	tracker.Transition(&texture, 0, ResourceState::COPY_SOURCE);
+	tracker.Flush(barriers);
+	CHECK(barriers.empty());
+
+	// A combined read state contains its parts
+	tracker.Transition(&texture, 0, ResourceState::COPY_SOURCE | ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Flush(barriers);
+	barriers.clear();
+	tracker.Transition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Flush(barriers);
+	CHECK(barriers.empty());
+}
+
+
+TEST(MergesSubresourcesIntoOneBarrier) {
+	int texture;
+	ResourceStateRegistry registry;
+	registry.Register(&texture, 4, ResourceState::COMMON);
+
+	ResourceStateTracker tracker(&registry);
+	std::vector<TrackedBarrier> barriers;
+
+	tracker.Transition(&texture, ALL_SUBRESOURCES, ResourceState::COPY_DEST);
+	tracker.Transition(&texture, ALL_SUBRESOURCES, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Flush(barriers);
+
+	CHECK(barriers.size() == 1);
+	CHECK(IsTransition(
+		barriers[0],
+		&texture,
+		ALL_SUBRESOURCES,
+		ResourceState::COPY_DEST,
+		ResourceState::PIXEL_SHADER_RESOURCE
+	));
+
+	// One subresource differs, so every one keeps its own barrier
+	barriers.clear();
+	tracker.Transition(&texture, 2, ResourceState::COPY_SOURCE);
+	tracker.Transition(&texture, ALL_SUBRESOURCES, ResourceState::RENDER_TARGET);
+	tracker.Flush(barriers);
+
+	CHECK(barriers.size() == 4);
+	CHECK(IsTransition(barriers[0], &texture, 2, ResourceState::PIXEL_SHADER_RESOURCE, ResourceState::RENDER_TARGET));
+}
+
+
+TEST(SplitsBarriersAcrossBatches) {
+	int texture;
+	ResourceStateRegistry registry;
+	registry.Register(&texture, 1, ResourceState::RENDER_TARGET);
+
+	ResourceStateTracker tracker(&registry);
+	std::vector<TrackedBarrier> barriers;
+
+	tracker.Transition(&texture, 0, ResourceState::RENDER_TARGET);
+	tracker.BeginTransition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Flush(barriers);
+
+	CHECK(barriers.size() == 1);
+	CHECK(IsTransition(
+		barriers[0],
+		&texture,
+		0,
+		ResourceState::RENDER_TARGET,
+		ResourceState::PIXEL_SHADER_RESOURCE,
+		TrackedBarrier::Split::BEGIN_ONLY
+	));
+
+	barriers.clear();
+	tracker.Transition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Flush(barriers);
+
+	CHECK(barriers.size() == 1);
+	CHECK(IsTransition(
+		barriers[0],
+		&texture,
+		0,
+		ResourceState::RENDER_TARGET,
+		ResourceState::PIXEL_SHADER_RESOURCE,
+		TrackedBarrier::Split::END_ONLY
+	));
+}
+
+
+TEST(SplitWithinABatchIsAWholeBarrier) {
+	int texture;
+	ResourceStateRegistry registry;
+	registry.Register(&texture, 1, ResourceState::RENDER_TARGET);
+
+	ResourceStateTracker tracker(&registry);
+	std::vector<TrackedBarrier> barriers;
+
+	tracker.Transition(&texture, 0, ResourceState::RENDER_TARGET);
+	tracker.BeginTransition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Transition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Flush(barriers);
+
+	CHECK(barriers.size() == 1);
+	CHECK(IsTransition(barriers[0], &texture, 0, ResourceState::RENDER_TARGET, ResourceState::PIXEL_SHADER_RESOURCE));
+
+	// Splits still in progress end when the list is finished
+	barriers.clear();
+	tracker.BeginTransition(&texture, 0, ResourceState::COPY_SOURCE);
+	tracker.Flush(barriers);
+	tracker.Finish(barriers);
+
+	CHECK(barriers.size() == 2);
+	CHECK(barriers[0].split == TrackedBarrier::Split::BEGIN_ONLY);
+	CHECK(IsTransition(
+		barriers[1],
+		&texture,
+		0,
+		ResourceState::PIXEL_SHADER_RESOURCE,
+		ResourceState::COPY_SOURCE,
+		TrackedBarrier::Split::END_ONLY
+	));
+}
+
+
+// A transition after a split that ended within the batch merges into the
+// split, not into the barrier that was pending before it
+TEST(TransitionAfterSplitEnd) {
+	int texture;
+	ResourceStateRegistry registry;
+	registry.Register(&texture, 1, ResourceState::RENDER_TARGET);
+
+	ResourceStateTracker tracker(&registry);
+	std::vector<TrackedBarrier> barriers;
+
+	tracker.Transition(&texture, 0, ResourceState::RENDER_TARGET);
+	tracker.Transition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.BeginTransition(&texture, 0, ResourceState::COPY_SOURCE);
+	tracker.Transition(&texture, 0, ResourceState::COPY_SOURCE);
+	tracker.Transition(&texture, 0, ResourceState::COPY_DEST);
+	tracker.Flush(barriers);
+
+	CHECK(barriers.size() == 2);
+	CHECK(IsTransition(barriers[0], &texture, 0, ResourceState::RENDER_TARGET, ResourceState::PIXEL_SHADER_RESOURCE));
+	CHECK(IsTransition(barriers[1], &texture, 0, ResourceState::PIXEL_SHADER_RESOURCE, ResourceState::COPY_DEST));
+
+	// The same with a split ended by a transition to another state
+	barriers.clear();
+	tracker.Transition(&texture, 0, ResourceState::RENDER_TARGET);
+	tracker.BeginTransition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Transition(&texture, 0, ResourceState::COPY_SOURCE);
+	tracker.Flush(barriers);
+
+	CHECK(barriers.size() == 2);
+	CHECK(IsTransition(barriers[0], &texture, 0, ResourceState::COPY_DEST, ResourceState::RENDER_TARGET));
+	CHECK(IsTransition(barriers[1], &texture, 0, ResourceState::RENDER_TARGET, ResourceState::COPY_SOURCE));
+}
+
+
+TEST(ResolvesStatesBetweenLists) {
+	int texture;
+	ResourceStateRegistry registry;
+	registry.Register(&texture, 1, ResourceState::RENDER_TARGET);
+
+	std::vector<TrackedBarrier> barriers;
+	std::vector<TrackedBarrier> resolvingBarriers;
+
+	ResourceStateTracker firstTracker(&registry);
+	firstTracker.Transition(&texture, 0, ResourceState::RENDER_TARGET);
+	firstTracker.Transition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	firstTracker.Finish(barriers);
+
+	ResourceStateTracker secondTracker(&registry);
+	secondTracker.Transition(&texture, 0, ResourceState::COPY_SOURCE);
+	secondTracker.Finish(barriers);
+
+	registry.Resolve(firstTracker, resolvingBarriers);
+	CHECK(resolvingBarriers.empty());
+
+	// Exact states, a combined read state would need a barrier too
+	registry.Resolve(secondTracker, resolvingBarriers);
+	CHECK(resolvingBarriers.size() == 1);
+	CHECK(IsTransition(
+		resolvingBarriers[0],
+		&texture,
+		0,
+		ResourceState::PIXEL_SHADER_RESOURCE,
+		ResourceState::COPY_SOURCE
+	));
+
+	int unregistered;
+	ResourceStateTracker thirdTracker(&registry);
+	CHECK_THROWS(thirdTracker.Transition(&unregistered, 0, ResourceState::COMMON), std::logic_error);
+}
+
+
+TEST(TexturesArePromotedToReadAndCopyStates) {
+	int texture;
+	ResourceStateRegistry registry;
+	registry.Register(&texture, 2, ResourceState::COMMON);
+
+	std::vector<TrackedBarrier> barriers;
+	std::vector<TrackedBarrier> resolvingBarriers;
+
+	ResourceStateTracker tracker(&registry);
+	tracker.Transition(&texture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Transition(&texture, 1, ResourceState::RENDER_TARGET);
+	tracker.Finish(barriers);
+	registry.Resolve(tracker, resolvingBarriers);
+
+	CHECK(resolvingBarriers.size() == 1);
+	CHECK(IsTransition(resolvingBarriers[0], &texture, 1, ResourceState::COMMON, ResourceState::RENDER_TARGET));
+
+	// Until the submission ends, later lists see the promoted state
+	resolvingBarriers.clear();
+	tracker.Reset();
+	tracker.Transition(&texture, 0, ResourceState::COPY_SOURCE);
+	tracker.Finish(barriers);
+	registry.Resolve(tracker, resolvingBarriers);
+
+	CHECK(resolvingBarriers.size() == 1);
+	CHECK(IsTransition(
+		resolvingBarriers[0],
+		&texture,
+		0,
+		ResourceState::PIXEL_SHADER_RESOURCE,
+		ResourceState::COPY_SOURCE
+	));
+}
+
+
+TEST(TexturesDecayOnlyFromPromotedReadStates) {
+	int readTexture;
+	int writtenTexture;
+	int transitionedTexture;
+	ResourceStateRegistry registry;
+	registry.Register(&readTexture, 1, ResourceState::COMMON);
+	registry.Register(&writtenTexture, 1, ResourceState::COMMON);
+	registry.Register(&transitionedTexture, 1, ResourceState::COMMON);
+
+	std::vector<TrackedBarrier> barriers;
+	std::vector<TrackedBarrier> resolvingBarriers;
+
+	ResourceStateTracker tracker(&registry);
+	tracker.Transition(&readTexture, 0, ResourceState::PIXEL_SHADER_RESOURCE);
+	tracker.Transition(&writtenTexture, 0, ResourceState::COPY_DEST);
+	tracker.Transition(&transitionedTexture, 0, ResourceState::COPY_SOURCE);
+	tracker.Flush(barriers);
+	tracker.Transition(&transitionedTexture, 0, ResourceState::RENDER_TARGET);
+	tracker.Transition(&transitionedTexture, 0, ResourceState::NON_PIXEL_SHADER_RESOURCE);
+	tracker.Finish(barriers);
+
+	registry.Resolve(tracker, resolvingBarriers);
+	registry.DecayStates();
+	CHECK(resolvingBarriers.empty());
+
+	tracker.Reset();
+	tracker.Transition(&readTexture, 0, ResourceState::COMMON);
+	tracker.Transition(&writtenTexture, 0, ResourceState::COMMON);
+	tracker.Transition(&transitionedTexture, 0, ResourceState::COMMON);
+	tracker.Finish(barriers);
+	registry.Resolve(tracker, resolvingBarriers);
+
+	CHECK(resolvingBarriers.size() == 2);
+	CHECK(IsTransition(resolvingBarriers[0], &writtenTexture, 0, ResourceState::COPY_DEST, ResourceState::COMMON));
+	CHECK(IsTransition(
+		resolvingBarriers[1],
+		&transitionedTexture,
+		0,
+		ResourceState::NON_PIXEL_SHADER_RESOURCE,
+		ResourceState::COMMON
+	));
+}
+
+
+TEST(BuffersArePromotedToAnyStateAndDecay) {
+	int buffer;
+	ResourceStateRegistry registry;
+	registry.Register(&buffer, 1, ResourceState::COMMON, StatePromotion::ANY_STATE);
+
+	std::vector<TrackedBarrier> barriers;
+	std::vector<TrackedBarrier> resolvingBarriers;
+
+	ResourceStateTracker tracker(&registry);
+	tracker.Transition(&buffer, 0, ResourceState::UNORDERED_ACCESS);
+	tracker.Transition(&buffer, 0, ResourceState::INDIRECT_ARGUMENT);
+	tracker.Finish(barriers);
+	registry.Resolve(tracker, resolvingBarriers);
+	registry.DecayStates();
+
+	CHECK(resolvingBarriers.empty());
+	CHECK(barriers.size() == 1);
+
+	// Decayed even though the list transitioned it
+	tracker.Reset();
+	tracker.Transition(&buffer, 0, ResourceState::COPY_DEST);
+	tracker.Finish(barriers);
+	registry.Resolve(tracker, resolvingBarriers);
+
+	CHECK(resolvingBarriers.empty());
+
+	// Not promoted from a state other than COMMON
+	registry.Register(&buffer, 1, ResourceState::COPY_SOURCE, StatePromotion::ANY_STATE);
+	tracker.Reset();
+	tracker.Transition(&buffer, 0, ResourceState::COPY_DEST);
+	tracker.Finish(barriers);
+	registry.Resolve(tracker, resolvingBarriers);
+
+	CHECK(resolvingBarriers.size() == 1);
+}
+
+
+// Random transitions of a few subresources. The barriers of every subresource
+// must form a chain from the state required at the first use to the last state
+TEST(RandomTransitionsFormChains) {
+	const ResourceState states[] = {
+		ResourceState::RENDER_TARGET,
+		ResourceState::UNORDERED_ACCESS,
+		ResourceState::PIXEL_SHADER_RESOURCE,
+		ResourceState::NON_PIXEL_SHADER_RESOURCE | ResourceState::PIXEL_SHADER_RESOURCE,
+		ResourceState::COPY_SOURCE,
+		ResourceState::COPY_DEST
+	};
+	const std::uint32_t SUBRESOURCES_COUNT = 3;
+
+	int texture;
+	ResourceStateRegistry registry;
+	registry.Register(&texture, SUBRESOURCES_COUNT, ResourceState::COMMON);
+	std::mt19937 random(13);
+
+	for (int list = 0; list < 200; list++) {
+		ResourceStateTracker tracker(&registry);
+		std::vector<TrackedBarrier> barriers;
+
+		// What the tracker should do, the states are known after the first use
+		struct ExpectedSubresource {
+			bool isUsed = false;
+			ResourceState state;
+			bool isSplit = false;
+			ResourceState splitState;
+		};
+		ExpectedSubresource expected[SUBRESOURCES_COUNT];
+
+		for (int operation = 0; operation < 40; operation++) {
+			const std::uint32_t subresource = random() % (SUBRESOURCES_COUNT + 1);
+			const ResourceState state = states[random() % 6];
+			const int type = random() % 4;
+
+			if (type == 1) {
+				tracker.Flush(barriers);
+				continue;
+			}
+
+			if (type == 0) {
+				tracker.BeginTransition(&texture, subresource == SUBRESOURCES_COUNT ? ALL_SUBRESOURCES : subresource, state);
+			} else {
+				tracker.Transition(&texture, subresource == SUBRESOURCES_COUNT ? ALL_SUBRESOURCES : subresource, state);
+			}
+
+			for (std::uint32_t i = 0; i < SUBRESOURCES_COUNT; i++) {
+				if (subresource != SUBRESOURCES_COUNT && subresource != i) {
+					continue;
+				}
+
+				ExpectedSubresource &current = expected[i];
+				if (type == 0) {
+					if (current.isUsed && !current.isSplit && current.state != state) {
+						current.isSplit = true;
+						current.splitState = state;
+					}
+					continue;
+				}
+
+				if (current.isSplit) {
+					current.isSplit = false;
+					current.state = current.splitState;
+				}
+
+				// Reads in a containing state need no barrier, the state stays
+				if (!current.isUsed || !ContainsState(current.state, state)) {
+					current.state = state;
+				}
+				current.isUsed = true;
+			}
+		}
+		tracker.Finish(barriers);
+
+		for (ExpectedSubresource &current : expected) {
+			if (current.isSplit) {
+				current.state = current.splitState;
+			}
+		}
+
+		std::vector<TrackedBarrier> resolvingBarriers;
+		registry.Resolve(tracker, resolvingBarriers);
+
+		// States from the first use on, the barriers must continue them
+		std::map<std::uint32_t, ResourceState> chainStates;
+		std::map<std::uint32_t, ResourceState> splitStates;
+		for (const TrackedBarrier &barrier : barriers) {
+			for (std::uint32_t i = 0; i < SUBRESOURCES_COUNT; i++) {
+				if (barrier.subresource != ALL_SUBRESOURCES && barrier.subresource != i) {
+					continue;
+				}
+				CHECK(barrier.before != barrier.after);
+
+				if (barrier.split == TrackedBarrier::Split::BEGIN_ONLY) {
+					CHECK(chainStates.count(i) == 0 || chainStates[i] == barrier.before);
+					CHECK(splitStates.count(i) == 0);
+					splitStates[i] = barrier.after;
+					chainStates[i] = barrier.before;
+				} else if (barrier.split == TrackedBarrier::Split::END_ONLY) {
+					CHECK(splitStates.count(i) == 1 && splitStates[i] == barrier.after);
+					CHECK(chainStates[i] == barrier.before);
+					splitStates.erase(i);
+					chainStates[i] = barrier.after;
+				} else {
+					CHECK(splitStates.count(i) == 0);
+					CHECK(chainStates.count(i) == 0 || chainStates[i] == barrier.before);
+					chainStates[i] = barrier.after;
+				}
+			}
+		}
+
+		CHECK(splitStates.empty());
+		for (std::uint32_t i = 0; i < SUBRESOURCES_COUNT; i++) {
+			if (expected[i].isUsed && chainStates.count(i) == 1) {
+				CHECK(chainStates[i] == expected[i].state);
+			}
+		}
+	}
+}
+
+
+int main() {
+	return RunTests();
+}
@@ -0,0 +1,114 @@
+#include "TestCommon.h"
+
+#include "RetirementQueue.h"
+
+#include <cstdint>
+#include <memory>
+
+
+namespace {
+	// Completes labels when the test says so, like a GPU that is paused
+	class FakeFence {
+	public:
+		struct Label {
+			std::uint64_t value;
+		};
+
+	public:
+		Label PutLabel() {
+			return Label{ ++mPutValue };
+		}
+
+		bool IsComplete(const Label &label) const {
+			return mCompletedValue >= label.value;
+		}
+
+		void Complete(const Label &label) {
+			mCompletedValue = label.value;
+		}
+
+	private:
+		std::uint64_t mPutValue = 0;
+		std::uint64_t mCompletedValue = 0;
+	};
+}
+
+
+TEST(ItemsRetireInOrder) {
+	FakeFence fence;
+	RetirementQueue<FakeFence, int> queue(fence);
+
+	int item = -1;
+	CHECK(!queue.TryAcquire(item));
+
+	FakeFence::Label labels[3];
+	for (int i = 0; i < 3; i++) {
+		labels[i] = fence.PutLabel();
+		queue.Release(i, labels[i]);
+	}
+	CHECK(queue.RetiringCount() == 3);
+
+	fence.Complete(labels[2]);
+	for (int i = 0; i < 3; i++) {
+		CHECK(queue.TryAcquire(item));
+		CHECK(item == i);
+	}
+
+	CHECK(!queue.TryAcquire(item));
+	CHECK(queue.RetiringCount() == 0);
+}
+
+
+TEST(ItemsBehindAnIncompleteLabelStayQueued) {
+	FakeFence fence;
+	RetirementQueue<FakeFence, int> queue(fence);
+
+	const FakeFence::Label first = fence.PutLabel();
+	const FakeFence::Label second = fence.PutLabel();
+	queue.Release(1, first);
+	queue.Release(2, second);
+
+	int item = -1;
+	CHECK(!queue.TryAcquire(item));
+	CHECK(item == -1);
+
+	fence.Complete(first);
+	CHECK(queue.TryAcquire(item));
+	CHECK(item == 1);
+
+	// The GPU still uses the second one
+	CHECK(!queue.TryAcquire(item));
+	CHECK(queue.RetiringCount() == 1);
+
+	fence.Complete(second);
+	CHECK(queue.TryAcquire(item));
+	CHECK(item == 2);
+}
+
+
+// Like a pool of command allocators, one is reused once its frame completes
+TEST(ItemsAreReusedAfterCompletion) {
+	FakeFence fence;
+	RetirementQueue<FakeFence, std::unique_ptr<int>> queue(fence);
+
+	std::unique_ptr<int> item(new int(7));
+	const int *address = item.get();
+
+	for (int frame = 0; frame < 5; frame++) {
+		const FakeFence::Label label = fence.PutLabel();
+		queue.Release(std::move(item), label);
+
+		CHECK(!queue.TryAcquire(item));
+		CHECK(item == nullptr);
+
+		fence.Complete(label);
+		CHECK(queue.TryAcquire(item));
+		CHECK(item.get() == address);
+		CHECK(*item == 7);
+	}
+}
+
+
+int main() {
+	return RunTests();
+}
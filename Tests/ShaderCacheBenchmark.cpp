@@ -0,0 +1,123 @@
+#include "BenchmarkCommon.h"
+
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	// Written into the working directory of the benchmark
+	const std::string PACK_PATH = "ShaderCacheBenchmark.pack";
+	const std::string INDEX_PATH = "ShaderCacheBenchmark.index";
+
+	// Like the permutations of a small renderer, a few KiB of bytecode each
+	const int SHADERS_COUNT = 4096;
+	const std::size_t BYTECODE_SIZE = 4096;
+
+
+	ShaderKey MakeKey(int index) {
+		ShaderKey key;
+		key.sourceHash = index / 64;
+		key.includesHash = 12345;
+		key.defines = {
+			{ "USE_NORMAL_MAP", std::to_string(index & 1) },
+			{ "USE_SHADOWS", std::to_string((index >> 1) & 1) },
+			{ "LIGHTS_COUNT", std::to_string((index >> 2) & 15) }
+		};
+		key.entryPoint = "main";
+		key.profile = "ps_6_0";
+		return key;
+	}
+}
+
+
+int main() {
+	std::remove(PACK_PATH.c_str());
+	std::remove(INDEX_PATH.c_str());
+
+	const std::vector<std::uint8_t> bytecode(BYTECODE_SIZE, 0xAB);
+
+	{
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+
+		const auto begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < SHADERS_COUNT; i++) {
+			cache.Store(MakeKey(i), bytecode.data(), bytecode.size());
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		PrintMeasurement("Store, appended to the pack", seconds / SHADERS_COUNT * 1e6, "us");
+	}
+
+	const double openSeconds = MeasureSeconds([] {
+		ShaderPackFile pack(PACK_PATH, INDEX_PATH);
+		KeepValue(pack.EntriesCount());
+	});
+	char name[96];
+	std::snprintf(name, sizeof(name), "Open a pack of %d shaders", SHADERS_COUNT);
+	PrintMeasurement(name, openSeconds * 1e3, "ms");
+
+	ShaderCache cache(PACK_PATH, INDEX_PATH);
+
+	// Keys are serialized by Find, like a renderer that builds them per request
+	std::vector<ShaderKey> keys;
+	for (int i = 0; i < SHADERS_COUNT; i++) {
+		keys.push_back(MakeKey(i));
+	}
+
+	int index = 0;
+	const double findSeconds = MeasureSeconds([&cache, &keys, &index] {
+		ShaderCache::Bytecode found;
+		cache.Find(keys[index++ % SHADERS_COUNT], found);
+		KeepValue(found.size);
+	});
+	PrintMeasurement("Find, one thread", findSeconds * 1e9, "ns");
+
+	// Reading every byte of the mapped bytecode, like handing it to the driver
+	index = 0;
+	const double loadSeconds = MeasureSeconds([&cache, &keys, &index] {
+		ShaderCache::Bytecode found;
+		cache.Find(keys[index++ % SHADERS_COUNT], found);
+
+		std::uint64_t sum = 0;
+		for (std::size_t i = 0; i < found.size; i++) {
+			sum += found.data.get()[i];
+		}
+		KeepValue(sum);
+	});
+	PrintMeasurement("Find and read the bytecode", double(BYTECODE_SIZE) / loadSeconds / (1 << 30), "GiB/s");
+
+	const std::size_t threadsCount = std::max(2u, std::thread::hardware_concurrency());
+	const int FINDS_PER_THREAD = 200000;
+	std::vector<std::thread> threads;
+
+	const auto begin = std::chrono::steady_clock::now();
+	for (std::size_t thread = 0; thread < threadsCount; thread++) {
+		threads.emplace_back([&cache, &keys, thread, FINDS_PER_THREAD] {
+			for (int i = 0; i < FINDS_PER_THREAD; i++) {
+				ShaderCache::Bytecode found;
+				cache.Find(keys[(i * 7 + thread) % SHADERS_COUNT], found);
+				KeepValue(found.size);
+			}
+		});
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	const double concurrentSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	std::snprintf(name, sizeof(name), "Find, %zu concurrent threads", threadsCount);
+	PrintMeasurement(name, double(threadsCount) * FINDS_PER_THREAD / concurrentSeconds / 1e6, "M/s");
+
+	std::remove(PACK_PATH.c_str());
+	std::remove(INDEX_PATH.c_str());
+
+	return 0;
+}
@@ -0,0 +1,209 @@
+#include "TestCommon.h"
+
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace {
+	// Written into the working directory of the test
+	const std::string PACK_PATH = "ShaderCacheTests.pack";
+	const std::string INDEX_PATH = "ShaderCacheTests.index";
+
+
+	ShaderKey MakeKey(int index) {
+		ShaderKey key;
+		key.sourceHash = index;
+		key.includesHash = index * 3;
+		key.defines = { { "B", "1" }, { "A", std::to_string(index) } };
+		key.entryPoint = "main";
+		key.profile = "ps_5_1";
+		return key;
+	}
+
+
+	// Of different sizes, so the entries need padding
+	std::string MakeBytecode(int index) {
+		return std::string(index % 50 + 1, static_cast<char>('a' + index % 26));
+	}
+
+
+	std::string ToString(const ShaderCache::Bytecode &bytecode) {
+		return std::string(reinterpret_cast<const char*>(bytecode.data.get()), bytecode.size);
+	}
+
+
+	void RemoveFiles() {
+		std::remove(PACK_PATH.c_str());
+		std::remove(INDEX_PATH.c_str());
+	}
+
+
+	// Rewrites the file without its last bytes, like a crash in the middle of a write
+	void CutFile(const std::string &path, std::size_t size) {
+		std::string data;
+		{
+			std::ifstream file(path, std::ios::binary);
+			data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), data.size() - size);
+	}
+}
+
+
+TEST(StoredShadersAreFoundAfterReopening) {
+	RemoveFiles();
+
+	ShaderCache::Bytecode keptBytecode;
+	{
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+		for (int i = 0; i < 100; i++) {
+			const std::string bytecode = MakeBytecode(i);
+			cache.Store(MakeKey(i), bytecode.data(), bytecode.size());
+		}
+
+		CHECK(cache.Find(MakeKey(7), keptBytecode));
+		CHECK(ToString(keptBytecode) == MakeBytecode(7));
+	}
+
+	// Bytecode outlives the cache
+	CHECK(ToString(keptBytecode) == MakeBytecode(7));
+
+	ShaderCache cache(PACK_PATH, INDEX_PATH);
+	for (int i = 0; i < 100; i++) {
+		ShaderCache::Bytecode bytecode;
+		CHECK(cache.Find(MakeKey(i), bytecode));
+		CHECK(ToString(bytecode) == MakeBytecode(i));
+	}
+
+	// The order of the defines doesn't matter, the profile and the compiler do
+	ShaderKey key = MakeKey(3);
+	std::swap(key.defines[0], key.defines[1]);
+	CHECK(cache.Find(key, keptBytecode));
+
+	key.profile = "vs_5_1";
+	CHECK(!cache.Find(key, keptBytecode));
+
+	key = MakeKey(3);
+	key.compiler = "compiler 2";
+	CHECK(!cache.Find(key, keptBytecode));
+
+	const ShaderCache::Statistics statistics = cache.GetStatistics();
+	CHECK(statistics.hitsCount == 101);
+	CHECK(statistics.missesCount == 2);
+}
+
+
+TEST(ConcurrentReadersAndWriters) {
+	RemoveFiles();
+
+	{
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+		std::vector<std::thread> threads;
+		std::vector<int> mismatchesCounts(4, 0);
+
+		for (int thread = 0; thread < 4; thread++) {
+			threads.emplace_back([&cache, &mismatchesCounts, thread] {
+				for (int i = 0; i < 2000; i++) {
+					const int index = (i * 7 + thread) % 500;
+
+					ShaderCache::Bytecode bytecode;
+					if (cache.Find(MakeKey(index), bytecode)) {
+						mismatchesCounts[thread] += ToString(bytecode) != MakeBytecode(index);
+					} else {
+						const std::string newBytecode = MakeBytecode(index);
+						cache.Store(MakeKey(index), newBytecode.data(), newBytecode.size());
+					}
+				}
+			});
+		}
+
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		for (int mismatchesCount : mismatchesCounts) {
+			CHECK(mismatchesCount == 0);
+		}
+	}
+
+	ShaderPackFile pack(PACK_PATH, INDEX_PATH);
+	CHECK(pack.EntriesCount() == 500);
+}
+
+
+// A crash between the writes of the pack and of the index loses only the last shader
+TEST(RecoversFromACutIndex) {
+	RemoveFiles();
+
+	{
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+		for (int i = 0; i < 10; i++) {
+			const std::string bytecode = MakeBytecode(i);
+			cache.Store(MakeKey(i), bytecode.data(), bytecode.size());
+		}
+	}
+
+	CutFile(INDEX_PATH, 5);
+
+	{
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+		ShaderCache::Bytecode bytecode;
+		CHECK(cache.Find(MakeKey(8), bytecode));
+		CHECK(!cache.Find(MakeKey(9), bytecode));
+
+		const std::string newBytecode = "new";
+		cache.Store(MakeKey(9999), newBytecode.data(), newBytecode.size());
+	}
+
+	ShaderCache cache(PACK_PATH, INDEX_PATH);
+	ShaderCache::Bytecode bytecode;
+	CHECK(cache.Find(MakeKey(9999), bytecode));
+	CHECK(ToString(bytecode) == "new");
+	CHECK(cache.Find(MakeKey(0), bytecode));
+	CHECK(ToString(bytecode) == MakeBytecode(0));
+}
+
+
+TEST(InvalidPackIsEmptied) {
+	RemoveFiles();
+
+	{
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+		const std::string bytecode = MakeBytecode(1);
+		cache.Store(MakeKey(1), bytecode.data(), bytecode.size());
+	}
+
+	{
+		std::fstream file(PACK_PATH, std::ios::binary | std::ios::in | std::ios::out);
+		file.put('X');
+	}
+
+	{
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+		ShaderCache::Bytecode bytecode;
+		CHECK(!cache.Find(MakeKey(1), bytecode));
+
+		cache.Store(MakeKey(1), "z", 1);
+	}
+
+	ShaderCache cache(PACK_PATH, INDEX_PATH);
+	ShaderCache::Bytecode bytecode;
+	CHECK(cache.Find(MakeKey(1), bytecode));
+	CHECK(ToString(bytecode) == "z");
+
+	RemoveFiles();
+}
+
+
+int main() {
+	return RunTests();
+}
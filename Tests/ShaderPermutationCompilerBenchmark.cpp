@@ -0,0 +1,133 @@
+#include "BenchmarkCommon.h"
+
+#include "ShaderPermutationCompiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	// Written into the working directory of the benchmark
+	const std::string PACK_PATH = "ShaderPermutationCompilerBenchmark.pack";
+	const std::string INDEX_PATH = "ShaderPermutationCompilerBenchmark.index";
+
+
+	// Preprocessing keeps the defines the source uses, compilation hashes the
+	// preprocessed source over and over, a few milliseconds like a small shader
+	class SyntheticBackend {
+	public:
+		std::string Preprocess(const ShaderSource &source, const ShaderDefines &defines) {
+			std::string preprocessedSource;
+			for (const auto &define : defines) {
+				if (source.text.find(define.first) != std::string::npos) {
+					preprocessedSource += "#define " + define.first + " " + define.second + "\n";
+				}
+			}
+
+			return preprocessedSource + source.text;
+		}
+
+		std::vector<std::uint8_t> Compile(const ShaderSource &/*source*/, const std::string &preprocessedSource) {
+			std::uint64_t hash = 0;
+			for (int i = 0; i < 2000; i++) {
+				hash = HashBytes(preprocessedSource.data(), preprocessedSource.size(), hash);
+			}
+
+			std::vector<std::uint8_t> bytecode(4096);
+			for (std::size_t i = 0; i < bytecode.size(); i++) {
+				bytecode[i] = static_cast<std::uint8_t>(hash >> (i % 8 * 8));
+			}
+			return bytecode;
+		}
+
+		std::string CompilerIdentity() const {
+			return "synthetic";
+		}
+	};
+
+
+	ShaderSource MakeSource() {
+		std::string text = "float4 main() : SV_Target {\n"
+			"\tfloat4 color = BASE_COLOR;\n"
+			"#if USE_NORMAL_MAP\n\tcolor *= SampleNormal();\n#endif\n"
+			"#if LIGHTS_COUNT > 0\n\tcolor *= Light(LIGHTS_COUNT);\n#endif\n"
+			"\treturn color;\n}\n";
+		// Like the body of a real shader
+		text += std::string(16 * 1024, ' ');
+
+		return ShaderSource{ "Synthetic.hlsl", text, "main", "ps_6_0" };
+	}
+
+
+	// 4 * 2 * 8 * 4 * 2 = 512 permutations, the last two axes aren't used
+	// by the source, so there are 64 unique ones
+	std::vector<ShaderPermutationAxis> MakeAxes() {
+		return {
+			{ "BASE_COLOR", { "0", "1", "2", "3" } },
+			{ "USE_NORMAL_MAP", { "0", "1" } },
+			{ "LIGHTS_COUNT", { "0", "1", "2", "3", "4", "5", "6", "7" } },
+			{ "QUALITY", { "0", "1", "2", "3" } },
+			{ "DEBUG_VIEW", { "0", "1" } }
+		};
+	}
+
+
+	void PrintReport(
+		const char *run,
+		std::size_t threadsCount,
+		const ShaderPermutationCompiler<SyntheticBackend>::Report &report
+	) {
+		char name[96];
+		std::snprintf(
+			name, sizeof(name), "%s, %zu threads, %zu of %zu unique, %zu compiled",
+			run, threadsCount, report.uniqueCount, report.permutationsCount, report.compiledCount
+		);
+		PrintMeasurement(name, report.wallSeconds * 1e3, "ms");
+
+		PrintMeasurement("  Preprocessing", report.preprocessingSeconds * 1e3, "ms");
+		PrintMeasurement("  Compilation or cache lookups", report.compilationSeconds * 1e3, "ms");
+		PrintMeasurement("  Dedup ratio", report.DedupRatio() * 100.0, "%");
+	}
+}
+
+
+int main() {
+	const std::size_t hardwareThreadsCount = std::max(1u, std::thread::hardware_concurrency());
+
+	SyntheticBackend backend;
+	const ShaderSource source = MakeSource();
+	const std::vector<ShaderPermutationAxis> axes = MakeAxes();
+
+	for (std::size_t threadsCount : { std::size_t(1), hardwareThreadsCount }) {
+		std::remove(PACK_PATH.c_str());
+		std::remove(INDEX_PATH.c_str());
+
+		JobSystem jobSystem(threadsCount - 1);
+		ShaderPermutationCompiler<SyntheticBackend>::Report report;
+
+		{
+			ShaderCache cache(PACK_PATH, INDEX_PATH);
+			ShaderPermutationCompiler<SyntheticBackend> compiler(backend, jobSystem, &cache);
+			KeepValue(compiler.Compile(source, axes, report).size());
+			PrintReport("Cold cache", threadsCount, report);
+		}
+
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+		ShaderPermutationCompiler<SyntheticBackend> compiler(backend, jobSystem, &cache);
+		KeepValue(compiler.Compile(source, axes, report).size());
+		PrintReport("Warm cache", threadsCount, report);
+
+		if (hardwareThreadsCount == 1) {
+			break;
+		}
+	}
+
+	std::remove(PACK_PATH.c_str());
+	std::remove(INDEX_PATH.c_str());
+
+	return 0;
+}
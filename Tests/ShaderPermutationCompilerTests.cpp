@@ -0,0 +1,200 @@
+#include "TestCommon.h"
+
+#include "ShaderPermutationCompiler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace {
+	// Written into the working directory of the test
+	const std::string PACK_PATH = "ShaderPermutationCompilerTests.pack";
+	const std::string INDEX_PATH = "ShaderPermutationCompilerTests.index";
+
+
+	// Keeps the defines whose names appear in the source, like a preprocessor
+	// that drops the unused ones, and "compiles" to the preprocessed text.
+	// The value BAD_PREPROCESS fails preprocessing, BAD_COMPILE fails compilation
+	class StubBackend {
+	public:
+		std::atomic<int> compilationsCount{0};
+
+	public:
+		std::string Preprocess(const ShaderSource &source, const ShaderDefines &defines) {
+			std::string preprocessedSource;
+			for (const auto &define : defines) {
+				if (define.second == "BAD_PREPROCESS") {
+					throw std::runtime_error("Can't preprocess " + define.first);
+				}
+				if (source.text.find(define.first) != std::string::npos) {
+					preprocessedSource += "#define " + define.first + " " + define.second + "\n";
+				}
+			}
+
+			return preprocessedSource + source.text;
+		}
+
+		std::vector<std::uint8_t> Compile(const ShaderSource &/*source*/, const std::string &preprocessedSource) {
+			compilationsCount.fetch_add(1);
+
+			if (preprocessedSource.find("BAD_COMPILE") != std::string::npos) {
+				throw std::runtime_error("Can't compile");
+			}
+
+			return std::vector<std::uint8_t>(preprocessedSource.begin(), preprocessedSource.end());
+		}
+
+		std::string CompilerIdentity() const {
+			return "stub 1.0";
+		}
+	};
+
+
+	ShaderSource MakeSource() {
+		return ShaderSource{ "Stub.hlsl", "float4 main() { return USE_COLOR; }", "main", "ps_6_0" };
+	}
+
+
+	std::string ToString(const ShaderCache::Bytecode &bytecode) {
+		return std::string(reinterpret_cast<const char*>(bytecode.data.get()), bytecode.size);
+	}
+
+
+	void RemoveFiles() {
+		std::remove(PACK_PATH.c_str());
+		std::remove(INDEX_PATH.c_str());
+	}
+}
+
+
+TEST(PermutationsWithTheSamePreprocessedSourceAreCompiledOnce) {
+	JobSystem jobSystem(2);
+	StubBackend backend;
+	ShaderPermutationCompiler<StubBackend> compiler(backend, jobSystem);
+
+	const std::vector<ShaderPermutationAxis> axes = {
+		{ "USE_COLOR", { "0", "1" } },
+		{ "UNUSED", { "0", "1", "2" } }
+	};
+
+	ShaderPermutationCompiler<StubBackend>::Report report;
+	const auto permutations = compiler.Compile(MakeSource(), axes, report);
+
+	CHECK(permutations.size() == 6);
+	CHECK(report.permutationsCount == 6);
+	CHECK(report.preprocessedCount == 6);
+	CHECK(report.uniqueCount == 2);
+	CHECK(report.compiledCount == 2);
+	CHECK(report.failedCount == 0);
+	CHECK(report.DedupRatio() > 0.66 && report.DedupRatio() < 0.67);
+	CHECK(backend.compilationsCount.load() == 2);
+
+	for (const auto &permutation : permutations) {
+		CHECK(permutation.IsCompiled());
+		CHECK(permutation.errors.empty());
+
+		const std::string expected = "#define USE_COLOR " + permutation.defines[0].second + "\n" + MakeSource().text;
+		CHECK(ToString(permutation.bytecode) == expected);
+	}
+}
+
+
+TEST(FailedPreprocessingIsReported) {
+	JobSystem jobSystem(2);
+	StubBackend backend;
+	ShaderPermutationCompiler<StubBackend> compiler(backend, jobSystem);
+
+	const std::vector<ShaderPermutationAxis> axes = { { "USE_COLOR", { "1", "BAD_PREPROCESS" } } };
+
+	ShaderPermutationCompiler<StubBackend>::Report report;
+	const auto permutations = compiler.Compile(MakeSource(), axes, report);
+
+	CHECK(report.preprocessedCount == 1);
+	CHECK(report.compiledCount == 1);
+	CHECK(report.failedCount == 1);
+
+	CHECK(permutations[0].IsCompiled());
+	CHECK(!permutations[1].IsCompiled());
+	CHECK(permutations[1].errors == "Can't preprocess USE_COLOR");
+}
+
+
+TEST(FailedCompilationIsReportedForEveryPermutationOfTheSource) {
+	JobSystem jobSystem(2);
+	StubBackend backend;
+	ShaderPermutationCompiler<StubBackend> compiler(backend, jobSystem);
+
+	const std::vector<ShaderPermutationAxis> axes = {
+		{ "USE_COLOR", { "1", "BAD_COMPILE" } },
+		{ "UNUSED", { "0", "1" } }
+	};
+
+	ShaderPermutationCompiler<StubBackend>::Report report;
+	const auto permutations = compiler.Compile(MakeSource(), axes, report);
+
+	CHECK(report.uniqueCount == 2);
+	CHECK(report.compiledCount == 1);
+	CHECK(report.failedCount == 2);
+	CHECK(backend.compilationsCount.load() == 2);
+
+	for (const auto &permutation : permutations) {
+		const bool isBad = permutation.defines[0].second == "BAD_COMPILE";
+		CHECK(permutation.IsCompiled() == !isBad);
+		CHECK(permutation.errors == (isBad ? "Can't compile" : ""));
+	}
+}
+
+
+TEST(SecondRunHitsTheShaderCache) {
+	RemoveFiles();
+
+	const std::vector<ShaderPermutationAxis> axes = {
+		{ "USE_COLOR", { "0", "1", "2" } },
+		{ "UNUSED", { "0", "1" } }
+	};
+
+	JobSystem jobSystem(2);
+	StubBackend backend;
+
+	std::vector<std::string> firstBytecodes;
+	{
+		ShaderCache cache(PACK_PATH, INDEX_PATH);
+		ShaderPermutationCompiler<StubBackend> compiler(backend, jobSystem, &cache);
+
+		ShaderPermutationCompiler<StubBackend>::Report report;
+		for (const auto &permutation : compiler.Compile(MakeSource(), axes, report)) {
+			firstBytecodes.push_back(ToString(permutation.bytecode));
+		}
+
+		CHECK(report.cacheHitsCount == 0);
+		CHECK(report.compiledCount == 3);
+	}
+
+	ShaderCache cache(PACK_PATH, INDEX_PATH);
+	ShaderPermutationCompiler<StubBackend> compiler(backend, jobSystem, &cache);
+
+	ShaderPermutationCompiler<StubBackend>::Report report;
+	const auto permutations = compiler.Compile(MakeSource(), axes, report);
+
+	CHECK(report.uniqueCount == 3);
+	CHECK(report.cacheHitsCount == 3);
+	CHECK(report.compiledCount == 0);
+	CHECK(report.failedCount == 0);
+	CHECK(backend.compilationsCount.load() == 3);
+
+	CHECK(permutations.size() == firstBytecodes.size());
+	for (std::size_t i = 0; i < permutations.size(); i++) {
+		CHECK(ToString(permutations[i].bytecode) == firstBytecodes[i]);
+	}
+
+	RemoveFiles();
+}
+
+
+int main() {
+	return RunTests();
+}
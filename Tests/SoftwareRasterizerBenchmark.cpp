@@ -0,0 +1,108 @@
+#include "BenchmarkCommon.h"
+
+#include "SoftwareRasterizer.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	const std::uint32_t WIDTH = 1920;
+	const std::uint32_t HEIGHT = 1080;
+
+	const float CLEAR_COLOR[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+
+	// Random triangles with bounds of size by size pixels and random depths
+	std::vector<SoftwareVertex> MakeTriangles(std::size_t count, float size) {
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+
+		const float halfWidth = size / WIDTH;
+		const float halfHeight = size / HEIGHT;
+
+		std::vector<SoftwareVertex> vertices;
+		for (std::size_t i = 0; i < count; i++) {
+			const float x = position(random);
+			const float y = position(random);
+			const float z = depth(random);
+
+			vertices.push_back(SoftwareVertex{ { x, y + halfHeight, z, 1.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } });
+			vertices.push_back(SoftwareVertex{ { x + halfWidth, y - halfHeight, z, 1.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } });
+			vertices.push_back(SoftwareVertex{ { x - halfWidth, y - halfHeight, z, 1.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } });
+		}
+
+		return vertices;
+	}
+
+
+	void BenchmarkTriangles(SoftwareRasterizer &rasterizer, SoftwareRenderTarget &target, std::size_t count, float size) {
+		const std::vector<SoftwareVertex> vertices = MakeTriangles(count, size);
+
+		const double seconds = MeasureSeconds([&rasterizer, &target, &vertices] {
+			rasterizer.BeginFrame(target);
+			rasterizer.ClearColor(CLEAR_COLOR);
+			rasterizer.ClearDepth(1.0f);
+			rasterizer.DrawTriangles(vertices.data(), vertices.size());
+			rasterizer.EndFrame();
+		});
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%zu triangles in %.0fx%.0f pixels, triangles", count, size, size);
+		PrintMeasurement(name, double(count) / seconds / 1e6, "M/s");
+
+		std::snprintf(name, sizeof(name), "%zu triangles in %.0fx%.0f pixels, pixels", count, size, size);
+		PrintMeasurement(name, double(rasterizer.LastFrameStatistics().pixelsShadedCount) / seconds / 1e6, "M/s");
+	}
+
+
+	// Overdraw of full-screen quads, bound by the pixels alone
+	void BenchmarkFillRate(SoftwareRasterizer &rasterizer, SoftwareRenderTarget &target, bool isDepthTestEnabled) {
+		const SoftwareVertex quad[6] = {
+			{ { -1.0f, 1.0f, 0.5f, 1.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
+			{ { 1.0f, 1.0f, 0.5f, 1.0f }, { 0.0f, 1.0f, 0.0f, 1.0f } },
+			{ { 1.0f, -1.0f, 0.5f, 1.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
+			{ { -1.0f, 1.0f, 0.5f, 1.0f }, { 1.0f, 0.0f, 0.0f, 1.0f } },
+			{ { 1.0f, -1.0f, 0.5f, 1.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
+			{ { -1.0f, -1.0f, 0.5f, 1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } }
+		};
+
+		const double seconds = MeasureSeconds([&rasterizer, &target, &quad, isDepthTestEnabled] {
+			rasterizer.BeginFrame(target);
+			rasterizer.SetDepthTestEnabled(isDepthTestEnabled);
+			for (int i = 0; i < 10; i++) {
+				// Depth is cleared each time, so no pixel fails the test
+				rasterizer.ClearDepth(1.0f);
+				rasterizer.DrawTriangles(quad, 6);
+			}
+			rasterizer.EndFrame();
+		});
+
+		PrintMeasurement(
+			isDepthTestEnabled ? "Full-screen quads, depth test" : "Full-screen quads, no depth test",
+			double(rasterizer.LastFrameStatistics().pixelsShadedCount) / seconds / 1e6,
+			"Mpixels/s"
+		);
+	}
+}
+
+
+int main() {
+	const unsigned int threadsCount = std::thread::hardware_concurrency();
+	JobSystem jobSystem(threadsCount > 1 ? threadsCount - 1 : 0);
+	SoftwareRasterizer rasterizer(jobSystem);
+	SoftwareRenderTarget target(WIDTH, HEIGHT);
+
+	BenchmarkTriangles(rasterizer, target, 200000, 4.0f);
+	BenchmarkTriangles(rasterizer, target, 50000, 16.0f);
+	BenchmarkTriangles(rasterizer, target, 5000, 64.0f);
+
+	BenchmarkFillRate(rasterizer, target, false);
+	BenchmarkFillRate(rasterizer, target, true);
+
+	return 0;
+}
@@ -0,0 +1,248 @@
+#include "TestCommon.h"
+
+#include "SoftwareRasterizer.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+namespace {
+	// Odd sizes, so the tiles on the right and bottom are partial
+	const std::uint32_t WIDTH = 203;
+	const std::uint32_t HEIGHT = 151;
+
+	const std::uint32_t CLEAR_COLOR = 0xFF336600;
+	const float CLEAR_COLOR_VALUE[4] = { 0.0f, 0.4f, 0.2f, 1.0f };
+	const std::uint32_t RED = 0xFF0000FF;
+	const std::uint32_t GREEN = 0xFF00FF00;
+
+
+	SoftwareVertex MakeVertex(float x, float y, float z = 0.5f, float red = 1.0f, float green = 0.0f) {
+		return SoftwareVertex{ { x, y, z, 1.0f }, { red, green, 0.0f, 1.0f } };
+	}
+
+
+	// Pixel coordinates to normalized device coordinates of the whole target
+	std::pair<float, float> ToNdc(float x, float y) {
+		return std::make_pair(x / WIDTH * 2.0f - 1.0f, 1.0f - y / HEIGHT * 2.0f);
+	}
+
+
+	// Clockwise on the screen, covers the viewport
+	const SoftwareVertex QUAD[6] = {
+		MakeVertex(-1.0f, 1.0f), MakeVertex(1.0f, 1.0f), MakeVertex(1.0f, -1.0f),
+		MakeVertex(-1.0f, 1.0f), MakeVertex(1.0f, -1.0f), MakeVertex(-1.0f, -1.0f)
+	};
+
+
+	bool IsFilledWith(const SoftwareRenderTarget &target, std::uint32_t color) {
+		for (std::uint32_t y = 0; y < target.Height(); y++) {
+			for (std::uint32_t x = 0; x < target.Width(); x++) {
+				if (target.Colors()[y * target.RowPitch() + x] != color) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+
+	// Without workers the tiles are rasterized by the calling thread alone
+	const std::size_t WORKER_THREADS_COUNTS[] = { 0, 3 };
+}
+
+
+TEST(QuadCoversEveryPixel) {
+	for (std::size_t workerThreadsCount : WORKER_THREADS_COUNTS) {
+		JobSystem jobSystem(workerThreadsCount);
+		SoftwareRasterizer rasterizer(jobSystem);
+		SoftwareRenderTarget target(WIDTH, HEIGHT);
+
+		rasterizer.BeginFrame(target);
+		rasterizer.ClearColor(CLEAR_COLOR_VALUE);
+		rasterizer.ClearDepth(1.0f);
+		rasterizer.DrawTriangles(QUAD, 6);
+		rasterizer.EndFrame();
+
+		CHECK(rasterizer.LastFrameStatistics().pixelsShadedCount == WIDTH * HEIGHT);
+		CHECK(IsFilledWith(target, RED));
+	}
+}
+
+
+// Triangles of a mesh with shared edges shade every pixel exactly once: the
+// counters would show a pixel shaded twice, the clear color a pixel missed
+TEST(MeshIsWatertight) {
+	const int CELLS_COUNT = 37;
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+
+	// Grid with jittered inner points, so the edges aren't axis-aligned
+	std::vector<std::vector<std::pair<float, float>>> points(
+		CELLS_COUNT + 1, std::vector<std::pair<float, float>>(CELLS_COUNT + 1)
+	);
+	for (int i = 0; i <= CELLS_COUNT; i++) {
+		for (int j = 0; j <= CELLS_COUNT; j++) {
+			float x = float(i) * WIDTH / CELLS_COUNT;
+			float y = float(j) * HEIGHT / CELLS_COUNT;
+			if (i > 0 && i < CELLS_COUNT) {
+				x += jitter(random) * WIDTH / CELLS_COUNT;
+			}
+			if (j > 0 && j < CELLS_COUNT) {
+				y += jitter(random) * HEIGHT / CELLS_COUNT;
+			}
+			points[i][j] = ToNdc(x, y);
+		}
+	}
+
+	// Half of the triangles are counterclockwise
+	std::vector<SoftwareVertex> vertices;
+	for (int i = 0; i < CELLS_COUNT; i++) {
+		for (int j = 0; j < CELLS_COUNT; j++) {
+			for (const auto &point : { points[i][j], points[i + 1][j], points[i + 1][j + 1] }) {
+				vertices.push_back(MakeVertex(point.first, point.second));
+			}
+			for (const auto &point : { points[i][j], points[i][j + 1], points[i + 1][j + 1] }) {
+				vertices.push_back(MakeVertex(point.first, point.second));
+			}
+		}
+	}
+
+	// A fan around a vertex on a pixel center, where the most edges meet
+	std::vector<SoftwareVertex> fanVertices;
+	const std::pair<float, float> center = ToNdc(100.5f, 75.5f);
+	const float PI = 3.14159265f;
+	for (int i = 0; i < 24; i++) {
+		const float angles[2] = { 2.0f * PI * i / 24, 2.0f * PI * (i + 1) / 24 };
+		const std::pair<float, float> first = ToNdc(100.5f + 300.0f * std::cos(angles[0]), 75.5f + 300.0f * std::sin(angles[0]));
+		const std::pair<float, float> second = ToNdc(100.5f + 300.0f * std::cos(angles[1]), 75.5f + 300.0f * std::sin(angles[1]));
+
+		fanVertices.push_back(MakeVertex(center.first, center.second));
+		fanVertices.push_back(MakeVertex(first.first, first.second));
+		fanVertices.push_back(MakeVertex(second.first, second.second));
+	}
+
+	for (std::size_t workerThreadsCount : WORKER_THREADS_COUNTS) {
+		JobSystem jobSystem(workerThreadsCount);
+		SoftwareRasterizer rasterizer(jobSystem);
+		SoftwareRenderTarget target(WIDTH, HEIGHT);
+
+		for (const std::vector<SoftwareVertex> *mesh : { &vertices, &fanVertices }) {
+			rasterizer.BeginFrame(target);
+			rasterizer.ClearColor(CLEAR_COLOR_VALUE);
+			rasterizer.SetCullMode(SoftwareCullMode::NONE);
+			rasterizer.SetDepthTestEnabled(false);
+			rasterizer.DrawTriangles(mesh->data(), mesh->size());
+			rasterizer.EndFrame();
+
+			CHECK(rasterizer.LastFrameStatistics().pixelsShadedCount == WIDTH * HEIGHT);
+			CHECK(IsFilledWith(target, RED));
+		}
+
+		// The counterclockwise half is culled by default
+		rasterizer.BeginFrame(target);
+		rasterizer.DrawTriangles(vertices.data(), vertices.size());
+		rasterizer.EndFrame();
+
+		CHECK(rasterizer.LastFrameStatistics().trianglesSetUpCount == CELLS_COUNT * CELLS_COUNT);
+	}
+}
+
+
+TEST(DepthTestKeepsTheNearestTriangle) {
+	JobSystem jobSystem(0);
+	SoftwareRasterizer rasterizer(jobSystem);
+	SoftwareRenderTarget target(WIDTH, HEIGHT);
+
+	const SoftwareVertex nearTriangle[3] = {
+		MakeVertex(-1.0f, 1.0f, 0.2f, 0.0f, 1.0f),
+		MakeVertex(1.0f, 1.0f, 0.2f, 0.0f, 1.0f),
+		MakeVertex(1.0f, -1.0f, 0.2f, 0.0f, 1.0f)
+	};
+	const SoftwareVertex farTriangle[3] = {
+		MakeVertex(-1.0f, 1.0f, 0.7f), MakeVertex(1.0f, 1.0f, 0.7f), MakeVertex(1.0f, -1.0f, 0.7f)
+	};
+
+	rasterizer.BeginFrame(target);
+	rasterizer.ClearDepth(1.0f);
+	rasterizer.DrawTriangles(nearTriangle, 3);
+	rasterizer.DrawTriangles(farTriangle, 3);
+	rasterizer.EndFrame();
+
+	const std::uint32_t pixel = 10 * target.RowPitch() + 150;
+	CHECK(target.Colors()[pixel] == GREEN);
+	CHECK(std::fabs(target.Depths()[pixel] - 0.2f) < 1e-5f);
+}
+
+
+TEST(ScissorRectAndViewportLimitThePixels) {
+	JobSystem jobSystem(0);
+	SoftwareRasterizer rasterizer(jobSystem);
+	SoftwareRenderTarget target(WIDTH, HEIGHT);
+
+	rasterizer.BeginFrame(target);
+	rasterizer.SetDepthTestEnabled(false);
+	rasterizer.SetScissorRect(Rect{ 10, 20, 110, 70 });
+	rasterizer.DrawTriangles(QUAD, 6);
+	rasterizer.EndFrame();
+
+	CHECK(rasterizer.LastFrameStatistics().pixelsShadedCount == 100 * 50);
+
+	// Pixel centers at half-integer coordinates, the left and top edges are in
+	rasterizer.BeginFrame(target);
+	rasterizer.SetDepthTestEnabled(false);
+	rasterizer.SetViewport(Viewport{ 20.5f, 10.25f, 64.0f, 32.0f, 0.0f, 1.0f });
+	rasterizer.DrawTriangles(QUAD, 6);
+	rasterizer.EndFrame();
+
+	CHECK(rasterizer.LastFrameStatistics().pixelsShadedCount == 64 * 32);
+}
+
+
+TEST(ClearsAreOrderedWithDraws) {
+	JobSystem jobSystem(0);
+	SoftwareRasterizer rasterizer(jobSystem);
+	SoftwareRenderTarget target(WIDTH, HEIGHT);
+
+	// Clears ignore the scissor rect
+	rasterizer.BeginFrame(target);
+	rasterizer.SetDepthTestEnabled(false);
+	rasterizer.DrawTriangles(QUAD, 6);
+	rasterizer.SetScissorRect(Rect{ 0, 0, 1, 1 });
+	rasterizer.ClearColor(CLEAR_COLOR_VALUE);
+	rasterizer.EndFrame();
+
+	CHECK(IsFilledWith(target, CLEAR_COLOR));
+}
+
+
+TEST(TrianglesBehindTheCameraAreClipped) {
+	JobSystem jobSystem(0);
+	SoftwareRasterizer rasterizer(jobSystem);
+	SoftwareRenderTarget target(WIDTH, HEIGHT);
+
+	const SoftwareVertex behind[3] = {
+		{ { -1.0f, 1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+		{ { 1.0f, 1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } },
+		{ { 1.0f, -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } }
+	};
+
+	rasterizer.BeginFrame(target);
+	rasterizer.ClearColor(CLEAR_COLOR_VALUE);
+	rasterizer.SetCullMode(SoftwareCullMode::NONE);
+	rasterizer.DrawTriangles(behind, 3);
+	rasterizer.EndFrame();
+
+	CHECK(rasterizer.LastFrameStatistics().trianglesSetUpCount == 0);
+	CHECK(IsFilledWith(target, CLEAR_COLOR));
+}
+
+
+int main() {
+	return RunTests();
+}
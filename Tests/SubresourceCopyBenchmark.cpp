@@ -0,0 +1,140 @@
+#include "BenchmarkCommon.h"
+
+#include "SubresourceCopy.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+	const std::size_t PITCH_ALIGNMENT = 256;
+
+
+	struct Format {
+		const char *name;
+		std::size_t pixelSize;
+	};
+
+
+	const Format FORMATS[] = {
+		{ "R8", 1 },
+		{ "RGBA8", 4 },
+		{ "RGBA16F", 8 },
+		{ "RGBA32F", 16 }
+	};
+
+
+	// MemcpySubresource of d3dx12.h
+	void MemcpySubresource(const SubresourceCopy &copy) {
+		for (std::uint32_t slice = 0; slice < copy.slicesCount; slice++) {
+			std::uint8_t *destinationSlice = static_cast<std::uint8_t*>(copy.destination) + copy.destinationSlicePitch * slice;
+			const std::uint8_t *sourceSlice = static_cast<const std::uint8_t*>(copy.source) + copy.sourceSlicePitch * slice;
+
+			for (std::uint32_t row = 0; row < copy.rowsCount; row++) {
+				std::memcpy(
+					destinationSlice + copy.destinationRowPitch * row,
+					sourceSlice + copy.sourceRowPitch * row,
+					copy.rowSize
+				);
+			}
+		}
+	}
+
+
+	// Tightly packed image data into the layout of an upload buffer
+	void BenchmarkTexture(JobSystem &jobSystem, std::size_t width, const Format &format) {
+		const std::size_t rowSize = width * format.pixelSize;
+		const std::size_t rowPitch = (rowSize + PITCH_ALIGNMENT - 1) / PITCH_ALIGNMENT * PITCH_ALIGNMENT;
+		const std::uint32_t rowsCount = static_cast<std::uint32_t>(width);
+
+		std::vector<std::uint8_t> source(rowSize * rowsCount, 1);
+		std::vector<std::uint8_t> destination(rowPitch * rowsCount);
+
+		const SubresourceCopy copy{
+			destination.data(), rowPitch, rowPitch * rowsCount,
+			source.data(), rowSize, rowSize * rowsCount,
+			rowSize, rowsCount, 1
+		};
+
+		const double bytesCount = double(rowSize) * rowsCount;
+		char name[96];
+
+		const double memcpySeconds = MeasureSeconds([&copy] {
+			MemcpySubresource(copy);
+		});
+		std::snprintf(name, sizeof(name), "%zux%zu %s, row by row memcpy", width, width, format.name);
+		PrintMeasurement(name, bytesCount / memcpySeconds / (1 << 30), "GiB/s");
+
+		const double copySeconds = MeasureSeconds([&copy] {
+			CopySubresource(copy);
+		});
+		std::snprintf(name, sizeof(name), "%zux%zu %s, CopySubresource", width, width, format.name);
+		PrintMeasurement(name, bytesCount / copySeconds / (1 << 30), "GiB/s");
+
+		const double parallelSeconds = MeasureSeconds([&jobSystem, &copy] {
+			CopySubresources(jobSystem, &copy, 1);
+		});
+		std::snprintf(name, sizeof(name), "%zux%zu %s, CopySubresources", width, width, format.name);
+		PrintMeasurement(name, bytesCount / parallelSeconds / (1 << 30), "GiB/s");
+	}
+
+
+	// A mip chain whose rows are already aligned, copied in one range per level
+	void BenchmarkMipChain(JobSystem &jobSystem, std::size_t width) {
+		std::vector<std::vector<std::uint8_t>> sources;
+		std::vector<std::vector<std::uint8_t>> destinations;
+		std::vector<SubresourceCopy> copies;
+
+		double bytesCount = 0;
+		for (std::size_t levelWidth = width; levelWidth >= 64; levelWidth /= 2) {
+			const std::size_t size = levelWidth * 4 * levelWidth;
+			sources.emplace_back(size, 1);
+			destinations.emplace_back(size);
+			bytesCount += double(size);
+
+			copies.push_back(SubresourceCopy{
+				destinations.back().data(), levelWidth * 4, size,
+				sources.back().data(), levelWidth * 4, size,
+				levelWidth * 4, static_cast<std::uint32_t>(levelWidth), 1
+			});
+		}
+
+		char name[96];
+
+		const double memcpySeconds = MeasureSeconds([&copies] {
+			for (const SubresourceCopy &copy : copies) {
+				MemcpySubresource(copy);
+			}
+		});
+		std::snprintf(name, sizeof(name), "%zux%zu RGBA8 mip chain, row by row memcpy", width, width);
+		PrintMeasurement(name, bytesCount / memcpySeconds / (1 << 30), "GiB/s");
+
+		const double parallelSeconds = MeasureSeconds([&jobSystem, &copies] {
+			CopySubresources(jobSystem, copies.data(), copies.size());
+		});
+		std::snprintf(name, sizeof(name), "%zux%zu RGBA8 mip chain, CopySubresources", width, width);
+		PrintMeasurement(name, bytesCount / parallelSeconds / (1 << 30), "GiB/s");
+	}
+}
+
+
+int main() {
+	const unsigned int threadsCount = std::thread::hardware_concurrency();
+	JobSystem jobSystem(threadsCount > 1 ? threadsCount - 1 : 0);
+
+	for (std::size_t width : { 256, 1024, 2048 }) {
+		for (const Format &format : FORMATS) {
+			BenchmarkTexture(jobSystem, width, format);
+		}
+	}
+
+	for (std::size_t width : { 1024, 4096 }) {
+		BenchmarkMipChain(jobSystem, width);
+	}
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "TestCommon.h"
+
+#include "SubresourceCopy.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace {
+	// Layouts of a random copy. Half of them have matching pitches, so every
+	// path of CopySubresource is taken
+	struct RandomLayout {
+		std::size_t rowSize;
+		std::uint32_t rowsCount;
+		std::uint32_t slicesCount;
+		std::size_t sourceRowPitch;
+		std::size_t sourceSlicePitch;
+		std::size_t destinationRowPitch;
+		std::size_t destinationSlicePitch;
+		// Unaligned starts
+		std::size_t sourceOffset;
+		std::size_t destinationOffset;
+	};
+
+
+	RandomLayout MakeRandomLayout(std::mt19937 &random) {
+		RandomLayout layout;
+		layout.rowSize = 1 + random() % 3000;
+		layout.rowsCount = 1 + random() % 200;
+		layout.slicesCount = 1 + random() % 4;
+
+		layout.sourceRowPitch = layout.rowSize + (random() % 2 ? 0 : random() % 64);
+		layout.destinationRowPitch = random() % 2 ? layout.sourceRowPitch : layout.rowSize + random() % 300;
+
+		layout.sourceSlicePitch = layout.sourceRowPitch * layout.rowsCount + (random() % 2 ? 0 : random() % 100);
+		layout.destinationSlicePitch = random() % 2 && layout.destinationRowPitch == layout.sourceRowPitch
+			? layout.sourceSlicePitch
+			: layout.destinationRowPitch * layout.rowsCount + random() % 100;
+
+		layout.sourceOffset = random() % 8;
+		layout.destinationOffset = random() % 8;
+		return layout;
+	}
+
+
+	// Only the copied bytes are compared, the padding may be overwritten when the
+	// pitches match
+	bool IsCopied(const RandomLayout &layout, const std::vector<std::uint8_t> &source, const std::vector<std::uint8_t> &destination) {
+		for (std::size_t slice = 0; slice < layout.slicesCount; slice++) {
+			for (std::size_t row = 0; row < layout.rowsCount; row++) {
+				const std::uint8_t *expected = &source[
+					layout.sourceOffset + slice * layout.sourceSlicePitch + row * layout.sourceRowPitch
+				];
+				const std::uint8_t *actual = &destination[
+					layout.destinationOffset + slice * layout.destinationSlicePitch + row * layout.destinationRowPitch
+				];
+
+				if (std::memcmp(expected, actual, layout.rowSize) != 0) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+}
+
+
+TEST(StreamCopyCopiesUnalignedRanges) {
+	std::mt19937 random(1);
+	std::vector<std::uint8_t> source(4096);
+	for (std::uint8_t &byte : source) {
+		byte = static_cast<std::uint8_t>(random());
+	}
+
+	for (std::size_t size : { 0, 1, 15, 16, 17, 63, 64, 65, 1000, 4000 }) {
+		for (std::size_t offset = 0; offset < 16; offset += 5) {
+			std::vector<std::uint8_t> destination(4096 + 32, 0xCD);
+			StreamCopy(destination.data() + offset, source.data(), size);
+
+			CHECK(std::memcmp(destination.data() + offset, source.data(), size) == 0);
+			CHECK(destination[offset + size] == 0xCD);
+			CHECK(offset == 0 || destination[offset - 1] == 0xCD);
+		}
+	}
+}
+
+
+TEST(CopiesMatchRowByRowMemcpy) {
+	JobSystem jobSystem(3);
+	std::mt19937 random(2);
+
+	for (int iteration = 0; iteration < 300; iteration++) {
+		const RandomLayout layout = MakeRandomLayout(random);
+
+		std::vector<std::uint8_t> source(layout.sourceSlicePitch * layout.slicesCount + 8);
+		for (std::uint8_t &byte : source) {
+			byte = static_cast<std::uint8_t>(random());
+		}
+		std::vector<std::uint8_t> destination(layout.destinationSlicePitch * layout.slicesCount + 8, 0xCD);
+
+		const SubresourceCopy copy{
+			destination.data() + layout.destinationOffset, layout.destinationRowPitch, layout.destinationSlicePitch,
+			source.data() + layout.sourceOffset, layout.sourceRowPitch, layout.sourceSlicePitch,
+			layout.rowSize, layout.rowsCount, layout.slicesCount
+		};
+
+		if (iteration % 2 == 0) {
+			CopySubresource(copy);
+		} else {
+			CopySubresources(jobSystem, &copy, 1);
+		}
+
+		CHECK(IsCopied(layout, source, destination));
+	}
+}
+
+
+// Large enough to be split into chunks of rows over the threads
+TEST(BatchesAreSplitOverThreads) {
+	const std::size_t SLICE_SIZE = 4096 * 1024;
+	JobSystem jobSystem(3);
+	std::mt19937 random(3);
+
+	std::vector<std::uint8_t> source(SLICE_SIZE * 3);
+	for (std::uint8_t &byte : source) {
+		byte = static_cast<std::uint8_t>(random());
+	}
+	std::vector<std::uint8_t> destination(source.size());
+
+	SubresourceCopy copies[3];
+	for (std::size_t i = 0; i < 3; i++) {
+		// Rows of 4 KiB into rows with a pitch of 8 KiB
+		copies[i] = SubresourceCopy{
+			destination.data() + i * SLICE_SIZE, 8192, SLICE_SIZE,
+			source.data() + i * SLICE_SIZE, 4096, SLICE_SIZE / 2,
+			4096, 512, 1
+		};
+	}
+
+	CopySubresources(jobSystem, copies, 3);
+
+	for (std::size_t i = 0; i < 3; i++) {
+		for (std::size_t row = 0; row < 512; row++) {
+			CHECK(std::memcmp(&destination[i * SLICE_SIZE + row * 8192], &source[i * SLICE_SIZE + row * 4096], 4096) == 0);
+		}
+	}
+}
+
+
+int main() {
+	return RunTests();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+
+// Minimal test harness: TEST defines a test case, CHECK fails it and
+// RunTests runs every case of the executable, main returns its result
+
+
+struct TestCase {
+	const char *name;
+	void (*function)();
+};
+
+
+inline std::vector<TestCase>& TestCases() {
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+
+// Thrown by a failed CHECK, ends its test case
+struct TestFailure {
+};
+
+
+struct TestRegistration {
+	TestRegistration(const char *name, void (*function)()) {
+		TestCases().push_back({ name, function });
+	}
+};
+
+
+#define TEST(name) \
+	static void name(); \
+	static TestRegistration name##Registration(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			throw TestFailure(); \
+		} \
+	} while (false)
+
+// Checks that the expression throws the exception type
+#define CHECK_THROWS(expression, exceptionType) \
+	do { \
+		bool isThrown = false; \
+		try { \
+			expression; \
+		} catch (const exceptionType&) { \
+			isThrown = true; \
+		} \
+		if (!isThrown) { \
+			std::fprintf(stderr, "%s:%d: %s didn't throw %s\n", __FILE__, __LINE__, #expression, #exceptionType); \
+			throw TestFailure(); \
+		} \
+	} while (false)
+
+
+// Returns the exit code of the executable
+inline int RunTests() {
+	int failuresCount = 0;
+	for (const TestCase &testCase : TestCases()) {
+		std::printf("%s\n", testCase.name);
+		std::fflush(stdout);
+
+		try {
+			testCase.function();
+		} catch (const TestFailure&) {
+			failuresCount++;
+		} catch (const std::exception &exception) {
+			std::fprintf(stderr, "%s: unexpected exception: %s\n", testCase.name, exception.what());
+			failuresCount++;
+		}
+	}
+
+	std::printf("%d of %d tests failed\n", failuresCount, static_cast<int>(TestCases().size()));
+	return failuresCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include "BenchmarkCommon.h"
+
+#include "TextureFootprints.h"
+#include "Hash.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+	struct Texture {
+		const char *name;
+		TextureLayoutDesc desc;
+	};
+
+
+	const Texture TEXTURES[] = {
+		{ "2048x2048 BC7, 12 mips", { TextureDimension::TEXTURE_2D, 2048, 2048, 1, 12, 16, 4, 4 } },
+		{ "1024x1024 RGBA8 cube, 11 mips", { TextureDimension::TEXTURE_2D, 1024, 1024, 6, 11, 4, 1, 1 } },
+		{ "128x128x128 R16F volume, 8 mips", { TextureDimension::TEXTURE_3D, 128, 128, 128, 8, 2, 1, 1 } }
+	};
+
+
+	std::uint32_t SubresourcesCount(const TextureLayoutDesc &desc) {
+		return desc.dimension == TextureDimension::TEXTURE_3D ? desc.mipLevels : desc.mipLevels * desc.depthOrArraySize;
+	}
+
+
+	// Like the heap-allocating UpdateSubresources of d3dx12.h, which allocates
+	// the footprint arrays and queries them for every upload
+	void BenchmarkAllocatingPerUpload(const Texture &texture) {
+		const std::uint32_t subresourcesCount = SubresourcesCount(texture.desc);
+
+		const double seconds = MeasureSeconds([&texture, subresourcesCount] {
+			std::unique_ptr<SubresourceFootprint[]> footprints(new SubresourceFootprint[subresourcesCount]);
+			KeepValue(ComputeFootprints(texture.desc, 0, subresourcesCount, 0, footprints.get()));
+			KeepValue(footprints[0]);
+		});
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%s, allocated per upload", texture.name);
+		PrintMeasurement(name, seconds * 1e9, "ns");
+	}
+
+
+	// Like TextureUploadBatch, computed once and found by the fields of the description
+	void BenchmarkCached(const Texture &texture) {
+		using LayoutKey = std::array<std::uint64_t, 4>;
+
+		struct LayoutKeyHash {
+			std::size_t operator () (const LayoutKey &key) const {
+				return static_cast<std::size_t>(HashBytes(key.data(), sizeof(key)));
+			}
+		};
+
+		std::unordered_map<LayoutKey, std::vector<SubresourceFootprint>, LayoutKeyHash> layouts;
+
+		const double seconds = MeasureSeconds([&texture, &layouts] {
+			const TextureLayoutDesc &desc = texture.desc;
+			const LayoutKey key = {
+				desc.width,
+				(std::uint64_t(desc.height) << 32) | (std::uint64_t(desc.depthOrArraySize) << 16) | desc.mipLevels,
+				(std::uint64_t(desc.bytesPerBlock) << 32) | std::uint64_t(desc.dimension),
+				(std::uint64_t(desc.blockWidth) << 32) | desc.blockHeight
+			};
+
+			std::vector<SubresourceFootprint> &footprints = layouts[key];
+			if (footprints.empty()) {
+				footprints.resize(SubresourcesCount(desc));
+				ComputeFootprints(desc, 0, static_cast<std::uint32_t>(footprints.size()), 0, footprints.data());
+			}
+			KeepValue(footprints[0]);
+		});
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "%s, cached", texture.name);
+		PrintMeasurement(name, seconds * 1e9, "ns");
+	}
+}
+
+
+int main() {
+	for (const Texture &texture : TEXTURES) {
+		BenchmarkAllocatingPerUpload(texture);
+		BenchmarkCached(texture);
+	}
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+#include "TestCommon.h"
+
+#include "TextureFootprints.h"
+
+#include <cstdint>
+
+
+// The expected values are the ones of ID3D12Device::GetCopyableFootprints
+
+
+TEST(Texture2dArrayWithMips) {
+	// 100x60 RGBA8, 3 mips, 2 slices
+	const TextureLayoutDesc desc{ TextureDimension::TEXTURE_2D, 100, 60, 2, 3, 4, 1, 1 };
+	SubresourceFootprint footprints[6];
+	const std::uint64_t totalSize = ComputeFootprints(desc, 0, 6, 0, footprints);
+
+	CHECK(footprints[0].offset == 0);
+	CHECK(footprints[0].width == 100 && footprints[0].height == 60 && footprints[0].depth == 1);
+	CHECK(footprints[0].rowPitch == 512 && footprints[0].rowsCount == 60 && footprints[0].rowSize == 400);
+
+	CHECK(footprints[1].offset == 30720);
+	CHECK(footprints[1].width == 50 && footprints[1].height == 30);
+	CHECK(footprints[1].rowPitch == 256 && footprints[1].rowSize == 200);
+
+	CHECK(footprints[2].offset == 38400);
+	CHECK(footprints[2].width == 25 && footprints[2].height == 15);
+
+	// The second slice starts at its first mip again
+	CHECK(footprints[3].offset == 42496);
+	CHECK(footprints[3].width == 100 && footprints[3].rowsCount == 60);
+
+	// Without the padding after the last row
+	CHECK(totalSize == footprints[5].offset + 256 * 14 + 100);
+}
+
+
+TEST(BlockCompressedSizesAreRoundedUpToBlocks) {
+	// 13x13 BC1, 8 bytes per 4x4 block
+	const TextureLayoutDesc desc{ TextureDimension::TEXTURE_2D, 13, 13, 1, 4, 8, 4, 4 };
+	SubresourceFootprint footprints[4];
+	ComputeFootprints(desc, 0, 4, 0, footprints);
+
+	CHECK(footprints[0].width == 16 && footprints[0].height == 16);
+	CHECK(footprints[0].rowsCount == 4 && footprints[0].rowSize == 32 && footprints[0].rowPitch == 256);
+
+	// Mips smaller than a block still take a whole one
+	CHECK(footprints[2].width == 4 && footprints[2].rowsCount == 1 && footprints[2].rowSize == 8);
+	CHECK(footprints[3].width == 4 && footprints[3].height == 4 && footprints[3].rowsCount == 1);
+}
+
+
+TEST(Texture3dMipsHalveTheDepth) {
+	// 64x64x16 RGBA8, the second mip only, after 1 KiB of other data
+	const TextureLayoutDesc desc{ TextureDimension::TEXTURE_3D, 64, 64, 16, 2, 4, 1, 1 };
+	SubresourceFootprint footprint;
+	const std::uint64_t totalSize = ComputeFootprints(desc, 1, 1, 1024, &footprint);
+
+	CHECK(footprint.offset == 1024);
+	CHECK(footprint.width == 32 && footprint.height == 32 && footprint.depth == 8);
+	CHECK(footprint.rowPitch == 256 && footprint.rowsCount == 32 && footprint.rowSize == 128);
+
+	// Every row of every depth slice but the last is padded to the pitch
+	CHECK(totalSize == 256 * (32 * 8 - 1) + 128);
+}
+
+
+TEST(Texture1dHasOneRow) {
+	const TextureLayoutDesc desc{ TextureDimension::TEXTURE_1D, 1000, 1, 1, 2, 2, 1, 1 };
+	SubresourceFootprint footprints[2];
+	const std::uint64_t totalSize = ComputeFootprints(desc, 0, 2, 0, footprints);
+
+	CHECK(footprints[0].height == 1 && footprints[0].rowsCount == 1 && footprints[0].rowSize == 2000);
+	CHECK(footprints[1].offset == 2048);
+	CHECK(footprints[1].width == 500 && footprints[1].rowSize == 1000);
+	CHECK(totalSize == 2048 + 1000);
+}
+
+
+TEST(BufferIsOneRow) {
+	const TextureLayoutDesc desc{ TextureDimension::BUFFER, 1000, 1, 1, 1, 1, 1, 1 };
+	SubresourceFootprint footprint;
+	const std::uint64_t totalSize = ComputeFootprints(desc, 0, 1, 512, &footprint);
+
+	CHECK(footprint.offset == 512);
+	CHECK(footprint.width == 1000 && footprint.rowsCount == 1 && footprint.rowSize == 1000);
+	CHECK(totalSize == 1000);
+}
+
+
+int main() {
+	return RunTests();
+}
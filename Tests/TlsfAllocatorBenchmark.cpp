@@ -0,0 +1,111 @@
+#include "BenchmarkCommon.h"
+
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+// Like a 256 MiB heap of placed resources
+static const std::uint64_t HEAP_SIZE = 256ull << 20;
+static const std::uint64_t PLACEMENT_ALIGNMENT = 64 * 1024;
+
+
+// Sizes of textures and buffers, mostly small with a few large ones
+static std::uint64_t RandomResourceSize(std::mt19937_64 &random) {
+	const std::uint64_t maxSize = 4096ull << (random() % 12);
+	return 256 + random() % maxSize;
+}
+
+
+// Allocate and free pairs with a steady number of live allocations, small
+// enough that the heap holds all of them
+static void BenchmarkThroughput(std::size_t liveAllocationsCount) {
+	TlsfAllocator allocator(HEAP_SIZE);
+	std::mt19937_64 random(1);
+
+	std::vector<TlsfAllocator::Allocation> liveAllocations;
+	while (liveAllocations.size() < liveAllocationsCount) {
+		liveAllocations.push_back(allocator.Allocate(RandomResourceSize(random) / 256, 256));
+	}
+
+	// Sizes are drawn up front, so the generator isn't measured
+	std::vector<std::uint64_t> sizes(4096);
+	for (std::uint64_t &size : sizes) {
+		size = RandomResourceSize(random) / 256;
+	}
+
+	std::size_t index = 0;
+	const double seconds = MeasureSeconds([&allocator, &liveAllocations, &sizes, &index] {
+		for (int i = 0; i < 1000; i++) {
+			index++;
+			TlsfAllocator::Allocation &allocation = liveAllocations[index * 7919 % liveAllocations.size()];
+			if (allocation.offset != TlsfAllocator::INVALID_OFFSET) {
+				allocator.Free(allocation);
+			}
+			allocation = allocator.Allocate(sizes[index % sizes.size()], 256);
+		}
+	});
+
+	char name[96];
+	std::snprintf(name, sizeof(name), "Allocate and free, %zu live allocations", liveAllocationsCount);
+	PrintMeasurement(name, seconds / 1000 * 1e9, "ns");
+}
+
+
+// Churns placed resources at a high occupancy and reports how fragmented the
+// free memory ends up and how often an allocation that fits in total fails
+static void BenchmarkFragmentation(double targetOccupancy) {
+	TlsfAllocator allocator(HEAP_SIZE);
+	std::mt19937_64 random(2);
+
+	std::vector<TlsfAllocator::Allocation> liveAllocations;
+	int fittingAttemptsCount = 0;
+	int fittingFailuresCount = 0;
+
+	for (int iteration = 0; iteration < 200000; iteration++) {
+		const double occupancy = 1.0 - double(allocator.FreeSize()) / double(HEAP_SIZE);
+		if (occupancy < targetOccupancy || liveAllocations.empty()) {
+			const std::uint64_t size = RandomResourceSize(random);
+			const TlsfAllocator::Allocation allocation = allocator.Allocate(size, PLACEMENT_ALIGNMENT);
+
+			if (size <= allocator.FreeSize()) {
+				fittingAttemptsCount++;
+				if (allocation.offset == TlsfAllocator::INVALID_OFFSET) {
+					fittingFailuresCount++;
+				}
+			}
+			if (allocation.offset != TlsfAllocator::INVALID_OFFSET) {
+				liveAllocations.push_back(allocation);
+			}
+		} else {
+			const std::size_t index = random() % liveAllocations.size();
+			allocator.Free(liveAllocations[index]);
+			liveAllocations[index] = liveAllocations.back();
+			liveAllocations.pop_back();
+		}
+	}
+
+	char name[96];
+	std::snprintf(name, sizeof(name), "Largest free block / free size at %.0f%% occupancy", targetOccupancy * 100);
+	PrintMeasurement(name, 100.0 * double(allocator.LargestFreeBlockSize()) / double(allocator.FreeSize()), "%");
+
+	std::snprintf(name, sizeof(name), "Failed allocations that fit at %.0f%% occupancy", targetOccupancy * 100);
+	PrintMeasurement(name, 100.0 * fittingFailuresCount / std::max(fittingAttemptsCount, 1), "%");
+}
+
+
+int main() {
+	for (std::size_t liveAllocationsCount : { 16, 1024, 65536 }) {
+		BenchmarkThroughput(liveAllocationsCount);
+	}
+
+	for (double targetOccupancy : { 0.5, 0.75, 0.9 }) {
+		BenchmarkFragmentation(targetOccupancy);
+	}
+
+	return 0;
+}
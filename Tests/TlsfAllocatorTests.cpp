@@ -0,0 +1,123 @@
+#include "TestCommon.h"
+
+#include "TlsfAllocator.h"
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+
+TEST(AllocatesTheWholeRange) {
+	TlsfAllocator allocator(1 << 20);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.LargestFreeBlockSize() == 1 << 20);
+
+	const TlsfAllocator::Allocation allocation = allocator.Allocate(1 << 20);
+	CHECK(allocation.offset == 0);
+	CHECK(allocator.FreeSize() == 0);
+	CHECK(allocator.AllocationsCount() == 1);
+	CHECK(allocator.Allocate(1).offset == TlsfAllocator::INVALID_OFFSET);
+
+	allocator.Free(allocation);
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.AllocationsCount() == 0);
+}
+
+
+TEST(FreedNeighboursMerge) {
+	TlsfAllocator allocator(3 * 4096);
+	const TlsfAllocator::Allocation first = allocator.Allocate(4096);
+	const TlsfAllocator::Allocation second = allocator.Allocate(4096);
+	const TlsfAllocator::Allocation third = allocator.Allocate(4096);
+	CHECK(allocator.FreeSize() == 0);
+
+	// The middle block merges with both neighbours into the whole range
+	allocator.Free(first);
+	allocator.Free(third);
+	CHECK(allocator.LargestFreeBlockSize() == 4096);
+	allocator.Free(second);
+	CHECK(allocator.LargestFreeBlockSize() == 3 * 4096);
+}
+
+
+TEST(RespectsAlignment) {
+	TlsfAllocator allocator(1 << 24);
+	allocator.Allocate(3);
+
+	// Placed resources need 64 KiB, small ones 4 KiB and MSAA ones 4 MiB
+	for (std::uint64_t alignment : { 4096ull, 65536ull, 4194304ull }) {
+		const TlsfAllocator::Allocation allocation = allocator.Allocate(100, alignment);
+		CHECK(allocation.offset != TlsfAllocator::INVALID_OFFSET);
+		CHECK(allocation.offset % alignment == 0);
+	}
+}
+
+
+// Random allocations and frees, checked against a map of the live ranges
+TEST(Fuzz) {
+	const std::uint64_t SIZE = 1 << 26;
+	TlsfAllocator allocator(SIZE);
+	std::mt19937_64 random(1);
+
+	struct LiveAllocation {
+		TlsfAllocator::Allocation allocation;
+		std::uint64_t size;
+	};
+	std::vector<LiveAllocation> liveAllocations;
+	// Offset to size
+	std::map<std::uint64_t, std::uint64_t> liveRanges;
+
+	for (int iteration = 0; iteration < 200000; iteration++) {
+		if (liveAllocations.empty() || random() % 2 == 0) {
+			const std::uint64_t size = 1 + random() % (1ull << (random() % 20));
+			const std::uint64_t alignment = 1ull << (random() % 17);
+
+			const TlsfAllocator::Allocation allocation = allocator.Allocate(size, alignment);
+			if (allocation.offset == TlsfAllocator::INVALID_OFFSET) {
+				continue;
+			}
+
+			CHECK(allocation.offset % alignment == 0);
+			CHECK(allocation.offset + size <= SIZE);
+
+			const auto next = liveRanges.lower_bound(allocation.offset);
+			CHECK(next == liveRanges.end() || next->first >= allocation.offset + size);
+			if (next != liveRanges.begin()) {
+				const auto previous = std::prev(next);
+				CHECK(previous->first + previous->second <= allocation.offset);
+			}
+
+			liveRanges[allocation.offset] = size;
+			liveAllocations.push_back({ allocation, size });
+		} else {
+			const std::size_t index = random() % liveAllocations.size();
+			allocator.Free(liveAllocations[index].allocation);
+			liveRanges.erase(liveAllocations[index].allocation.offset);
+
+			liveAllocations[index] = liveAllocations.back();
+			liveAllocations.pop_back();
+		}
+
+		CHECK(allocator.AllocationsCount() == liveAllocations.size());
+	}
+
+	// Alignment padding goes back to the free blocks, nothing leaks
+	std::uint64_t usedSize = 0;
+	for (const LiveAllocation &liveAllocation : liveAllocations) {
+		usedSize += liveAllocation.size;
+	}
+	CHECK(usedSize + allocator.FreeSize() == SIZE);
+
+	for (const LiveAllocation &liveAllocation : liveAllocations) {
+		allocator.Free(liveAllocation.allocation);
+	}
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.LargestFreeBlockSize() == SIZE);
+}
+
+
+int main() {
+	return RunTests();
+}
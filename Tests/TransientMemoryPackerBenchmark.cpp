@@ -0,0 +1,55 @@
+#include "BenchmarkCommon.h"
+
+#include "TransientMemoryPacker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+// A frame of render targets and buffers over a chain of passes, each resource
+// used by a few consecutive passes
+static std::vector<TransientResourceLifetime> SyntheticFrame(std::size_t resourcesCount, std::uint32_t passesCount) {
+	std::mt19937 random(static_cast<std::uint32_t>(resourcesCount));
+	std::vector<TransientResourceLifetime> resources(resourcesCount);
+
+	for (TransientResourceLifetime &resource : resources) {
+		// 64 KiB to 32 MiB, like buffers up to 4K render targets
+		resource.size = (1 + random() % 512) * 65536;
+		resource.alignment = 65536;
+		resource.firstPass = random() % passesCount;
+		resource.lastPass = std::min(passesCount - 1, static_cast<std::uint32_t>(resource.firstPass + random() % 8));
+	}
+
+	return resources;
+}
+
+
+int main() {
+	TransientMemoryPacker packer;
+
+	for (std::size_t resourcesCount : { 100, 300, 1000 }) {
+		const std::uint32_t passesCount = static_cast<std::uint32_t>(resourcesCount / 4);
+		const std::vector<TransientResourceLifetime> resources = SyntheticFrame(resourcesCount, passesCount);
+
+		std::uint64_t totalSize = 0;
+		for (const TransientResourceLifetime &resource : resources) {
+			totalSize += resource.size;
+		}
+
+		const double seconds = MeasureSeconds([&packer, &resources] {
+			KeepValue(packer.Pack(resources.data(), resources.size()));
+		});
+
+		char name[96];
+		std::snprintf(name, sizeof(name), "Pack %zu resources over %u passes", resourcesCount, passesCount);
+		PrintMeasurement(name, seconds * 1e6, "us");
+
+		std::snprintf(name, sizeof(name), "Packed memory / total size of %zu resources", resourcesCount);
+		PrintMeasurement(name, 100.0 * double(packer.MemorySize()) / double(totalSize), "%");
+	}
+
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include "TestCommon.h"
+
+#include "TransientMemoryPacker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+namespace {
+	bool LifetimesOverlap(const TransientResourceLifetime &a, const TransientResourceLifetime &b) {
+		return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+	}
+
+
+	bool MemoryOverlaps(
+		const TransientMemoryPacker &packer,
+		const std::vector<TransientResourceLifetime> &resources,
+		std::size_t a,
+		std::size_t b
+	) {
+		return packer.Offset(a) < packer.Offset(b) + resources[b].size
+			&& packer.Offset(b) < packer.Offset(a) + resources[a].size;
+	}
+}
+
+
+TEST(DisjointLifetimesShareMemory) {
+	const std::vector<TransientResourceLifetime> resources = {
+		{ 1 << 20, 65536, 0, 1 },
+		{ 1 << 19, 65536, 2, 3 },
+		{ 1 << 18, 65536, 4, 4 },
+	};
+
+	TransientMemoryPacker packer;
+	CHECK(packer.Pack(resources.data(), resources.size()) == 1 << 20);
+
+	for (std::size_t i = 0; i < resources.size(); i++) {
+		CHECK(packer.Offset(i) == 0);
+	}
+
+	CHECK(packer.AliasedResources(0).empty());
+	CHECK(packer.AliasedResources(1) == std::vector<std::uint32_t>{ 0 });
+	CHECK((packer.AliasedResources(2) == std::vector<std::uint32_t>{ 0, 1 }));
+}
+
+
+TEST(OverlappingLifetimesDontShareMemory) {
+	const std::vector<TransientResourceLifetime> resources = {
+		{ 1000, 256, 0, 2 },
+		{ 3000, 4096, 1, 3 },
+		{ 100, 65536, 2, 2 },
+	};
+
+	TransientMemoryPacker packer;
+	const std::uint64_t memorySize = packer.Pack(resources.data(), resources.size());
+
+	for (std::size_t i = 0; i < resources.size(); i++) {
+		CHECK(packer.Offset(i) % resources[i].alignment == 0);
+		CHECK(packer.Offset(i) + resources[i].size <= memorySize);
+		CHECK(packer.AliasedResources(i).empty());
+
+		for (std::size_t j = i + 1; j < resources.size(); j++) {
+			CHECK(!MemoryOverlaps(packer, resources, i, j));
+		}
+	}
+}
+
+
+// Random frames checked against the definitions, packed by one packer that
+// reuses its scratch memory
+TEST(RandomFrames) {
+	std::mt19937 random(3);
+	TransientMemoryPacker packer;
+
+	for (int frame = 0; frame < 20; frame++) {
+		std::vector<TransientResourceLifetime> resources(50 + random() % 250);
+		std::uint64_t totalSize = 0;
+		std::uint64_t largestSize = 0;
+
+		for (TransientResourceLifetime &resource : resources) {
+			resource.alignment = 1ull << (8 + random() % 9);
+			resource.size = 1 + random() % (1 << 22);
+			resource.firstPass = random() % 50;
+			resource.lastPass = resource.firstPass + random() % 10;
+
+			totalSize += resource.size;
+			largestSize = std::max(largestSize, resource.size);
+		}
+
+		const std::uint64_t memorySize = packer.Pack(resources.data(), resources.size());
+		CHECK(memorySize == packer.MemorySize());
+		CHECK(memorySize >= largestSize);
+		CHECK(memorySize < totalSize);
+
+		for (std::size_t i = 0; i < resources.size(); i++) {
+			CHECK(packer.Offset(i) % resources[i].alignment == 0);
+			CHECK(packer.Offset(i) + resources[i].size <= memorySize);
+
+			std::vector<std::uint32_t> expectedAliasedResources;
+			for (std::size_t j = 0; j < resources.size(); j++) {
+				if (j == i) {
+					continue;
+				}
+
+				const bool memoryOverlaps = MemoryOverlaps(packer, resources, i, j);
+				CHECK(!(memoryOverlaps && LifetimesOverlap(resources[i], resources[j])));
+
+				if (memoryOverlaps && resources[j].lastPass < resources[i].firstPass) {
+					expectedAliasedResources.push_back(static_cast<std::uint32_t>(j));
+				}
+			}
+
+			CHECK(packer.AliasedResources(i) == expectedAliasedResources);
+		}
+	}
+}
+
+
+int main() {
+	return RunTests();
+}
@@ -0,0 +1,220 @@
+#include "TestCommon.h"
+
+#include "CpuTimelineFence.h"
+#include "UploadRing.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace {
+	// Completes labels when the test says so, like a GPU that is paused. Waiting
+	// for a label completes it, like a GPU that catches up, and is recorded
+	class FakeFence {
+	public:
+		struct Label {
+			std::uint64_t value;
+		};
+
+		std::vector<std::uint64_t> waitedValues;
+
+	public:
+		Label PutLabel() {
+			return Label{ ++mPutValue };
+		}
+
+		bool IsComplete(const Label &label) const {
+			return mCompletedValue >= label.value;
+		}
+
+		void WaitForLabel(const Label &label) {
+			waitedValues.push_back(label.value);
+			Complete(label);
+		}
+
+		void Complete(const Label &label) {
+			if (label.value > mCompletedValue) {
+				mCompletedValue = label.value;
+			}
+		}
+
+	private:
+		std::uint64_t mPutValue = 0;
+		std::uint64_t mCompletedValue = 0;
+	};
+
+
+	// Host memory standing in for an upload heap, GPU addresses of different
+	// buffers don't overlap
+	class HostBuffer {
+	public:
+		HostBuffer(std::uint64_t size, std::uint64_t gpuAddress, int &liveBuffersCount)
+		: mMemory(size), mGpuAddress(gpuAddress), mLiveBuffersCount(liveBuffersCount) {
+			mLiveBuffersCount++;
+		}
+
+		~HostBuffer() {
+			mLiveBuffersCount--;
+		}
+
+		std::uint8_t* CpuAddress() {
+			return mMemory.data();
+		}
+
+		std::uint64_t GpuAddress() const {
+			return mGpuAddress;
+		}
+
+	private:
+		std::vector<std::uint8_t> mMemory;
+		std::uint64_t mGpuAddress;
+		int &mLiveBuffersCount;
+	};
+
+
+	template <typename Fence>
+	using HostUploadRing = UploadRing<Fence, HostBuffer>;
+
+
+	template <typename Fence>
+	typename HostUploadRing<Fence>::BufferFactory HostBufferFactory(int &liveBuffersCount) {
+		std::uint64_t nextGpuAddress = 0x10000;
+		return [&liveBuffersCount, nextGpuAddress](std::uint64_t size) mutable {
+			const std::uint64_t gpuAddress = nextGpuAddress;
+			nextGpuAddress += (size + 0xffff) & ~std::uint64_t(0xffff);
+			return std::unique_ptr<HostBuffer>(new HostBuffer(size, gpuAddress, liveBuffersCount));
+		};
+	}
+}
+
+
+TEST(AllocationsAreAligned) {
+	FakeFence fence;
+	int liveBuffersCount = 0;
+	HostUploadRing<FakeFence> ring(fence, HostBufferFactory<FakeFence>(liveBuffersCount), 4096, 4096);
+
+	const auto bytes = ring.Allocate(10, 1);
+	CHECK(bytes.offset == 0);
+
+	const auto constants = ring.AllocateConstants(100);
+	CHECK(constants.offset == 256);
+	CHECK(constants.buffer == bytes.buffer);
+	CHECK(constants.cpuAddress == bytes.buffer->CpuAddress() + 256);
+	CHECK(constants.gpuAddress == bytes.buffer->GpuAddress() + 256);
+
+	const auto textureData = ring.AllocateTextureData(100);
+	CHECK(textureData.offset == 512);
+
+	const auto moreBytes = ring.Allocate(3, 4);
+	CHECK(moreBytes.offset == 612);
+
+	CHECK(fence.waitedValues.empty());
+}
+
+
+TEST(AllocationsWrapAroundOnceTheOldestFrameCompletes) {
+	FakeFence fence;
+	int liveBuffersCount = 0;
+	HostUploadRing<FakeFence> ring(fence, HostBufferFactory<FakeFence>(liveBuffersCount), 1024, 1024);
+
+	CHECK(ring.Allocate(400, 1).offset == 0);
+	const FakeFence::Label firstLabel = fence.PutLabel();
+	ring.EndFrame(firstLabel);
+
+	CHECK(ring.Allocate(400, 1).offset == 400);
+	ring.EndFrame(fence.PutLabel());
+
+	// Doesn't fit at the end, the beginning is free once the first frame is done
+	fence.Complete(firstLabel);
+	CHECK(ring.AllocateConstants(300).offset == 0);
+	CHECK(ring.Allocate(100, 1).offset == 300);
+
+	CHECK(fence.waitedValues.empty());
+}
+
+
+TEST(AllocateWaitsForTheOldestFrameInFlight) {
+	FakeFence fence;
+	int liveBuffersCount = 0;
+	HostUploadRing<FakeFence> ring(fence, HostBufferFactory<FakeFence>(liveBuffersCount), 1024, 1024);
+
+	CHECK(ring.Allocate(400, 1).offset == 0);
+	const FakeFence::Label firstLabel = fence.PutLabel();
+	ring.EndFrame(firstLabel);
+
+	CHECK(ring.Allocate(400, 1).offset == 400);
+	const FakeFence::Label secondLabel = fence.PutLabel();
+	ring.EndFrame(secondLabel);
+
+	// Only the first frame has to complete to make room
+	CHECK(ring.Allocate(300, 1).offset == 0);
+	CHECK(fence.waitedValues.size() == 1);
+	CHECK(fence.waitedValues[0] == firstLabel.value);
+	CHECK(!fence.IsComplete(secondLabel));
+}
+
+
+TEST(AllocateBlocksUntilTheLabelIsSignaled) {
+	CpuTimelineFence fence;
+	int liveBuffersCount = 0;
+	HostUploadRing<CpuTimelineFence> ring(fence, HostBufferFactory<CpuTimelineFence>(liveBuffersCount), 1024, 1024);
+
+	ring.Allocate(1000, 1);
+	const CpuTimelineFence::Label label = fence.PutLabel();
+	ring.EndFrame(label);
+
+	std::thread gpuThread([&fence, label] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		fence.Signal(label);
+	});
+
+	const auto allocation = ring.Allocate(1000, 1);
+	const bool isComplete = fence.IsComplete(label);
+	gpuThread.join();
+
+	CHECK(allocation.offset == 0);
+	CHECK(isComplete);
+}
+
+
+TEST(FrameLargerThanTheRingThrows) {
+	FakeFence fence;
+	int liveBuffersCount = 0;
+	HostUploadRing<FakeFence> ring(fence, HostBufferFactory<FakeFence>(liveBuffersCount), 1024, 1024);
+
+	ring.Allocate(600, 1);
+	CHECK_THROWS(ring.Allocate(600, 1), std::runtime_error);
+}
+
+
+TEST(DedicatedBuffersAreReleasedOnceTheirFrameCompletes) {
+	FakeFence fence;
+	int liveBuffersCount = 0;
+	HostUploadRing<FakeFence> ring(fence, HostBufferFactory<FakeFence>(liveBuffersCount), 1024, 256);
+	CHECK(liveBuffersCount == 1);
+
+	const auto small = ring.AllocateConstants(256);
+	const auto large = ring.AllocateConstants(1000);
+	CHECK(large.buffer != small.buffer);
+	CHECK(large.offset == 0);
+	CHECK(large.cpuAddress == large.buffer->CpuAddress());
+	CHECK(liveBuffersCount == 2);
+
+	const FakeFence::Label label = fence.PutLabel();
+	ring.EndFrame(label);
+	ring.EndFrame(fence.PutLabel());
+	CHECK(liveBuffersCount == 2);
+
+	fence.Complete(label);
+	ring.EndFrame(fence.PutLabel());
+	CHECK(liveBuffersCount == 1);
+}
+
+
+int main() {
+	return RunTests();
+}